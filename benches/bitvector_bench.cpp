@@ -0,0 +1,149 @@
+#include <benchmark/benchmark.h>
+#include "bitvector.hpp"
+#include "vector.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+
+// Flags with about one in one_in set
+static xd::vector<bool> make_flags(size_t n, unsigned one_in, unsigned seed) {
+    std::mt19937 rng(seed);
+    xd::vector<bool> flags;
+    flags.reserve(n);
+    for(size_t i=0; i<n; i++) {
+        flags.push_back(rng() % one_in == 0);
+    }
+    return flags;
+}
+
+// The filter intersection as it runs today, a byte per flag
+static void byte_flags_and(benchmark::State& state) {
+    const auto a = make_flags(state.range(0), 2, 1);
+    const auto b = make_flags(state.range(0), 2, 2);
+    auto res = a;
+    for(auto _ : state) {
+        for(size_t i=0; i<res.size(); i++) {
+            res[i] = res[i] & b[i];
+        }
+        benchmark::DoNotOptimize(res.data());
+    }
+    state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+
+static void std_vector_bool_and(benchmark::State& state) {
+    const auto a = make_flags(state.range(0), 2, 1);
+    const auto b = make_flags(state.range(0), 2, 2);
+    std::vector<bool> res(a.begin(), a.end());
+    const std::vector<bool> other(b.begin(), b.end());
+    for(auto _ : state) {
+        for(size_t i=0; i<res.size(); i++) {
+            res[i] = res[i] && other[i];
+        }
+        benchmark::DoNotOptimize(&res);
+    }
+    state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+
+static void bitvector_and(benchmark::State& state) {
+    const auto a = make_flags(state.range(0), 2, 1);
+    const auto b = make_flags(state.range(0), 2, 2);
+    xd::bitvector res(a.begin(), a.end());
+    const xd::bitvector other(b.begin(), b.end());
+    for(auto _ : state) {
+        res &= other;
+        benchmark::DoNotOptimize(res.data());
+    }
+    state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+
+static void byte_flags_count(benchmark::State& state) {
+    const auto flags = make_flags(state.range(0), 2, 1);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(std::count(flags.begin(), flags.end(), true));
+    }
+    state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+
+static void std_vector_bool_count(benchmark::State& state) {
+    const auto flags = make_flags(state.range(0), 2, 1);
+    const std::vector<bool> bits(flags.begin(), flags.end());
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(std::count(bits.begin(), bits.end(), true));
+    }
+    state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+
+static void bitvector_count(benchmark::State& state) {
+    const auto flags = make_flags(state.range(0), 2, 1);
+    const xd::bitvector bits(flags.begin(), flags.end());
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(bits.count());
+    }
+    state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+
+// Visiting every set flag of a sparse filter
+static void byte_flags_scan(benchmark::State& state) {
+    const auto flags = make_flags(state.range(0), 1000, 1);
+    for(auto _ : state) {
+        size_t sum = 0;
+        for(size_t i=0; i<flags.size(); i++) {
+            if(flags[i]) {
+                sum += i;
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+
+static void bitvector_find_next(benchmark::State& state) {
+    const auto flags = make_flags(state.range(0), 1000, 1);
+    const xd::bitvector bits(flags.begin(), flags.end());
+    for(auto _ : state) {
+        size_t sum = 0;
+        for(size_t i=bits.find_first(); i!=xd::bitvector::npos; i=bits.find_next(i)) {
+            sum += i;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+
+static void bitvector_rank(benchmark::State& state) {
+    const auto flags = make_flags(state.range(0), 2, 1);
+    const xd::bitvector bits(flags.begin(), flags.end());
+    const xd::rank_select index(bits);
+    std::mt19937_64 rng(9);
+    size_t sum = 0;
+    for(auto _ : state) {
+        sum += index.rank(rng() % bits.size());
+    }
+    benchmark::DoNotOptimize(sum);
+}
+
+static void bitvector_select(benchmark::State& state) {
+    const auto flags = make_flags(state.range(0), 2, 1);
+    const xd::bitvector bits(flags.begin(), flags.end());
+    const xd::rank_select index(bits);
+    std::mt19937_64 rng(9);
+    size_t sum = 0;
+    for(auto _ : state) {
+        sum += index.select(rng() % index.ones());
+    }
+    benchmark::DoNotOptimize(sum);
+}
+
+BENCHMARK(byte_flags_and)->Arg(1<<24);
+BENCHMARK(std_vector_bool_and)->Arg(1<<24);
+BENCHMARK(bitvector_and)->Arg(1<<24);
+BENCHMARK(byte_flags_count)->Arg(1<<24);
+BENCHMARK(std_vector_bool_count)->Arg(1<<24);
+BENCHMARK(bitvector_count)->Arg(1<<24);
+BENCHMARK(byte_flags_scan)->Arg(1<<24);
+BENCHMARK(bitvector_find_next)->Arg(1<<24);
+BENCHMARK(bitvector_rank)->Arg(1<<24);
+BENCHMARK(bitvector_select)->Arg(1<<24);
+BENCHMARK_MAIN();
@@ -0,0 +1,174 @@
+#!/usr/bin/env python3
+"""Checks vector_suite results against a baseline.
+
+    cmake -S . -B build -DCMAKE_BUILD_TYPE=Release
+    vector_suite --benchmark_out=times.json --benchmark_out_format=json
+    vector_suite_counters --benchmark_out=counters.json --benchmark_out_format=json
+    compare.py merge times.json counters.json -o run.json
+    compare.py check baseline.json run.json
+
+merge copies the allocs and bytes_moved counters from the instrumented run
+onto the times of the plain one. To refresh the baseline merge straight
+into baseline.json.
+
+Times slower than the baseline by more than --threshold are regressions.
+The allocs and bytes_moved counters are deterministic, so any increase in
+them is a regression whatever the threshold. With --normalise each xd/
+time is divided by the std/ time of the same operation in its own run,
+which makes a baseline from one machine usable on another.
+
+Runs record the build type of the suite as xd_build_type, and check refuses
+to compare a run against a baseline from a different build type. The
+checked in baseline is from a Release build.
+
+Exits 1 if anything regressed, 2 on bad input.
+"""
+import argparse
+import json
+import re
+import sys
+
+COUNTERS = ("allocs", "bytes_moved")
+
+
+def key(bench):
+    # vector_suite_counters fixes the iteration count, which shows in names
+    return re.sub(r"/iterations:\d+", "", bench.get("run_name", bench["name"]))
+
+
+def build_type(path):
+    with open(path) as f:
+        return json.load(f).get("context", {}).get("xd_build_type")
+
+
+def load(path):
+    with open(path) as f:
+        data = json.load(f)
+    runs = {}
+    medians = {}
+    for bench in data.get("benchmarks", []):
+        if bench.get("error_occurred"):
+            continue
+        if bench.get("run_type") == "aggregate":
+            # With --benchmark_repetitions the median is the stable figure
+            if bench.get("aggregate_name") == "median":
+                medians[key(bench)] = bench
+            continue
+        runs.setdefault(key(bench), bench)
+    runs.update(medians)
+    return runs
+
+
+def relative_time(runs, name, metric):
+    """xd time over the std time of the same operation, type and size."""
+    if not name.startswith("xd/"):
+        return None
+    reference = runs.get("std/" + name[len("xd/"):])
+    if reference is None or reference[metric] == 0:
+        return None
+    return runs[name][metric] / reference[metric]
+
+
+def merge(args):
+    with open(args.times) as f:
+        times = json.load(f)
+    counters = load(args.counters)
+    for bench in times.get("benchmarks", []):
+        source = counters.get(key(bench))
+        if source is None:
+            continue
+        for counter in COUNTERS:
+            if counter in source:
+                bench[counter] = source[counter]
+    with open(args.output, "w") as f:
+        json.dump(times, f, indent=2)
+        f.write("\n")
+    return 0
+
+
+def check(args):
+    expected = build_type(args.baseline)
+    actual = build_type(args.current)
+    if expected != actual:
+        raise ValueError("baseline is from a {} build but the run is from a {} build".format(
+            expected or "unknown", actual or "unknown"))
+    baseline = load(args.baseline)
+    current = load(args.current)
+
+    regressions = 0
+    compared = 0
+    missing = []
+    print("{:<52} {:>14} {:>14} {:>8}".format("benchmark", "baseline", "current", "change"))
+    for name in sorted(current):
+        if args.filter not in name:
+            continue
+        if args.normalise and not name.startswith("xd/"):
+            continue
+        if name not in baseline:
+            missing.append(name)
+            continue
+        if args.normalise:
+            old = relative_time(baseline, name, args.metric)
+            new = relative_time(current, name, args.metric)
+            if old is None or new is None:
+                continue
+        else:
+            old = baseline[name][args.metric]
+            new = current[name][args.metric]
+        compared += 1
+        change = new/old - 1.0 if old > 0 else 0.0
+        notes = []
+        if change > args.threshold:
+            notes.append("SLOWER")
+        for counter in COUNTERS:
+            before = baseline[name].get(counter)
+            after = current[name].get(counter)
+            if before is not None and after is not None and after > before:
+                notes.append("{} {:g} -> {:g}".format(counter, before, after))
+        if notes:
+            regressions += 1
+        if notes or args.all or change < -args.threshold:
+            unit = "" if args.normalise else current[name].get("time_unit", "")
+            print("{:<52} {:>12.4g}{:>2} {:>12.4g}{:>2} {:>+7.1%}  {}".format(
+                name, old, unit, new, unit, change, ", ".join(notes)))
+
+    for name in missing:
+        print("{:<52} not in baseline".format(name))
+    print("{} compared, {} regressed".format(compared, regressions))
+    return 1 if regressions else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    commands = parser.add_subparsers(dest="command")
+    commands.required = True
+
+    merge_parser = commands.add_parser("merge", help="add counters from an instrumented run to a timed run")
+    merge_parser.add_argument("times")
+    merge_parser.add_argument("counters")
+    merge_parser.add_argument("-o", "--output", required=True)
+    merge_parser.set_defaults(run=merge)
+
+    check_parser = commands.add_parser("check", help="compare a run against a baseline")
+    check_parser.add_argument("baseline")
+    check_parser.add_argument("current")
+    check_parser.add_argument("--threshold", type=float, default=0.10,
+                              help="allowed slowdown as a fraction, default 0.10")
+    check_parser.add_argument("--metric", choices=("cpu_time", "real_time"), default="cpu_time")
+    check_parser.add_argument("--normalise", action="store_true",
+                              help="compare xd/ times relative to std/ instead of absolute")
+    check_parser.add_argument("--filter", default="",
+                              help="only compare benchmarks whose name contains this")
+    check_parser.add_argument("--all", action="store_true", help="print unchanged benchmarks too")
+    check_parser.set_defaults(run=check)
+
+    args = parser.parse_args()
+    try:
+        return args.run(args)
+    except (OSError, ValueError, KeyError) as e:
+        print("error: {}".format(e), file=sys.stderr)
+        return 2
+
+
+if __name__ == "__main__":
+    sys.exit(main())
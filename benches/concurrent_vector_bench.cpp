@@ -0,0 +1,74 @@
+#include <benchmark/benchmark.h>
+#include "concurrent_vector.hpp"
+#include "vector.hpp"
+#include <cstdint>
+#include <mutex>
+
+
+// Worker threads appending results to one shared vector
+static xd::concurrent_vector<uint64_t>* shared_concurrent = nullptr;
+static xd::vector<uint64_t>* shared_locked = nullptr;
+static std::mutex shared_lock;
+
+static void concurrent_append(benchmark::State& state) {
+    if(state.thread_index() == 0) {
+        shared_concurrent = new xd::concurrent_vector<uint64_t>();
+    }
+    uint64_t i = 0;
+    for(auto _ : state) {
+        shared_concurrent->push_back(i++);
+    }
+    if(state.thread_index() == 0) {
+        delete shared_concurrent;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void locked_append(benchmark::State& state) {
+    if(state.thread_index() == 0) {
+        shared_locked = new xd::vector<uint64_t>();
+    }
+    uint64_t i = 0;
+    for(auto _ : state) {
+        std::lock_guard<std::mutex> guard(shared_lock);
+        shared_locked->push_back(i++);
+    }
+    if(state.thread_index() == 0) {
+        delete shared_locked;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Batches of 64 results claimed at once
+static void concurrent_grow_by(benchmark::State& state) {
+    if(state.thread_index() == 0) {
+        shared_concurrent = new xd::concurrent_vector<uint64_t>();
+    }
+    for(auto _ : state) {
+        shared_concurrent->grow_by(64, 1);
+    }
+    if(state.thread_index() == 0) {
+        delete shared_concurrent;
+    }
+    state.SetItemsProcessed(state.iterations()*64);
+}
+
+static void locked_grow_by(benchmark::State& state) {
+    if(state.thread_index() == 0) {
+        shared_locked = new xd::vector<uint64_t>();
+    }
+    for(auto _ : state) {
+        std::lock_guard<std::mutex> guard(shared_lock);
+        shared_locked->insert(shared_locked->end(), 64, 1);
+    }
+    if(state.thread_index() == 0) {
+        delete shared_locked;
+    }
+    state.SetItemsProcessed(state.iterations()*64);
+}
+
+BENCHMARK(concurrent_append)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK(locked_append)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK(concurrent_grow_by)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK(locked_grow_by)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK_MAIN();
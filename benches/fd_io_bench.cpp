@@ -0,0 +1,122 @@
+#include <benchmark/benchmark.h>
+#include "fd_io.hpp"
+#include "vector.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+// Temp file holding n bytes, removed when the benchmark ends
+struct temp_file {
+    explicit temp_file(size_t n) {
+        fd = mkstemp(path);
+        xd::vector<char> data(n, 'x');
+        xd::write_all(fd, data);
+    }
+    ~temp_file() {
+        close(fd);
+        unlink(path);
+    }
+
+    char path[32] = "/tmp/xd_fd_io_bench_XXXXXX";
+    int fd;
+};
+
+// What ingest did before, the file goes through a stringstream and a
+// std::string on its way into the vector
+static void file_read_iostream(benchmark::State& state) {
+    temp_file file(state.range(0));
+    for(auto _ : state) {
+        std::ifstream in(file.path, std::ios::binary);
+        std::stringstream ss;
+        ss<<in.rdbuf();
+        const std::string s = ss.str();
+        xd::vector<char> vec(s.begin(), s.end());
+        benchmark::DoNotOptimize(vec.data());
+    }
+    state.SetBytesProcessed(state.iterations()*state.range(0));
+}
+
+static void file_read_all(benchmark::State& state) {
+    temp_file file(state.range(0));
+    for(auto _ : state) {
+        lseek(file.fd, 0, SEEK_SET);
+        xd::vector<char> vec;
+        xd::read_all(file.fd, vec);
+        benchmark::DoNotOptimize(vec.data());
+    }
+    state.SetBytesProcessed(state.iterations()*state.range(0));
+}
+
+static void file_write_iostream(benchmark::State& state) {
+    temp_file file(0);
+    const xd::vector<char> vec(state.range(0), 'y');
+    for(auto _ : state) {
+        const std::string s(vec.begin(), vec.end());
+        std::ofstream out(file.path, std::ios::binary | std::ios::trunc);
+        out<<s;
+    }
+    state.SetBytesProcessed(state.iterations()*state.range(0));
+}
+
+static void file_write_all(benchmark::State& state) {
+    temp_file file(0);
+    const xd::vector<char> vec(state.range(0), 'y');
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(ftruncate(file.fd, 0));
+        lseek(file.fd, 0, SEEK_SET);
+        xd::write_all(file.fd, vec);
+    }
+    state.SetBytesProcessed(state.iterations()*state.range(0));
+}
+
+// Messages of a small header and a payload through a pipe, small enough
+// to fit in the pipe buffer so one thread can do both ends
+static void pipe_messages(benchmark::State& state, bool gather) {
+    int fds[2];
+    if(pipe(fds) != 0) {
+        state.SkipWithError("pipe failed");
+        return;
+    }
+    const xd::vector<uint32_t> header = {0xfeed, 0};
+    const xd::vector<uint32_t> payload(state.range(0)/sizeof(uint32_t), 7u);
+    const xd::vector<uint32_t>* parts[] = {&header, &payload};
+    xd::vector<uint32_t> in;
+    const size_t message = header.size() + payload.size();
+    for(auto _ : state) {
+        if(gather) {
+            xd::writev_all(fds[1], parts);
+        } else {
+            xd::write_all(fds[1], header);
+            xd::write_all(fds[1], payload);
+        }
+        in.clear();
+        while(in.size() < message) {
+            xd::read_append(fds[0], in, message - in.size());
+        }
+        benchmark::DoNotOptimize(in.data());
+    }
+    close(fds[0]);
+    close(fds[1]);
+    state.SetBytesProcessed(state.iterations()*message*sizeof(uint32_t));
+}
+
+static void pipe_write_twice(benchmark::State& state) {
+    pipe_messages(state, false);
+}
+
+static void pipe_writev(benchmark::State& state) {
+    pipe_messages(state, true);
+}
+
+BENCHMARK(file_read_iostream)->Arg(1<<24);
+BENCHMARK(file_read_all)->Arg(1<<24);
+BENCHMARK(file_write_iostream)->Arg(1<<24);
+BENCHMARK(file_write_all)->Arg(1<<24);
+BENCHMARK(pipe_write_twice)->Arg(256)->Arg(1<<14);
+BENCHMARK(pipe_writev)->Arg(256)->Arg(1<<14);
+BENCHMARK_MAIN();
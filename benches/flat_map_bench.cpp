@@ -0,0 +1,125 @@
+#include <benchmark/benchmark.h>
+#include "flat_map.hpp"
+#include <cstdint>
+#include <map>
+#include <random>
+#include <unordered_map>
+
+
+// n distinct random keys
+static xd::vector<uint64_t> make_keys(size_t n) {
+    std::mt19937_64 rng(42);
+    std::unordered_map<uint64_t, bool> seen;
+    xd::vector<uint64_t> keys;
+    while(keys.size() < n) {
+        const uint64_t key = rng();
+        if(seen.emplace(key, true).second) {
+            keys.push_back(key);
+        }
+    }
+    return keys;
+}
+
+// Probes in a shuffled order so each lookup goes somewhere new
+static xd::vector<uint64_t> make_probes(const xd::vector<uint64_t>& keys) {
+    xd::vector<uint64_t> probes = keys;
+    std::shuffle(probes.begin(), probes.end(), std::mt19937_64(7));
+    return probes;
+}
+
+template<typename Map>
+static void lookup(benchmark::State& state, Map& map, const xd::vector<uint64_t>& probes) {
+    size_t i = 0;
+    uint64_t sum = 0;
+    for(auto _ : state) {
+        sum += map.find(probes[i])->second;
+        i = i + 1 == probes.size() ? 0 : i + 1;
+    }
+    benchmark::DoNotOptimize(sum);
+}
+
+static void std_map_find(benchmark::State& state) {
+    const auto keys = make_keys(state.range(0));
+    std::map<uint64_t, uint64_t> map;
+    for(uint64_t key: keys) {
+        map.emplace(key, key);
+    }
+    lookup(state, map, make_probes(keys));
+}
+
+static void std_unordered_map_find(benchmark::State& state) {
+    const auto keys = make_keys(state.range(0));
+    std::unordered_map<uint64_t, uint64_t> map;
+    for(uint64_t key: keys) {
+        map.emplace(key, key);
+    }
+    lookup(state, map, make_probes(keys));
+}
+
+static xd::flat_map<uint64_t, uint64_t> make_flat_map(const xd::vector<uint64_t>& keys) {
+    xd::vector<std::pair<uint64_t, uint64_t>> pairs;
+    for(uint64_t key: keys) {
+        pairs.push_back({key, key});
+    }
+    return xd::flat_map<uint64_t, uint64_t>(pairs.begin(), pairs.end());
+}
+
+static void flat_map_find(benchmark::State& state) {
+    const auto keys = make_keys(state.range(0));
+    auto map = make_flat_map(keys);
+    lookup(state, map, make_probes(keys));
+}
+
+static void flat_map_frozen_find(benchmark::State& state) {
+    const auto keys = make_keys(state.range(0));
+    auto map = make_flat_map(keys);
+    map.freeze();
+    lookup(state, map, make_probes(keys));
+}
+
+static void std_map_build(benchmark::State& state) {
+    const auto keys = make_keys(state.range(0));
+    for(auto _ : state) {
+        std::map<uint64_t, uint64_t> map;
+        for(uint64_t key: keys) {
+            map.emplace(key, key);
+        }
+        benchmark::DoNotOptimize(&map);
+    }
+    state.SetItemsProcessed(state.iterations()*keys.size());
+}
+
+static void flat_map_build_insert(benchmark::State& state) {
+    const auto keys = make_keys(state.range(0));
+    for(auto _ : state) {
+        xd::flat_map<uint64_t, uint64_t> map;
+        for(uint64_t key: keys) {
+            map.insert({key, key});
+        }
+        benchmark::DoNotOptimize(&map);
+    }
+    state.SetItemsProcessed(state.iterations()*keys.size());
+}
+
+static void flat_map_build_insert_range(benchmark::State& state) {
+    const auto keys = make_keys(state.range(0));
+    xd::vector<std::pair<uint64_t, uint64_t>> pairs;
+    for(uint64_t key: keys) {
+        pairs.push_back({key, key});
+    }
+    for(auto _ : state) {
+        xd::flat_map<uint64_t, uint64_t> map;
+        map.insert_range(pairs.begin(), pairs.end());
+        benchmark::DoNotOptimize(&map);
+    }
+    state.SetItemsProcessed(state.iterations()*keys.size());
+}
+
+BENCHMARK(std_map_find)->Arg(64)->Arg(1<<12)->Arg(1<<20);
+BENCHMARK(std_unordered_map_find)->Arg(64)->Arg(1<<12)->Arg(1<<20);
+BENCHMARK(flat_map_find)->Arg(64)->Arg(1<<12)->Arg(1<<20);
+BENCHMARK(flat_map_frozen_find)->Arg(64)->Arg(1<<12)->Arg(1<<20);
+BENCHMARK(std_map_build)->Arg(1<<14);
+BENCHMARK(flat_map_build_insert)->Arg(1<<14);
+BENCHMARK(flat_map_build_insert_range)->Arg(1<<14);
+BENCHMARK_MAIN();
@@ -0,0 +1,73 @@
+#include <benchmark/benchmark.h>
+#include "mmap_vector.hpp"
+#include "vector.hpp"
+#include <cstdint>
+#include <fstream>
+#include <unistd.h>
+
+
+static const char* table_path = "/tmp/xd_mmap_vector_bench";
+
+struct record {
+    uint64_t fields[8];
+};
+
+static void build_table(size_t n) {
+    unlink(table_path);
+    xd::mmap_vector<record> table(table_path);
+    table.reserve(n);
+    for(size_t i=0; i<n; i++) {
+        table.push_back(record{{i}});
+    }
+}
+
+// Open a prebuilt table and scan one field, the mapping is shared with the
+// page cache so nothing is copied
+static void mmap_load_scan(benchmark::State& state) {
+    const size_t n = state.range(0);
+    build_table(n);
+    for(auto _ : state) {
+        const xd::mmap_view<record> table(table_path);
+        uint64_t sum = 0;
+        for(const auto& r: table) {
+            sum += r.fields[0];
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetBytesProcessed(state.iterations()*n*sizeof(record));
+}
+
+// Same scan after reading the elements into a heap vector
+static void read_load_scan(benchmark::State& state) {
+    const size_t n = state.range(0);
+    build_table(n);
+    for(auto _ : state) {
+        std::ifstream file(table_path, std::ios::binary);
+        file.seekg(64);
+        xd::vector<record> table(n);
+        file.read(reinterpret_cast<char*>(table.data()), n*sizeof(record));
+        uint64_t sum = 0;
+        for(const auto& r: table) {
+            sum += r.fields[0];
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetBytesProcessed(state.iterations()*n*sizeof(record));
+}
+
+static void mmap_append(benchmark::State& state) {
+    const size_t n = state.range(0);
+    for(auto _ : state) {
+        unlink(table_path);
+        xd::mmap_vector<record> table(table_path);
+        for(size_t i=0; i<n; i++) {
+            table.push_back(record{{i}});
+        }
+        benchmark::DoNotOptimize(table.data());
+    }
+}
+
+BENCHMARK(mmap_load_scan)->Arg(1<<12)->Arg(1<<20);
+BENCHMARK(read_load_scan)->Arg(1<<12)->Arg(1<<20);
+BENCHMARK(mmap_append)->Arg(1<<12)->Arg(1<<16);
+BENCHMARK_MAIN();
@@ -0,0 +1,107 @@
+#include <benchmark/benchmark.h>
+#include "packed_int_vector.hpp"
+#include "vector.hpp"
+#include <cstdint>
+#include <random>
+
+
+// Sorted ids with gaps under 1000, like the id columns
+static xd::vector<uint64_t> make_ids(size_t n) {
+    std::mt19937_64 rng(42);
+    xd::vector<uint64_t> ids;
+    ids.reserve(n);
+    uint64_t id = uint64_t(1) << 40;
+    for(size_t i=0; i<n; i++) {
+        id += rng() % 1000;
+        ids.push_back(id);
+    }
+    return ids;
+}
+
+static void set_ratio(benchmark::State& state, size_t bytes) {
+    state.counters["bits_per_value"] = 8.0*bytes/state.range(0);
+}
+
+static void vector_sum(benchmark::State& state) {
+    const auto ids = make_ids(state.range(0));
+    for(auto _ : state) {
+        uint64_t sum = 0;
+        for(uint64_t id: ids) {
+            sum += id;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations()*state.range(0));
+    set_ratio(state, ids.capacity()*sizeof(uint64_t));
+}
+
+static void packed_sum(benchmark::State& state) {
+    xd::packed_int_vector<uint64_t> ids(make_ids(state.range(0)));
+    ids.shrink_to_fit();
+    for(auto _ : state) {
+        uint64_t sum = 0;
+        for(uint64_t id: ids) {
+            sum += id;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations()*state.range(0));
+    set_ratio(state, ids.memory_usage());
+}
+
+static void vector_random_access(benchmark::State& state) {
+    const auto ids = make_ids(state.range(0));
+    std::mt19937_64 rng(7);
+    uint64_t sum = 0;
+    for(auto _ : state) {
+        sum += ids[rng() % ids.size()];
+    }
+    benchmark::DoNotOptimize(sum);
+}
+
+static void packed_random_access(benchmark::State& state) {
+    const xd::packed_int_vector<uint64_t> ids(make_ids(state.range(0)));
+    std::mt19937_64 rng(7);
+    uint64_t sum = 0;
+    for(auto _ : state) {
+        sum += ids[rng() % ids.size()];
+    }
+    benchmark::DoNotOptimize(sum);
+}
+
+static void packed_encode(benchmark::State& state) {
+    const auto ids = make_ids(state.range(0));
+    for(auto _ : state) {
+        xd::packed_int_vector<uint64_t> packed(ids);
+        benchmark::DoNotOptimize(&packed);
+    }
+    state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+
+// Baseline for to_vector, most of both is faulting in the new pages
+static void vector_copy(benchmark::State& state) {
+    const auto ids = make_ids(state.range(0));
+    for(auto _ : state) {
+        auto vec = ids;
+        benchmark::DoNotOptimize(vec.data());
+    }
+    state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+
+static void packed_to_vector(benchmark::State& state) {
+    const xd::packed_int_vector<uint64_t> ids(make_ids(state.range(0)));
+    for(auto _ : state) {
+        auto vec = ids.to_vector();
+        benchmark::DoNotOptimize(vec.data());
+    }
+    state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+
+BENCHMARK(vector_sum)->Arg(1<<16)->Arg(1<<24);
+BENCHMARK(packed_sum)->Arg(1<<16)->Arg(1<<24);
+BENCHMARK(vector_random_access)->Arg(1<<24);
+BENCHMARK(packed_random_access)->Arg(1<<24);
+BENCHMARK(packed_encode)->Arg(1<<24);
+BENCHMARK(vector_copy)->Arg(1<<24);
+BENCHMARK(packed_to_vector)->Arg(1<<24);
+BENCHMARK_MAIN();
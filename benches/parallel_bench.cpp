@@ -0,0 +1,68 @@
+#include <benchmark/benchmark.h>
+#include "parallel.hpp"
+#include "vector.hpp"
+#include <cstdint>
+#include <thread>
+
+
+// Args are (elements, pool threads), threads go up to the core count
+static void thread_counts(benchmark::internal::Benchmark* b) {
+    const int cores = std::thread::hardware_concurrency();
+    for(int threads=1; threads<2*cores; threads*=2) {
+        b->Args({1<<24, threads < cores ? threads : cores});
+    }
+}
+
+// Building a fresh vector, the pages are first touched by the pool
+static void parallel_assign(benchmark::State& state) {
+    xd::thread_pool pool(state.range(1));
+    const auto policy = xd::par.on(pool);
+    for(auto _ : state) {
+        xd::vector<uint64_t> vec;
+        vec.assign(policy, state.range(0), 1);
+        benchmark::DoNotOptimize(vec.data());
+    }
+    state.SetBytesProcessed(state.iterations()*state.range(0)*sizeof(uint64_t));
+}
+
+static void parallel_copy(benchmark::State& state) {
+    xd::thread_pool pool(state.range(1));
+    const auto policy = xd::par.on(pool);
+    xd::vector<uint64_t> src;
+    src.assign(policy, state.range(0), 1);
+    for(auto _ : state) {
+        xd::vector<uint64_t> vec(policy, src);
+        benchmark::DoNotOptimize(vec.data());
+    }
+    state.SetBytesProcessed(state.iterations()*state.range(0)*sizeof(uint64_t));
+}
+
+static void parallel_transform(benchmark::State& state) {
+    xd::thread_pool pool(state.range(1));
+    const auto policy = xd::par.on(pool);
+    xd::vector<uint64_t> src;
+    src.assign(policy, state.range(0), 3);
+    xd::vector<double> dst;
+    for(auto _ : state) {
+        xd::transform(policy, src, dst, [](uint64_t x) { return x*1.5; });
+        benchmark::DoNotOptimize(dst.data());
+    }
+    state.SetBytesProcessed(state.iterations()*state.range(0)*sizeof(uint64_t)*2);
+}
+
+static void parallel_reduce(benchmark::State& state) {
+    xd::thread_pool pool(state.range(1));
+    const auto policy = xd::par.on(pool);
+    xd::vector<uint64_t> src;
+    src.assign(policy, state.range(0), 3);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(xd::reduce(policy, src));
+    }
+    state.SetBytesProcessed(state.iterations()*state.range(0)*sizeof(uint64_t));
+}
+
+BENCHMARK(parallel_assign)->Apply(thread_counts)->UseRealTime();
+BENCHMARK(parallel_copy)->Apply(thread_counts)->UseRealTime();
+BENCHMARK(parallel_transform)->Apply(thread_counts)->UseRealTime();
+BENCHMARK(parallel_reduce)->Apply(thread_counts)->UseRealTime();
+BENCHMARK_MAIN();
@@ -0,0 +1,139 @@
+#include <benchmark/benchmark.h>
+#include "persistent_vector.hpp"
+#include "vector.hpp"
+#include <cstdint>
+
+
+using unchecked_vector = xd::vector<uint64_t, std::allocator<uint64_t>, xd::double_growth, xd::bounds_unchecked>;
+using unchecked_persistent = xd::persistent_vector<uint64_t, xd::bounds_unchecked>;
+
+static unchecked_vector make_vector(size_t n) {
+    unchecked_vector vec;
+    for(size_t i=0; i<n; i++) {
+        vec.push_back(i);
+    }
+    return vec;
+}
+
+// Handing a reader a consistent snapshot
+template<typename Vec>
+static void snapshot(benchmark::State& state) {
+    const Vec vec(make_vector(state.range(0)));
+    for(auto _ : state) {
+        Vec copy(vec);
+        benchmark::DoNotOptimize(&copy);
+    }
+}
+
+static void vector_push_back(benchmark::State& state) {
+    const size_t n = state.range(0);
+    for(auto _ : state) {
+        unchecked_vector vec;
+        for(size_t i=0; i<n; i++) {
+            vec.push_back(i);
+        }
+        benchmark::DoNotOptimize(&vec[0]);
+    }
+    state.SetItemsProcessed(state.iterations()*n);
+}
+
+// Every intermediate version stays valid, so the tail is copied each time
+static void persistent_push_back(benchmark::State& state) {
+    const size_t n = state.range(0);
+    for(auto _ : state) {
+        unchecked_persistent vec;
+        for(size_t i=0; i<n; i++) {
+            vec = vec.push_back(i);
+        }
+        benchmark::DoNotOptimize(&vec);
+    }
+    state.SetItemsProcessed(state.iterations()*n);
+}
+
+static void persistent_push_back_rvalue(benchmark::State& state) {
+    const size_t n = state.range(0);
+    for(auto _ : state) {
+        unchecked_persistent vec;
+        for(size_t i=0; i<n; i++) {
+            vec = std::move(vec).push_back(i);
+        }
+        benchmark::DoNotOptimize(&vec);
+    }
+    state.SetItemsProcessed(state.iterations()*n);
+}
+
+static void transient_push_back(benchmark::State& state) {
+    const size_t n = state.range(0);
+    for(auto _ : state) {
+        xd::transient_vector<uint64_t, xd::bounds_unchecked> builder;
+        for(size_t i=0; i<n; i++) {
+            builder.push_back(i);
+        }
+        auto vec = std::move(builder).persistent();
+        benchmark::DoNotOptimize(&vec);
+    }
+    state.SetItemsProcessed(state.iterations()*n);
+}
+
+static void from_vector(benchmark::State& state) {
+    const unchecked_vector source = make_vector(state.range(0));
+    for(auto _ : state) {
+        unchecked_persistent vec(source);
+        benchmark::DoNotOptimize(&vec);
+    }
+    state.SetItemsProcessed(state.iterations()*source.size());
+}
+
+// A new version with one element changed, while the old one is kept
+static void persistent_set(benchmark::State& state) {
+    const size_t n = state.range(0);
+    unchecked_persistent vec(make_vector(n));
+    size_t i = 0;
+    for(auto _ : state) {
+        auto next = vec.set(i, i);
+        benchmark::DoNotOptimize(&next);
+        i = (i + 7919) % n;
+    }
+}
+
+template<typename Vec>
+static void index_sum(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const Vec vec(make_vector(n));
+    for(auto _ : state) {
+        uint64_t sum = 0;
+        for(size_t i=0; i<n; i++) {
+            sum += vec[i];
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations()*n);
+}
+
+template<typename Vec>
+static void iterate_sum(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const Vec vec(make_vector(n));
+    for(auto _ : state) {
+        uint64_t sum = 0;
+        for(uint64_t x: vec) {
+            sum += x;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations()*n);
+}
+
+BENCHMARK_TEMPLATE(snapshot, unchecked_vector)->Arg(1<<10)->Arg(1<<20);
+BENCHMARK_TEMPLATE(snapshot, unchecked_persistent)->Arg(1<<10)->Arg(1<<20);
+BENCHMARK(vector_push_back)->Arg(1<<16);
+BENCHMARK(persistent_push_back)->Arg(1<<16);
+BENCHMARK(persistent_push_back_rvalue)->Arg(1<<16);
+BENCHMARK(transient_push_back)->Arg(1<<16);
+BENCHMARK(from_vector)->Arg(1<<16);
+BENCHMARK(persistent_set)->Arg(1<<20);
+BENCHMARK_TEMPLATE(index_sum, unchecked_vector)->Arg(1<<16);
+BENCHMARK_TEMPLATE(index_sum, unchecked_persistent)->Arg(1<<16);
+BENCHMARK_TEMPLATE(iterate_sum, unchecked_vector)->Arg(1<<16);
+BENCHMARK_TEMPLATE(iterate_sum, unchecked_persistent)->Arg(1<<16);
+BENCHMARK_MAIN();
@@ -0,0 +1,36 @@
+#include <benchmark/benchmark.h>
+#include "small_vector.hpp"
+#include "vector.hpp"
+
+
+// Builds and drops a vector of state.range(0) elements, below N the
+// small_vector never touches the heap
+template<typename Vec>
+static void build_and_drop(benchmark::State& state) {
+    const int n = state.range(0);
+    for(auto _ : state) {
+        Vec vec;
+        for(int i=0; i<n; i++) {
+            vec.push_back(i);
+        }
+        benchmark::DoNotOptimize(vec.data());
+    }
+}
+
+template<typename Vec>
+static void insert_front(benchmark::State& state) {
+    const int n = state.range(0);
+    for(auto _ : state) {
+        Vec vec;
+        for(int i=0; i<n; i++) {
+            vec.insert(vec.begin(), i);
+        }
+        benchmark::DoNotOptimize(vec.data());
+    }
+}
+
+BENCHMARK_TEMPLATE(build_and_drop, xd::vector<int>)->Arg(2)->Arg(4)->Arg(8)->Arg(16)->Arg(64);
+BENCHMARK_TEMPLATE(build_and_drop, xd::small_vector<int, 8>)->Arg(2)->Arg(4)->Arg(8)->Arg(16)->Arg(64);
+BENCHMARK_TEMPLATE(insert_front, xd::vector<int>)->Arg(4)->Arg(8)->Arg(64);
+BENCHMARK_TEMPLATE(insert_front, xd::small_vector<int, 8>)->Arg(4)->Arg(8)->Arg(64);
+BENCHMARK_MAIN();
@@ -0,0 +1,80 @@
+#include <benchmark/benchmark.h>
+#include "soa_vector.hpp"
+#include "vector.hpp"
+#include <cstdint>
+
+
+struct particle {
+    float x, y, z;
+    float vx, vy, vz;
+    float mass;
+    uint32_t id;
+};
+
+// Sum a single field, AoS loads the whole 32 byte particle per element
+static void aos_sum_mass(benchmark::State& state) {
+    const size_t n = state.range(0);
+    xd::vector<particle> particles(n, particle{0, 0, 0, 0, 0, 0, 1.0f, 0});
+    for(auto _ : state) {
+        float sum = 0;
+        for(const auto& p: particles) {
+            sum += p.mass;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations()*n);
+}
+
+static void soa_sum_mass(benchmark::State& state) {
+    const size_t n = state.range(0);
+    xd::soa_vector<float, float, float, float, float, float, float, uint32_t> particles;
+    for(size_t i=0; i<n; i++) {
+        particles.push_back(0, 0, 0, 0, 0, 0, 1.0f, 0);
+    }
+    for(auto _ : state) {
+        float sum = 0;
+        for(float m: particles.column<6>()) {
+            sum += m;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations()*n);
+}
+
+// Integrate x += vx, touches two fields
+static void aos_integrate(benchmark::State& state) {
+    const size_t n = state.range(0);
+    xd::vector<particle> particles(n, particle{0, 0, 0, 1.0f, 0, 0, 1.0f, 0});
+    for(auto _ : state) {
+        for(auto& p: particles) {
+            p.x += p.vx;
+        }
+        benchmark::DoNotOptimize(particles.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations()*n);
+}
+
+static void soa_integrate(benchmark::State& state) {
+    const size_t n = state.range(0);
+    xd::soa_vector<float, float, float, float, float, float, float, uint32_t> particles;
+    for(size_t i=0; i<n; i++) {
+        particles.push_back(0, 0, 0, 1.0f, 0, 0, 1.0f, 0);
+    }
+    for(auto _ : state) {
+        float* x = particles.data<0>();
+        const float* vx = particles.data<3>();
+        for(size_t i=0; i<n; i++) {
+            x[i] += vx[i];
+        }
+        benchmark::DoNotOptimize(x);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations()*n);
+}
+
+BENCHMARK(aos_sum_mass)->Arg(1<<12)->Arg(1<<22);
+BENCHMARK(soa_sum_mass)->Arg(1<<12)->Arg(1<<22);
+BENCHMARK(aos_integrate)->Arg(1<<12)->Arg(1<<22);
+BENCHMARK(soa_integrate)->Arg(1<<12)->Arg(1<<22);
+BENCHMARK_MAIN();
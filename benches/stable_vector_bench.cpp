@@ -0,0 +1,77 @@
+#include <benchmark/benchmark.h>
+#include "stable_vector.hpp"
+#include "vector.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+
+struct entity {
+    uint64_t id;
+    double position[3];
+    double velocity[3];
+};
+
+// Growing an entity table, also reports the slowest single push_back as
+// copy on grow shows up there rather than in the mean
+template<typename Vec>
+static void entity_push_back(benchmark::State& state) {
+    const size_t n = state.range(0);
+    double worst = 0;
+    for(auto _ : state) {
+        Vec vec;
+        for(size_t i=0; i<n; i++) {
+            const auto start = std::chrono::steady_clock::now();
+            vec.push_back(entity{i, {}, {}});
+            const std::chrono::duration<double, std::micro> took = std::chrono::steady_clock::now() - start;
+            worst = std::max(worst, took.count());
+        }
+        benchmark::DoNotOptimize(&vec[0]);
+    }
+    state.counters["worst_us"] = worst;
+}
+
+template<typename Vec>
+static void entity_index_sum(benchmark::State& state) {
+    const size_t n = state.range(0);
+    Vec vec;
+    for(size_t i=0; i<n; i++) {
+        vec.push_back(entity{i, {}, {}});
+    }
+    for(auto _ : state) {
+        uint64_t sum = 0;
+        for(size_t i=0; i<n; i++) {
+            sum += vec[i].id;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations()*n);
+}
+
+template<typename Vec>
+static void entity_iterate_sum(benchmark::State& state) {
+    const size_t n = state.range(0);
+    Vec vec;
+    for(size_t i=0; i<n; i++) {
+        vec.push_back(entity{i, {}, {}});
+    }
+    for(auto _ : state) {
+        uint64_t sum = 0;
+        for(const auto& e: vec) {
+            sum += e.id;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations()*n);
+}
+
+using unchecked_vector = xd::vector<entity, std::allocator<entity>, xd::double_growth, xd::bounds_unchecked>;
+using unchecked_stable = xd::stable_vector<entity, xd::detail::default_chunk_size<entity>(), std::allocator<entity>, xd::bounds_unchecked>;
+
+BENCHMARK_TEMPLATE(entity_push_back, unchecked_vector)->Arg(1<<16)->Arg(1<<20);
+BENCHMARK_TEMPLATE(entity_push_back, unchecked_stable)->Arg(1<<16)->Arg(1<<20);
+BENCHMARK_TEMPLATE(entity_index_sum, unchecked_vector)->Arg(1<<16);
+BENCHMARK_TEMPLATE(entity_index_sum, unchecked_stable)->Arg(1<<16);
+BENCHMARK_TEMPLATE(entity_iterate_sum, unchecked_vector)->Arg(1<<16);
+BENCHMARK_TEMPLATE(entity_iterate_sum, unchecked_stable)->Arg(1<<16);
+BENCHMARK_MAIN();
@@ -0,0 +1,41 @@
+#include <benchmark/benchmark.h>
+#include "small_vector.hpp"
+#include "static_vector.hpp"
+#include "vector.hpp"
+
+
+// Builds and drops a vector of state.range(0) elements, the static_vector
+// never touches the heap and has no spill check
+template<typename Vec>
+static void build_and_drop(benchmark::State& state) {
+    const int n = state.range(0);
+    for(auto _ : state) {
+        Vec vec;
+        for(int i=0; i<n; i++) {
+            vec.push_back(i);
+        }
+        benchmark::DoNotOptimize(vec.data());
+    }
+}
+
+// Copies a full vector, a trivially copyable static_vector is one memcpy
+template<typename Vec>
+static void copy(benchmark::State& state) {
+    const int n = state.range(0);
+    Vec src;
+    for(int i=0; i<n; i++) {
+        src.push_back(i);
+    }
+    for(auto _ : state) {
+        Vec vec(src);
+        benchmark::DoNotOptimize(vec.data());
+    }
+}
+
+BENCHMARK_TEMPLATE(build_and_drop, xd::vector<int>)->Arg(4)->Arg(15);
+BENCHMARK_TEMPLATE(build_and_drop, xd::small_vector<int, 15>)->Arg(4)->Arg(15);
+BENCHMARK_TEMPLATE(build_and_drop, xd::static_vector<int, 15>)->Arg(4)->Arg(15);
+BENCHMARK_TEMPLATE(copy, xd::vector<int>)->Arg(4)->Arg(15);
+BENCHMARK_TEMPLATE(copy, xd::small_vector<int, 15>)->Arg(4)->Arg(15);
+BENCHMARK_TEMPLATE(copy, xd::static_vector<int, 15>)->Arg(4)->Arg(15);
+BENCHMARK_MAIN();
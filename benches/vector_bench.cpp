@@ -1,5 +1,14 @@
 #include <benchmark/benchmark.h>
+#include "aligned_allocator.hpp"
+#include "arena.hpp"
+#include "realloc_allocator.hpp"
+#include "serialize.hpp"
 #include "vector.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <numeric>
+#include <random>
 #include <vector>
 
 
@@ -18,6 +27,283 @@ static void stdvec_push_back(benchmark::State& state) {
     }
 }
 
+// Simulates a request handler building a batch of short-lived vectors
+static void xdvec_request_heap(benchmark::State& state) {
+    const size_t n_vecs = state.range(0);
+    for(auto _ : state) {
+        for(size_t i=0; i<n_vecs; i++) {
+            xd::vector<int> vec;
+            for(int j=0; j<64; j++) {
+                vec.push_back(j);
+            }
+            benchmark::DoNotOptimize(vec.data());
+        }
+    }
+}
+
+static void xdvec_request_arena(benchmark::State& state) {
+    const size_t n_vecs = state.range(0);
+    xd::arena arena;
+    for(auto _ : state) {
+        for(size_t i=0; i<n_vecs; i++) {
+            xd::vector<int, xd::arena_allocator<int>> vec(arena);
+            for(int j=0; j<64; j++) {
+                vec.push_back(j);
+            }
+            benchmark::DoNotOptimize(vec.data());
+        }
+        arena.reset();
+    }
+}
+
+struct record {
+    uint64_t fields[8];
+};
+
+// Growing a large POD vector, compares allocate+copy against realloc/mremap
+template<typename Vec>
+static void grow_records(benchmark::State& state) {
+    const size_t n = state.range(0);
+    for(auto _ : state) {
+        Vec vec;
+        for(size_t i=0; i<n; i++) {
+            vec.push_back(record{{i}});
+        }
+        benchmark::DoNotOptimize(vec.data());
+    }
+}
+
+// a[i] += k*b[i] over floats, only vectorises when operator[] doesn't check
+template<typename Vec>
+static void indexed_saxpy(benchmark::State& state) {
+    const size_t n = state.range(0);
+    Vec a(n, 1.0f);
+    Vec b(n, 2.0f);
+    for(auto _ : state) {
+        for(size_t i=0; i<n; i++) {
+            a[i] += 0.5f*b[i];
+        }
+        benchmark::DoNotOptimize(a.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations()*n*sizeof(float)*2);
+}
+
+template<typename Vec>
+static void indexed_sum(benchmark::State& state) {
+    const size_t n = state.range(0);
+    Vec a(n, 1);
+    for(auto _ : state) {
+        int sum = 0;
+        for(size_t i=0; i<n; i++) {
+            sum += a[i];
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetBytesProcessed(state.iterations()*n*sizeof(int));
+}
+
+// Batch merge: splice a block of records into the middle of a vector
+template<typename Vec>
+static void range_insert_middle(benchmark::State& state) {
+    const size_t n = state.range(0);
+    Vec batch(n/4, 1);
+    for(auto _ : state) {
+        state.PauseTiming();
+        Vec vec(n, 0);
+        state.ResumeTiming();
+        vec.insert(vec.begin() + n/2, batch.begin(), batch.end());
+        benchmark::DoNotOptimize(vec.data());
+    }
+}
+
+// Eviction pass removing every 8th element
+static void xdvec_evict_erase_loop(benchmark::State& state) {
+    const size_t n = state.range(0);
+    for(auto _ : state) {
+        state.PauseTiming();
+        xd::vector<int> vec;
+        for(size_t i=0; i<n; i++) {
+            vec.push_back(i);
+        }
+        state.ResumeTiming();
+        for(size_t i=0; i<vec.size(); ) {
+            if(vec[i] % 8 == 0) {
+                vec.erase(vec.begin() + i);
+            } else {
+                i++;
+            }
+        }
+        benchmark::DoNotOptimize(vec.data());
+    }
+}
+
+static void xdvec_evict_erase_if(benchmark::State& state) {
+    const size_t n = state.range(0);
+    for(auto _ : state) {
+        state.PauseTiming();
+        xd::vector<int> vec;
+        for(size_t i=0; i<n; i++) {
+            vec.push_back(i);
+        }
+        state.ResumeTiming();
+        xd::erase_if(vec, [](int x) { return x % 8 == 0; });
+        benchmark::DoNotOptimize(vec.data());
+    }
+}
+
+// Dedupe style comparison of small key vectors
+template<typename T>
+static void xdvec_compare_keys(benchmark::State& state) {
+    const size_t n = state.range(0);
+    xd::vector<T> a(n, 3);
+    xd::vector<T> b(n, 3);
+    b.back() = 4;
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(a == b);
+        benchmark::DoNotOptimize(a < b);
+    }
+}
+
+template<typename T>
+static void stdvec_compare_keys(benchmark::State& state) {
+    const size_t n = state.range(0);
+    std::vector<T> a(n, 3);
+    std::vector<T> b(n, 3);
+    b.back() = 4;
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(a == b);
+        benchmark::DoNotOptimize(a < b);
+    }
+}
+
+static void xdvec_find(benchmark::State& state) {
+    const size_t n = state.range(0);
+    xd::vector<uint32_t> vec(n, 1);
+    vec.back() = 2;
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(xd::find(vec, 2u));
+        benchmark::DoNotOptimize(xd::count(vec, 1u));
+    }
+}
+
+static void stdvec_find(benchmark::State& state) {
+    const size_t n = state.range(0);
+    std::vector<uint32_t> vec(n, 1);
+    vec.back() = 2;
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(std::find(vec.begin(), vec.end(), 2u));
+        benchmark::DoNotOptimize(std::count(vec.begin(), vec.end(), 1u));
+    }
+}
+
+// Dependent random reads over a large table, TLB misses dominate on 4K pages
+template<typename Vec>
+static void random_access(benchmark::State& state) {
+    const size_t n = state.range(0);
+    Vec vec;
+    vec.resize(n);
+    // Sattolo's shuffle gives a single cycle so the chase visits every slot
+    std::iota(vec.begin(), vec.end(), 0);
+    std::mt19937_64 rng(42);
+    for(size_t i=n-1; i>0; i--) {
+        std::swap(vec[i], vec[rng() % i]);
+    }
+    uint64_t index = 0;
+    for(auto _ : state) {
+        for(int i=0; i<1024; i++) {
+            index = vec[index];
+        }
+        benchmark::DoNotOptimize(index);
+    }
+    state.SetItemsProcessed(state.iterations()*1024);
+}
+
+// Checkpointing a vector of samples, one stream write per element vs bulk
+static void checkpoint_per_element(benchmark::State& state) {
+    const size_t n = state.range(0);
+    xd::vector<double> vec(n, 1.0);
+    std::ofstream out("/tmp/xd_checkpoint_bench", std::ios::binary);
+    for(auto _ : state) {
+        out.seekp(0);
+        for(const auto& x: vec) {
+            out.write(reinterpret_cast<const char*>(&x), sizeof(x));
+        }
+    }
+    state.SetBytesProcessed(state.iterations()*n*sizeof(double));
+}
+
+static void checkpoint_serialize(benchmark::State& state) {
+    const size_t n = state.range(0);
+    xd::vector<double> vec(n, 1.0);
+    std::ofstream out("/tmp/xd_checkpoint_bench", std::ios::binary);
+    for(auto _ : state) {
+        out.seekp(0);
+        xd::serialize(out, vec);
+    }
+    state.SetBytesProcessed(state.iterations()*n*sizeof(double));
+}
+
+// Filling a buffer 64KB at a time the way a read() loop would, memcpy
+// standing in for the kernel. Past the last level cache so the extra
+// zeroing pass from resize shows up as memory traffic.
+static void fill_chunks(benchmark::State& state, bool uninitialized) {
+    const size_t n = state.range(0);
+    const size_t chunk = 1<<16;
+    const std::vector<char> source(chunk, 'x');
+    xd::vector<char> buffer;
+    buffer.reserve(n);
+    for(auto _ : state) {
+        buffer.clear();
+        for(size_t done=0; done<n; done+=chunk) {
+            if(uninitialized) {
+                memcpy(buffer.append_uninitialized(chunk), source.data(), chunk);
+                buffer.commit(chunk);
+            } else {
+                buffer.resize(done + chunk);
+                memcpy(buffer.data() + done, source.data(), chunk);
+            }
+        }
+        benchmark::DoNotOptimize(buffer.data());
+    }
+    state.SetBytesProcessed(state.iterations()*n);
+}
+
+static void xdvec_fill_resize(benchmark::State& state) {
+    fill_chunks(state, false);
+}
+
+static void xdvec_fill_append_uninitialized(benchmark::State& state) {
+    fill_chunks(state, true);
+}
+
 BENCHMARK(stdvec_push_back);
 BENCHMARK(xdvec_push_back);
+BENCHMARK(xdvec_request_heap)->Arg(16)->Arg(64)->ThreadRange(1, 8);
+BENCHMARK(xdvec_request_arena)->Arg(16)->Arg(64)->ThreadRange(1, 8);
+BENCHMARK_TEMPLATE(grow_records, xd::vector<record>)->Arg(1<<12)->Arg(1<<16)->Arg(1<<20);
+BENCHMARK_TEMPLATE(grow_records, xd::vector<record, xd::realloc_allocator<record>>)->Arg(1<<12)->Arg(1<<16)->Arg(1<<20);
+BENCHMARK_TEMPLATE(grow_records, xd::vector<record, xd::realloc_allocator<record>, xd::one_and_a_half_growth>)->Arg(1<<12)->Arg(1<<16)->Arg(1<<20);
+BENCHMARK_TEMPLATE(indexed_saxpy, std::vector<float>)->Arg(1<<10)->Arg(1<<16);
+BENCHMARK_TEMPLATE(indexed_saxpy, xd::vector<float, std::allocator<float>, xd::double_growth, xd::bounds_unchecked>)->Arg(1<<10)->Arg(1<<16);
+BENCHMARK_TEMPLATE(indexed_saxpy, xd::vector<float, std::allocator<float>, xd::double_growth, xd::bounds_throw>)->Arg(1<<10)->Arg(1<<16);
+BENCHMARK_TEMPLATE(indexed_sum, std::vector<int>)->Arg(1<<10)->Arg(1<<16);
+BENCHMARK_TEMPLATE(indexed_sum, xd::vector<int, std::allocator<int>, xd::double_growth, xd::bounds_unchecked>)->Arg(1<<10)->Arg(1<<16);
+BENCHMARK_TEMPLATE(indexed_sum, xd::vector<int, std::allocator<int>, xd::double_growth, xd::bounds_throw>)->Arg(1<<10)->Arg(1<<16);
+BENCHMARK_TEMPLATE(range_insert_middle, std::vector<int>)->Arg(1<<10)->Arg(1<<14);
+BENCHMARK_TEMPLATE(range_insert_middle, xd::vector<int>)->Arg(1<<10)->Arg(1<<14);
+BENCHMARK(xdvec_evict_erase_loop)->Arg(1<<10)->Arg(1<<16);
+BENCHMARK(xdvec_evict_erase_if)->Arg(1<<10)->Arg(1<<16);
+BENCHMARK_TEMPLATE(stdvec_compare_keys, int32_t)->Arg(16)->Arg(1<<12);
+BENCHMARK_TEMPLATE(xdvec_compare_keys, int32_t)->Arg(16)->Arg(1<<12);
+BENCHMARK_TEMPLATE(stdvec_compare_keys, int16_t)->Arg(16)->Arg(1<<12);
+BENCHMARK_TEMPLATE(xdvec_compare_keys, int16_t)->Arg(16)->Arg(1<<12);
+BENCHMARK(stdvec_find)->Arg(1<<12);
+BENCHMARK(xdvec_find)->Arg(1<<12);
+BENCHMARK_TEMPLATE(random_access, xd::vector<uint64_t>)->Arg(1<<24)->Arg(1<<27)->Arg(1<<28);
+BENCHMARK_TEMPLATE(random_access, xd::huge_page_vector<uint64_t>)->Arg(1<<24)->Arg(1<<27)->Arg(1<<28);
+BENCHMARK(checkpoint_per_element)->Arg(1<<20);
+BENCHMARK(checkpoint_serialize)->Arg(1<<20);
+BENCHMARK(xdvec_fill_resize)->Arg(1<<26);
+BENCHMARK(xdvec_fill_append_uninitialized)->Arg(1<<26);
 BENCHMARK_MAIN();
@@ -0,0 +1,450 @@
+// Regression suite for xd::vector, every operation over element types from
+// char to std::string and sizes from 8 to 100M, with std::vector alongside
+// as a reference.
+//
+// The instrumentation hooks cost tens of nanoseconds per allocation so they
+// would skew the times. vector_suite is built without them and only times,
+// vector_suite_counters is this file with XD_VECTOR_INSTRUMENT=1 and runs
+// each benchmark once to report allocations and bytes moved per iteration.
+// compare.py merges the two runs and checks them against a baseline:
+//
+//   vector_suite --benchmark_out=times.json --benchmark_out_format=json
+//   vector_suite_counters --benchmark_out=counters.json --benchmark_out_format=json
+//   compare.py merge times.json counters.json -o run.json
+//   compare.py check baseline.json run.json
+#include <benchmark/benchmark.h>
+#include "instrument.hpp"
+#include "vector.hpp"
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+//! Sizes whose largest vector would need more than this are skipped, copy
+//! benchmarks hold two of them
+#ifndef XD_SUITE_MAX_BYTES
+#define XD_SUITE_MAX_BYTES (size_t(1) << 30)
+#endif
+
+struct pod64 {
+    uint64_t fields[8];
+};
+
+static bool operator==(const pod64& a, const pod64& b) {
+    for(size_t i=0; i<8; i++) {
+        if(a.fields[i] != b.fields[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool operator!=(const pod64& a, const pod64& b) {
+    return !(a == b);
+}
+
+static bool operator<(const pod64& a, const pod64& b) {
+    for(size_t i=0; i<8; i++) {
+        if(a.fields[i] != b.fields[i]) {
+            return a.fields[i] < b.fields[i];
+        }
+    }
+    return false;
+}
+
+static bool operator>(const pod64& a, const pod64& b) {
+    return b < a;
+}
+
+static bool operator<=(const pod64& a, const pod64& b) {
+    return !(b < a);
+}
+
+static bool operator>=(const pod64& a, const pod64& b) {
+    return !(a < b);
+}
+
+template<typename T>
+struct element;
+
+template<>
+struct element<char> {
+    static constexpr const char* name = "char";
+    static constexpr size_t footprint = 1;
+    static char make(size_t i) { return char(i); }
+    static size_t weight(char c) { return size_t(c); }
+};
+
+template<>
+struct element<uint32_t> {
+    static constexpr const char* name = "u32";
+    static constexpr size_t footprint = 4;
+    static uint32_t make(size_t i) { return uint32_t(i); }
+    static size_t weight(uint32_t x) { return x; }
+};
+
+template<>
+struct element<pod64> {
+    static constexpr const char* name = "pod64";
+    static constexpr size_t footprint = 64;
+    static pod64 make(size_t i) { return pod64{{i, i, i, i, i, i, i, i}}; }
+    static size_t weight(const pod64& p) { return p.fields[0]; }
+};
+
+// Long enough to miss the small string buffer so copies hit the heap
+template<>
+struct element<std::string> {
+    static constexpr const char* name = "string";
+    static constexpr size_t footprint = sizeof(std::string) + 32;
+    static std::string make(size_t i) { return std::string(24, char('a' + i%26)); }
+    static size_t weight(const std::string& s) { return s.size(); }
+};
+
+template<typename Vec>
+struct container;
+
+template<typename T>
+struct container<xd::vector<T>> {
+    static constexpr const char* name = "xd";
+    static constexpr bool instrumented = XD_VECTOR_INSTRUMENT;
+};
+
+template<typename T>
+struct container<std::vector<T>> {
+    static constexpr const char* name = "std";
+    static constexpr bool instrumented = false;
+};
+
+//! Reports the allocations and bytes moved to new buffers per iteration
+//! between construction and destruction, skipped for std::vector which
+//! has no hooks
+template<typename Vec>
+class storage_counters {
+public:
+    using T = typename Vec::value_type;
+
+    explicit storage_counters(benchmark::State& state):
+    state(state),
+    allocations(0),
+    bytes_copied(0) {
+        if constexpr(container<Vec>::instrumented) {
+            const auto& stats = xd::vector_stats_for<T>();
+            allocations = stats.allocations.load();
+            bytes_copied = stats.bytes_copied.load();
+        }
+    }
+
+    ~storage_counters() {
+        if constexpr(container<Vec>::instrumented) {
+            const auto& stats = xd::vector_stats_for<T>();
+            state.counters["allocs"] = benchmark::Counter(double(stats.allocations.load() - allocations),
+                                                          benchmark::Counter::kAvgIterations);
+            state.counters["bytes_moved"] = benchmark::Counter(double(stats.bytes_copied.load() - bytes_copied),
+                                                               benchmark::Counter::kAvgIterations);
+        }
+    }
+private:
+    benchmark::State& state;
+    uint64_t allocations;
+    uint64_t bytes_copied;
+};
+
+template<typename Vec>
+Vec make_filled(size_t n, size_t offset = 0) {
+    using T = typename Vec::value_type;
+    Vec vec;
+    vec.reserve(n);
+    for(size_t i=0; i<n; i++) {
+        vec.push_back(element<T>::make(i + offset));
+    }
+    return vec;
+}
+
+template<typename Vec>
+void construct_fill(benchmark::State& state) {
+    using T = typename Vec::value_type;
+    const size_t n = state.range(0);
+    const T value = element<T>::make(1);
+    storage_counters<Vec> counters(state);
+    for(auto _ : state) {
+        Vec vec(n, value);
+        benchmark::DoNotOptimize(vec.data());
+    }
+    state.SetItemsProcessed(state.iterations()*n);
+}
+
+template<typename Vec>
+void construct_range(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const Vec src = make_filled<Vec>(n);
+    storage_counters<Vec> counters(state);
+    for(auto _ : state) {
+        Vec vec(src.begin(), src.end());
+        benchmark::DoNotOptimize(vec.data());
+    }
+    state.SetItemsProcessed(state.iterations()*n);
+}
+
+template<typename Vec>
+void copy_construct(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const Vec src = make_filled<Vec>(n);
+    storage_counters<Vec> counters(state);
+    for(auto _ : state) {
+        Vec vec(src);
+        benchmark::DoNotOptimize(vec.data());
+    }
+    state.SetItemsProcessed(state.iterations()*n);
+}
+
+// Destination already has the capacity so this is just the element copies
+template<typename Vec>
+void copy_assign(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const Vec src = make_filled<Vec>(n);
+    Vec dst = make_filled<Vec>(n, 1);
+    storage_counters<Vec> counters(state);
+    for(auto _ : state) {
+        dst = src;
+        benchmark::DoNotOptimize(dst.data());
+    }
+    state.SetItemsProcessed(state.iterations()*n);
+}
+
+// A move out and back, should be constant in n
+template<typename Vec>
+void move(benchmark::State& state) {
+    const size_t n = state.range(0);
+    Vec vec = make_filled<Vec>(n);
+    storage_counters<Vec> counters(state);
+    for(auto _ : state) {
+        Vec tmp(std::move(vec));
+        benchmark::DoNotOptimize(tmp.data());
+        vec = std::move(tmp);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template<typename Vec>
+void push_back_growth(benchmark::State& state) {
+    using T = typename Vec::value_type;
+    const size_t n = state.range(0);
+    const T value = element<T>::make(1);
+    storage_counters<Vec> counters(state);
+    for(auto _ : state) {
+        Vec vec;
+        for(size_t i=0; i<n; i++) {
+            vec.push_back(value);
+        }
+        benchmark::DoNotOptimize(vec.data());
+    }
+    state.SetItemsProcessed(state.iterations()*n);
+}
+
+template<typename Vec>
+void push_back_reserved(benchmark::State& state) {
+    using T = typename Vec::value_type;
+    const size_t n = state.range(0);
+    const T value = element<T>::make(1);
+    storage_counters<Vec> counters(state);
+    for(auto _ : state) {
+        Vec vec;
+        vec.reserve(n);
+        for(size_t i=0; i<n; i++) {
+            vec.push_back(value);
+        }
+        benchmark::DoNotOptimize(vec.data());
+    }
+    state.SetItemsProcessed(state.iterations()*n);
+}
+
+// Insert and erase are paired so the size stays at n, each iteration
+// shifts everything after pos twice
+template<typename Vec>
+void insert_erase_at(benchmark::State& state, size_t pos) {
+    using T = typename Vec::value_type;
+    Vec vec = make_filled<Vec>(state.range(0));
+    // Room for the insert so the first iteration doesn't count a grow
+    vec.reserve(vec.size() + 1);
+    const T value = element<T>::make(7);
+    storage_counters<Vec> counters(state);
+    for(auto _ : state) {
+        vec.insert(vec.begin() + pos, value);
+        vec.erase(vec.begin() + pos);
+        benchmark::DoNotOptimize(vec.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template<typename Vec>
+void insert_erase_front(benchmark::State& state) {
+    insert_erase_at<Vec>(state, 0);
+}
+
+template<typename Vec>
+void insert_erase_middle(benchmark::State& state) {
+    insert_erase_at<Vec>(state, state.range(0)/2);
+}
+
+template<typename Vec>
+void insert_erase_back(benchmark::State& state) {
+    insert_erase_at<Vec>(state, state.range(0));
+}
+
+template<typename Vec>
+void resize(benchmark::State& state) {
+    const size_t n = state.range(0);
+    storage_counters<Vec> counters(state);
+    for(auto _ : state) {
+        Vec vec;
+        vec.resize(n);
+        benchmark::DoNotOptimize(vec.data());
+    }
+    state.SetItemsProcessed(state.iterations()*n);
+}
+
+// Reuses the capacity from the first iteration
+template<typename Vec>
+void assign(benchmark::State& state) {
+    using T = typename Vec::value_type;
+    const size_t n = state.range(0);
+    const T value = element<T>::make(3);
+    Vec vec;
+    vec.reserve(n);
+    storage_counters<Vec> counters(state);
+    for(auto _ : state) {
+        vec.assign(n, value);
+        benchmark::DoNotOptimize(vec.data());
+    }
+    state.SetItemsProcessed(state.iterations()*n);
+}
+
+template<typename Vec>
+void iterate(benchmark::State& state) {
+    using T = typename Vec::value_type;
+    const size_t n = state.range(0);
+    const Vec vec = make_filled<Vec>(n);
+    storage_counters<Vec> counters(state);
+    for(auto _ : state) {
+        size_t sum = 0;
+        for(const auto& x: vec) {
+            sum += element<T>::weight(x);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations()*n);
+}
+
+template<typename Vec>
+void index(benchmark::State& state) {
+    using T = typename Vec::value_type;
+    const size_t n = state.range(0);
+    const Vec vec = make_filled<Vec>(n);
+    storage_counters<Vec> counters(state);
+    for(auto _ : state) {
+        size_t sum = 0;
+        for(size_t i=0; i<n; i++) {
+            sum += element<T>::weight(vec[i]);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations()*n);
+}
+
+// Equal vectors so the whole range is compared
+template<typename Vec>
+void compare_equal(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const Vec a = make_filled<Vec>(n);
+    const Vec b = a;
+    storage_counters<Vec> counters(state);
+    for(auto _ : state) {
+        bool eq = a == b;
+        benchmark::DoNotOptimize(eq);
+    }
+    state.SetItemsProcessed(state.iterations()*n);
+}
+
+// Only the last element differs
+template<typename Vec>
+void compare_less(benchmark::State& state) {
+    using T = typename Vec::value_type;
+    const size_t n = state.range(0);
+    const Vec a = make_filled<Vec>(n);
+    Vec b = a;
+    b.back() = element<T>::make(n);
+    storage_counters<Vec> counters(state);
+    for(auto _ : state) {
+        bool lt = a < b;
+        benchmark::DoNotOptimize(lt);
+    }
+    state.SetItemsProcessed(state.iterations()*n);
+}
+
+static const size_t suite_sizes[] = {8, 1 << 10, 1 << 16, 1 << 20, 1 << 24, 100000000};
+
+template<typename Vec>
+void register_operation(const char* op, void (*fn)(benchmark::State&)) {
+    using T = typename Vec::value_type;
+    const std::string name = std::string(container<Vec>::name) + "/" + op + "/" + element<T>::name;
+    auto* bench = benchmark::RegisterBenchmark(name.c_str(), fn);
+    if(XD_VECTOR_INSTRUMENT) {
+        // The counters are the same every iteration, only the time varies
+        bench->Iterations(1);
+    }
+    for(size_t n: suite_sizes) {
+        if(n*element<T>::footprint <= XD_SUITE_MAX_BYTES) {
+            bench->Arg(int64_t(n));
+        }
+    }
+}
+
+template<typename Vec>
+void register_container() {
+    register_operation<Vec>("construct_fill", construct_fill<Vec>);
+    register_operation<Vec>("construct_range", construct_range<Vec>);
+    register_operation<Vec>("copy_construct", copy_construct<Vec>);
+    register_operation<Vec>("copy_assign", copy_assign<Vec>);
+    register_operation<Vec>("move", move<Vec>);
+    register_operation<Vec>("push_back_growth", push_back_growth<Vec>);
+    register_operation<Vec>("push_back_reserved", push_back_reserved<Vec>);
+    register_operation<Vec>("insert_erase_front", insert_erase_front<Vec>);
+    register_operation<Vec>("insert_erase_middle", insert_erase_middle<Vec>);
+    register_operation<Vec>("insert_erase_back", insert_erase_back<Vec>);
+    register_operation<Vec>("resize", resize<Vec>);
+    register_operation<Vec>("assign", assign<Vec>);
+    register_operation<Vec>("iterate", iterate<Vec>);
+    register_operation<Vec>("index", index<Vec>);
+    register_operation<Vec>("compare_equal", compare_equal<Vec>);
+    register_operation<Vec>("compare_less", compare_less<Vec>);
+}
+
+template<typename T>
+void register_type() {
+    register_container<xd::vector<T>>();
+    // Nothing to count for the reference
+    if(!XD_VECTOR_INSTRUMENT) {
+        register_container<std::vector<T>>();
+    }
+}
+
+int main(int argc, char** argv) {
+    register_type<char>();
+    register_type<uint32_t>();
+    register_type<pod64>();
+    register_type<std::string>();
+    // library_build_type describes how libbenchmark was built, not this
+    // code, so record the suite's own build for compare.py
+#ifdef NDEBUG
+    benchmark::AddCustomContext("xd_build_type", "release");
+#else
+    benchmark::AddCustomContext("xd_build_type", "debug");
+#endif
+    benchmark::Initialize(&argc, argv);
+    if(benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    return 0;
+}
@@ -0,0 +1,171 @@
+#ifndef XD_ALIGNED_ALLOCATOR_H
+#define XD_ALIGNED_ALLOCATOR_H
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#define XD_HAS_MMAP 1
+#endif
+
+#include "vector.hpp"
+
+
+namespace xd {
+
+    //! Allocator returning storage aligned to Alignment bytes, the default
+    //! is a cache line so SIMD loads over data() are aligned
+    template<typename T, size_t Alignment = 64>
+    class aligned_allocator {
+    public:
+        using value_type = T;
+        using is_always_equal = std::true_type;
+
+        static_assert((Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two");
+        static_assert(Alignment >= alignof(T), "Alignment can't be less than alignof(T)");
+
+        template<typename U>
+        struct rebind {
+            using other = aligned_allocator<U, Alignment>;
+        };
+
+        aligned_allocator() noexcept = default;
+
+        template<typename U>
+        aligned_allocator(const aligned_allocator<U, Alignment>&) noexcept {}
+
+        T* allocate(size_t n) {
+            return static_cast<T*>(::operator new(n*sizeof(T), std::align_val_t(Alignment)));
+        }
+
+        void deallocate(T* p, size_t) noexcept {
+            ::operator delete(p, std::align_val_t(Alignment));
+        }
+    };
+
+    template<typename T, size_t A, typename U, size_t B>
+    bool operator==(const aligned_allocator<T, A>&, const aligned_allocator<U, B>&) {
+        return A == B;
+    }
+
+    template<typename T, size_t A, typename U, size_t B>
+    bool operator!=(const aligned_allocator<T, A>& lhs, const aligned_allocator<U, B>& rhs) {
+        return !(lhs == rhs);
+    }
+
+    //! Allocator for big vectors. Blocks of at least Threshold bytes are
+    //! mapped on a 2MB boundary and advised with MADV_HUGEPAGE so random
+    //! access over them doesn't thrash the TLB. Smaller blocks are cache
+    //! line aligned.
+    template<typename T, size_t Threshold = (size_t(1) << 22)>
+    class huge_page_allocator {
+    public:
+        using value_type = T;
+        using is_always_equal = std::true_type;
+
+        //! Size of a transparent huge page on x86-64 and aarch64 (4K pages)
+        static constexpr size_t huge_page_size = size_t(1) << 21;
+
+        static_assert(alignof(T) <= huge_page_size, "Can't align past a huge page");
+
+        template<typename U>
+        struct rebind {
+            using other = huge_page_allocator<U, Threshold>;
+        };
+
+        huge_page_allocator() noexcept = default;
+
+        template<typename U>
+        huge_page_allocator(const huge_page_allocator<U, Threshold>&) noexcept {}
+
+        T* allocate(size_t n);
+        void deallocate(T* p, size_t n) noexcept;
+    private:
+        static constexpr size_t small_alignment = alignof(T) > 64 ? alignof(T) : 64;
+
+        static bool is_mapped(size_t bytes) noexcept;
+        static size_t round_up(size_t bytes) noexcept;
+    };
+
+    template<typename T, size_t A, typename U, size_t B>
+    bool operator==(const huge_page_allocator<T, A>&, const huge_page_allocator<U, B>&) {
+        return A == B;
+    }
+
+    template<typename T, size_t A, typename U, size_t B>
+    bool operator!=(const huge_page_allocator<T, A>& lhs, const huge_page_allocator<U, B>& rhs) {
+        return !(lhs == rhs);
+    }
+
+    //! Vector whose data() is aligned to Alignment bytes
+    template<typename T, size_t Alignment = 64>
+    using aligned_vector = vector<T, aligned_allocator<T, Alignment>>;
+
+    //! Vector backed by transparent huge pages once it reaches Threshold bytes
+    template<typename T, size_t Threshold = (size_t(1) << 22)>
+    using huge_page_vector = vector<T, huge_page_allocator<T, Threshold>>;
+
+    template<typename T, size_t Threshold>
+    bool huge_page_allocator<T, Threshold>::is_mapped(size_t bytes) noexcept {
+#ifdef XD_HAS_MMAP
+        return bytes >= Threshold;
+#else
+        (void)bytes;
+        return false;
+#endif
+    }
+
+    template<typename T, size_t Threshold>
+    size_t huge_page_allocator<T, Threshold>::round_up(size_t bytes) noexcept {
+        return (bytes + huge_page_size - 1) & ~(huge_page_size - 1);
+    }
+
+    template<typename T, size_t Threshold>
+    T* huge_page_allocator<T, Threshold>::allocate(size_t n) {
+        const size_t bytes = n*sizeof(T);
+        if(!is_mapped(bytes)) {
+            return static_cast<T*>(::operator new(bytes, std::align_val_t(small_alignment)));
+        }
+#ifdef XD_HAS_MMAP
+        // mmap only promises page alignment, map an extra huge page and
+        // trim either side to land on a huge page boundary
+        const size_t size = round_up(bytes);
+        const size_t padded = size + huge_page_size;
+        void* raw = mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(raw == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        const uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+        const uintptr_t aligned = (start + huge_page_size - 1) & ~(uintptr_t)(huge_page_size - 1);
+        if(aligned != start) {
+            munmap(raw, aligned - start);
+        }
+        const size_t tail = start + padded - (aligned + size);
+        if(tail != 0) {
+            munmap(reinterpret_cast<void*>(aligned + size), tail);
+        }
+#ifdef MADV_HUGEPAGE
+        madvise(reinterpret_cast<void*>(aligned), size, MADV_HUGEPAGE);
+#endif
+        return reinterpret_cast<T*>(aligned);
+#else
+        throw std::bad_alloc();
+#endif
+    }
+
+    template<typename T, size_t Threshold>
+    void huge_page_allocator<T, Threshold>::deallocate(T* p, size_t n) noexcept {
+        const size_t bytes = n*sizeof(T);
+        if(!is_mapped(bytes)) {
+            ::operator delete(p, std::align_val_t(small_alignment));
+            return;
+        }
+#ifdef XD_HAS_MMAP
+        munmap(p, round_up(bytes));
+#endif
+    }
+}
+
+#endif
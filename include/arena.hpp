@@ -0,0 +1,210 @@
+#ifndef XD_ARENA_H
+#define XD_ARENA_H
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+
+namespace xd {
+
+    //! Bump allocator handing out memory from large blocks. Individual
+    //! deallocations are (mostly) no-ops, everything is released at once by
+    //! reset() or when the arena is destroyed. Not thread safe, the intended
+    //! use is one arena per request/worker thread.
+    class arena {
+    public:
+        explicit arena(size_t block_size = 64*1024);
+        ~arena();
+
+        arena(const arena&) = delete;
+        arena& operator=(const arena&) = delete;
+
+        void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+        void deallocate(void* p, size_t bytes) noexcept;
+        //! Resizes an allocation keeping its bytes, the most recent
+        //! allocation grows in place while there's room in the block
+        void* reallocate(void* p, size_t old_bytes, size_t new_bytes, size_t alignment = alignof(std::max_align_t));
+
+        //! Releases every allocation made from the arena. Anything still
+        //! pointing into the arena is invalidated, so containers using it
+        //! should be destroyed (or abandoned if trivially destructible) first.
+        void reset() noexcept;
+
+        //! Bytes handed out since the last reset
+        size_t bytes_used() const noexcept;
+        //! Bytes currently owned by the arena
+        size_t bytes_reserved() const noexcept;
+    private:
+        struct block {
+            block* next;
+            size_t size;
+        };
+
+        void add_block(size_t min_bytes);
+        static char* block_start(block* b) noexcept;
+
+        //! Block allocations are served from, older blocks follow via next
+        block* head;
+        //! Next free byte in head
+        char* cursor;
+        //! One past the last usable byte in head
+        char* limit;
+        //! Minimum size of a new block
+        size_t block_size;
+        //! Bytes used in blocks other than head
+        size_t retired;
+    };
+
+    //! Standard allocator interface over an xd::arena. Copies share the
+    //! arena and the allocator isn't propagated on copy/move/swap so a
+    //! container stays on the arena it was created with.
+    template<typename T>
+    class arena_allocator {
+    public:
+        using value_type = T;
+        using propagate_on_container_copy_assignment = std::false_type;
+        using propagate_on_container_move_assignment = std::false_type;
+        using propagate_on_container_swap = std::false_type;
+        using is_always_equal = std::false_type;
+
+        arena_allocator(arena& a) noexcept: source(&a) {}
+
+        template<typename U>
+        arena_allocator(const arena_allocator<U>& other) noexcept: source(other.resource()) {}
+
+        T* allocate(size_t n) {
+            return static_cast<T*>(source->allocate(n*sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T* p, size_t n) noexcept {
+            source->deallocate(p, n*sizeof(T));
+        }
+
+        T* reallocate(T* p, size_t old_n, size_t new_n) {
+            return static_cast<T*>(source->reallocate(p, old_n*sizeof(T), new_n*sizeof(T), alignof(T)));
+        }
+
+        arena* resource() const noexcept {
+            return source;
+        }
+    private:
+        arena* source;
+    };
+
+    template<typename T, typename U>
+    bool operator==(const arena_allocator<T>& lhs, const arena_allocator<U>& rhs) {
+        return lhs.resource() == rhs.resource();
+    }
+
+    template<typename T, typename U>
+    bool operator!=(const arena_allocator<T>& lhs, const arena_allocator<U>& rhs) {
+        return !(lhs == rhs);
+    }
+
+    inline arena::arena(size_t block_size):
+    head(nullptr),
+    cursor(nullptr),
+    limit(nullptr),
+    block_size(block_size),
+    retired(0) {
+    }
+
+    inline arena::~arena() {
+        while(head != nullptr) {
+            block* next = head->next;
+            free(head);
+            head = next;
+        }
+    }
+
+    inline char* arena::block_start(block* b) noexcept {
+        return reinterpret_cast<char*>(b) + sizeof(block);
+    }
+
+    inline void arena::add_block(size_t min_bytes) {
+        size_t size = block_size;
+        if(size < min_bytes) {
+            size = min_bytes;
+        }
+        block* b = static_cast<block*>(malloc(sizeof(block) + size));
+        if(b == nullptr) {
+            throw std::bad_alloc();
+        }
+        if(head != nullptr) {
+            retired += cursor - block_start(head);
+        }
+        b->next = head;
+        b->size = size;
+        head = b;
+        cursor = block_start(b);
+        limit = cursor + size;
+    }
+
+    inline void* arena::allocate(size_t bytes, size_t alignment) {
+        uintptr_t aligned = (reinterpret_cast<uintptr_t>(cursor) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+        if(head == nullptr || aligned + bytes > reinterpret_cast<uintptr_t>(limit)) {
+            add_block(bytes + alignment);
+            aligned = (reinterpret_cast<uintptr_t>(cursor) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+        }
+        cursor = reinterpret_cast<char*>(aligned + bytes);
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    inline void arena::deallocate(void* p, size_t bytes) noexcept {
+        // Freeing the most recent allocation rewinds the bump pointer so
+        // temporaries destroyed in LIFO order hand their memory straight back
+        if(static_cast<char*>(p) + bytes == cursor) {
+            cursor = static_cast<char*>(p);
+        }
+    }
+
+    inline void* arena::reallocate(void* p, size_t old_bytes, size_t new_bytes, size_t alignment) {
+        char* start = static_cast<char*>(p);
+        if(p != nullptr && start + old_bytes == cursor && start + new_bytes <= limit) {
+            cursor = start + new_bytes;
+            return p;
+        }
+        void* moved = allocate(new_bytes, alignment);
+        if(p != nullptr) {
+            memcpy(moved, p, old_bytes < new_bytes ? old_bytes : new_bytes);
+        }
+        return moved;
+    }
+
+    inline void arena::reset() noexcept {
+        if(head == nullptr) {
+            return;
+        }
+        // Keep the newest block around so the next request doesn't malloc
+        block* old = head->next;
+        while(old != nullptr) {
+            block* next = old->next;
+            free(old);
+            old = next;
+        }
+        head->next = nullptr;
+        cursor = block_start(head);
+        limit = cursor + head->size;
+        retired = 0;
+    }
+
+    inline size_t arena::bytes_used() const noexcept {
+        if(head == nullptr) {
+            return 0;
+        }
+        return retired + (cursor - block_start(head));
+    }
+
+    inline size_t arena::bytes_reserved() const noexcept {
+        size_t total = 0;
+        for(block* b=head; b!=nullptr; b=b->next) {
+            total += b->size;
+        }
+        return total;
+    }
+}
+
+#endif
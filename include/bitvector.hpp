@@ -0,0 +1,658 @@
+#ifndef XD_BITVECTOR_H
+#define XD_BITVECTOR_H
+#include <bit>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include "aligned_allocator.hpp"
+#include "simd.hpp"
+#include "vector.hpp"
+
+
+namespace xd {
+
+    namespace detail {
+        //! Position of the k-th set bit of word, counting from 0. The word
+        //! must have more than k bits set. Byte counts pick the byte then
+        //! the bits below it are cleared, so at most 15 steps without BMI2.
+        inline size_t select_in_word(uint64_t word, size_t k) noexcept {
+            uint64_t bytes = word - ((word >> 1) & 0x5555555555555555ull);
+            bytes = (bytes & 0x3333333333333333ull) + ((bytes >> 2) & 0x3333333333333333ull);
+            bytes = (bytes + (bytes >> 4)) & 0x0f0f0f0f0f0f0f0full;
+            // Byte i now holds the set bits in bytes 0 to i
+            bytes *= 0x0101010101010101ull;
+            size_t shift = 0;
+            size_t before = 0;
+            while(((bytes >> shift) & 0xff) <= k) {
+                before = (bytes >> shift) & 0xff;
+                shift += 8;
+            }
+            uint64_t rest = (word >> shift) & 0xff;
+            for(size_t i=k - before; i>0; i--) {
+                rest &= rest - 1;
+            }
+            return shift + std::countr_zero(rest);
+        }
+    }
+
+    //! Vector of bools packed 64 to a word. The bits past size() in the
+    //! last word are kept zero so count(), == and the bitwise operators
+    //! run on whole words, the latter with the SIMD kernels in simd.hpp.
+    //! Bitwise operators need both sides the same size and throw
+    //! std::invalid_argument otherwise.
+    template<typename BoundsCheck = default_bounds_check>
+    class basic_bitvector {
+    public:
+        using word_type = uint64_t;
+        using value_type = bool;
+        using size_type = size_t;
+        using const_reference = bool;
+
+        static constexpr size_t word_bits = 64;
+        //! Returned by the find functions when no bit is set
+        static constexpr size_t npos = size_t(-1);
+
+        class reference;
+        class const_iterator;
+
+        basic_bitvector() noexcept;
+        explicit basic_bitvector(size_t count, bool value = false);
+        template<typename InputIt, typename = detail::require_input_iterator<InputIt>>
+        basic_bitvector(InputIt first, InputIt last);
+        basic_bitvector(std::initializer_list<bool> l);
+
+        //! Fills whole words at a time
+        void assign(size_t count, bool value);
+
+        void reserve(size_t capacity);
+
+        void push_back(bool value);
+        void pop_back();
+
+        //! New bits are filled a word at a time
+        void resize(size_t count, bool value = false);
+
+        void clear() noexcept;
+
+        reference operator[](size_t index);
+        const_reference operator[](size_t index) const;
+
+        reference at(size_t index);
+        const_reference at(size_t index) const;
+
+        reference front();
+        const_reference front() const;
+
+        reference back();
+        const_reference back() const;
+
+        basic_bitvector& set(size_t index, bool value = true);
+        basic_bitvector& reset(size_t index);
+        basic_bitvector& flip(size_t index);
+        //! Sets, clears or flips every bit
+        basic_bitvector& set() noexcept;
+        basic_bitvector& reset() noexcept;
+        basic_bitvector& flip() noexcept;
+
+        //! Number of set bits
+        size_t count() const noexcept;
+        bool any() const noexcept;
+        bool none() const noexcept;
+        bool all() const noexcept;
+
+        //! Index of the first set bit, npos if there isn't one
+        size_t find_first() const noexcept;
+        //! Index of the first set bit after index, npos if there isn't one
+        size_t find_next(size_t index) const noexcept;
+
+        basic_bitvector& operator&=(const basic_bitvector& other);
+        basic_bitvector& operator|=(const basic_bitvector& other);
+        basic_bitvector& operator^=(const basic_bitvector& other);
+        //! Clears the bits set in other, *this &= ~other without the copy
+        basic_bitvector& and_not(const basic_bitvector& other);
+        basic_bitvector operator~() const;
+
+        size_t size() const noexcept;
+        size_t capacity() const noexcept;
+        bool empty() const noexcept;
+
+        void shrink_to_fit();
+
+        //! The packed words, bit i is bit i % 64 of word i / 64
+        const word_type* data() const noexcept;
+        size_t word_count() const noexcept;
+
+        void swap(basic_bitvector& other) noexcept;
+
+        const_iterator begin() const noexcept;
+        const_iterator cbegin() const noexcept;
+        const_iterator end() const noexcept;
+        const_iterator cend() const noexcept;
+    private:
+        static size_t words_for(size_t bits) noexcept;
+        //! Zeroes the bits past raw_size in the last word
+        void clear_tail() noexcept;
+        template<detail::bit_op Op>
+        basic_bitvector& combine(const basic_bitvector& other);
+
+        aligned_vector<word_type> _words;
+        size_t raw_size;
+    };
+
+    using bitvector = basic_bitvector<>;
+
+    //! Proxy for one bit, what operator[] returns on a non-const bitvector
+    template<typename BoundsCheck>
+    class basic_bitvector<BoundsCheck>::reference {
+    public:
+        reference& operator=(bool value) noexcept { *word = value ? *word | mask : *word & ~mask; return *this; }
+        reference& operator=(const reference& other) noexcept { return *this = bool(other); }
+        operator bool() const noexcept { return (*word & mask) != 0; }
+        bool operator~() const noexcept { return !bool(*this); }
+        reference& flip() noexcept { *word ^= mask; return *this; }
+    private:
+        friend class basic_bitvector;
+
+        reference(word_type* word, word_type mask) noexcept: word(word), mask(mask) {}
+
+        word_type* word;
+        word_type mask;
+    };
+
+    //! Random access iterator over the bits by value
+    template<typename BoundsCheck>
+    class basic_bitvector<BoundsCheck>::const_iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = bool;
+        using difference_type = std::ptrdiff_t;
+        using reference = bool;
+        using pointer = void;
+
+        const_iterator() noexcept: words(nullptr), index(0) {}
+
+        bool operator*() const noexcept { return (words[index/word_bits] >> (index%word_bits)) & 1; }
+        bool operator[](difference_type n) const noexcept { return *(*this + n); }
+
+        const_iterator& operator++() noexcept { ++index; return *this; }
+        const_iterator operator++(int) noexcept { auto tmp = *this; ++index; return tmp; }
+        const_iterator& operator--() noexcept { --index; return *this; }
+        const_iterator operator--(int) noexcept { auto tmp = *this; --index; return tmp; }
+        const_iterator& operator+=(difference_type n) noexcept { index += n; return *this; }
+        const_iterator& operator-=(difference_type n) noexcept { index -= n; return *this; }
+        const_iterator operator+(difference_type n) const noexcept { return const_iterator(words, index + n); }
+        const_iterator operator-(difference_type n) const noexcept { return const_iterator(words, index - n); }
+        difference_type operator-(const const_iterator& other) const noexcept { return difference_type(index - other.index); }
+
+        bool operator==(const const_iterator& other) const noexcept { return index == other.index; }
+        bool operator!=(const const_iterator& other) const noexcept { return index != other.index; }
+        bool operator<(const const_iterator& other) const noexcept { return index < other.index; }
+        bool operator>(const const_iterator& other) const noexcept { return index > other.index; }
+        bool operator<=(const const_iterator& other) const noexcept { return index <= other.index; }
+        bool operator>=(const const_iterator& other) const noexcept { return index >= other.index; }
+    private:
+        friend class basic_bitvector;
+
+        const_iterator(const word_type* words, size_t index) noexcept: words(words), index(index) {}
+
+        const word_type* words;
+        size_t index;
+    };
+
+    //! Rank and select over a bitvector in O(1) and O(log n). Each 512 bit
+    //! block stores the ones before it and, packed 9 bits apiece, the ones
+    //! before each of its words within the block, so a rank is two loads
+    //! and a popcount. The index is about 25% the size of the bits. It
+    //! reads the bitvector it was built from, which must outlive it, and
+    //! is stale once that changes.
+    template<typename Bits>
+    class rank_select {
+    public:
+        explicit rank_select(const Bits& bits);
+
+        //! Ones in [0, index), index can be up to bits.size()
+        size_t rank(size_t index) const noexcept;
+        //! Position of the k-th one counting from 0, Bits::npos if there
+        //! are k or fewer ones
+        size_t select(size_t k) const noexcept;
+        //! Total number of ones
+        size_t ones() const noexcept;
+    private:
+        static constexpr size_t block_words = 8;
+
+        const Bits* bits;
+        //! Ones before block b at 2*b, word counts within it at 2*b + 1
+        vector<uint64_t> _blocks;
+        size_t block_count;
+    };
+
+    template<typename BoundsCheck>
+    bool operator==(const basic_bitvector<BoundsCheck>& lhs, const basic_bitvector<BoundsCheck>& rhs) {
+        return lhs.size() == rhs.size() && detail::equal(lhs.data(), rhs.data(), lhs.word_count());
+    }
+
+    template<typename BoundsCheck>
+    bool operator!=(const basic_bitvector<BoundsCheck>& lhs, const basic_bitvector<BoundsCheck>& rhs) {
+        return !(lhs == rhs);
+    }
+
+    template<typename BoundsCheck>
+    basic_bitvector<BoundsCheck> operator&(basic_bitvector<BoundsCheck> lhs, const basic_bitvector<BoundsCheck>& rhs) {
+        return lhs &= rhs;
+    }
+
+    template<typename BoundsCheck>
+    basic_bitvector<BoundsCheck> operator|(basic_bitvector<BoundsCheck> lhs, const basic_bitvector<BoundsCheck>& rhs) {
+        return lhs |= rhs;
+    }
+
+    template<typename BoundsCheck>
+    basic_bitvector<BoundsCheck> operator^(basic_bitvector<BoundsCheck> lhs, const basic_bitvector<BoundsCheck>& rhs) {
+        return lhs ^= rhs;
+    }
+
+    template<typename BoundsCheck>
+    basic_bitvector<BoundsCheck>::basic_bitvector() noexcept:
+    _words(),
+    raw_size(0) {
+    }
+
+    template<typename BoundsCheck>
+    basic_bitvector<BoundsCheck>::basic_bitvector(size_t count, bool value):
+    basic_bitvector() {
+        assign(count, value);
+    }
+
+    template<typename BoundsCheck>
+    template<typename InputIt, typename>
+    basic_bitvector<BoundsCheck>::basic_bitvector(InputIt first, InputIt last):
+    basic_bitvector() {
+        if constexpr(detail::is_forward_iterator_v<InputIt>) {
+            reserve(size_t(std::distance(first, last)));
+        }
+        for(; first != last; ++first) {
+            push_back(bool(*first));
+        }
+    }
+
+    template<typename BoundsCheck>
+    basic_bitvector<BoundsCheck>::basic_bitvector(std::initializer_list<bool> l):
+    basic_bitvector(l.begin(), l.end()) {
+    }
+
+    template<typename BoundsCheck>
+    void basic_bitvector<BoundsCheck>::assign(size_t count, bool value) {
+        _words.assign(words_for(count), value ? ~word_type(0) : word_type(0));
+        raw_size = count;
+        clear_tail();
+    }
+
+    template<typename BoundsCheck>
+    void basic_bitvector<BoundsCheck>::reserve(size_t capacity) {
+        _words.reserve(words_for(capacity));
+    }
+
+    template<typename BoundsCheck>
+    void basic_bitvector<BoundsCheck>::push_back(bool value) {
+        const size_t bit = raw_size % word_bits;
+        if(bit == 0) {
+            _words.push_back(word_type(value));
+        } else {
+            _words.back() |= word_type(value) << bit;
+        }
+        raw_size++;
+    }
+
+    template<typename BoundsCheck>
+    void basic_bitvector<BoundsCheck>::pop_back() {
+        if(empty()) {
+            return;
+        }
+        raw_size--;
+        if(raw_size % word_bits == 0) {
+            _words.pop_back();
+        } else {
+            clear_tail();
+        }
+    }
+
+    template<typename BoundsCheck>
+    void basic_bitvector<BoundsCheck>::resize(size_t count, bool value) {
+        if(value && count > raw_size && raw_size % word_bits != 0) {
+            _words.back() |= ~word_type(0) << (raw_size % word_bits);
+        }
+        _words.resize(words_for(count), value ? ~word_type(0) : word_type(0));
+        raw_size = count;
+        clear_tail();
+    }
+
+    template<typename BoundsCheck>
+    void basic_bitvector<BoundsCheck>::clear() noexcept {
+        _words.clear();
+        raw_size = 0;
+    }
+
+    template<typename BoundsCheck>
+    typename basic_bitvector<BoundsCheck>::reference basic_bitvector<BoundsCheck>::operator[](size_t index) {
+        BoundsCheck::check(index, raw_size);
+        return reference(_words.data() + index/word_bits, word_type(1) << (index%word_bits));
+    }
+
+    template<typename BoundsCheck>
+    bool basic_bitvector<BoundsCheck>::operator[](size_t index) const {
+        BoundsCheck::check(index, raw_size);
+        return (_words.data()[index/word_bits] >> (index%word_bits)) & 1;
+    }
+
+    template<typename BoundsCheck>
+    typename basic_bitvector<BoundsCheck>::reference basic_bitvector<BoundsCheck>::at(size_t index) {
+        bounds_throw::check(index, raw_size);
+        return reference(_words.data() + index/word_bits, word_type(1) << (index%word_bits));
+    }
+
+    template<typename BoundsCheck>
+    bool basic_bitvector<BoundsCheck>::at(size_t index) const {
+        bounds_throw::check(index, raw_size);
+        return (_words.data()[index/word_bits] >> (index%word_bits)) & 1;
+    }
+
+    template<typename BoundsCheck>
+    typename basic_bitvector<BoundsCheck>::reference basic_bitvector<BoundsCheck>::front() {
+        return (*this)[0];
+    }
+
+    template<typename BoundsCheck>
+    bool basic_bitvector<BoundsCheck>::front() const {
+        return (*this)[0];
+    }
+
+    template<typename BoundsCheck>
+    typename basic_bitvector<BoundsCheck>::reference basic_bitvector<BoundsCheck>::back() {
+        return (*this)[raw_size - 1];
+    }
+
+    template<typename BoundsCheck>
+    bool basic_bitvector<BoundsCheck>::back() const {
+        return (*this)[raw_size - 1];
+    }
+
+    template<typename BoundsCheck>
+    basic_bitvector<BoundsCheck>& basic_bitvector<BoundsCheck>::set(size_t index, bool value) {
+        (*this)[index] = value;
+        return *this;
+    }
+
+    template<typename BoundsCheck>
+    basic_bitvector<BoundsCheck>& basic_bitvector<BoundsCheck>::reset(size_t index) {
+        (*this)[index] = false;
+        return *this;
+    }
+
+    template<typename BoundsCheck>
+    basic_bitvector<BoundsCheck>& basic_bitvector<BoundsCheck>::flip(size_t index) {
+        (*this)[index].flip();
+        return *this;
+    }
+
+    template<typename BoundsCheck>
+    basic_bitvector<BoundsCheck>& basic_bitvector<BoundsCheck>::set() noexcept {
+        detail::fill(_words.data(), _words.size(), ~word_type(0));
+        clear_tail();
+        return *this;
+    }
+
+    template<typename BoundsCheck>
+    basic_bitvector<BoundsCheck>& basic_bitvector<BoundsCheck>::reset() noexcept {
+        detail::fill(_words.data(), _words.size(), word_type(0));
+        return *this;
+    }
+
+    template<typename BoundsCheck>
+    basic_bitvector<BoundsCheck>& basic_bitvector<BoundsCheck>::flip() noexcept {
+        word_type* words = _words.data();
+        for(size_t i=0; i<_words.size(); i++) {
+            words[i] = ~words[i];
+        }
+        clear_tail();
+        return *this;
+    }
+
+    template<typename BoundsCheck>
+    size_t basic_bitvector<BoundsCheck>::count() const noexcept {
+        return detail::popcount(_words.data(), _words.size());
+    }
+
+    template<typename BoundsCheck>
+    bool basic_bitvector<BoundsCheck>::any() const noexcept {
+        return find_first() != npos;
+    }
+
+    template<typename BoundsCheck>
+    bool basic_bitvector<BoundsCheck>::none() const noexcept {
+        return !any();
+    }
+
+    template<typename BoundsCheck>
+    bool basic_bitvector<BoundsCheck>::all() const noexcept {
+        const size_t full = raw_size/word_bits;
+        if(detail::count(_words.data(), full, ~word_type(0)) != full) {
+            return false;
+        }
+        return raw_size % word_bits == 0 || std::popcount(_words.back()) == int(raw_size % word_bits);
+    }
+
+    template<typename BoundsCheck>
+    size_t basic_bitvector<BoundsCheck>::find_first() const noexcept {
+        const word_type* words = _words.data();
+        for(size_t i=0; i<_words.size(); i++) {
+            if(words[i] != 0) {
+                return i*word_bits + std::countr_zero(words[i]);
+            }
+        }
+        return npos;
+    }
+
+    template<typename BoundsCheck>
+    size_t basic_bitvector<BoundsCheck>::find_next(size_t index) const noexcept {
+        if(index + 1 >= raw_size) {
+            return npos;
+        }
+        index++;
+        const word_type* words = _words.data();
+        size_t i = index/word_bits;
+        word_type word = words[i] & (~word_type(0) << (index%word_bits));
+        while(word == 0) {
+            if(++i == _words.size()) {
+                return npos;
+            }
+            word = words[i];
+        }
+        return i*word_bits + std::countr_zero(word);
+    }
+
+    template<typename BoundsCheck>
+    template<detail::bit_op Op>
+    basic_bitvector<BoundsCheck>& basic_bitvector<BoundsCheck>::combine(const basic_bitvector& other) {
+        if(raw_size != other.raw_size) {
+            throw std::invalid_argument("Bitwise operation on bitvectors of different sizes");
+        }
+        detail::bit_op_words<Op>(_words.data(), other._words.data(), _words.size());
+        return *this;
+    }
+
+    template<typename BoundsCheck>
+    basic_bitvector<BoundsCheck>& basic_bitvector<BoundsCheck>::operator&=(const basic_bitvector& other) {
+        return combine<detail::bit_op::and_>(other);
+    }
+
+    template<typename BoundsCheck>
+    basic_bitvector<BoundsCheck>& basic_bitvector<BoundsCheck>::operator|=(const basic_bitvector& other) {
+        return combine<detail::bit_op::or_>(other);
+    }
+
+    template<typename BoundsCheck>
+    basic_bitvector<BoundsCheck>& basic_bitvector<BoundsCheck>::operator^=(const basic_bitvector& other) {
+        return combine<detail::bit_op::xor_>(other);
+    }
+
+    template<typename BoundsCheck>
+    basic_bitvector<BoundsCheck>& basic_bitvector<BoundsCheck>::and_not(const basic_bitvector& other) {
+        return combine<detail::bit_op::and_not>(other);
+    }
+
+    template<typename BoundsCheck>
+    basic_bitvector<BoundsCheck> basic_bitvector<BoundsCheck>::operator~() const {
+        basic_bitvector res = *this;
+        res.flip();
+        return res;
+    }
+
+    template<typename BoundsCheck>
+    size_t basic_bitvector<BoundsCheck>::size() const noexcept {
+        return raw_size;
+    }
+
+    template<typename BoundsCheck>
+    size_t basic_bitvector<BoundsCheck>::capacity() const noexcept {
+        return _words.capacity()*word_bits;
+    }
+
+    template<typename BoundsCheck>
+    bool basic_bitvector<BoundsCheck>::empty() const noexcept {
+        return raw_size == 0;
+    }
+
+    template<typename BoundsCheck>
+    void basic_bitvector<BoundsCheck>::shrink_to_fit() {
+        _words.shrink_to_fit();
+    }
+
+    template<typename BoundsCheck>
+    const uint64_t* basic_bitvector<BoundsCheck>::data() const noexcept {
+        return _words.data();
+    }
+
+    template<typename BoundsCheck>
+    size_t basic_bitvector<BoundsCheck>::word_count() const noexcept {
+        return _words.size();
+    }
+
+    template<typename BoundsCheck>
+    void basic_bitvector<BoundsCheck>::swap(basic_bitvector& other) noexcept {
+        _words.swap(other._words);
+        std::swap(raw_size, other.raw_size);
+    }
+
+    template<typename BoundsCheck>
+    typename basic_bitvector<BoundsCheck>::const_iterator basic_bitvector<BoundsCheck>::begin() const noexcept {
+        return const_iterator(_words.data(), 0);
+    }
+
+    template<typename BoundsCheck>
+    typename basic_bitvector<BoundsCheck>::const_iterator basic_bitvector<BoundsCheck>::cbegin() const noexcept {
+        return begin();
+    }
+
+    template<typename BoundsCheck>
+    typename basic_bitvector<BoundsCheck>::const_iterator basic_bitvector<BoundsCheck>::end() const noexcept {
+        return const_iterator(_words.data(), raw_size);
+    }
+
+    template<typename BoundsCheck>
+    typename basic_bitvector<BoundsCheck>::const_iterator basic_bitvector<BoundsCheck>::cend() const noexcept {
+        return end();
+    }
+
+    template<typename BoundsCheck>
+    size_t basic_bitvector<BoundsCheck>::words_for(size_t bits) noexcept {
+        return (bits + word_bits - 1)/word_bits;
+    }
+
+    template<typename BoundsCheck>
+    void basic_bitvector<BoundsCheck>::clear_tail() noexcept {
+        if(raw_size % word_bits != 0) {
+            _words.back() &= ~(~word_type(0) << (raw_size % word_bits));
+        }
+    }
+
+    template<typename Bits>
+    rank_select<Bits>::rank_select(const Bits& bits):
+    bits(&bits),
+    _blocks(),
+    block_count((bits.word_count() + block_words - 1)/block_words) {
+        const uint64_t* words = bits.data();
+        const size_t n = bits.word_count();
+        // One extra block so rank(bits.size()) on a block boundary has
+        // somewhere to look
+        _blocks.resize(2*(block_count + 1), 0);
+        uint64_t total = 0;
+        for(size_t b=0; b<block_count; b++) {
+            _blocks[2*b] = total;
+            uint64_t in_block = 0;
+            uint64_t counts = 0;
+            for(size_t j=0; j<block_words; j++) {
+                if(j > 0) {
+                    counts |= in_block << (9*(j - 1));
+                }
+                if(b*block_words + j < n) {
+                    in_block += std::popcount(words[b*block_words + j]);
+                }
+            }
+            _blocks[2*b + 1] = counts;
+            total += in_block;
+        }
+        _blocks[2*block_count] = total;
+    }
+
+    template<typename Bits>
+    size_t rank_select<Bits>::rank(size_t index) const noexcept {
+        const size_t word = index/64;
+        const size_t block = word/block_words;
+        const size_t sub = word%block_words;
+        size_t res = _blocks[2*block];
+        if(sub != 0) {
+            res += (_blocks[2*block + 1] >> (9*(sub - 1))) & 0x1ff;
+        }
+        if(index%64 != 0) {
+            res += std::popcount(bits->data()[word] & ~(~uint64_t(0) << (index%64)));
+        }
+        return res;
+    }
+
+    template<typename Bits>
+    size_t rank_select<Bits>::select(size_t k) const noexcept {
+        if(k >= ones()) {
+            return Bits::npos;
+        }
+        // Last block with at most k ones before it
+        size_t block = 0;
+        size_t len = block_count;
+        while(len > 1) {
+            const size_t half = len/2;
+            block = _blocks[2*(block + half)] <= k ? block + half : block;
+            len -= half;
+        }
+        k -= _blocks[2*block];
+        const uint64_t counts = _blocks[2*block + 1];
+        size_t sub = 0;
+        for(size_t j=1; j<block_words; j++) {
+            const size_t before = (counts >> (9*(j - 1))) & 0x1ff;
+            if(before <= k) {
+                sub = j;
+            }
+        }
+        if(sub != 0) {
+            k -= (counts >> (9*(sub - 1))) & 0x1ff;
+        }
+        const size_t word = block*block_words + sub;
+        return word*64 + detail::select_in_word(bits->data()[word], k);
+    }
+
+    template<typename Bits>
+    size_t rank_select<Bits>::ones() const noexcept {
+        return _blocks[2*block_count];
+    }
+}
+
+#endif
@@ -0,0 +1,455 @@
+#ifndef XD_CONCURRENT_VECTOR_H
+#define XD_CONCURRENT_VECTOR_H
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <iterator>
+#include "vector.hpp"
+
+
+namespace xd {
+
+    //! Vector that many threads can append to without a lock. Storage is a
+    //! list of segments that double in size, so elements never move and a
+    //! reference stays valid until the vector is cleared or destroyed.
+    //!
+    //! Appends claim slots with a fetch_add, construct in parallel and then
+    //! set a ready bit for each slot, so an append never waits on another
+    //! thread. size() is the run of ready slots from the start, advanced
+    //! lazily by whichever thread asks, so every element below it is fully
+    //! constructed and can be read by any thread. A slot whose append is
+    //! still running holds size() back without blocking later appends.
+    //! Appends don't throw: if allocating a segment or constructing an
+    //! element throws the slot can't be given back and std::terminate is
+    //! called.
+    template<typename T, typename Allocator = std::allocator<T>, typename BoundsCheck = default_bounds_check>
+    class concurrent_vector {
+    public:
+        using reference = T&;
+        using const_reference = const T&;
+        using value_type = T;
+        using allocator_type = Allocator;
+
+        template<typename Owner, typename Value>
+        class index_iterator;
+
+        using iterator = index_iterator<concurrent_vector, T>;
+        using const_iterator = index_iterator<const concurrent_vector, const T>;
+
+        concurrent_vector() noexcept(noexcept(Allocator()));
+        explicit concurrent_vector(const Allocator& alloc) noexcept;
+        concurrent_vector(const concurrent_vector& other) = delete;
+        ~concurrent_vector();
+
+        concurrent_vector& operator=(const concurrent_vector& other) = delete;
+
+        //! Appends value and returns its index
+        size_t push_back(const T& value) noexcept;
+        size_t push_back(T&& value) noexcept;
+
+        template<typename... Args>
+        size_t emplace_back(Args&&... args) noexcept;
+
+        //! Claims count contiguous slots in one atomic operation and value
+        //! initialises them, returns the index of the first
+        size_t grow_by(size_t count) noexcept;
+        size_t grow_by(size_t count, const T& value) noexcept;
+
+        //! Allocates the segments needed to hold capacity elements
+        void reserve(size_t capacity);
+
+        //! Not thread safe, destroys the elements and frees the segments
+        void clear() noexcept;
+
+        reference operator[](size_t index);
+        const_reference operator[](size_t index) const;
+
+        reference at(size_t index);
+        const_reference at(size_t index) const;
+
+        //! Number of elements before the first slot still being constructed,
+        //! may be behind the number claimed
+        size_t size() const noexcept;
+        bool empty() const noexcept;
+
+        allocator_type get_allocator() const;
+
+        //! Iterators cover the elements published when begin/end were called
+        iterator begin() noexcept;
+        const_iterator begin() const noexcept;
+        const_iterator cbegin() const noexcept;
+
+        iterator end() noexcept;
+        const_iterator end() const noexcept;
+        const_iterator cend() const noexcept;
+    private:
+        using alloc_traits = std::allocator_traits<Allocator>;
+        using bits_allocator = typename alloc_traits::template rebind_alloc<std::atomic<uint64_t>>;
+        using bits_traits = std::allocator_traits<bits_allocator>;
+
+        //! Elements in segment 0, segment k holds first_segment << k
+        static constexpr size_t first_segment_log = 6;
+        static constexpr size_t first_segment = size_t(1) << first_segment_log;
+        static constexpr size_t max_segments = std::numeric_limits<size_t>::digits - first_segment_log;
+        // The segments together hold every index up to SIZE_MAX - first_segment,
+        // segment_of has to put that last one in the last segment
+        static_assert(std::bit_width(((std::numeric_limits<size_t>::max() - first_segment) >> first_segment_log) + 1) == max_segments,
+                "Segment math doesn't match max_segments");
+
+        static size_t segment_of(size_t index) noexcept;
+        static size_t segment_base(size_t segment) noexcept;
+        static size_t segment_size(size_t segment) noexcept;
+
+        //! Returns segment, allocating it and its ready bits if no thread
+        //! has yet
+        T* ensure_segment(size_t segment);
+        T* slot(size_t index) const noexcept;
+        //! Ready bits for segment through the allocator, all clear
+        std::atomic<uint64_t>* allocate_bits(size_t segment);
+        void deallocate_bits(std::atomic<uint64_t>* bits, size_t segment) noexcept;
+        //! Sets the ready bits of [first, last), which must be constructed
+        void publish(size_t first, size_t last) noexcept;
+
+        Allocator _alloc;
+        std::atomic<T*> segments[max_segments];
+        //! One bit per slot of each segment, set once it's constructed
+        std::atomic<std::atomic<uint64_t>*> ready[max_segments];
+        //! Slots handed out to appending threads
+        std::atomic<size_t> claimed;
+        //! Slots below this are known ready, a cache for size()
+        mutable std::atomic<size_t> published;
+    };
+
+    template<typename T, typename Allocator, typename BoundsCheck>
+    template<typename Owner, typename Value>
+    class concurrent_vector<T, Allocator, BoundsCheck>::index_iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Value*;
+        using reference = Value&;
+
+        index_iterator() noexcept: owner(nullptr), index(0) {}
+        index_iterator(Owner* owner, size_t index) noexcept: owner(owner), index(index) {}
+
+        reference operator*() const noexcept { return *owner->slot(index); }
+        pointer operator->() const noexcept { return owner->slot(index); }
+        reference operator[](difference_type n) const noexcept { return *owner->slot(index + n); }
+
+        index_iterator& operator++() noexcept { index++; return *this; }
+        index_iterator operator++(int) noexcept { auto tmp = *this; index++; return tmp; }
+        index_iterator& operator--() noexcept { index--; return *this; }
+        index_iterator operator--(int) noexcept { auto tmp = *this; index--; return tmp; }
+        index_iterator& operator+=(difference_type n) noexcept { index += n; return *this; }
+        index_iterator& operator-=(difference_type n) noexcept { index -= n; return *this; }
+        index_iterator operator+(difference_type n) const noexcept { return index_iterator(owner, index + n); }
+        index_iterator operator-(difference_type n) const noexcept { return index_iterator(owner, index - n); }
+        difference_type operator-(const index_iterator& other) const noexcept {
+            return difference_type(index) - difference_type(other.index);
+        }
+
+        bool operator==(const index_iterator& other) const noexcept { return index == other.index; }
+        bool operator!=(const index_iterator& other) const noexcept { return index != other.index; }
+        bool operator<(const index_iterator& other) const noexcept { return index < other.index; }
+        bool operator>(const index_iterator& other) const noexcept { return index > other.index; }
+        bool operator<=(const index_iterator& other) const noexcept { return index <= other.index; }
+        bool operator>=(const index_iterator& other) const noexcept { return index >= other.index; }
+    private:
+        Owner* owner;
+        size_t index;
+    };
+
+    template<typename T, typename Allocator, typename BoundsCheck>
+    concurrent_vector<T, Allocator, BoundsCheck>::concurrent_vector() noexcept(noexcept(Allocator())):
+    concurrent_vector(Allocator()) {
+    }
+
+    template<typename T, typename Allocator, typename BoundsCheck>
+    concurrent_vector<T, Allocator, BoundsCheck>::concurrent_vector(const Allocator& alloc) noexcept:
+    _alloc(alloc),
+    claimed(0),
+    published(0) {
+        for(size_t segment=0; segment<max_segments; segment++) {
+            segments[segment].store(nullptr, std::memory_order_relaxed);
+            ready[segment].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    template<typename T, typename Allocator, typename BoundsCheck>
+    concurrent_vector<T, Allocator, BoundsCheck>::~concurrent_vector() {
+        clear();
+    }
+
+    template<typename T, typename Allocator, typename BoundsCheck>
+    size_t concurrent_vector<T, Allocator, BoundsCheck>::segment_of(size_t index) noexcept {
+        const size_t block = (index >> first_segment_log) + 1;
+        return std::bit_width(block) - 1;
+    }
+
+    template<typename T, typename Allocator, typename BoundsCheck>
+    size_t concurrent_vector<T, Allocator, BoundsCheck>::segment_base(size_t segment) noexcept {
+        return (first_segment << segment) - first_segment;
+    }
+
+    template<typename T, typename Allocator, typename BoundsCheck>
+    size_t concurrent_vector<T, Allocator, BoundsCheck>::segment_size(size_t segment) noexcept {
+        return first_segment << segment;
+    }
+
+    template<typename T, typename Allocator, typename BoundsCheck>
+    T* concurrent_vector<T, Allocator, BoundsCheck>::ensure_segment(size_t segment) {
+        T* current = segments[segment].load(std::memory_order_acquire);
+        if(current != nullptr) {
+            return current;
+        }
+        // The bits go in before the segment so a thread that finds the
+        // segment always finds them too
+        std::atomic<uint64_t>* bits = ready[segment].load(std::memory_order_acquire);
+        if(bits == nullptr) {
+            std::atomic<uint64_t>* fresh_bits = allocate_bits(segment);
+            if(ready[segment].compare_exchange_strong(bits, fresh_bits, std::memory_order_acq_rel)) {
+                bits = fresh_bits;
+            } else {
+                deallocate_bits(fresh_bits, segment);
+            }
+        }
+        T* fresh = alloc_traits::allocate(_alloc, segment_size(segment));
+        if(segments[segment].compare_exchange_strong(current, fresh, std::memory_order_acq_rel)) {
+            return fresh;
+        }
+        // Another thread got there first, current now holds its segment
+        alloc_traits::deallocate(_alloc, fresh, segment_size(segment));
+        return current;
+    }
+
+    template<typename T, typename Allocator, typename BoundsCheck>
+    std::atomic<uint64_t>* concurrent_vector<T, Allocator, BoundsCheck>::allocate_bits(size_t segment) {
+        bits_allocator alloc(_alloc);
+        const size_t words = segment_size(segment)/64;
+        std::atomic<uint64_t>* bits = bits_traits::allocate(alloc, words);
+        for(size_t i=0; i<words; i++) {
+            bits_traits::construct(alloc, bits + i, uint64_t(0));
+        }
+        return bits;
+    }
+
+    template<typename T, typename Allocator, typename BoundsCheck>
+    void concurrent_vector<T, Allocator, BoundsCheck>::deallocate_bits(std::atomic<uint64_t>* bits, size_t segment) noexcept {
+        bits_allocator alloc(_alloc);
+        const size_t words = segment_size(segment)/64;
+        for(size_t i=0; i<words; i++) {
+            bits_traits::destroy(alloc, bits + i);
+        }
+        bits_traits::deallocate(alloc, bits, words);
+    }
+
+    template<typename T, typename Allocator, typename BoundsCheck>
+    T* concurrent_vector<T, Allocator, BoundsCheck>::slot(size_t index) const noexcept {
+        const size_t segment = segment_of(index);
+        return segments[segment].load(std::memory_order_acquire) + (index - segment_base(segment));
+    }
+
+    template<typename T, typename Allocator, typename BoundsCheck>
+    void concurrent_vector<T, Allocator, BoundsCheck>::publish(size_t first, size_t last) noexcept {
+        while(first < last) {
+            const size_t segment = segment_of(first);
+            const size_t offset = first - segment_base(segment);
+            const size_t bit = offset%64;
+            const size_t count = std::min(last - first, 64 - bit);
+            const uint64_t mask = (count == 64 ? ~uint64_t(0) : (uint64_t(1) << count) - 1) << bit;
+            ready[segment].load(std::memory_order_acquire)[offset/64].fetch_or(mask, std::memory_order_release);
+            first += count;
+        }
+    }
+
+    template<typename T, typename Allocator, typename BoundsCheck>
+    size_t concurrent_vector<T, Allocator, BoundsCheck>::push_back(const T& value) noexcept {
+        return emplace_back(value);
+    }
+
+    template<typename T, typename Allocator, typename BoundsCheck>
+    size_t concurrent_vector<T, Allocator, BoundsCheck>::push_back(T&& value) noexcept {
+        return emplace_back(std::move(value));
+    }
+
+    template<typename T, typename Allocator, typename BoundsCheck>
+    template<typename... Args>
+    size_t concurrent_vector<T, Allocator, BoundsCheck>::emplace_back(Args&&... args) noexcept {
+        const size_t index = claimed.fetch_add(1, std::memory_order_relaxed);
+        const size_t segment = segment_of(index);
+        T* base = ensure_segment(segment);
+        alloc_traits::construct(_alloc, base + (index - segment_base(segment)), std::forward<Args>(args)...);
+        publish(index, index + 1);
+        return index;
+    }
+
+    template<typename T, typename Allocator, typename BoundsCheck>
+    size_t concurrent_vector<T, Allocator, BoundsCheck>::grow_by(size_t count) noexcept {
+        const size_t first = claimed.fetch_add(count, std::memory_order_relaxed);
+        for(size_t i=first; i<first+count; ) {
+            const size_t segment = segment_of(i);
+            T* base = ensure_segment(segment);
+            const size_t end = std::min(first + count, segment_base(segment) + segment_size(segment));
+            for(; i<end; i++) {
+                alloc_traits::construct(_alloc, base + (i - segment_base(segment)));
+            }
+        }
+        publish(first, first + count);
+        return first;
+    }
+
+    template<typename T, typename Allocator, typename BoundsCheck>
+    size_t concurrent_vector<T, Allocator, BoundsCheck>::grow_by(size_t count, const T& value) noexcept {
+        const size_t first = claimed.fetch_add(count, std::memory_order_relaxed);
+        for(size_t i=first; i<first+count; ) {
+            const size_t segment = segment_of(i);
+            T* base = ensure_segment(segment);
+            const size_t end = std::min(first + count, segment_base(segment) + segment_size(segment));
+            for(; i<end; i++) {
+                alloc_traits::construct(_alloc, base + (i - segment_base(segment)), value);
+            }
+        }
+        publish(first, first + count);
+        return first;
+    }
+
+    template<typename T, typename Allocator, typename BoundsCheck>
+    void concurrent_vector<T, Allocator, BoundsCheck>::reserve(size_t cap) {
+        if(cap == 0) {
+            return;
+        }
+        const size_t last = segment_of(cap - 1);
+        for(size_t segment=0; segment<=last; segment++) {
+            ensure_segment(segment);
+        }
+    }
+
+    template<typename T, typename Allocator, typename BoundsCheck>
+    void concurrent_vector<T, Allocator, BoundsCheck>::clear() noexcept {
+        // No appends are running so every claimed slot is constructed
+        const size_t count = claimed.load(std::memory_order_acquire);
+        for(size_t segment=0; segment<max_segments; segment++) {
+            std::atomic<uint64_t>* bits = ready[segment].load(std::memory_order_relaxed);
+            if(bits != nullptr) {
+                deallocate_bits(bits, segment);
+            }
+            ready[segment].store(nullptr, std::memory_order_relaxed);
+            T* base = segments[segment].load(std::memory_order_relaxed);
+            if(base == nullptr) {
+                continue;
+            }
+            const size_t first = segment_base(segment);
+            if(first < count) {
+                const size_t end = std::min(count, first + segment_size(segment));
+                for(size_t i=first; i<end; i++) {
+                    alloc_traits::destroy(_alloc, base + (i - first));
+                }
+            }
+            alloc_traits::deallocate(_alloc, base, segment_size(segment));
+            segments[segment].store(nullptr, std::memory_order_relaxed);
+        }
+        claimed.store(0, std::memory_order_relaxed);
+        published.store(0, std::memory_order_release);
+    }
+
+    template<typename T, typename Allocator, typename BoundsCheck>
+    T& concurrent_vector<T, Allocator, BoundsCheck>::operator[](size_t i) {
+        BoundsCheck::check(i, size());
+        return *slot(i);
+    }
+
+    template<typename T, typename Allocator, typename BoundsCheck>
+    const T& concurrent_vector<T, Allocator, BoundsCheck>::operator[](size_t i) const {
+        BoundsCheck::check(i, size());
+        return *slot(i);
+    }
+
+    template<typename T, typename Allocator, typename BoundsCheck>
+    T& concurrent_vector<T, Allocator, BoundsCheck>::at(size_t i) {
+        if(!(i < size())) {
+            throw std::out_of_range("Attempted to access element out of range");
+        }
+        return *slot(i);
+    }
+
+    template<typename T, typename Allocator, typename BoundsCheck>
+    const T& concurrent_vector<T, Allocator, BoundsCheck>::at(size_t i) const {
+        if(!(i < size())) {
+            throw std::out_of_range("Attempted to access element out of range");
+        }
+        return *slot(i);
+    }
+
+    template<typename T, typename Allocator, typename BoundsCheck>
+    size_t concurrent_vector<T, Allocator, BoundsCheck>::size() const noexcept {
+        const size_t start = published.load(std::memory_order_acquire);
+        const size_t limit = claimed.load(std::memory_order_relaxed);
+        size_t end = start;
+        // Extend the known prefix a word of ready bits at a time
+        while(end < limit) {
+            const size_t segment = segment_of(end);
+            const std::atomic<uint64_t>* bits = ready[segment].load(std::memory_order_acquire);
+            if(bits == nullptr) {
+                break;
+            }
+            const size_t offset = end - segment_base(segment);
+            const size_t run = std::countr_one(bits[offset/64].load(std::memory_order_acquire) >> (offset%64));
+            end += std::min(run, 64 - offset%64);
+            if(run < 64 - offset%64) {
+                break;
+            }
+        }
+        end = std::min(end, limit);
+        if(end == start) {
+            return start;
+        }
+        size_t current = start;
+        while(current < end && !published.compare_exchange_weak(current, end, std::memory_order_release,
+                                                                std::memory_order_acquire)) {
+        }
+        return std::max(current, end);
+    }
+
+    template<typename T, typename Allocator, typename BoundsCheck>
+    bool concurrent_vector<T, Allocator, BoundsCheck>::empty() const noexcept {
+        return size() == 0;
+    }
+
+    template<typename T, typename Allocator, typename BoundsCheck>
+    Allocator concurrent_vector<T, Allocator, BoundsCheck>::get_allocator() const {
+        return _alloc;
+    }
+
+    template<typename T, typename Allocator, typename BoundsCheck>
+    typename concurrent_vector<T, Allocator, BoundsCheck>::iterator concurrent_vector<T, Allocator, BoundsCheck>::begin() noexcept {
+        return iterator(this, 0);
+    }
+
+    template<typename T, typename Allocator, typename BoundsCheck>
+    typename concurrent_vector<T, Allocator, BoundsCheck>::const_iterator concurrent_vector<T, Allocator, BoundsCheck>::begin() const noexcept {
+        return cbegin();
+    }
+
+    template<typename T, typename Allocator, typename BoundsCheck>
+    typename concurrent_vector<T, Allocator, BoundsCheck>::const_iterator concurrent_vector<T, Allocator, BoundsCheck>::cbegin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    template<typename T, typename Allocator, typename BoundsCheck>
+    typename concurrent_vector<T, Allocator, BoundsCheck>::iterator concurrent_vector<T, Allocator, BoundsCheck>::end() noexcept {
+        return iterator(this, size());
+    }
+
+    template<typename T, typename Allocator, typename BoundsCheck>
+    typename concurrent_vector<T, Allocator, BoundsCheck>::const_iterator concurrent_vector<T, Allocator, BoundsCheck>::end() const noexcept {
+        return cend();
+    }
+
+    template<typename T, typename Allocator, typename BoundsCheck>
+    typename concurrent_vector<T, Allocator, BoundsCheck>::const_iterator concurrent_vector<T, Allocator, BoundsCheck>::cend() const noexcept {
+        return const_iterator(this, size());
+    }
+}
+
+#endif
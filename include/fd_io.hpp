@@ -0,0 +1,193 @@
+#ifndef XD_FD_IO_H
+#define XD_FD_IO_H
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include "vector.hpp"
+
+
+namespace xd {
+
+    namespace detail {
+        //! Smallest read worth a system call, buffers start growing here
+        constexpr size_t min_read_bytes = 4096;
+
+#ifdef IOV_MAX
+        constexpr size_t max_iovecs = IOV_MAX;
+#else
+        constexpr size_t max_iovecs = 1024;
+#endif
+
+        [[noreturn]] inline void throw_fd_errno(const char* what) {
+            throw std::system_error(errno, std::generic_category(), what);
+        }
+
+        //! Lets the scatter/gather helpers take vectors or pointers to them
+        template<typename Vector>
+        Vector& deref_vector(Vector& vec) noexcept {
+            return vec;
+        }
+
+        template<typename Vector>
+        Vector& deref_vector(Vector* vec) noexcept {
+            return *vec;
+        }
+
+        //! Calls readv or writev until every byte in iov has been moved,
+        //! stepping past whatever a partial transfer completed. Throws
+        //! std::runtime_error if the descriptor stops moving bytes first.
+        inline void transfer_all(ssize_t (*call)(int, const iovec*, int), int fd, iovec* iov, size_t count,
+                const char* failed, const char* stopped) {
+            // Entries for empty buffers would read as a stall below
+            while(count > 0 && iov->iov_len == 0) {
+                iov++;
+                count--;
+            }
+            while(count > 0) {
+                const ssize_t moved = call(fd, iov, int(std::min(count, max_iovecs)));
+                if(moved < 0) {
+                    if(errno == EINTR) {
+                        continue;
+                    }
+                    throw_fd_errno(failed);
+                }
+                if(moved == 0) {
+                    throw std::runtime_error(stopped);
+                }
+                size_t n = moved;
+                while(count > 0 && n >= iov->iov_len) {
+                    n -= iov->iov_len;
+                    iov++;
+                    count--;
+                }
+                if(count > 0) {
+                    iov->iov_base = static_cast<unsigned char*>(iov->iov_base) + n;
+                    iov->iov_len -= n;
+                }
+            }
+        }
+
+        template<typename Vector>
+        iovec vector_iovec(const Vector& vec) noexcept {
+            iovec iov;
+            iov.iov_base = const_cast<void*>(static_cast<const void*>(vec.data()));
+            iov.iov_len = vec.size()*sizeof(typename Vector::value_type);
+            return iov;
+        }
+    }
+
+    //! Does one read() from fd onto the end of vec, at most max elements.
+    //! Returns the number of elements appended, 0 means end of file. The
+    //! read goes straight into spare capacity which is grown by the
+    //! vector's Growth policy only once a read has filled it, so streams
+    //! that deliver a lot get geometrically larger reads and ones that
+    //! trickle don't allocate. A read ending partway through an element
+    //! waits for the rest of it. Retries on EINTR, other failures throw
+    //! std::system_error, EAGAIN included, as this is meant for blocking
+    //! descriptors.
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    size_t read_append(int fd, vector<T, Allocator, Growth, BoundsCheck>& vec,
+            size_t max = std::numeric_limits<size_t>::max()) {
+        static_assert(std::is_trivially_copyable<T>::value, "Only vectors of trivially copyable types can be read into");
+        const size_t min_read = std::max<size_t>(1, detail::min_read_bytes/sizeof(T));
+        max = std::min(max, size_t(SSIZE_MAX)/sizeof(T));
+        if(max == 0) {
+            return 0;
+        }
+        if(vec.capacity() - vec.size() < std::min(min_read, max)) {
+            vec.append_uninitialized(std::min(min_read, max));
+        }
+        const size_t want = std::min(vec.capacity() - vec.size(), max);
+        unsigned char* dest = reinterpret_cast<unsigned char*>(vec.append_uninitialized(want));
+        ssize_t got;
+        do {
+            got = ::read(fd, dest, want*sizeof(T));
+        } while(got < 0 && errno == EINTR);
+        if(got < 0) {
+            detail::throw_fd_errno("Failed to read from file descriptor");
+        }
+        size_t bytes = got;
+        if(bytes % sizeof(T) != 0) {
+            iovec rest;
+            rest.iov_base = dest + bytes;
+            rest.iov_len = sizeof(T) - bytes % sizeof(T);
+            detail::transfer_all(::readv, fd, &rest, 1, "Failed to read from file descriptor",
+                    "File descriptor ended partway through an element");
+            bytes += rest.iov_len;
+        }
+        vec.commit(bytes/sizeof(T));
+        return bytes/sizeof(T);
+    }
+
+    //! Appends everything up to end of file onto vec, returns the number
+    //! of elements read. The rest of a regular file is reserved up front
+    //! so it arrives in one allocation.
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    size_t read_all(int fd, vector<T, Allocator, Growth, BoundsCheck>& vec) {
+        struct stat st;
+        if(fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+            const off_t offset = lseek(fd, 0, SEEK_CUR);
+            if(offset >= 0 && st.st_size > offset) {
+                // Room for the end of file read too, so it doesn't grow the buffer
+                const size_t remaining = (st.st_size - offset + sizeof(T) - 1)/sizeof(T);
+                vec.reserve(vec.size() + remaining + std::max<size_t>(1, detail::min_read_bytes/sizeof(T)));
+            }
+        }
+        const size_t old_size = vec.size();
+        while(read_append(fd, vec) != 0) {
+        }
+        return vec.size() - old_size;
+    }
+
+    //! Writes every element of vec to fd, carrying on after partial writes
+    //! and EINTR. Failures throw std::system_error.
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    void write_all(int fd, const vector<T, Allocator, Growth, BoundsCheck>& vec) {
+        static_assert(std::is_trivially_copyable<T>::value, "Only vectors of trivially copyable types can be written");
+        iovec iov = detail::vector_iovec(vec);
+        detail::transfer_all(::writev, fd, &iov, 1, "Failed to write to file descriptor",
+                "File descriptor stopped accepting data");
+    }
+
+    //! Scatter read filling every existing element of each vector in vecs
+    //! in order, with one readv() per attempt. vecs is a range of vectors
+    //! or pointers to vectors. Throws std::runtime_error if the file ends
+    //! before they are all filled.
+    template<typename Vectors>
+    void readv_all(int fd, Vectors& vecs) {
+        vector<iovec> iov;
+        for(auto& v: vecs) {
+            auto& vec = detail::deref_vector(v);
+            static_assert(std::is_trivially_copyable<typename std::remove_reference_t<decltype(vec)>::value_type>::value,
+                    "Only vectors of trivially copyable types can be read into");
+            iov.push_back(detail::vector_iovec(vec));
+        }
+        detail::transfer_all(::readv, fd, iov.data(), iov.size(), "Failed to read from file descriptor",
+                "File descriptor ended before the vectors were filled");
+    }
+
+    //! Gather write of every element of each vector in vecs in order, with
+    //! one writev() per attempt. vecs is a range of vectors or pointers to
+    //! vectors.
+    template<typename Vectors>
+    void writev_all(int fd, const Vectors& vecs) {
+        vector<iovec> iov;
+        for(const auto& v: vecs) {
+            const auto& vec = detail::deref_vector(v);
+            static_assert(std::is_trivially_copyable<typename std::remove_reference_t<decltype(vec)>::value_type>::value,
+                    "Only vectors of trivially copyable types can be written");
+            iov.push_back(detail::vector_iovec(vec));
+        }
+        detail::transfer_all(::writev, fd, iov.data(), iov.size(), "Failed to write to file descriptor",
+                "File descriptor stopped accepting data");
+    }
+}
+
+#endif
@@ -0,0 +1,843 @@
+#ifndef XD_FLAT_MAP_H
+#define XD_FLAT_MAP_H
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include "aligned_allocator.hpp"
+#include "vector.hpp"
+
+
+namespace xd {
+
+    namespace detail {
+        //! std::lower_bound without a data dependent branch, each halving
+        //! is a conditional move so a lookup doesn't pay a misprediction
+        //! per level. Returns the index of the first key not less than key.
+        template<typename K, typename Compare>
+        size_t branchless_lower_bound(const K* keys, size_t n, const K& key, const Compare& comp) {
+            if(n == 0) {
+                return 0;
+            }
+            const K* base = keys;
+            while(n > 1) {
+                const size_t half = n/2;
+                base = comp(base[half], key) ? base + half : base;
+                n -= half;
+            }
+            return (base - keys) + comp(*base, key);
+        }
+
+        //! Levels below a node whose descendants all fit in one cache line
+        template<typename K>
+        constexpr size_t eytzinger_prefetch_levels() {
+            size_t levels = 0;
+            while((size_t(2) << levels)*sizeof(K) <= 64) {
+                levels++;
+            }
+            return levels;
+        }
+
+        //! Copy of sorted keys in Eytzinger (breadth first) order, the
+        //! children of slot k are 2k and 2k+1. The top levels of every
+        //! search share a few cache lines and the line holding the
+        //! descendants a few levels down is prefetched while the current
+        //! level is compared, so big tables wait on far fewer misses than
+        //! a binary search over the sorted keys. Immutable once built.
+        template<typename K, typename Compare>
+        class eytzinger_index {
+        public:
+            eytzinger_index(const K* sorted, size_t n, const Compare& comp);
+
+            //! Same result as branchless_lower_bound over the sorted keys
+            size_t lower_bound(const K& key) const;
+        private:
+            //! Fills the subtree under k in order from sorted[i], returns
+            //! the next unused index
+            size_t build(const K* sorted, size_t i, size_t k);
+
+            //! Key with its sorted position, so the answer comes from the
+            //! line the search already touched
+            struct slot {
+                K key;
+                uint32_t rank;
+            };
+
+            //! 1 based, slot 0 is padding so children are 2k and 2k+1
+            aligned_vector<slot> slots;
+            size_t count;
+            Compare comp;
+        };
+    }
+
+    //! Sorted set in one contiguous xd::vector. Lookups are a branchless
+    //! binary search, or an Eytzinger search after freeze(). A bulk
+    //! insert_range sorts and merges once instead of shifting the tail
+    //! for every element.
+    template<typename K, typename Compare = std::less<K>>
+    class flat_set {
+    public:
+        using key_type = K;
+        using value_type = K;
+        using key_compare = Compare;
+        using const_reference = const K&;
+        using reference = const K&;
+        using const_iterator = const K*;
+        using iterator = const_iterator;
+
+        flat_set() = default;
+        explicit flat_set(const Compare& comp);
+        template<typename InputIt, typename = detail::require_input_iterator<InputIt>>
+        flat_set(InputIt first, InputIt last, const Compare& comp = Compare());
+        flat_set(std::initializer_list<K> l, const Compare& comp = Compare());
+        //! Takes keys over, sorting them and dropping duplicates once
+        explicit flat_set(vector<K> keys, const Compare& comp = Compare());
+
+        //! Returns the position of key and whether it was inserted
+        std::pair<iterator, bool> insert(const K& key);
+        std::pair<iterator, bool> insert(K&& key);
+        //! Sorts the new keys then merges them in one pass, keys already
+        //! present are kept
+        template<typename InputIt, typename = detail::require_input_iterator<InputIt>>
+        void insert_range(InputIt first, InputIt last);
+
+        //! Returns the number of keys removed, 0 or 1
+        size_t erase(const K& key);
+        iterator erase(const_iterator pos);
+
+        iterator find(const K& key) const;
+        bool contains(const K& key) const;
+        size_t count(const K& key) const;
+        iterator lower_bound(const K& key) const;
+        iterator upper_bound(const K& key) const;
+
+        //! Builds an Eytzinger copy of the keys for lookups to use, worth
+        //! it for big tables that are read far more than written. Costs
+        //! another copy of the keys, each padded with a 4 byte rank. Any
+        //! insert or erase drops it. Throws std::length_error past 2^32 keys.
+        void freeze();
+        bool frozen() const noexcept;
+
+        size_t size() const noexcept;
+        bool empty() const noexcept;
+        void clear() noexcept;
+        void reserve(size_t capacity);
+        void shrink_to_fit();
+
+        //! The sorted keys
+        const vector<K>& keys() const noexcept;
+        key_compare key_comp() const;
+
+        iterator begin() const noexcept;
+        iterator cbegin() const noexcept;
+        iterator end() const noexcept;
+        iterator cend() const noexcept;
+    private:
+        //! Index of the first key not less than key
+        size_t lower_index(const K& key) const;
+        template<typename Key>
+        std::pair<iterator, bool> insert_key(Key&& key);
+
+        vector<K> _keys;
+        //! Shared between copies as it never changes once built
+        std::shared_ptr<const detail::eytzinger_index<K, Compare>> _index;
+        Compare _comp;
+    };
+
+    //! Sorted map keeping keys and values in separate xd::vectors, so a
+    //! search only pulls keys into cache and keys() can be scanned with
+    //! SIMD. Iterators yield std::pair<const K&, V&> proxies. Searching
+    //! and bulk insertion work as in flat_set, including freeze().
+    template<typename K, typename V, typename Compare = std::less<K>>
+    class flat_map {
+    public:
+        using key_type = K;
+        using mapped_type = V;
+        using value_type = std::pair<K, V>;
+        using key_compare = Compare;
+        using reference = std::pair<const K&, V&>;
+        using const_reference = std::pair<const K&, const V&>;
+
+        template<typename Value>
+        class zip_iterator;
+
+        using iterator = zip_iterator<V>;
+        using const_iterator = zip_iterator<const V>;
+
+        flat_map() = default;
+        explicit flat_map(const Compare& comp);
+        template<typename InputIt, typename = detail::require_input_iterator<InputIt>>
+        flat_map(InputIt first, InputIt last, const Compare& comp = Compare());
+        flat_map(std::initializer_list<value_type> l, const Compare& comp = Compare());
+
+        //! Value for key, default constructing it if key is missing
+        V& operator[](const K& key);
+        //! Throws std::out_of_range if key is missing
+        V& at(const K& key);
+        const V& at(const K& key) const;
+
+        std::pair<iterator, bool> insert(const value_type& value);
+        std::pair<iterator, bool> insert(value_type&& value);
+        template<typename M>
+        std::pair<iterator, bool> insert_or_assign(const K& key, M&& value);
+        //! Constructs the value from args only if key is missing
+        template<typename... Args>
+        std::pair<iterator, bool> try_emplace(const K& key, Args&&... args);
+        //! Sorts the new pairs then merges them in one pass, keys already
+        //! present keep their value
+        template<typename InputIt, typename = detail::require_input_iterator<InputIt>>
+        void insert_range(InputIt first, InputIt last);
+
+        size_t erase(const K& key);
+        iterator erase(const_iterator pos);
+
+        iterator find(const K& key);
+        const_iterator find(const K& key) const;
+        bool contains(const K& key) const;
+        size_t count(const K& key) const;
+        iterator lower_bound(const K& key);
+        const_iterator lower_bound(const K& key) const;
+
+        //! See flat_set::freeze
+        void freeze();
+        bool frozen() const noexcept;
+
+        size_t size() const noexcept;
+        bool empty() const noexcept;
+        void clear() noexcept;
+        void reserve(size_t capacity);
+        void shrink_to_fit();
+
+        //! The sorted keys, values() holds the value for each at the same index
+        const vector<K>& keys() const noexcept;
+        const vector<V>& values() const noexcept;
+        key_compare key_comp() const;
+
+        iterator begin() noexcept;
+        const_iterator begin() const noexcept;
+        const_iterator cbegin() const noexcept;
+        iterator end() noexcept;
+        const_iterator end() const noexcept;
+        const_iterator cend() const noexcept;
+    private:
+        size_t lower_index(const K& key) const;
+        //! Inserts key and a value built from args at index
+        template<typename... Args>
+        iterator insert_at(size_t index, const K& key, Args&&... args);
+
+        vector<K> _keys;
+        vector<V> _values;
+        std::shared_ptr<const detail::eytzinger_index<K, Compare>> _index;
+        Compare _comp;
+    };
+
+    //! Random access iterator walking the key and value vectors together
+    template<typename K, typename V, typename Compare>
+    template<typename Value>
+    class flat_map<K, V, Compare>::zip_iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::pair<K, V>;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::pair<const K&, Value&>;
+
+        //! operator-> has to return something holding the pair
+        struct pointer {
+            reference ref;
+            const reference* operator->() const noexcept { return &ref; }
+        };
+
+        zip_iterator() noexcept: key(nullptr), value(nullptr) {}
+        zip_iterator(const K* key, Value* value) noexcept: key(key), value(value) {}
+
+        //! iterator converts to const_iterator
+        template<typename V2, typename = std::enable_if_t<std::is_convertible<V2*, Value*>::value>>
+        zip_iterator(const zip_iterator<V2>& other) noexcept: key(other.key), value(other.value) {}
+
+        reference operator*() const noexcept { return reference(*key, *value); }
+        pointer operator->() const noexcept { return pointer{**this}; }
+        reference operator[](difference_type n) const noexcept { return reference(key[n], value[n]); }
+
+        zip_iterator& operator++() noexcept { ++key; ++value; return *this; }
+        zip_iterator operator++(int) noexcept { auto tmp = *this; ++*this; return tmp; }
+        zip_iterator& operator--() noexcept { --key; --value; return *this; }
+        zip_iterator operator--(int) noexcept { auto tmp = *this; --*this; return tmp; }
+        zip_iterator& operator+=(difference_type n) noexcept { key += n; value += n; return *this; }
+        zip_iterator& operator-=(difference_type n) noexcept { return *this += -n; }
+        zip_iterator operator+(difference_type n) const noexcept { return zip_iterator(key + n, value + n); }
+        zip_iterator operator-(difference_type n) const noexcept { return zip_iterator(key - n, value - n); }
+        difference_type operator-(const zip_iterator& other) const noexcept { return key - other.key; }
+
+        bool operator==(const zip_iterator& other) const noexcept { return key == other.key; }
+        bool operator!=(const zip_iterator& other) const noexcept { return key != other.key; }
+        bool operator<(const zip_iterator& other) const noexcept { return key < other.key; }
+        bool operator>(const zip_iterator& other) const noexcept { return key > other.key; }
+        bool operator<=(const zip_iterator& other) const noexcept { return key <= other.key; }
+        bool operator>=(const zip_iterator& other) const noexcept { return key >= other.key; }
+    private:
+        friend class flat_map;
+        template<typename V2>
+        friend class zip_iterator;
+
+        const K* key;
+        Value* value;
+    };
+
+    template<typename K, typename C>
+    bool operator==(const flat_set<K, C>& lhs, const flat_set<K, C>& rhs) {
+        return lhs.keys() == rhs.keys();
+    }
+
+    template<typename K, typename C>
+    bool operator!=(const flat_set<K, C>& lhs, const flat_set<K, C>& rhs) {
+        return !(lhs == rhs);
+    }
+
+    template<typename K, typename V, typename C>
+    bool operator==(const flat_map<K, V, C>& lhs, const flat_map<K, V, C>& rhs) {
+        return lhs.keys() == rhs.keys() && lhs.values() == rhs.values();
+    }
+
+    template<typename K, typename V, typename C>
+    bool operator!=(const flat_map<K, V, C>& lhs, const flat_map<K, V, C>& rhs) {
+        return !(lhs == rhs);
+    }
+
+    namespace detail {
+        template<typename K, typename Compare>
+        eytzinger_index<K, Compare>::eytzinger_index(const K* sorted, size_t n, const Compare& comp):
+        slots(),
+        count(n),
+        comp(comp) {
+            if(n > UINT32_MAX) {
+                throw std::length_error("Too many keys for an Eytzinger index");
+            }
+            if(n > 0) {
+                slots.assign(n + 1, slot{sorted[0], 0});
+                build(sorted, 0, 1);
+            }
+        }
+
+        template<typename K, typename Compare>
+        size_t eytzinger_index<K, Compare>::build(const K* sorted, size_t i, size_t k) {
+            if(k <= count) {
+                i = build(sorted, i, 2*k);
+                slots[k] = slot{sorted[i], uint32_t(i)};
+                i = build(sorted, i + 1, 2*k + 1);
+            }
+            return i;
+        }
+
+        template<typename K, typename Compare>
+        size_t eytzinger_index<K, Compare>::lower_bound(const K& key) const {
+            constexpr size_t stride = size_t(1) << eytzinger_prefetch_levels<slot>();
+            const slot* base = slots.data();
+            size_t k = 1;
+            while(k <= count) {
+                // Integer arithmetic as the address may be past the end
+                __builtin_prefetch(reinterpret_cast<const void*>(reinterpret_cast<uintptr_t>(base) + stride*k*sizeof(slot)));
+                k = 2*k + comp(base[k].key, key);
+            }
+            // Undo the right turns taken after the last left one
+            k >>= __builtin_ffsll(~k);
+            return k == 0 ? count : base[k].rank;
+        }
+    }
+
+    template<typename K, typename Compare>
+    flat_set<K, Compare>::flat_set(const Compare& comp):
+    _keys(),
+    _index(),
+    _comp(comp) {
+    }
+
+    template<typename K, typename Compare>
+    template<typename InputIt, typename>
+    flat_set<K, Compare>::flat_set(InputIt first, InputIt last, const Compare& comp):
+    flat_set(comp) {
+        insert_range(first, last);
+    }
+
+    template<typename K, typename Compare>
+    flat_set<K, Compare>::flat_set(std::initializer_list<K> il, const Compare& comp):
+    flat_set(il.begin(), il.end(), comp) {
+    }
+
+    template<typename K, typename Compare>
+    flat_set<K, Compare>::flat_set(vector<K> keys, const Compare& comp):
+    _keys(std::move(keys)),
+    _index(),
+    _comp(comp) {
+        std::stable_sort(_keys.begin(), _keys.end(), _comp);
+        auto last = std::unique(_keys.begin(), _keys.end(), [this](const K& a, const K& b) {
+            return !_comp(a, b);
+        });
+        _keys.erase(last, _keys.end());
+    }
+
+    template<typename K, typename Compare>
+    std::pair<const K*, bool> flat_set<K, Compare>::insert(const K& key) {
+        return insert_key(key);
+    }
+
+    template<typename K, typename Compare>
+    std::pair<const K*, bool> flat_set<K, Compare>::insert(K&& key) {
+        return insert_key(std::move(key));
+    }
+
+    template<typename K, typename Compare>
+    template<typename Key>
+    std::pair<const K*, bool> flat_set<K, Compare>::insert_key(Key&& key) {
+        const size_t i = lower_index(key);
+        if(i < _keys.size() && !_comp(key, _keys[i])) {
+            return {_keys.data() + i, false};
+        }
+        _index.reset();
+        return {_keys.insert(_keys.begin() + i, std::forward<Key>(key)), true};
+    }
+
+    template<typename K, typename Compare>
+    template<typename InputIt, typename>
+    void flat_set<K, Compare>::insert_range(InputIt first, InputIt last) {
+        vector<K> incoming(first, last);
+        if(incoming.empty()) {
+            return;
+        }
+        std::stable_sort(incoming.begin(), incoming.end(), _comp);
+        vector<K> merged;
+        merged.reserve(_keys.size() + incoming.size());
+        size_t i = 0;
+        size_t j = 0;
+        while(j < incoming.size()) {
+            if(i < _keys.size() && !_comp(incoming[j], _keys[i])) {
+                if(!_comp(_keys[i], incoming[j])) {
+                    j++;
+                    continue;
+                }
+                merged.push_back(std::move_if_noexcept(_keys[i++]));
+            } else {
+                merged.push_back(std::move(incoming[j++]));
+                // Only the first of equal new keys goes in
+                while(j < incoming.size() && !_comp(merged.back(), incoming[j])) {
+                    j++;
+                }
+            }
+        }
+        for(; i < _keys.size(); i++) {
+            merged.push_back(std::move_if_noexcept(_keys[i]));
+        }
+        _index.reset();
+        _keys.swap(merged);
+    }
+
+    template<typename K, typename Compare>
+    size_t flat_set<K, Compare>::erase(const K& key) {
+        const size_t i = lower_index(key);
+        if(i < _keys.size() && !_comp(key, _keys[i])) {
+            _index.reset();
+            _keys.erase(_keys.begin() + i);
+            return 1;
+        }
+        return 0;
+    }
+
+    template<typename K, typename Compare>
+    const K* flat_set<K, Compare>::erase(const K* pos) {
+        _index.reset();
+        return _keys.erase(pos);
+    }
+
+    template<typename K, typename Compare>
+    const K* flat_set<K, Compare>::find(const K& key) const {
+        const size_t i = lower_index(key);
+        if(i < _keys.size() && !_comp(key, _keys[i])) {
+            return _keys.data() + i;
+        }
+        return end();
+    }
+
+    template<typename K, typename Compare>
+    bool flat_set<K, Compare>::contains(const K& key) const {
+        return find(key) != end();
+    }
+
+    template<typename K, typename Compare>
+    size_t flat_set<K, Compare>::count(const K& key) const {
+        return contains(key) ? 1 : 0;
+    }
+
+    template<typename K, typename Compare>
+    const K* flat_set<K, Compare>::lower_bound(const K& key) const {
+        return _keys.data() + lower_index(key);
+    }
+
+    template<typename K, typename Compare>
+    const K* flat_set<K, Compare>::upper_bound(const K& key) const {
+        const K* pos = lower_bound(key);
+        return (pos != end() && !_comp(key, *pos)) ? pos + 1 : pos;
+    }
+
+    template<typename K, typename Compare>
+    void flat_set<K, Compare>::freeze() {
+        if(!_index) {
+            _index = std::make_shared<const detail::eytzinger_index<K, Compare>>(_keys.data(), _keys.size(), _comp);
+        }
+    }
+
+    template<typename K, typename Compare>
+    bool flat_set<K, Compare>::frozen() const noexcept {
+        return _index != nullptr;
+    }
+
+    template<typename K, typename Compare>
+    size_t flat_set<K, Compare>::size() const noexcept {
+        return _keys.size();
+    }
+
+    template<typename K, typename Compare>
+    bool flat_set<K, Compare>::empty() const noexcept {
+        return _keys.empty();
+    }
+
+    template<typename K, typename Compare>
+    void flat_set<K, Compare>::clear() noexcept {
+        _index.reset();
+        _keys.clear();
+    }
+
+    template<typename K, typename Compare>
+    void flat_set<K, Compare>::reserve(size_t capacity) {
+        _keys.reserve(capacity);
+    }
+
+    template<typename K, typename Compare>
+    void flat_set<K, Compare>::shrink_to_fit() {
+        _keys.shrink_to_fit();
+    }
+
+    template<typename K, typename Compare>
+    const vector<K>& flat_set<K, Compare>::keys() const noexcept {
+        return _keys;
+    }
+
+    template<typename K, typename Compare>
+    Compare flat_set<K, Compare>::key_comp() const {
+        return _comp;
+    }
+
+    template<typename K, typename Compare>
+    const K* flat_set<K, Compare>::begin() const noexcept {
+        return _keys.begin();
+    }
+
+    template<typename K, typename Compare>
+    const K* flat_set<K, Compare>::cbegin() const noexcept {
+        return _keys.begin();
+    }
+
+    template<typename K, typename Compare>
+    const K* flat_set<K, Compare>::end() const noexcept {
+        return _keys.end();
+    }
+
+    template<typename K, typename Compare>
+    const K* flat_set<K, Compare>::cend() const noexcept {
+        return _keys.end();
+    }
+
+    template<typename K, typename Compare>
+    size_t flat_set<K, Compare>::lower_index(const K& key) const {
+        if(_index) {
+            return _index->lower_bound(key);
+        }
+        return detail::branchless_lower_bound(_keys.data(), _keys.size(), key, _comp);
+    }
+
+    template<typename K, typename V, typename Compare>
+    flat_map<K, V, Compare>::flat_map(const Compare& comp):
+    _keys(),
+    _values(),
+    _index(),
+    _comp(comp) {
+    }
+
+    template<typename K, typename V, typename Compare>
+    template<typename InputIt, typename>
+    flat_map<K, V, Compare>::flat_map(InputIt first, InputIt last, const Compare& comp):
+    flat_map(comp) {
+        insert_range(first, last);
+    }
+
+    template<typename K, typename V, typename Compare>
+    flat_map<K, V, Compare>::flat_map(std::initializer_list<value_type> il, const Compare& comp):
+    flat_map(il.begin(), il.end(), comp) {
+    }
+
+    template<typename K, typename V, typename Compare>
+    V& flat_map<K, V, Compare>::operator[](const K& key) {
+        return try_emplace(key).first->second;
+    }
+
+    template<typename K, typename V, typename Compare>
+    V& flat_map<K, V, Compare>::at(const K& key) {
+        auto pos = find(key);
+        if(pos == end()) {
+            throw std::out_of_range("Key not in flat_map");
+        }
+        return pos->second;
+    }
+
+    template<typename K, typename V, typename Compare>
+    const V& flat_map<K, V, Compare>::at(const K& key) const {
+        auto pos = find(key);
+        if(pos == end()) {
+            throw std::out_of_range("Key not in flat_map");
+        }
+        return pos->second;
+    }
+
+    template<typename K, typename V, typename Compare>
+    auto flat_map<K, V, Compare>::insert(const value_type& value) -> std::pair<iterator, bool> {
+        return try_emplace(value.first, value.second);
+    }
+
+    template<typename K, typename V, typename Compare>
+    auto flat_map<K, V, Compare>::insert(value_type&& value) -> std::pair<iterator, bool> {
+        return try_emplace(value.first, std::move(value.second));
+    }
+
+    template<typename K, typename V, typename Compare>
+    template<typename M>
+    auto flat_map<K, V, Compare>::insert_or_assign(const K& key, M&& value) -> std::pair<iterator, bool> {
+        const size_t i = lower_index(key);
+        if(i < _keys.size() && !_comp(key, _keys[i])) {
+            _values[i] = std::forward<M>(value);
+            return {begin() + i, false};
+        }
+        return {insert_at(i, key, std::forward<M>(value)), true};
+    }
+
+    template<typename K, typename V, typename Compare>
+    template<typename... Args>
+    auto flat_map<K, V, Compare>::try_emplace(const K& key, Args&&... args) -> std::pair<iterator, bool> {
+        const size_t i = lower_index(key);
+        if(i < _keys.size() && !_comp(key, _keys[i])) {
+            return {begin() + i, false};
+        }
+        return {insert_at(i, key, std::forward<Args>(args)...), true};
+    }
+
+    template<typename K, typename V, typename Compare>
+    template<typename... Args>
+    auto flat_map<K, V, Compare>::insert_at(size_t index, const K& key, Args&&... args) -> iterator {
+        _index.reset();
+        _values.emplace(_values.begin() + index, std::forward<Args>(args)...);
+        try {
+            _keys.insert(_keys.begin() + index, key);
+        } catch(...) {
+            _values.erase(_values.begin() + index);
+            throw;
+        }
+        return begin() + index;
+    }
+
+    template<typename K, typename V, typename Compare>
+    template<typename InputIt, typename>
+    void flat_map<K, V, Compare>::insert_range(InputIt first, InputIt last) {
+        vector<value_type> incoming(first, last);
+        if(incoming.empty()) {
+            return;
+        }
+        std::stable_sort(incoming.begin(), incoming.end(), [this](const value_type& a, const value_type& b) {
+            return _comp(a.first, b.first);
+        });
+        vector<K> keys;
+        vector<V> values;
+        keys.reserve(_keys.size() + incoming.size());
+        values.reserve(_keys.size() + incoming.size());
+        size_t i = 0;
+        size_t j = 0;
+        while(j < incoming.size()) {
+            if(i < _keys.size() && !_comp(incoming[j].first, _keys[i])) {
+                if(!_comp(_keys[i], incoming[j].first)) {
+                    j++;
+                    continue;
+                }
+                keys.push_back(std::move_if_noexcept(_keys[i]));
+                values.push_back(std::move_if_noexcept(_values[i]));
+                i++;
+            } else {
+                keys.push_back(std::move(incoming[j].first));
+                values.push_back(std::move(incoming[j].second));
+                j++;
+                // Only the first of equal new keys goes in
+                while(j < incoming.size() && !_comp(keys.back(), incoming[j].first)) {
+                    j++;
+                }
+            }
+        }
+        for(; i < _keys.size(); i++) {
+            keys.push_back(std::move_if_noexcept(_keys[i]));
+            values.push_back(std::move_if_noexcept(_values[i]));
+        }
+        _index.reset();
+        _keys.swap(keys);
+        _values.swap(values);
+    }
+
+    template<typename K, typename V, typename Compare>
+    size_t flat_map<K, V, Compare>::erase(const K& key) {
+        const size_t i = lower_index(key);
+        if(i < _keys.size() && !_comp(key, _keys[i])) {
+            erase(cbegin() + i);
+            return 1;
+        }
+        return 0;
+    }
+
+    template<typename K, typename V, typename Compare>
+    auto flat_map<K, V, Compare>::erase(const_iterator pos) -> iterator {
+        const size_t i = pos.key - _keys.data();
+        _index.reset();
+        _keys.erase(_keys.begin() + i);
+        _values.erase(_values.begin() + i);
+        return begin() + i;
+    }
+
+    template<typename K, typename V, typename Compare>
+    auto flat_map<K, V, Compare>::find(const K& key) -> iterator {
+        const size_t i = lower_index(key);
+        if(i < _keys.size() && !_comp(key, _keys[i])) {
+            return begin() + i;
+        }
+        return end();
+    }
+
+    template<typename K, typename V, typename Compare>
+    auto flat_map<K, V, Compare>::find(const K& key) const -> const_iterator {
+        const size_t i = lower_index(key);
+        if(i < _keys.size() && !_comp(key, _keys[i])) {
+            return begin() + i;
+        }
+        return end();
+    }
+
+    template<typename K, typename V, typename Compare>
+    bool flat_map<K, V, Compare>::contains(const K& key) const {
+        return find(key) != end();
+    }
+
+    template<typename K, typename V, typename Compare>
+    size_t flat_map<K, V, Compare>::count(const K& key) const {
+        return contains(key) ? 1 : 0;
+    }
+
+    template<typename K, typename V, typename Compare>
+    auto flat_map<K, V, Compare>::lower_bound(const K& key) -> iterator {
+        return begin() + lower_index(key);
+    }
+
+    template<typename K, typename V, typename Compare>
+    auto flat_map<K, V, Compare>::lower_bound(const K& key) const -> const_iterator {
+        return begin() + lower_index(key);
+    }
+
+    template<typename K, typename V, typename Compare>
+    void flat_map<K, V, Compare>::freeze() {
+        if(!_index) {
+            _index = std::make_shared<const detail::eytzinger_index<K, Compare>>(_keys.data(), _keys.size(), _comp);
+        }
+    }
+
+    template<typename K, typename V, typename Compare>
+    bool flat_map<K, V, Compare>::frozen() const noexcept {
+        return _index != nullptr;
+    }
+
+    template<typename K, typename V, typename Compare>
+    size_t flat_map<K, V, Compare>::size() const noexcept {
+        return _keys.size();
+    }
+
+    template<typename K, typename V, typename Compare>
+    bool flat_map<K, V, Compare>::empty() const noexcept {
+        return _keys.empty();
+    }
+
+    template<typename K, typename V, typename Compare>
+    void flat_map<K, V, Compare>::clear() noexcept {
+        _index.reset();
+        _keys.clear();
+        _values.clear();
+    }
+
+    template<typename K, typename V, typename Compare>
+    void flat_map<K, V, Compare>::reserve(size_t capacity) {
+        _keys.reserve(capacity);
+        _values.reserve(capacity);
+    }
+
+    template<typename K, typename V, typename Compare>
+    void flat_map<K, V, Compare>::shrink_to_fit() {
+        _keys.shrink_to_fit();
+        _values.shrink_to_fit();
+    }
+
+    template<typename K, typename V, typename Compare>
+    const vector<K>& flat_map<K, V, Compare>::keys() const noexcept {
+        return _keys;
+    }
+
+    template<typename K, typename V, typename Compare>
+    const vector<V>& flat_map<K, V, Compare>::values() const noexcept {
+        return _values;
+    }
+
+    template<typename K, typename V, typename Compare>
+    Compare flat_map<K, V, Compare>::key_comp() const {
+        return _comp;
+    }
+
+    template<typename K, typename V, typename Compare>
+    auto flat_map<K, V, Compare>::begin() noexcept -> iterator {
+        return iterator(_keys.data(), _values.data());
+    }
+
+    template<typename K, typename V, typename Compare>
+    auto flat_map<K, V, Compare>::begin() const noexcept -> const_iterator {
+        return const_iterator(_keys.data(), _values.data());
+    }
+
+    template<typename K, typename V, typename Compare>
+    auto flat_map<K, V, Compare>::cbegin() const noexcept -> const_iterator {
+        return begin();
+    }
+
+    template<typename K, typename V, typename Compare>
+    auto flat_map<K, V, Compare>::end() noexcept -> iterator {
+        return begin() + _keys.size();
+    }
+
+    template<typename K, typename V, typename Compare>
+    auto flat_map<K, V, Compare>::end() const noexcept -> const_iterator {
+        return begin() + _keys.size();
+    }
+
+    template<typename K, typename V, typename Compare>
+    auto flat_map<K, V, Compare>::cend() const noexcept -> const_iterator {
+        return end();
+    }
+
+    template<typename K, typename V, typename Compare>
+    size_t flat_map<K, V, Compare>::lower_index(const K& key) const {
+        if(_index) {
+            return _index->lower_bound(key);
+        }
+        return detail::branchless_lower_bound(_keys.data(), _keys.size(), key, _comp);
+    }
+}
+
+#endif
@@ -0,0 +1,246 @@
+#ifndef XD_INSTRUMENT_H
+#define XD_INSTRUMENT_H
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <typeinfo>
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
+
+//! Storage events of xd::vector are only recorded when this is 1, with
+//! the default of 0 the hooks compile to nothing
+#ifndef XD_VECTOR_INSTRUMENT
+#define XD_VECTOR_INSTRUMENT 0
+#endif
+
+
+namespace xd {
+
+    enum class vector_event_kind {
+        //! A buffer was obtained from the allocator
+        allocate,
+        //! A buffer was given back to the allocator
+        deallocate,
+        //! Elements were moved to a bigger buffer
+        grow,
+        //! Elements were moved to a smaller buffer by shrink_to_fit
+        shrink,
+        //! realloc or mremap resized the buffer without moving it, not
+        //! also reported as an allocate and deallocate
+        resize_in_place
+    };
+
+    //! What a hook is told about each storage event. Capacities and size
+    //! are in elements, data is the buffer allocated or freed, or the new
+    //! buffer for grow and shrink.
+    struct vector_event {
+        vector_event_kind kind;
+        const std::type_info* type;
+        size_t element_size;
+        size_t old_capacity;
+        size_t new_capacity;
+        size_t size;
+        const void* data;
+    };
+
+    //! Counters for one element type or the whole process, all sizes in
+    //! bytes. Updated with relaxed atomics so they're safe to read while
+    //! other threads run but aren't a consistent snapshot.
+    struct vector_stats {
+        std::atomic<uint64_t> allocations{0};
+        std::atomic<uint64_t> deallocations{0};
+        //! Times existing elements were moved to a new buffer
+        std::atomic<uint64_t> reallocations{0};
+        std::atomic<uint64_t> bytes_allocated{0};
+        //! Bytes of elements moved by reallocations
+        std::atomic<uint64_t> bytes_copied{0};
+        //! Times a buffer was grown or shrunk where it was, nothing copied
+        std::atomic<uint64_t> in_place_resizes{0};
+        //! Capacity currently allocated
+        std::atomic<uint64_t> live_bytes{0};
+        std::atomic<uint64_t> peak_bytes{0};
+        //! Capacity that was never filled when buffers were freed or
+        //! swapped for a smaller one
+        std::atomic<uint64_t> slack_bytes{0};
+
+        //! Zeroes the counters, live_bytes still tracks buffers that are
+        //! allocated so it becomes the new peak
+        void reset() noexcept {
+            for(auto* counter: {&allocations, &deallocations, &reallocations, &bytes_allocated,
+                                &bytes_copied, &in_place_resizes, &slack_bytes}) {
+                counter->store(0, std::memory_order_relaxed);
+            }
+            peak_bytes.store(live_bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+    };
+
+    using vector_hook = void (*)(const vector_event& event, void* context);
+
+    namespace detail {
+        //! Per type counters, linked into a list on first use so reports
+        //! can walk every type that has been seen
+        struct type_stats_entry {
+            const std::type_info* type;
+            vector_stats stats;
+            type_stats_entry* next;
+        };
+
+        inline std::atomic<type_stats_entry*> type_stats_head{nullptr};
+        inline std::atomic<vector_hook> current_hook{nullptr};
+        inline std::atomic<void*> current_hook_context{nullptr};
+
+        inline void add_live(vector_stats& stats, int64_t bytes) noexcept {
+            const uint64_t live = stats.live_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+            uint64_t peak = stats.peak_bytes.load(std::memory_order_relaxed);
+            while(live > peak && !stats.peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+            }
+        }
+
+        inline void apply_event(vector_stats& stats, const vector_event& e) noexcept {
+            const size_t sz = e.element_size;
+            switch(e.kind) {
+            case vector_event_kind::allocate:
+                stats.allocations.fetch_add(1, std::memory_order_relaxed);
+                stats.bytes_allocated.fetch_add(e.new_capacity*sz, std::memory_order_relaxed);
+                add_live(stats, int64_t(e.new_capacity*sz));
+                break;
+            case vector_event_kind::deallocate:
+                stats.deallocations.fetch_add(1, std::memory_order_relaxed);
+                stats.slack_bytes.fetch_add((e.old_capacity - e.size)*sz, std::memory_order_relaxed);
+                add_live(stats, -int64_t(e.old_capacity*sz));
+                break;
+            case vector_event_kind::grow:
+            case vector_event_kind::shrink:
+                stats.reallocations.fetch_add(1, std::memory_order_relaxed);
+                stats.bytes_copied.fetch_add(e.size*sz, std::memory_order_relaxed);
+                break;
+            case vector_event_kind::resize_in_place:
+                // The same buffer, so only the live capacity changes
+                stats.in_place_resizes.fetch_add(1, std::memory_order_relaxed);
+                if(e.new_capacity < e.old_capacity) {
+                    stats.slack_bytes.fetch_add((e.old_capacity - e.new_capacity)*sz, std::memory_order_relaxed);
+                }
+                add_live(stats, int64_t(e.new_capacity*sz) - int64_t(e.old_capacity*sz));
+                break;
+            }
+        }
+
+        template<typename T>
+        vector_stats& type_stats() {
+            static type_stats_entry* entry = []() {
+                auto* fresh = new type_stats_entry{&typeid(T), {}, nullptr};
+                fresh->next = type_stats_head.load(std::memory_order_relaxed);
+                while(!type_stats_head.compare_exchange_weak(fresh->next, fresh, std::memory_order_release)) {
+                }
+                return fresh;
+            }();
+            return entry->stats;
+        }
+
+        inline vector_stats& global_stats() {
+            static vector_stats stats;
+            return stats;
+        }
+
+        //! Called by xd::vector for every storage event when instrumented
+        template<typename T>
+        void record_vector_event(vector_event_kind kind, size_t old_capacity, size_t new_capacity,
+                                 size_t size, const void* data) noexcept {
+            const vector_event e{kind, &typeid(T), sizeof(T), old_capacity, new_capacity, size, data};
+            apply_event(global_stats(), e);
+            apply_event(type_stats<T>(), e);
+            if(vector_hook hook = current_hook.load(std::memory_order_acquire)) {
+                hook(e, current_hook_context.load(std::memory_order_relaxed));
+            }
+        }
+    }
+
+    //! Counters summed over every element type
+    inline const vector_stats& global_vector_stats() {
+        return detail::global_stats();
+    }
+
+    template<typename T>
+    const vector_stats& vector_stats_for() {
+        return detail::type_stats<T>();
+    }
+
+    //! Calls f(type, stats) for every element type with recorded events
+    template<typename F>
+    void for_each_vector_stats(F f) {
+        for(auto* entry = detail::type_stats_head.load(std::memory_order_acquire); entry != nullptr; entry = entry->next) {
+            f(*entry->type, entry->stats);
+        }
+    }
+
+    inline void reset_vector_stats() noexcept {
+        detail::global_stats().reset();
+        for_each_vector_stats([](const std::type_info&, const vector_stats& stats) {
+            const_cast<vector_stats&>(stats).reset();
+        });
+    }
+
+    //! Forwards every event to hook, i.e. to capture a stack trace for
+    //! grow events and find the call sites missing a reserve(). Passing
+    //! nullptr removes the hook. The hook runs on the thread that caused
+    //! the event, if it allocates through an xd::vector it will recurse.
+    inline void set_vector_hook(vector_hook hook, void* context = nullptr) noexcept {
+        detail::current_hook_context.store(context, std::memory_order_relaxed);
+        detail::current_hook.store(hook, std::memory_order_release);
+    }
+
+    //! Readable name of a type, demangled where the ABI allows
+    inline std::string type_name(const std::type_info& type) {
+#if defined(__GNUG__)
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+        if(status == 0 && demangled != nullptr) {
+            std::string name(demangled);
+            std::free(demangled);
+            return name;
+        }
+#endif
+        return type.name();
+    }
+
+    //! Prints a table of the per type counters, types that copied the most
+    //! bytes growing come first
+    inline void print_vector_stats(FILE* out = stderr) {
+        struct row {
+            const std::type_info* type;
+            const vector_stats* stats;
+        };
+        size_t count = 0;
+        for_each_vector_stats([&](const std::type_info&, const vector_stats&) { count++; });
+        // Types seen after counting are left out rather than overflowing
+        std::unique_ptr<row[]> rows(new row[count]);
+        size_t i = 0;
+        for_each_vector_stats([&](const std::type_info& type, const vector_stats& stats) {
+            if(i < count) {
+                rows[i++] = row{&type, &stats};
+            }
+        });
+        std::sort(rows.get(), rows.get() + i, [](const row& a, const row& b) {
+            return a.stats->bytes_copied.load() > b.stats->bytes_copied.load();
+        });
+        std::fprintf(out, "%12s %12s %14s %14s %14s  %s\n", "allocs", "reallocs", "copied", "peak", "slack", "type");
+        auto print = [out](const vector_stats& s, const std::string& name) {
+            std::fprintf(out, "%12llu %12llu %14llu %14llu %14llu  %s\n",
+                    (unsigned long long)s.allocations.load(), (unsigned long long)s.reallocations.load(),
+                    (unsigned long long)s.bytes_copied.load(), (unsigned long long)s.peak_bytes.load(),
+                    (unsigned long long)s.slack_bytes.load(), name.c_str());
+        };
+        for(size_t j=0; j<i; j++) {
+            print(*rows[j].stats, type_name(*rows[j].type));
+        }
+        print(global_vector_stats(), "(all)");
+    }
+}
+
+#endif
@@ -0,0 +1,585 @@
+#ifndef XD_MMAP_VECTOR_H
+#define XD_MMAP_VECTOR_H
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "vector.hpp"
+
+
+namespace xd {
+
+    template<typename T, typename BoundsCheck>
+    class mmap_view;
+
+    //! Vector of trivially copyable T stored in a memory mapped file. The
+    //! file is a 64 byte header followed by the elements so opening a
+    //! table is O(1) and processes mapping the same file share the page
+    //! cache. Growth extends the file with ftruncate and remaps it. Use
+    //! mmap_view to open a table read only.
+    template<typename T, typename BoundsCheck = default_bounds_check>
+    class mmap_vector {
+    public:
+        using reference = T&;
+        using const_reference = const T&;
+        using value_type = T;
+        using pointer = T*;
+        using iterator = pointer;
+        using const_pointer = const T*;
+        using const_iterator = const_pointer;
+
+        static_assert(std::is_trivially_copyable<T>::value, "mmap_vector needs a trivially copyable T");
+
+        //! Opens path, creating an empty table if it doesn't exist
+        explicit mmap_vector(const std::string& path);
+        mmap_vector(const mmap_vector& other) = delete;
+        mmap_vector(mmap_vector&& other) noexcept;
+
+        //! Unmaps the file without trimming the unused capacity, another
+        //! process may still map the old length. Doesn't wait for the data
+        //! to reach the disk (see sync).
+        ~mmap_vector();
+
+        mmap_vector& operator=(const mmap_vector& other) = delete;
+        mmap_vector& operator=(mmap_vector&& other) noexcept;
+
+        void reserve(size_t capacity);
+
+        void push_back(const_reference value);
+
+        template<typename... Args>
+        reference emplace_back(Args&&... args);
+
+        void pop_back();
+
+        void resize(size_t count);
+        void resize(size_t count, const T& value);
+
+        void clear();
+
+        reference operator[](size_t index);
+        const_reference operator[](size_t index) const;
+
+        reference at(size_t index);
+        const_reference at(size_t index) const;
+
+        reference front();
+        const_reference front() const;
+
+        reference back();
+        const_reference back() const;
+
+        size_t size() const noexcept;
+        size_t capacity() const noexcept;
+        bool empty() const noexcept;
+
+        //! Trims the file to size(), only safe while no other process maps
+        //! the file as their accesses past the new end would fault
+        void shrink_to_fit();
+
+        //! Blocks until the elements and size have been written to the file
+        void sync();
+
+        //! Trims the file like shrink_to_fit then unmaps it, leaving this
+        //! empty
+        void close();
+
+        pointer data() noexcept;
+
+        const_pointer data() const noexcept;
+
+        iterator begin() noexcept;
+        const_iterator begin() const noexcept;
+        const_iterator cbegin() const noexcept;
+
+        iterator end() noexcept;
+        const_iterator end() const noexcept;
+        const_iterator cend() const noexcept;
+    protected:
+        size_t next_capacity() const {
+            // Grow a page at a time at first so small tables don't pay a
+            // syscall per element
+            const size_t min_cap = 4096/sizeof(T) + 1;
+            return _capacity<min_cap?min_cap:_capacity*2;
+        }
+    private:
+        friend class mmap_view<T, BoundsCheck>;
+
+        struct header {
+            uint64_t magic;
+            uint64_t element_size;
+            uint64_t count;
+            uint64_t reserved[5];
+        };
+        static_assert(sizeof(header) == 64, "Header must keep the elements aligned");
+        static_assert(alignof(T) <= sizeof(header), "T is too over-aligned for mmap_vector");
+
+        //! "XDMMAPV1" read as a little endian integer
+        static constexpr uint64_t header_magic = 0x3156504d414d4458ULL;
+
+        //! Opens an existing table, mapped read only unless writable
+        mmap_vector(const std::string& path, bool writable);
+
+        //! Resizes the file and the mapping to hold cap elements
+        void remap(size_t cap);
+        void set_size(size_t count) noexcept;
+        void release() noexcept;
+        [[noreturn]] static void throw_errno(const std::string& what);
+
+        //! File descriptor, -1 once moved from
+        int fd;
+        //! Start of the mapping, the header lives here
+        unsigned char* mapping;
+        //! Bytes mapped
+        size_t mapped_bytes;
+        //! Current size of the vector
+        size_t raw_size;
+        //! Elements the file currently has room for
+        size_t _capacity;
+    };
+
+    //! Read only mapping of a table written by mmap_vector. Only const
+    //! accessors exist, so read only access is checked at compile time
+    //! and indexing costs the same as on a writable table.
+    template<typename T, typename BoundsCheck = default_bounds_check>
+    class mmap_view {
+    public:
+        using reference = const T&;
+        using const_reference = const T&;
+        using value_type = T;
+        using pointer = const T*;
+        using iterator = pointer;
+        using const_pointer = const T*;
+        using const_iterator = const_pointer;
+
+        //! Opens an existing table at path
+        explicit mmap_view(const std::string& path);
+
+        const_reference operator[](size_t index) const;
+
+        const_reference at(size_t index) const;
+
+        const_reference front() const;
+
+        const_reference back() const;
+
+        size_t size() const noexcept;
+        bool empty() const noexcept;
+
+        const_pointer data() const noexcept;
+
+        const_iterator begin() const noexcept;
+        const_iterator cbegin() const noexcept;
+
+        const_iterator end() const noexcept;
+        const_iterator cend() const noexcept;
+    private:
+        //! Mapped with PROT_READ, only ever used through const members
+        mmap_vector<T, BoundsCheck> table;
+    };
+
+    template<typename T, typename BoundsCheck>
+    void mmap_vector<T, BoundsCheck>::throw_errno(const std::string& what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    template<typename T, typename BoundsCheck>
+    mmap_vector<T, BoundsCheck>::mmap_vector(const std::string& path):mmap_vector(path, true) {
+    }
+
+    template<typename T, typename BoundsCheck>
+    mmap_vector<T, BoundsCheck>::mmap_vector(const std::string& path, bool writable):
+    fd(-1),
+    mapping(nullptr),
+    mapped_bytes(0),
+    raw_size(0),
+    _capacity(0) {
+        const int flags = writable ? (O_RDWR | O_CREAT) : O_RDONLY;
+        fd = open(path.c_str(), flags, 0644);
+        if(fd < 0) {
+            throw_errno("Failed to open "+path);
+        }
+        struct stat info;
+        if(fstat(fd, &info) != 0) {
+            const int err = errno;
+            ::close(fd);
+            throw std::system_error(err, std::generic_category(), "Failed to stat "+path);
+        }
+        const size_t file_size = info.st_size;
+        try {
+            if(file_size == 0 && writable) {
+                remap(0);
+                header* h = reinterpret_cast<header*>(mapping);
+                h->magic = header_magic;
+                h->element_size = sizeof(T);
+                h->count = 0;
+                return;
+            }
+            if(file_size < sizeof(header)) {
+                throw std::runtime_error(path+" isn't an mmap_vector file");
+            }
+            const int prot = writable ? (PROT_READ | PROT_WRITE) : PROT_READ;
+            void* p = mmap(nullptr, file_size, prot, MAP_SHARED, fd, 0);
+            if(p == MAP_FAILED) {
+                throw_errno("Failed to map "+path);
+            }
+            mapping = static_cast<unsigned char*>(p);
+            mapped_bytes = file_size;
+            const header* h = reinterpret_cast<const header*>(mapping);
+            if(h->magic != header_magic || h->element_size != sizeof(T)) {
+                throw std::runtime_error(path+" doesn't hold elements of this type");
+            }
+            _capacity = (file_size - sizeof(header))/sizeof(T);
+            if(h->count > _capacity) {
+                throw std::runtime_error(path+" is truncated");
+            }
+            raw_size = h->count;
+        } catch(...) {
+            release();
+            throw;
+        }
+    }
+
+    template<typename T, typename BoundsCheck>
+    mmap_vector<T, BoundsCheck>::mmap_vector(mmap_vector<T, BoundsCheck>&& other) noexcept:
+    fd(other.fd),
+    mapping(other.mapping),
+    mapped_bytes(other.mapped_bytes),
+    raw_size(other.raw_size),
+    _capacity(other._capacity) {
+        other.fd = -1;
+        other.mapping = nullptr;
+        other.mapped_bytes = 0;
+        other.raw_size = 0;
+        other._capacity = 0;
+    }
+
+    template<typename T, typename BoundsCheck>
+    mmap_vector<T, BoundsCheck>::~mmap_vector() {
+        release();
+    }
+
+    template<typename T, typename BoundsCheck>
+    mmap_vector<T, BoundsCheck>& mmap_vector<T, BoundsCheck>::operator=(mmap_vector<T, BoundsCheck>&& other) noexcept {
+        if(this != &other) {
+            mmap_vector<T, BoundsCheck> tmp(std::move(other));
+            std::swap(fd, tmp.fd);
+            std::swap(mapping, tmp.mapping);
+            std::swap(mapped_bytes, tmp.mapped_bytes);
+            std::swap(raw_size, tmp.raw_size);
+            std::swap(_capacity, tmp._capacity);
+        }
+        return *this;
+    }
+
+    template<typename T, typename BoundsCheck>
+    void mmap_vector<T, BoundsCheck>::release() noexcept {
+        if(mapping != nullptr) {
+            munmap(mapping, mapped_bytes);
+            mapping = nullptr;
+        }
+        if(fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+        raw_size = 0;
+        _capacity = 0;
+    }
+
+    template<typename T, typename BoundsCheck>
+    void mmap_vector<T, BoundsCheck>::set_size(size_t count) noexcept {
+        raw_size = count;
+        reinterpret_cast<header*>(mapping)->count = count;
+    }
+
+    template<typename T, typename BoundsCheck>
+    void mmap_vector<T, BoundsCheck>::remap(size_t cap) {
+        const size_t bytes = sizeof(header) + cap*sizeof(T);
+        // The file grows before the mapping and shrinks after it, so no
+        // mapped page is ever past EOF
+        const bool growing = bytes > mapped_bytes;
+        if(growing && ftruncate(fd, bytes) != 0) {
+            throw_errno("Failed to resize mmap_vector file");
+        }
+        void* p;
+        if(mapping == nullptr) {
+            p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        } else {
+#ifdef __linux__
+            p = mremap(mapping, mapped_bytes, bytes, MREMAP_MAYMOVE);
+#else
+            munmap(mapping, mapped_bytes);
+            mapping = nullptr;
+            p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if(p == MAP_FAILED && mapped_bytes != 0) {
+                // Put the old mapping back, the file still covers it
+                const int err = errno;
+                void* old = mmap(nullptr, mapped_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                if(old != MAP_FAILED) {
+                    mapping = static_cast<unsigned char*>(old);
+                } else {
+                    mapped_bytes = 0;
+                    raw_size = 0;
+                    _capacity = 0;
+                }
+                errno = err;
+            }
+#endif
+        }
+        if(p == MAP_FAILED) {
+            throw_errno("Failed to map mmap_vector file");
+        }
+        mapping = static_cast<unsigned char*>(p);
+        mapped_bytes = bytes;
+        _capacity = cap;
+        if(!growing && ftruncate(fd, bytes) != 0) {
+            throw_errno("Failed to resize mmap_vector file");
+        }
+    }
+
+    template<typename T, typename BoundsCheck>
+    void mmap_vector<T, BoundsCheck>::reserve(size_t cap) {
+        if(cap > _capacity) {
+            remap(cap);
+        }
+    }
+
+    template<typename T, typename BoundsCheck>
+    void mmap_vector<T, BoundsCheck>::push_back(const T& value) {
+        emplace_back(value);
+    }
+
+    template<typename T, typename BoundsCheck>
+    template<typename... Args>
+    T& mmap_vector<T, BoundsCheck>::emplace_back(Args&&... args) {
+        // Build the element first, args may point into the mapping
+        T tmp(std::forward<Args>(args)...);
+        if(raw_size == _capacity) {
+            remap(next_capacity());
+        }
+        memcpy(static_cast<void*>(data() + raw_size), static_cast<const void*>(&tmp), sizeof(T));
+        set_size(raw_size + 1);
+        return data()[raw_size-1];
+    }
+
+    template<typename T, typename BoundsCheck>
+    void mmap_vector<T, BoundsCheck>::pop_back() {
+        if(!empty()) {
+            set_size(raw_size - 1);
+        }
+    }
+
+    template<typename T, typename BoundsCheck>
+    void mmap_vector<T, BoundsCheck>::resize(size_t count) {
+        resize(count, T());
+    }
+
+    template<typename T, typename BoundsCheck>
+    void mmap_vector<T, BoundsCheck>::resize(size_t count, const T& value) {
+        if(count > raw_size) {
+            const T tmp(value);
+            reserve(count);
+            detail::fill(data() + raw_size, count - raw_size, tmp);
+        }
+        set_size(count);
+    }
+
+    template<typename T, typename BoundsCheck>
+    void mmap_vector<T, BoundsCheck>::clear() {
+        set_size(0);
+    }
+
+    template<typename T, typename BoundsCheck>
+    T& mmap_vector<T, BoundsCheck>::operator[](size_t i) {
+        BoundsCheck::check(i, raw_size);
+        return data()[i];
+    }
+
+    template<typename T, typename BoundsCheck>
+    const T& mmap_vector<T, BoundsCheck>::operator[](size_t i) const {
+        BoundsCheck::check(i, raw_size);
+        return data()[i];
+    }
+
+    template<typename T, typename BoundsCheck>
+    T& mmap_vector<T, BoundsCheck>::at(size_t i) {
+        if(!(i < raw_size)) {
+            throw std::out_of_range("Attempted to access element out of range");
+        }
+        return data()[i];
+    }
+
+    template<typename T, typename BoundsCheck>
+    const T& mmap_vector<T, BoundsCheck>::at(size_t i) const {
+        if(!(i < raw_size)) {
+            throw std::out_of_range("Attempted to access element out of range");
+        }
+        return data()[i];
+    }
+
+    template<typename T, typename BoundsCheck>
+    T& mmap_vector<T, BoundsCheck>::front() {
+        BoundsCheck::check(0, raw_size);
+        return data()[0];
+    }
+
+    template<typename T, typename BoundsCheck>
+    const T& mmap_vector<T, BoundsCheck>::front() const {
+        BoundsCheck::check(0, raw_size);
+        return data()[0];
+    }
+
+    template<typename T, typename BoundsCheck>
+    T& mmap_vector<T, BoundsCheck>::back() {
+        BoundsCheck::check(0, raw_size);
+        return data()[raw_size-1];
+    }
+
+    template<typename T, typename BoundsCheck>
+    const T& mmap_vector<T, BoundsCheck>::back() const {
+        BoundsCheck::check(0, raw_size);
+        return data()[raw_size-1];
+    }
+
+    template<typename T, typename BoundsCheck>
+    size_t mmap_vector<T, BoundsCheck>::size() const noexcept {
+        return raw_size;
+    }
+
+    template<typename T, typename BoundsCheck>
+    size_t mmap_vector<T, BoundsCheck>::capacity() const noexcept {
+        return _capacity;
+    }
+
+    template<typename T, typename BoundsCheck>
+    bool mmap_vector<T, BoundsCheck>::empty() const noexcept {
+        return raw_size == 0;
+    }
+
+    template<typename T, typename BoundsCheck>
+    void mmap_vector<T, BoundsCheck>::shrink_to_fit() {
+        if(raw_size != _capacity) {
+            remap(raw_size);
+        }
+    }
+
+    template<typename T, typename BoundsCheck>
+    void mmap_vector<T, BoundsCheck>::sync() {
+        if(mapping != nullptr && msync(mapping, mapped_bytes, MS_SYNC) != 0) {
+            throw_errno("Failed to sync mmap_vector");
+        }
+    }
+
+    template<typename T, typename BoundsCheck>
+    void mmap_vector<T, BoundsCheck>::close() {
+        if(fd >= 0 && ftruncate(fd, sizeof(header) + raw_size*sizeof(T)) != 0) {
+            throw_errno("Failed to trim mmap_vector file");
+        }
+        release();
+    }
+
+    template<typename T, typename BoundsCheck>
+    T* mmap_vector<T, BoundsCheck>::data() noexcept {
+        return reinterpret_cast<T*>(mapping + sizeof(header));
+    }
+
+    template<typename T, typename BoundsCheck>
+    const T* mmap_vector<T, BoundsCheck>::data() const noexcept {
+        return reinterpret_cast<const T*>(mapping + sizeof(header));
+    }
+
+    template<typename T, typename BoundsCheck>
+    T* mmap_vector<T, BoundsCheck>::begin() noexcept {
+        return data();
+    }
+
+    template<typename T, typename BoundsCheck>
+    const T* mmap_vector<T, BoundsCheck>::begin() const noexcept {
+        return cbegin();
+    }
+
+    template<typename T, typename BoundsCheck>
+    const T* mmap_vector<T, BoundsCheck>::cbegin() const noexcept {
+        return data();
+    }
+
+    template<typename T, typename BoundsCheck>
+    T* mmap_vector<T, BoundsCheck>::end() noexcept {
+        return data() + raw_size;
+    }
+
+    template<typename T, typename BoundsCheck>
+    const T* mmap_vector<T, BoundsCheck>::end() const noexcept {
+        return cend();
+    }
+
+    template<typename T, typename BoundsCheck>
+    const T* mmap_vector<T, BoundsCheck>::cend() const noexcept {
+        return data() + raw_size;
+    }
+    template<typename T, typename BoundsCheck>
+    mmap_view<T, BoundsCheck>::mmap_view(const std::string& path):table(path, false) {
+    }
+
+    template<typename T, typename BoundsCheck>
+    const T& mmap_view<T, BoundsCheck>::operator[](size_t i) const {
+        return table[i];
+    }
+
+    template<typename T, typename BoundsCheck>
+    const T& mmap_view<T, BoundsCheck>::at(size_t i) const {
+        return table.at(i);
+    }
+
+    template<typename T, typename BoundsCheck>
+    const T& mmap_view<T, BoundsCheck>::front() const {
+        return table.front();
+    }
+
+    template<typename T, typename BoundsCheck>
+    const T& mmap_view<T, BoundsCheck>::back() const {
+        return table.back();
+    }
+
+    template<typename T, typename BoundsCheck>
+    size_t mmap_view<T, BoundsCheck>::size() const noexcept {
+        return table.size();
+    }
+
+    template<typename T, typename BoundsCheck>
+    bool mmap_view<T, BoundsCheck>::empty() const noexcept {
+        return table.empty();
+    }
+
+    template<typename T, typename BoundsCheck>
+    const T* mmap_view<T, BoundsCheck>::data() const noexcept {
+        return table.data();
+    }
+
+    template<typename T, typename BoundsCheck>
+    const T* mmap_view<T, BoundsCheck>::begin() const noexcept {
+        return table.cbegin();
+    }
+
+    template<typename T, typename BoundsCheck>
+    const T* mmap_view<T, BoundsCheck>::cbegin() const noexcept {
+        return table.cbegin();
+    }
+
+    template<typename T, typename BoundsCheck>
+    const T* mmap_view<T, BoundsCheck>::end() const noexcept {
+        return table.cend();
+    }
+
+    template<typename T, typename BoundsCheck>
+    const T* mmap_view<T, BoundsCheck>::cend() const noexcept {
+        return table.cend();
+    }
+}
+
+#endif
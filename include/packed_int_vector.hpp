@@ -0,0 +1,521 @@
+#ifndef XD_PACKED_INT_VECTOR_H
+#define XD_PACKED_INT_VECTOR_H
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include "aligned_allocator.hpp"
+#include "simd.hpp"
+#include "vector.hpp"
+
+
+namespace xd {
+
+    namespace detail {
+        //! Values per packed block
+        inline constexpr size_t packed_block_size = 128;
+        //! Values are spread over this many 64 bit lanes, value j is row
+        //! j / 4 of lane j % 4 and the lanes' words are interleaved, so a
+        //! row of every lane unpacks with the same shifts in one AVX2
+        //! register. Widths are even so a lane is a whole number of words
+        //! and a block of width w takes 2*w words.
+        inline constexpr size_t packed_lanes = 4;
+
+        //! Where a block lives and how to rebuild its values
+        struct packed_block {
+            uint64_t base;
+            //! Word offset << 8 | width << 1 | delta
+            uint64_t packed;
+
+            uint64_t offset() const noexcept { return packed >> 8; }
+            unsigned width() const noexcept { return unsigned(packed >> 1) & 0x7f; }
+            bool delta() const noexcept { return packed & 1; }
+        };
+
+        //! Even number of bits that holds value
+        inline unsigned packed_width(uint64_t value) noexcept {
+            const unsigned bits = 64 - std::countl_zero(value);
+            return (bits + 1) & ~1u;
+        }
+
+        //! Packs a block of residuals at width into out, which must hold
+        //! 2*width zeroed words
+        inline void pack_residuals(const uint64_t* residuals, unsigned width, uint64_t* out) noexcept {
+            if(width == 0) {
+                return;
+            }
+            for(size_t j=0; j<packed_block_size; j++) {
+                const size_t lane = j%packed_lanes;
+                const size_t bit = (j/packed_lanes)*width;
+                const size_t word = bit/64;
+                const size_t shift = bit%64;
+                out[word*packed_lanes + lane] |= residuals[j] << shift;
+                if(shift + width > 64) {
+                    out[(word + 1)*packed_lanes + lane] |= residuals[j] >> (64 - shift);
+                }
+            }
+        }
+
+        //! Residual j of a block packed at width
+        inline uint64_t unpack_one(const uint64_t* in, unsigned width, size_t j) noexcept {
+            if(width == 0) {
+                return 0;
+            }
+            const size_t lane = j%packed_lanes;
+            const size_t bit = (j/packed_lanes)*width;
+            const size_t word = bit/64;
+            const size_t shift = bit%64;
+            uint64_t value = in[word*packed_lanes + lane] >> shift;
+            if(shift + width > 64) {
+                value |= in[(word + 1)*packed_lanes + lane] << (64 - shift);
+            }
+            return width == 64 ? value : value & ((uint64_t(1) << width) - 1);
+        }
+
+        //! Unpack kernels rebuild a block's values from its residuals. The
+        //! width, row and encoding are template arguments so every shift
+        //! and mask is an immediate and the rows unroll. Frame of reference
+        //! adds base to each row, delta adds each row to the one before it,
+        //! so a block is 32 dependent vector adds rather than 128 scalar.
+        using unpack_fn = void (*)(const uint64_t*, uint64_t*, uint64_t);
+
+        template<unsigned W, bool Delta>
+        inline void unpack_scalar(const uint64_t* in, uint64_t* out, uint64_t base) noexcept {
+            for(size_t j=0; j<packed_block_size; j++) {
+                const uint64_t prev = Delta && j >= packed_lanes ? out[j - packed_lanes] : base;
+                out[j] = prev + unpack_one(in, W, j);
+            }
+        }
+
+#ifdef XD_SIMD_X86
+        template<unsigned W, size_t R>
+        __attribute__((target("avx2"), always_inline))
+        inline __m256i unpack_row_avx2(const uint64_t* in) noexcept {
+            constexpr size_t word = R*W/64;
+            constexpr int shift = int(R*W%64);
+            if constexpr(W == 0) {
+                return _mm256_setzero_si256();
+            } else {
+                __m256i v = _mm256_srli_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + word*packed_lanes)), shift);
+                if constexpr(shift + W > 64) {
+                    const __m256i next = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + (word + 1)*packed_lanes));
+                    v = _mm256_or_si256(v, _mm256_slli_epi64(next, 64 - shift));
+                }
+                if constexpr(W < 64) {
+                    v = _mm256_and_si256(v, _mm256_set1_epi64x((int64_t(1) << W) - 1));
+                }
+                return v;
+            }
+        }
+
+        template<unsigned W, bool Delta, size_t R>
+        __attribute__((target("avx2"), always_inline))
+        inline void unpack_step_avx2(const uint64_t* in, uint64_t* out, __m256i& acc) noexcept {
+            const __m256i v = unpack_row_avx2<W, R>(in);
+            if constexpr(Delta) {
+                acc = _mm256_add_epi64(acc, v);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + R*packed_lanes), acc);
+            } else {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + R*packed_lanes), _mm256_add_epi64(acc, v));
+            }
+        }
+
+        template<unsigned W, bool Delta, size_t... R>
+        __attribute__((target("avx2")))
+        inline void unpack_avx2(const uint64_t* in, uint64_t* out, uint64_t base, std::index_sequence<R...>) noexcept {
+            __m256i acc = _mm256_set1_epi64x(int64_t(base));
+            (unpack_step_avx2<W, Delta, R>(in, out, acc), ...);
+        }
+
+        template<unsigned W, bool Delta>
+        __attribute__((target("avx2")))
+        inline void unpack_avx2(const uint64_t* in, uint64_t* out, uint64_t base) noexcept {
+            unpack_avx2<W, Delta>(in, out, base, std::make_index_sequence<packed_block_size/packed_lanes>());
+        }
+
+        //! SSE2 does a row as two halves of two lanes each
+        template<unsigned W, size_t R>
+        __attribute__((always_inline))
+        inline __m128i unpack_row_sse2(const uint64_t* in, size_t half) noexcept {
+            constexpr size_t word = R*W/64;
+            constexpr int shift = int(R*W%64);
+            if constexpr(W == 0) {
+                return _mm_setzero_si128();
+            } else {
+                __m128i v = _mm_srli_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + word*packed_lanes + half)), shift);
+                if constexpr(shift + W > 64) {
+                    const __m128i next = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + (word + 1)*packed_lanes + half));
+                    v = _mm_or_si128(v, _mm_slli_epi64(next, 64 - shift));
+                }
+                if constexpr(W < 64) {
+                    v = _mm_and_si128(v, _mm_set1_epi64x((int64_t(1) << W) - 1));
+                }
+                return v;
+            }
+        }
+
+        template<unsigned W, bool Delta, size_t R>
+        __attribute__((always_inline))
+        inline void unpack_step_sse2(const uint64_t* in, uint64_t* out, __m128i& lo, __m128i& hi) noexcept {
+            const __m128i a = unpack_row_sse2<W, R>(in, 0);
+            const __m128i b = unpack_row_sse2<W, R>(in, 2);
+            if constexpr(Delta) {
+                lo = _mm_add_epi64(lo, a);
+                hi = _mm_add_epi64(hi, b);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + R*packed_lanes), lo);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + R*packed_lanes + 2), hi);
+            } else {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + R*packed_lanes), _mm_add_epi64(lo, a));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + R*packed_lanes + 2), _mm_add_epi64(hi, b));
+            }
+        }
+
+        template<unsigned W, bool Delta, size_t... R>
+        inline void unpack_sse2(const uint64_t* in, uint64_t* out, uint64_t base, std::index_sequence<R...>) noexcept {
+            __m128i lo = _mm_set1_epi64x(int64_t(base));
+            __m128i hi = lo;
+            (unpack_step_sse2<W, Delta, R>(in, out, lo, hi), ...);
+        }
+
+        template<unsigned W, bool Delta>
+        inline void unpack_sse2(const uint64_t* in, uint64_t* out, uint64_t base) noexcept {
+            unpack_sse2<W, Delta>(in, out, base, std::make_index_sequence<packed_block_size/packed_lanes>());
+        }
+#endif
+
+        //! Kernel for each even width and encoding, indexed by width + delta
+        template<size_t... I>
+        inline const unpack_fn* unpack_table(std::index_sequence<I...>) noexcept {
+#ifdef XD_SIMD_X86
+            static const unpack_fn avx2[] = {&unpack_avx2<unsigned(I & ~size_t(1)), bool(I & 1)>...};
+            static const unpack_fn sse2[] = {&unpack_sse2<unsigned(I & ~size_t(1)), bool(I & 1)>...};
+            return cpu_has_avx2() ? avx2 : sse2;
+#else
+            static const unpack_fn scalar[] = {&unpack_scalar<unsigned(I & ~size_t(1)), bool(I & 1)>...};
+            return scalar;
+#endif
+        }
+
+        //! Rebuilds the 128 values of a block into out
+        inline void unpack_block(const uint64_t* in, unsigned width, bool delta, uint64_t base, uint64_t* out) noexcept {
+            static const unpack_fn* table = unpack_table(std::make_index_sequence<66>());
+            table[width + delta](in, out, base);
+        }
+    }
+
+    //! Append-only vector of unsigned integers compressed in blocks of
+    //! 128. Each block is stored as offsets from its minimum (frame of
+    //! reference), or when every value is at least the one four places
+    //! before it, as those gaps if they need fewer bits. Either way the
+    //! residuals are bit-packed at the narrowest even width that fits. The
+    //! gaps are four apart so the four SIMD lanes add up independently.
+    //! A 16 byte index entry per block finds any block in O(1). Frame of
+    //! reference values are read straight out of the packed bits, delta
+    //! blocks are unpacked whole. The last size() % 128 values wait
+    //! unpacked until their block fills. Iterating decodes a block at a
+    //! time so sequential reads are the fast path.
+    template<typename T = uint64_t, typename BoundsCheck = default_bounds_check>
+    class packed_int_vector {
+    public:
+        using value_type = T;
+        using size_type = size_t;
+        using const_reference = T;
+
+        static_assert(std::is_unsigned<T>::value && sizeof(T) <= sizeof(uint64_t),
+                      "packed_int_vector holds unsigned integers of up to 64 bits");
+
+        static constexpr size_t block_size = detail::packed_block_size;
+
+        class const_iterator;
+
+        packed_int_vector() noexcept = default;
+        template<typename InputIt, typename = detail::require_input_iterator<InputIt>>
+        packed_int_vector(InputIt first, InputIt last);
+        packed_int_vector(std::initializer_list<T> l);
+        explicit packed_int_vector(const vector<T>& values);
+
+        void push_back(T value);
+        //! Appends n values, whole blocks are packed straight from values
+        void append(const T* values, size_t n);
+
+        T operator[](size_t index) const;
+        T at(size_t index) const;
+        T front() const;
+        T back() const;
+
+        size_t size() const noexcept;
+        bool empty() const noexcept;
+        void clear() noexcept;
+        void shrink_to_fit();
+
+        //! Blocks including the partly filled one at the end
+        size_t block_count() const noexcept;
+        //! Decodes block into out, which needs room for block_size values,
+        //! returns how many values the block holds
+        size_t decode_block(size_t block, T* out) const;
+        //! Bytes held by the packed words, the block index and the tail
+        size_t memory_usage() const noexcept;
+
+        //! Decodes everything into a plain vector
+        vector<T> to_vector() const;
+
+        const_iterator begin() const;
+        const_iterator cbegin() const;
+        const_iterator end() const noexcept;
+        const_iterator cend() const noexcept;
+    private:
+        //! Chooses the encoding for a full block of values and packs it
+        void pack_block(const T* values);
+        T get(size_t index) const;
+
+        aligned_vector<uint64_t> _words;
+        vector<detail::packed_block> _blocks;
+        vector<T> _tail;
+    };
+
+    //! Input iterator holding one decoded block, each step is a load from
+    //! it and every 128th step decodes the next block
+    template<typename T, typename BoundsCheck>
+    class packed_int_vector<T, BoundsCheck>::const_iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using reference = T;
+        using pointer = void;
+
+        const_iterator() noexcept: owner(nullptr), index(0) {}
+
+        T operator*() const noexcept { return values[index%block_size]; }
+
+        const_iterator& operator++() { if(++index%block_size == 0) { load(); } return *this; }
+        const_iterator operator++(int) { auto tmp = *this; ++*this; return tmp; }
+
+        bool operator==(const const_iterator& other) const noexcept { return index == other.index; }
+        bool operator!=(const const_iterator& other) const noexcept { return index != other.index; }
+    private:
+        friend class packed_int_vector;
+
+        const_iterator(const packed_int_vector* owner, size_t index): owner(owner), index(index) { load(); }
+
+        void load() { if(index < owner->size()) { owner->decode_block(index/block_size, values); } }
+
+        const packed_int_vector* owner;
+        size_t index;
+        T values[block_size];
+    };
+
+    template<typename T, typename BoundsCheck>
+    template<typename InputIt, typename>
+    packed_int_vector<T, BoundsCheck>::packed_int_vector(InputIt first, InputIt last) {
+        for(; first != last; ++first) {
+            push_back(*first);
+        }
+    }
+
+    template<typename T, typename BoundsCheck>
+    packed_int_vector<T, BoundsCheck>::packed_int_vector(std::initializer_list<T> l) {
+        append(l.begin(), l.size());
+    }
+
+    template<typename T, typename BoundsCheck>
+    packed_int_vector<T, BoundsCheck>::packed_int_vector(const vector<T>& values) {
+        append(values.data(), values.size());
+    }
+
+    template<typename T, typename BoundsCheck>
+    void packed_int_vector<T, BoundsCheck>::push_back(T value) {
+        if(_tail.capacity() == 0) {
+            _tail.reserve(block_size);
+        }
+        _tail.push_back(value);
+        if(_tail.size() == block_size) {
+            pack_block(_tail.data());
+            _tail.clear();
+        }
+    }
+
+    template<typename T, typename BoundsCheck>
+    void packed_int_vector<T, BoundsCheck>::append(const T* values, size_t n) {
+        // Top up a partial block first so the rest starts on a boundary
+        for(; n > 0 && !_tail.empty(); values++, n--) {
+            push_back(*values);
+        }
+        for(; n >= block_size; values += block_size, n -= block_size) {
+            pack_block(values);
+        }
+        for(; n > 0; values++, n--) {
+            push_back(*values);
+        }
+    }
+
+    template<typename T, typename BoundsCheck>
+    T packed_int_vector<T, BoundsCheck>::operator[](size_t index) const {
+        BoundsCheck::check(index, size());
+        return get(index);
+    }
+
+    template<typename T, typename BoundsCheck>
+    T packed_int_vector<T, BoundsCheck>::at(size_t index) const {
+        bounds_throw::check(index, size());
+        return get(index);
+    }
+
+    template<typename T, typename BoundsCheck>
+    T packed_int_vector<T, BoundsCheck>::front() const {
+        return (*this)[0];
+    }
+
+    template<typename T, typename BoundsCheck>
+    T packed_int_vector<T, BoundsCheck>::back() const {
+        return (*this)[size() - 1];
+    }
+
+    template<typename T, typename BoundsCheck>
+    size_t packed_int_vector<T, BoundsCheck>::size() const noexcept {
+        return _blocks.size()*block_size + _tail.size();
+    }
+
+    template<typename T, typename BoundsCheck>
+    bool packed_int_vector<T, BoundsCheck>::empty() const noexcept {
+        return _blocks.empty() && _tail.empty();
+    }
+
+    template<typename T, typename BoundsCheck>
+    void packed_int_vector<T, BoundsCheck>::clear() noexcept {
+        _words.clear();
+        _blocks.clear();
+        _tail.clear();
+    }
+
+    template<typename T, typename BoundsCheck>
+    void packed_int_vector<T, BoundsCheck>::shrink_to_fit() {
+        _words.shrink_to_fit();
+        _blocks.shrink_to_fit();
+        _tail.shrink_to_fit();
+    }
+
+    template<typename T, typename BoundsCheck>
+    size_t packed_int_vector<T, BoundsCheck>::block_count() const noexcept {
+        return _blocks.size() + !_tail.empty();
+    }
+
+    template<typename T, typename BoundsCheck>
+    size_t packed_int_vector<T, BoundsCheck>::decode_block(size_t block, T* out) const {
+        if(block == _blocks.size()) {
+            std::copy(_tail.begin(), _tail.end(), out);
+            return _tail.size();
+        }
+        const detail::packed_block& info = _blocks[block];
+        const uint64_t* in = _words.data() + info.offset();
+        if constexpr(std::is_same<T, uint64_t>::value) {
+            detail::unpack_block(in, info.width(), info.delta(), info.base, out);
+        } else {
+            uint64_t values[block_size];
+            detail::unpack_block(in, info.width(), info.delta(), info.base, values);
+            std::copy(values, values + block_size, out);
+        }
+        return block_size;
+    }
+
+    template<typename T, typename BoundsCheck>
+    size_t packed_int_vector<T, BoundsCheck>::memory_usage() const noexcept {
+        return _words.capacity()*sizeof(uint64_t) + _blocks.capacity()*sizeof(detail::packed_block) +
+               _tail.capacity()*sizeof(T);
+    }
+
+    template<typename T, typename BoundsCheck>
+    vector<T> packed_int_vector<T, BoundsCheck>::to_vector() const {
+        vector<T> res;
+        T* out = res.resize_for_overwrite(size());
+        for(size_t b=0; b<block_count(); b++) {
+            out += decode_block(b, out);
+        }
+        return res;
+    }
+
+    template<typename T, typename BoundsCheck>
+    typename packed_int_vector<T, BoundsCheck>::const_iterator packed_int_vector<T, BoundsCheck>::begin() const {
+        return const_iterator(this, 0);
+    }
+
+    template<typename T, typename BoundsCheck>
+    typename packed_int_vector<T, BoundsCheck>::const_iterator packed_int_vector<T, BoundsCheck>::cbegin() const {
+        return begin();
+    }
+
+    template<typename T, typename BoundsCheck>
+    typename packed_int_vector<T, BoundsCheck>::const_iterator packed_int_vector<T, BoundsCheck>::end() const noexcept {
+        const_iterator res;
+        res.owner = this;
+        res.index = size();
+        return res;
+    }
+
+    template<typename T, typename BoundsCheck>
+    typename packed_int_vector<T, BoundsCheck>::const_iterator packed_int_vector<T, BoundsCheck>::cend() const noexcept {
+        return end();
+    }
+
+    template<typename T, typename BoundsCheck>
+    void packed_int_vector<T, BoundsCheck>::pack_block(const T* values) {
+        // Delta gaps run down each lane, from the previous value in the
+        // lane or from the first value for the top row
+        uint64_t min = values[0];
+        uint64_t max = values[0];
+        uint64_t max_gap = 0;
+        bool ascending = true;
+        for(size_t j=0; j<block_size; j++) {
+            const uint64_t value = values[j];
+            const uint64_t prev = j < detail::packed_lanes ? values[0] : values[j - detail::packed_lanes];
+            min = value < min ? value : min;
+            max = value > max ? value : max;
+            ascending = ascending && value >= prev;
+            max_gap = value - prev > max_gap ? value - prev : max_gap;
+        }
+        const unsigned for_width = detail::packed_width(max - min);
+        const unsigned delta_width = ascending ? detail::packed_width(max_gap) : 64;
+        // Ties go to frame of reference, its values can be read one at a time
+        const bool delta = delta_width < for_width;
+        const unsigned width = delta ? delta_width : for_width;
+        const uint64_t base = delta ? uint64_t(values[0]) : min;
+
+        uint64_t residuals[block_size];
+        for(size_t j=0; j<block_size; j++) {
+            const uint64_t prev = !delta || j < detail::packed_lanes ? base : values[j - detail::packed_lanes];
+            residuals[j] = values[j] - prev;
+        }
+        const uint64_t offset = _words.size();
+        const size_t words = 2*width;
+        // Blocks of one repeated value have width 0 and no words at all
+        if(words > 0) {
+            uint64_t* out = _words.append_uninitialized(words);
+            memset(out, 0, words*sizeof(uint64_t));
+            detail::pack_residuals(residuals, width, out);
+            _words.commit(words);
+        }
+        _blocks.push_back(detail::packed_block{base, offset << 8 | width << 1 | delta});
+    }
+
+    template<typename T, typename BoundsCheck>
+    T packed_int_vector<T, BoundsCheck>::get(size_t index) const {
+        const size_t block = index/block_size;
+        if(block == _blocks.size()) {
+            return _tail[index%block_size];
+        }
+        const detail::packed_block& info = _blocks[block];
+        const uint64_t* in = _words.data() + info.offset();
+        if(!info.delta()) {
+            return T(info.base + detail::unpack_one(in, info.width(), index%block_size));
+        }
+        uint64_t decoded[block_size];
+        detail::unpack_block(in, info.width(), true, info.base, decoded);
+        return T(decoded[index%block_size]);
+    }
+}
+
+#endif
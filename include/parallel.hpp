@@ -0,0 +1,341 @@
+#ifndef XD_PARALLEL_H
+#define XD_PARALLEL_H
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include "vector.hpp"
+
+
+namespace xd {
+
+    //! Fixed set of worker threads running fork-join jobs. The calling
+    //! thread works on its own job too, so a pool of size n starts n - 1
+    //! threads. Jobs started from inside a job run on the calling thread.
+    class thread_pool {
+    public:
+        //! threads is the total including the caller, 0 means one per core
+        explicit thread_pool(size_t threads = 0);
+        thread_pool(const thread_pool& other) = delete;
+        ~thread_pool();
+
+        thread_pool& operator=(const thread_pool& other) = delete;
+
+        //! Threads that work on a job, including the caller
+        size_t size() const noexcept;
+
+        //! Calls f(task) for every task in [0, tasks) and returns once
+        //! they're all done. The first exception thrown by a task is
+        //! rethrown after the rest have finished.
+        template<typename F>
+        void run(size_t tasks, F&& f);
+
+        //! Pool shared by the default parallel policies
+        static thread_pool& global();
+    private:
+        //! Copy of a job taken under the lock, so a worker never mixes the
+        //! fields of two jobs
+        struct job_state {
+            void (*job)(void*, size_t);
+            void* context;
+            size_t tasks;
+            uint64_t generation;
+        };
+
+        void worker();
+        //! Runs tasks of the given job until none are left
+        void work(const job_state& current) noexcept;
+
+        xd::vector<std::thread> threads;
+        //! Serialises jobs from different calling threads
+        std::mutex run_lock;
+        std::mutex lock;
+        std::condition_variable wake;
+        std::condition_variable done;
+        //! Bumped for every job so sleeping workers know to wake
+        uint64_t generation;
+        bool stopping;
+        //! Workers currently inside work()
+        size_t active;
+
+        //! Current job, erased to a function pointer so the pool isn't a
+        //! template
+        void (*job)(void*, size_t);
+        void* job_context;
+        size_t job_tasks;
+        std::atomic<size_t> next_task;
+        std::atomic<size_t> finished_tasks;
+        std::exception_ptr error;
+
+        static thread_local bool in_job;
+    };
+
+    //! Runs bulk operations on the calling thread
+    struct sequenced_policy {
+        size_t chunk_count(size_t, size_t) const noexcept {
+            return 1;
+        }
+
+        template<typename F>
+        void run(size_t chunks, F&& f) const {
+            for(size_t i=0; i<chunks; i++) {
+                f(i);
+            }
+        }
+    };
+
+    //! Splits bulk operations into one contiguous chunk per pool thread.
+    //! Operations touching fewer than min_bytes stay on the calling thread.
+    class parallel_policy {
+    public:
+        explicit constexpr parallel_policy(size_t min_bytes = 0, thread_pool* pool = nullptr) noexcept:
+        min_bytes(min_bytes),
+        pool(pool) {
+        }
+
+        //! Same thresholds running on another pool
+        constexpr parallel_policy on(thread_pool& other) const noexcept {
+            return parallel_policy(min_bytes, &other);
+        }
+
+        size_t chunk_count(size_t n, size_t element_size) const {
+            if(n < 2 || n*element_size < min_bytes) {
+                return 1;
+            }
+            const size_t threads = get_pool().size();
+            return n < threads ? n : threads;
+        }
+
+        template<typename F>
+        void run(size_t chunks, F&& f) const {
+            get_pool().run(chunks, std::forward<F>(f));
+        }
+    private:
+        thread_pool& get_pool() const {
+            return pool != nullptr ? *pool : thread_pool::global();
+        }
+
+        size_t min_bytes;
+        thread_pool* pool;
+    };
+
+    template<>
+    struct is_execution_policy<sequenced_policy>: std::true_type {};
+
+    template<>
+    struct is_execution_policy<parallel_policy>: std::true_type {};
+
+    constexpr sequenced_policy seq{};
+    //! Always splits across the global pool
+    constexpr parallel_policy par{};
+    //! Only splits work touching at least 4MB, below that the cost of
+    //! waking the pool outweighs the copy
+    constexpr parallel_policy par_auto{size_t(1) << 22};
+
+    //! Assigns value to every element of vec
+    template<typename Policy, typename T, typename Allocator, typename Growth, typename BoundsCheck,
+             typename = detail::require_execution_policy<Policy>>
+    void fill(Policy&& policy, vector<T, Allocator, Growth, BoundsCheck>& vec, const T& value) {
+        const T tmp(value);
+        T* data = vec.data();
+        detail::for_each_chunk(policy, vec.size(), sizeof(T), [&](size_t first, size_t last) {
+            if constexpr(std::is_trivially_copyable<T>::value) {
+                detail::fill(data + first, last - first, tmp);
+            } else {
+                std::fill(data + first, data + last, tmp);
+            }
+        });
+    }
+
+    //! Sets dst[i] = op(src[i]), dst is resized to src.size() first. dst
+    //! may be src for an in-place transform.
+    template<typename Policy, typename T, typename A1, typename G1, typename B1,
+             typename U, typename A2, typename G2, typename B2, typename UnaryOp,
+             typename = detail::require_execution_policy<Policy>>
+    void transform(Policy&& policy, const vector<T, A1, G1, B1>& src, vector<U, A2, G2, B2>& dst, UnaryOp op) {
+        dst.resize(policy, src.size());
+        const T* in = src.data();
+        U* out = dst.data();
+        detail::for_each_chunk(policy, src.size(), sizeof(U), [&](size_t first, size_t last) {
+            for(size_t i=first; i<last; i++) {
+                out[i] = op(in[i]);
+            }
+        });
+    }
+
+    //! Folds vec into init with op. Each chunk is folded separately then
+    //! the partial results are folded in order, so op must be associative.
+    template<typename Policy, typename T, typename Allocator, typename Growth, typename BoundsCheck,
+             typename Result, typename BinaryOp, typename = detail::require_execution_policy<Policy>>
+    Result reduce(Policy&& policy, const vector<T, Allocator, Growth, BoundsCheck>& vec, Result init, BinaryOp op) {
+        const size_t n = vec.size();
+        const size_t chunks = n == 0 ? 1 : policy.chunk_count(n, sizeof(T));
+        const T* data = vec.data();
+        if(chunks <= 1) {
+            for(size_t i=0; i<n; i++) {
+                init = op(std::move(init), data[i]);
+            }
+            return init;
+        }
+        vector<Result> partials(chunks, init);
+        policy.run(chunks, [&](size_t chunk) {
+            const size_t first = n*chunk/chunks;
+            const size_t last = n*(chunk + 1)/chunks;
+            Result acc = data[first];
+            for(size_t i=first+1; i<last; i++) {
+                acc = op(std::move(acc), data[i]);
+            }
+            partials[chunk] = std::move(acc);
+        });
+        for(auto& partial: partials) {
+            init = op(std::move(init), std::move(partial));
+        }
+        return init;
+    }
+
+    template<typename Policy, typename T, typename Allocator, typename Growth, typename BoundsCheck,
+             typename = detail::require_execution_policy<Policy>>
+    T reduce(Policy&& policy, const vector<T, Allocator, Growth, BoundsCheck>& vec) {
+        return reduce(std::forward<Policy>(policy), vec, T(), [](const T& a, const T& b) { return a + b; });
+    }
+
+    inline thread_local bool thread_pool::in_job = false;
+
+    inline thread_pool::thread_pool(size_t n):
+    generation(0),
+    stopping(false),
+    active(0),
+    job(nullptr),
+    job_context(nullptr),
+    job_tasks(0),
+    next_task(0),
+    finished_tasks(0) {
+        if(n == 0) {
+            n = std::thread::hardware_concurrency();
+        }
+        if(n > 1) {
+            threads.reserve(n - 1);
+            for(size_t i=0; i<n-1; i++) {
+                threads.emplace_back(&thread_pool::worker, this);
+            }
+        }
+    }
+
+    inline thread_pool::~thread_pool() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for(auto& t: threads) {
+            t.join();
+        }
+    }
+
+    inline size_t thread_pool::size() const noexcept {
+        return threads.size() + 1;
+    }
+
+    inline thread_pool& thread_pool::global() {
+        static thread_pool pool;
+        return pool;
+    }
+
+    template<typename F>
+    void thread_pool::run(size_t tasks, F&& f) {
+        if(tasks == 0) {
+            return;
+        }
+        if(in_job || threads.empty() || tasks == 1) {
+            for(size_t i=0; i<tasks; i++) {
+                f(i);
+            }
+            return;
+        }
+        std::lock_guard<std::mutex> job_guard(run_lock);
+        using func = std::remove_reference_t<F>;
+        job_state current;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            job = [](void* context, size_t task) {
+                (*static_cast<func*>(context))(task);
+            };
+            job_context = const_cast<void*>(static_cast<const void*>(&f));
+            job_tasks = tasks;
+            next_task.store(0, std::memory_order_relaxed);
+            finished_tasks.store(0, std::memory_order_relaxed);
+            error = nullptr;
+            generation++;
+            current = job_state{job, job_context, job_tasks, generation};
+        }
+        wake.notify_all();
+        in_job = true;
+        work(current);
+        in_job = false;
+        std::unique_lock<std::mutex> guard(lock);
+        done.wait(guard, [&]() {
+            return active == 0 && finished_tasks.load(std::memory_order_acquire) == tasks;
+        });
+        // Workers that wake late now see an empty job. Any worker that
+        // took a copy of this one is counted in active, so none of them
+        // can still touch next_task or finished_tasks when the next job
+        // resets them.
+        job_tasks = 0;
+        if(error) {
+            std::exception_ptr e = error;
+            error = nullptr;
+            std::rethrow_exception(e);
+        }
+    }
+
+    inline void thread_pool::worker() {
+        in_job = true;
+        uint64_t seen = 0;
+        std::unique_lock<std::mutex> guard(lock);
+        for(;;) {
+            wake.wait(guard, [&]() { return stopping || generation != seen; });
+            if(stopping) {
+                return;
+            }
+            seen = generation;
+            const job_state current{job, job_context, job_tasks, generation};
+            if(current.tasks == 0) {
+                continue;
+            }
+            active++;
+            guard.unlock();
+            work(current);
+            guard.lock();
+            active--;
+            if(active == 0) {
+                done.notify_all();
+            }
+        }
+    }
+
+    inline void thread_pool::work(const job_state& current) noexcept {
+        for(;;) {
+            const size_t task = next_task.fetch_add(1, std::memory_order_relaxed);
+            if(task >= current.tasks) {
+                return;
+            }
+            try {
+                current.job(current.context, task);
+            } catch(...) {
+                std::lock_guard<std::mutex> guard(lock);
+                if(!error) {
+                    error = std::current_exception();
+                }
+            }
+            if(finished_tasks.fetch_add(1, std::memory_order_acq_rel) + 1 == current.tasks) {
+                std::lock_guard<std::mutex> guard(lock);
+                if(generation == current.generation) {
+                    done.notify_all();
+                }
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,973 @@
+#ifndef XD_PERSISTENT_VECTOR_H
+#define XD_PERSISTENT_VECTOR_H
+#include <atomic>
+#include <iterator>
+#include "vector.hpp"
+
+
+namespace xd {
+
+    namespace detail {
+        constexpr size_t trie_bits = 5;
+        constexpr size_t trie_width = size_t(1) << trie_bits;
+        constexpr size_t trie_mask = trie_width - 1;
+
+        //! Header of every trie node. Nodes are shared between versions so
+        //! the count of owners is atomic, a node owned once can be edited
+        //! in place. count is live elements in a leaf, children in a branch.
+        struct trie_node {
+            trie_node() noexcept: refs(1), count(0) {}
+
+            std::atomic<uint32_t> refs;
+            uint32_t count;
+        };
+
+        template<typename T>
+        struct trie_leaf: trie_node {
+            T* elements() noexcept { return reinterpret_cast<T*>(buffer); }
+            const T* elements() const noexcept { return reinterpret_cast<const T*>(buffer); }
+
+            alignas(T) unsigned char buffer[trie_width*sizeof(T)];
+        };
+
+        struct trie_branch: trie_node {
+            trie_node* children[trie_width];
+        };
+
+        //! Bit partitioned trie of 32 way nodes with the last partial leaf
+        //! kept out of the tree as a tail, so most appends never walk it.
+        //! Edits copy each shared node on the path they change and reuse
+        //! the ones they own outright, the same code gives path copying
+        //! for persistent versions and in place updates for transients.
+        template<typename T>
+        class trie {
+        public:
+            trie() noexcept;
+            trie(const trie& other) noexcept;
+            trie(trie&& other) noexcept;
+            ~trie();
+
+            trie& operator=(const trie& other) noexcept;
+            trie& operator=(trie&& other) noexcept;
+
+            //! Fills whole leaves straight from the range and hangs each one
+            //! in the tree, rather than appending element by element
+            template<typename InputIt>
+            void assign(InputIt first, InputIt last);
+
+            template<typename... Args>
+            void emplace_back(Args&&... args);
+            void set(size_t index, T value);
+            void pop_back();
+
+            //! Start of the leaf holding index
+            const T* leaf_for(size_t index) const noexcept;
+            //! Appends every element to out a leaf at a time
+            template<typename Vector>
+            void append_to(Vector& out) const;
+
+            size_t size() const noexcept { return raw_size; }
+
+            void swap(trie& other) noexcept;
+
+            //! True if both hold the very same nodes
+            bool same_nodes(const trie& other) const noexcept;
+        private:
+            using leaf = trie_leaf<T>;
+            using alloc_traits = std::allocator_traits<std::allocator<T>>;
+
+            //! Index of the first element in the tail
+            size_t tail_offset() const noexcept;
+            //! Leaf in the tree holding index, which is before the tail
+            leaf* tree_leaf(size_t index) const noexcept;
+
+            static leaf* make_leaf();
+            static trie_branch* make_branch();
+            static void retain(trie_node* node) noexcept;
+            //! Drops a reference, freeing the node and then its children
+            //! when it was the last. level is 0 for leaves.
+            static void release(trie_node* node, size_t level) noexcept;
+            //! node if this is its only owner, otherwise a private copy
+            //! that replaces our reference to it
+            static leaf* unique_leaf(trie_node* node);
+            static trie_branch* unique_branch(trie_node* node, size_t level);
+            //! Chain of single child branches from level down to node
+            static trie_node* new_path(size_t level, trie_node* node);
+
+            //! Moves the full tail into the tree
+            void push_tail();
+            void push_leaf(trie_branch* branch, size_t level, trie_node* node);
+            //! Removes the last leaf of the tree, which the caller has retained
+            void pop_leaf(trie_branch* branch, size_t level);
+
+            //! Number of elements
+            size_t raw_size;
+            //! Bits of the index consumed above the leaves, a multiple of 5
+            size_t shift;
+            //! Branch at the top of the tree, nullptr while the tail holds everything
+            trie_node* root;
+            //! Last 1 to 32 elements, nullptr when empty
+            leaf* tail;
+        };
+
+        //! Random access iterator caching the leaf it's in, it only walks
+        //! the trie again when it crosses into another leaf
+        template<typename T>
+        class trie_iterator {
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const T*;
+            using reference = const T&;
+
+            trie_iterator() noexcept: owner(nullptr), index(0), elements(nullptr) {}
+            trie_iterator(const trie<T>* owner, size_t index) noexcept:
+            owner(owner),
+            index(index),
+            elements(owner->leaf_for(index)) {
+            }
+
+            reference operator*() const noexcept { return elements[index & trie_mask]; }
+            pointer operator->() const noexcept { return elements + (index & trie_mask); }
+            reference operator[](difference_type n) const noexcept {
+                const size_t i = index + n;
+                return owner->leaf_for(i)[i & trie_mask];
+            }
+
+            trie_iterator& operator++() noexcept {
+                index++;
+                if((index & trie_mask) == 0) {
+                    elements = owner->leaf_for(index);
+                }
+                return *this;
+            }
+            trie_iterator operator++(int) noexcept { auto tmp = *this; ++*this; return tmp; }
+            trie_iterator& operator--() noexcept {
+                // end() has no leaf cached, so stepping back from it
+                // reloads too
+                if(elements == nullptr || (index & trie_mask) == 0) {
+                    elements = owner->leaf_for(index - 1);
+                }
+                index--;
+                return *this;
+            }
+            trie_iterator operator--(int) noexcept { auto tmp = *this; --*this; return tmp; }
+            trie_iterator& operator+=(difference_type n) noexcept {
+                index += n;
+                elements = owner->leaf_for(index);
+                return *this;
+            }
+            trie_iterator& operator-=(difference_type n) noexcept { return *this += -n; }
+            trie_iterator operator+(difference_type n) const noexcept { return trie_iterator(owner, index + n); }
+            trie_iterator operator-(difference_type n) const noexcept { return trie_iterator(owner, index - n); }
+            difference_type operator-(const trie_iterator& other) const noexcept {
+                return difference_type(index) - difference_type(other.index);
+            }
+
+            bool operator==(const trie_iterator& other) const noexcept { return index == other.index; }
+            bool operator!=(const trie_iterator& other) const noexcept { return index != other.index; }
+            bool operator<(const trie_iterator& other) const noexcept { return index < other.index; }
+            bool operator>(const trie_iterator& other) const noexcept { return index > other.index; }
+            bool operator<=(const trie_iterator& other) const noexcept { return index <= other.index; }
+            bool operator>=(const trie_iterator& other) const noexcept { return index >= other.index; }
+        private:
+            const trie<T>* owner;
+            size_t index;
+            //! Leaf holding index, nullptr past the end
+            const T* elements;
+        };
+    }
+
+    template<typename T, typename BoundsCheck>
+    class transient_vector;
+
+    //! Immutable vector where every edit returns a new version sharing all
+    //! the nodes it didn't change with the old one. Copies are O(1) and a
+    //! copy is a consistent snapshot, so readers on other threads can hold
+    //! versions while a writer keeps producing new ones. Nodes are freed
+    //! by whichever version lets go of them last.
+    //!
+    //! Edits on an rvalue reuse the nodes only that version owns, so
+    //! v = std::move(v).push_back(x) doesn't copy the tail each time. For
+    //! batches of edits use transient().
+    template<typename T, typename BoundsCheck = default_bounds_check>
+    class persistent_vector {
+    public:
+        using reference = const T&;
+        using const_reference = const T&;
+        using value_type = T;
+        using iterator = detail::trie_iterator<T>;
+        using const_iterator = detail::trie_iterator<T>;
+        using transient_type = transient_vector<T, BoundsCheck>;
+
+        persistent_vector() noexcept = default;
+        persistent_vector(const persistent_vector& other) noexcept = default;
+        persistent_vector(persistent_vector&& other) noexcept = default;
+        template<typename InputIt, typename = detail::require_input_iterator<InputIt>>
+        persistent_vector(InputIt first, InputIt last);
+        persistent_vector(std::initializer_list<T> l);
+        //! Copies v a leaf at a time
+        template<typename Allocator, typename Growth, typename VectorBounds>
+        explicit persistent_vector(const vector<T, Allocator, Growth, VectorBounds>& v);
+        //! Moves the elements out of v, leaving it empty
+        template<typename Allocator, typename Growth, typename VectorBounds>
+        explicit persistent_vector(vector<T, Allocator, Growth, VectorBounds>&& v);
+
+        persistent_vector& operator=(const persistent_vector& other) noexcept = default;
+        persistent_vector& operator=(persistent_vector&& other) noexcept = default;
+
+        persistent_vector push_back(T value) const&;
+        persistent_vector push_back(T value) &&;
+
+        //! Version with the element at index replaced, throws
+        //! std::out_of_range on a bad index
+        persistent_vector set(size_t index, T value) const&;
+        persistent_vector set(size_t index, T value) &&;
+
+        persistent_vector pop_back() const&;
+        persistent_vector pop_back() &&;
+
+        //! Mutable builder starting from this version, O(1)
+        transient_type transient() const& noexcept;
+        transient_type transient() && noexcept;
+
+        const_reference operator[](size_t index) const;
+        const_reference at(size_t index) const;
+        const_reference front() const;
+        const_reference back() const;
+
+        size_t size() const noexcept;
+        bool empty() const noexcept;
+
+        //! Copies the elements into a contiguous vector a leaf at a time
+        vector<T> to_vector() const;
+
+        void swap(persistent_vector& other) noexcept;
+
+        const_iterator begin() const noexcept;
+        const_iterator cbegin() const noexcept;
+        const_iterator end() const noexcept;
+        const_iterator cend() const noexcept;
+    private:
+        friend class transient_vector<T, BoundsCheck>;
+        template<typename U, typename B>
+        friend bool operator==(const persistent_vector<U, B>& lhs, const persistent_vector<U, B>& rhs);
+
+        explicit persistent_vector(const detail::trie<T>& tree) noexcept;
+        explicit persistent_vector(detail::trie<T>&& tree) noexcept;
+
+        detail::trie<T> tree;
+    };
+
+    //! Mutable builder over the same trie as persistent_vector. Nodes it
+    //! owns alone are edited in place, so a batch of edits only copies the
+    //! shared nodes it touches once. persistent() hands out a snapshot in
+    //! O(1), after which the transient copies what it shares again.
+    template<typename T, typename BoundsCheck = default_bounds_check>
+    class transient_vector {
+    public:
+        using reference = const T&;
+        using const_reference = const T&;
+        using value_type = T;
+        using iterator = detail::trie_iterator<T>;
+        using const_iterator = detail::trie_iterator<T>;
+        using persistent_type = persistent_vector<T, BoundsCheck>;
+
+        transient_vector() noexcept = default;
+        transient_vector(const transient_vector& other) noexcept = default;
+        transient_vector(transient_vector&& other) noexcept = default;
+
+        transient_vector& operator=(const transient_vector& other) noexcept = default;
+        transient_vector& operator=(transient_vector&& other) noexcept = default;
+
+        void push_back(const_reference value);
+        void push_back(T&& value);
+
+        template<typename... Args>
+        void emplace_back(Args&&... args);
+
+        //! Replaces the element at index, throws std::out_of_range on a bad index
+        void set(size_t index, T value);
+
+        void pop_back();
+
+        //! Snapshot of the current contents, O(1)
+        persistent_type persistent() const& noexcept;
+        persistent_type persistent() && noexcept;
+
+        const_reference operator[](size_t index) const;
+        const_reference at(size_t index) const;
+        const_reference front() const;
+        const_reference back() const;
+
+        size_t size() const noexcept;
+        bool empty() const noexcept;
+
+        void swap(transient_vector& other) noexcept;
+
+        const_iterator begin() const noexcept;
+        const_iterator cbegin() const noexcept;
+        const_iterator end() const noexcept;
+        const_iterator cend() const noexcept;
+    private:
+        friend class persistent_vector<T, BoundsCheck>;
+
+        explicit transient_vector(const detail::trie<T>& tree) noexcept;
+        explicit transient_vector(detail::trie<T>&& tree) noexcept;
+
+        detail::trie<T> tree;
+    };
+
+    template<typename T, typename B>
+    bool operator==(const persistent_vector<T, B>& lhs, const persistent_vector<T, B>& rhs) {
+        if(lhs.tree.same_nodes(rhs.tree)) {
+            return true;
+        }
+        return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+
+    template<typename T, typename B>
+    bool operator!=(const persistent_vector<T, B>& lhs, const persistent_vector<T, B>& rhs) {
+        return !(lhs == rhs);
+    }
+
+    template<typename T, typename B>
+    bool operator<(const persistent_vector<T, B>& lhs, const persistent_vector<T, B>& rhs) {
+        return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+
+    namespace detail {
+        template<typename T>
+        trie<T>::trie() noexcept:
+        raw_size(0),
+        shift(trie_bits),
+        root(nullptr),
+        tail(nullptr) {
+        }
+
+        template<typename T>
+        trie<T>::trie(const trie& other) noexcept:
+        raw_size(other.raw_size),
+        shift(other.shift),
+        root(other.root),
+        tail(other.tail) {
+            retain(root);
+            retain(tail);
+        }
+
+        template<typename T>
+        trie<T>::trie(trie&& other) noexcept:
+        raw_size(other.raw_size),
+        shift(other.shift),
+        root(other.root),
+        tail(other.tail) {
+            other.raw_size = 0;
+            other.shift = trie_bits;
+            other.root = nullptr;
+            other.tail = nullptr;
+        }
+
+        template<typename T>
+        trie<T>::~trie() {
+            release(root, shift);
+            release(tail, 0);
+        }
+
+        template<typename T>
+        trie<T>& trie<T>::operator=(const trie& other) noexcept {
+            trie tmp(other);
+            swap(tmp);
+            return *this;
+        }
+
+        template<typename T>
+        trie<T>& trie<T>::operator=(trie&& other) noexcept {
+            trie tmp(std::move(other));
+            swap(tmp);
+            return *this;
+        }
+
+        template<typename T>
+        template<typename InputIt>
+        void trie<T>::assign(InputIt first, InputIt last) {
+            trie built;
+            if constexpr(is_forward_iterator_v<InputIt>) {
+                std::allocator<T> alloc;
+                size_t remaining = std::distance(first, last);
+                while(remaining > 0) {
+                    const size_t n = std::min(trie_width, remaining);
+                    InputIt next = std::next(first, n);
+                    leaf* node = make_leaf();
+                    try {
+                        uninitialized_copy(alloc, first, next, node->elements());
+                        node->count = n;
+                        if(built.tail != nullptr) {
+                            built.push_tail();
+                        }
+                    } catch(...) {
+                        release(node, 0);
+                        throw;
+                    }
+                    built.tail = node;
+                    built.raw_size += n;
+                    remaining -= n;
+                    first = next;
+                }
+            } else {
+                for(; first != last; ++first) {
+                    built.emplace_back(*first);
+                }
+            }
+            swap(built);
+        }
+
+        template<typename T>
+        template<typename... Args>
+        void trie<T>::emplace_back(Args&&... args) {
+            std::allocator<T> alloc;
+            if(tail != nullptr && tail->count < trie_width) {
+                tail = unique_leaf(tail);
+                alloc_traits::construct(alloc, tail->elements() + tail->count, std::forward<Args>(args)...);
+                tail->count++;
+            } else {
+                leaf* fresh = make_leaf();
+                try {
+                    alloc_traits::construct(alloc, fresh->elements(), std::forward<Args>(args)...);
+                    fresh->count = 1;
+                    if(tail != nullptr) {
+                        push_tail();
+                    }
+                } catch(...) {
+                    release(fresh, 0);
+                    throw;
+                }
+                tail = fresh;
+            }
+            raw_size++;
+        }
+
+        template<typename T>
+        void trie<T>::set(size_t index, T value) {
+            if(!(index < raw_size)) {
+                throw std::out_of_range("Attempted to set element out of range");
+            }
+            if(index >= tail_offset()) {
+                tail = unique_leaf(tail);
+                tail->elements()[index & trie_mask] = std::move(value);
+                return;
+            }
+            trie_branch* node = unique_branch(root, shift);
+            root = node;
+            for(size_t level = shift; level > trie_bits; level -= trie_bits) {
+                trie_node*& child = node->children[(index >> level) & trie_mask];
+                child = unique_branch(child, level - trie_bits);
+                node = static_cast<trie_branch*>(child);
+            }
+            trie_node*& child = node->children[(index >> trie_bits) & trie_mask];
+            child = unique_leaf(child);
+            static_cast<leaf*>(child)->elements()[index & trie_mask] = std::move(value);
+        }
+
+        template<typename T>
+        void trie<T>::pop_back() {
+            if(raw_size == 0) {
+                return;
+            }
+            if(tail->count > 1) {
+                tail = unique_leaf(tail);
+                tail->count--;
+                std::allocator<T> alloc;
+                alloc_traits::destroy(alloc, tail->elements() + tail->count);
+            } else if(raw_size == 1) {
+                release(tail, 0);
+                tail = nullptr;
+            } else {
+                // The last leaf of the tree becomes the tail
+                leaf* last = tree_leaf(raw_size - 2);
+                retain(last);
+                try {
+                    root = unique_branch(root, shift);
+                    pop_leaf(static_cast<trie_branch*>(root), shift);
+                } catch(...) {
+                    release(last, 0);
+                    throw;
+                }
+                release(tail, 0);
+                tail = last;
+                if(root->count == 0) {
+                    release(root, shift);
+                    root = nullptr;
+                    shift = trie_bits;
+                }
+                while(root != nullptr && shift > trie_bits && root->count == 1) {
+                    trie_node* child = static_cast<trie_branch*>(root)->children[0];
+                    retain(child);
+                    release(root, shift);
+                    root = child;
+                    shift -= trie_bits;
+                }
+            }
+            raw_size--;
+        }
+
+        template<typename T>
+        const T* trie<T>::leaf_for(size_t index) const noexcept {
+            if(index >= raw_size) {
+                return nullptr;
+            }
+            if(index >= tail_offset()) {
+                return tail->elements();
+            }
+            return tree_leaf(index)->elements();
+        }
+
+        template<typename T>
+        template<typename Vector>
+        void trie<T>::append_to(Vector& out) const {
+            out.reserve(out.size() + raw_size);
+            for(size_t i=0; i<raw_size; i+=trie_width) {
+                const T* elements = leaf_for(i);
+                out.insert(out.end(), elements, elements + std::min(trie_width, raw_size - i));
+            }
+        }
+
+        template<typename T>
+        void trie<T>::swap(trie& other) noexcept {
+            std::swap(raw_size, other.raw_size);
+            std::swap(shift, other.shift);
+            std::swap(root, other.root);
+            std::swap(tail, other.tail);
+        }
+
+        template<typename T>
+        bool trie<T>::same_nodes(const trie& other) const noexcept {
+            return root == other.root && tail == other.tail;
+        }
+
+        template<typename T>
+        size_t trie<T>::tail_offset() const noexcept {
+            return raw_size == 0 ? 0 : ((raw_size - 1) >> trie_bits) << trie_bits;
+        }
+
+        template<typename T>
+        trie_leaf<T>* trie<T>::tree_leaf(size_t index) const noexcept {
+            trie_node* node = root;
+            for(size_t level = shift; level > 0; level -= trie_bits) {
+                node = static_cast<trie_branch*>(node)->children[(index >> level) & trie_mask];
+            }
+            return static_cast<leaf*>(node);
+        }
+
+        template<typename T>
+        trie_leaf<T>* trie<T>::make_leaf() {
+            return new leaf();
+        }
+
+        template<typename T>
+        trie_branch* trie<T>::make_branch() {
+            return new trie_branch();
+        }
+
+        template<typename T>
+        void trie<T>::retain(trie_node* node) noexcept {
+            if(node != nullptr) {
+                node->refs.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        template<typename T>
+        void trie<T>::release(trie_node* node, size_t level) noexcept {
+            if(node == nullptr || node->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+                return;
+            }
+            if(level == 0) {
+                leaf* l = static_cast<leaf*>(node);
+                std::allocator<T> alloc;
+                for(uint32_t i=0; i<l->count; i++) {
+                    alloc_traits::destroy(alloc, l->elements() + i);
+                }
+                delete l;
+            } else {
+                trie_branch* branch = static_cast<trie_branch*>(node);
+                for(uint32_t i=0; i<branch->count; i++) {
+                    release(branch->children[i], level - trie_bits);
+                }
+                delete branch;
+            }
+        }
+
+        template<typename T>
+        trie_leaf<T>* trie<T>::unique_leaf(trie_node* node) {
+            leaf* original = static_cast<leaf*>(node);
+            if(original->refs.load(std::memory_order_acquire) == 1) {
+                return original;
+            }
+            leaf* copy = make_leaf();
+            std::allocator<T> alloc;
+            try {
+                const T* first = original->elements();
+                uninitialized_copy(alloc, first, first + original->count, copy->elements());
+            } catch(...) {
+                delete copy;
+                throw;
+            }
+            copy->count = original->count;
+            release(original, 0);
+            return copy;
+        }
+
+        template<typename T>
+        trie_branch* trie<T>::unique_branch(trie_node* node, size_t level) {
+            trie_branch* original = static_cast<trie_branch*>(node);
+            if(original->refs.load(std::memory_order_acquire) == 1) {
+                return original;
+            }
+            trie_branch* copy = make_branch();
+            copy->count = original->count;
+            for(uint32_t i=0; i<original->count; i++) {
+                copy->children[i] = original->children[i];
+                retain(copy->children[i]);
+            }
+            release(original, level);
+            return copy;
+        }
+
+        template<typename T>
+        trie_node* trie<T>::new_path(size_t level, trie_node* node) {
+            trie_node* top = node;
+            try {
+                for(; level > 0; level -= trie_bits) {
+                    trie_branch* branch = make_branch();
+                    branch->children[0] = top;
+                    branch->count = 1;
+                    top = branch;
+                }
+            } catch(...) {
+                // Free the branches made so far but not node, the caller owns it
+                while(top != node) {
+                    trie_branch* branch = static_cast<trie_branch*>(top);
+                    top = branch->children[0];
+                    delete branch;
+                }
+                throw;
+            }
+            return top;
+        }
+
+        template<typename T>
+        void trie<T>::push_tail() {
+            // raw_size counts the full tail so this is the leaf count after the push
+            const size_t leaves = raw_size >> trie_bits;
+            if(root == nullptr) {
+                trie_branch* branch = make_branch();
+                branch->children[0] = tail;
+                branch->count = 1;
+                root = branch;
+                shift = trie_bits;
+            } else if(leaves > (size_t(1) << shift)) {
+                trie_branch* top = make_branch();
+                try {
+                    top->children[1] = new_path(shift, tail);
+                } catch(...) {
+                    delete top;
+                    throw;
+                }
+                top->children[0] = root;
+                top->count = 2;
+                root = top;
+                shift += trie_bits;
+            } else {
+                trie_branch* branch = unique_branch(root, shift);
+                root = branch;
+                push_leaf(branch, shift, tail);
+            }
+            tail = nullptr;
+        }
+
+        template<typename T>
+        void trie<T>::push_leaf(trie_branch* branch, size_t level, trie_node* node) {
+            const size_t index = ((raw_size - 1) >> level) & trie_mask;
+            if(level == trie_bits) {
+                branch->children[index] = node;
+                branch->count = index + 1;
+            } else if(index < branch->count) {
+                trie_branch* child = unique_branch(branch->children[index], level - trie_bits);
+                branch->children[index] = child;
+                push_leaf(child, level - trie_bits, node);
+            } else {
+                branch->children[index] = new_path(level - trie_bits, node);
+                branch->count = index + 1;
+            }
+        }
+
+        template<typename T>
+        void trie<T>::pop_leaf(trie_branch* branch, size_t level) {
+            const size_t index = ((raw_size - 2) >> level) & trie_mask;
+            if(level == trie_bits) {
+                release(branch->children[index], 0);
+                branch->count = index;
+                return;
+            }
+            trie_branch* child = unique_branch(branch->children[index], level - trie_bits);
+            branch->children[index] = child;
+            pop_leaf(child, level - trie_bits);
+            if(child->count == 0) {
+                release(child, level - trie_bits);
+                branch->count = index;
+            }
+        }
+    }
+
+    template<typename T, typename BoundsCheck>
+    template<typename InputIt, typename>
+    persistent_vector<T, BoundsCheck>::persistent_vector(InputIt first, InputIt last) {
+        tree.assign(first, last);
+    }
+
+    template<typename T, typename BoundsCheck>
+    persistent_vector<T, BoundsCheck>::persistent_vector(std::initializer_list<T> il) {
+        tree.assign(il.begin(), il.end());
+    }
+
+    template<typename T, typename BoundsCheck>
+    template<typename Allocator, typename Growth, typename VectorBounds>
+    persistent_vector<T, BoundsCheck>::persistent_vector(const vector<T, Allocator, Growth, VectorBounds>& v) {
+        tree.assign(v.begin(), v.end());
+    }
+
+    template<typename T, typename BoundsCheck>
+    template<typename Allocator, typename Growth, typename VectorBounds>
+    persistent_vector<T, BoundsCheck>::persistent_vector(vector<T, Allocator, Growth, VectorBounds>&& v) {
+        tree.assign(std::make_move_iterator(v.begin()), std::make_move_iterator(v.end()));
+        v.clear();
+    }
+
+    template<typename T, typename BoundsCheck>
+    persistent_vector<T, BoundsCheck>::persistent_vector(const detail::trie<T>& tree) noexcept:
+    tree(tree) {
+    }
+
+    template<typename T, typename BoundsCheck>
+    persistent_vector<T, BoundsCheck>::persistent_vector(detail::trie<T>&& tree) noexcept:
+    tree(std::move(tree)) {
+    }
+
+    template<typename T, typename BoundsCheck>
+    persistent_vector<T, BoundsCheck> persistent_vector<T, BoundsCheck>::push_back(T value) const& {
+        return persistent_vector(*this).push_back(std::move(value));
+    }
+
+    template<typename T, typename BoundsCheck>
+    persistent_vector<T, BoundsCheck> persistent_vector<T, BoundsCheck>::push_back(T value) && {
+        tree.emplace_back(std::move(value));
+        return std::move(*this);
+    }
+
+    template<typename T, typename BoundsCheck>
+    persistent_vector<T, BoundsCheck> persistent_vector<T, BoundsCheck>::set(size_t index, T value) const& {
+        return persistent_vector(*this).set(index, std::move(value));
+    }
+
+    template<typename T, typename BoundsCheck>
+    persistent_vector<T, BoundsCheck> persistent_vector<T, BoundsCheck>::set(size_t index, T value) && {
+        tree.set(index, std::move(value));
+        return std::move(*this);
+    }
+
+    template<typename T, typename BoundsCheck>
+    persistent_vector<T, BoundsCheck> persistent_vector<T, BoundsCheck>::pop_back() const& {
+        return persistent_vector(*this).pop_back();
+    }
+
+    template<typename T, typename BoundsCheck>
+    persistent_vector<T, BoundsCheck> persistent_vector<T, BoundsCheck>::pop_back() && {
+        tree.pop_back();
+        return std::move(*this);
+    }
+
+    template<typename T, typename BoundsCheck>
+    transient_vector<T, BoundsCheck> persistent_vector<T, BoundsCheck>::transient() const& noexcept {
+        return transient_type(tree);
+    }
+
+    template<typename T, typename BoundsCheck>
+    transient_vector<T, BoundsCheck> persistent_vector<T, BoundsCheck>::transient() && noexcept {
+        return transient_type(std::move(tree));
+    }
+
+    template<typename T, typename BoundsCheck>
+    const T& persistent_vector<T, BoundsCheck>::operator[](size_t index) const {
+        BoundsCheck::check(index, size());
+        return tree.leaf_for(index)[index & detail::trie_mask];
+    }
+
+    template<typename T, typename BoundsCheck>
+    const T& persistent_vector<T, BoundsCheck>::at(size_t index) const {
+        if(!(index < size())) {
+            throw std::out_of_range("Attempted to access element out of range");
+        }
+        return tree.leaf_for(index)[index & detail::trie_mask];
+    }
+
+    template<typename T, typename BoundsCheck>
+    const T& persistent_vector<T, BoundsCheck>::front() const {
+        return (*this)[0];
+    }
+
+    template<typename T, typename BoundsCheck>
+    const T& persistent_vector<T, BoundsCheck>::back() const {
+        BoundsCheck::check(0, size());
+        return (*this)[size() - 1];
+    }
+
+    template<typename T, typename BoundsCheck>
+    size_t persistent_vector<T, BoundsCheck>::size() const noexcept {
+        return tree.size();
+    }
+
+    template<typename T, typename BoundsCheck>
+    bool persistent_vector<T, BoundsCheck>::empty() const noexcept {
+        return size() == 0;
+    }
+
+    template<typename T, typename BoundsCheck>
+    vector<T> persistent_vector<T, BoundsCheck>::to_vector() const {
+        vector<T> result;
+        tree.append_to(result);
+        return result;
+    }
+
+    template<typename T, typename BoundsCheck>
+    void persistent_vector<T, BoundsCheck>::swap(persistent_vector& other) noexcept {
+        tree.swap(other.tree);
+    }
+
+    template<typename T, typename BoundsCheck>
+    detail::trie_iterator<T> persistent_vector<T, BoundsCheck>::begin() const noexcept {
+        return const_iterator(&tree, 0);
+    }
+
+    template<typename T, typename BoundsCheck>
+    detail::trie_iterator<T> persistent_vector<T, BoundsCheck>::cbegin() const noexcept {
+        return begin();
+    }
+
+    template<typename T, typename BoundsCheck>
+    detail::trie_iterator<T> persistent_vector<T, BoundsCheck>::end() const noexcept {
+        return const_iterator(&tree, size());
+    }
+
+    template<typename T, typename BoundsCheck>
+    detail::trie_iterator<T> persistent_vector<T, BoundsCheck>::cend() const noexcept {
+        return end();
+    }
+
+    template<typename T, typename BoundsCheck>
+    transient_vector<T, BoundsCheck>::transient_vector(const detail::trie<T>& tree) noexcept:
+    tree(tree) {
+    }
+
+    template<typename T, typename BoundsCheck>
+    transient_vector<T, BoundsCheck>::transient_vector(detail::trie<T>&& tree) noexcept:
+    tree(std::move(tree)) {
+    }
+
+    template<typename T, typename BoundsCheck>
+    void transient_vector<T, BoundsCheck>::push_back(const T& value) {
+        tree.emplace_back(value);
+    }
+
+    template<typename T, typename BoundsCheck>
+    void transient_vector<T, BoundsCheck>::push_back(T&& value) {
+        tree.emplace_back(std::move(value));
+    }
+
+    template<typename T, typename BoundsCheck>
+    template<typename... Args>
+    void transient_vector<T, BoundsCheck>::emplace_back(Args&&... args) {
+        tree.emplace_back(std::forward<Args>(args)...);
+    }
+
+    template<typename T, typename BoundsCheck>
+    void transient_vector<T, BoundsCheck>::set(size_t index, T value) {
+        tree.set(index, std::move(value));
+    }
+
+    template<typename T, typename BoundsCheck>
+    void transient_vector<T, BoundsCheck>::pop_back() {
+        tree.pop_back();
+    }
+
+    template<typename T, typename BoundsCheck>
+    persistent_vector<T, BoundsCheck> transient_vector<T, BoundsCheck>::persistent() const& noexcept {
+        return persistent_type(tree);
+    }
+
+    template<typename T, typename BoundsCheck>
+    persistent_vector<T, BoundsCheck> transient_vector<T, BoundsCheck>::persistent() && noexcept {
+        return persistent_type(std::move(tree));
+    }
+
+    template<typename T, typename BoundsCheck>
+    const T& transient_vector<T, BoundsCheck>::operator[](size_t index) const {
+        BoundsCheck::check(index, size());
+        return tree.leaf_for(index)[index & detail::trie_mask];
+    }
+
+    template<typename T, typename BoundsCheck>
+    const T& transient_vector<T, BoundsCheck>::at(size_t index) const {
+        if(!(index < size())) {
+            throw std::out_of_range("Attempted to access element out of range");
+        }
+        return tree.leaf_for(index)[index & detail::trie_mask];
+    }
+
+    template<typename T, typename BoundsCheck>
+    const T& transient_vector<T, BoundsCheck>::front() const {
+        return (*this)[0];
+    }
+
+    template<typename T, typename BoundsCheck>
+    const T& transient_vector<T, BoundsCheck>::back() const {
+        BoundsCheck::check(0, size());
+        return (*this)[size() - 1];
+    }
+
+    template<typename T, typename BoundsCheck>
+    size_t transient_vector<T, BoundsCheck>::size() const noexcept {
+        return tree.size();
+    }
+
+    template<typename T, typename BoundsCheck>
+    bool transient_vector<T, BoundsCheck>::empty() const noexcept {
+        return size() == 0;
+    }
+
+    template<typename T, typename BoundsCheck>
+    void transient_vector<T, BoundsCheck>::swap(transient_vector& other) noexcept {
+        tree.swap(other.tree);
+    }
+
+    template<typename T, typename BoundsCheck>
+    detail::trie_iterator<T> transient_vector<T, BoundsCheck>::begin() const noexcept {
+        return const_iterator(&tree, 0);
+    }
+
+    template<typename T, typename BoundsCheck>
+    detail::trie_iterator<T> transient_vector<T, BoundsCheck>::cbegin() const noexcept {
+        return begin();
+    }
+
+    template<typename T, typename BoundsCheck>
+    detail::trie_iterator<T> transient_vector<T, BoundsCheck>::end() const noexcept {
+        return const_iterator(&tree, size());
+    }
+
+    template<typename T, typename BoundsCheck>
+    detail::trie_iterator<T> transient_vector<T, BoundsCheck>::cend() const noexcept {
+        return end();
+    }
+}
+
+#endif
@@ -0,0 +1,156 @@
+#ifndef XD_REALLOC_ALLOCATOR_H
+#define XD_REALLOC_ALLOCATOR_H
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define XD_HAS_MMAP 1
+#endif
+
+
+namespace xd {
+
+    //! Allocator that can grow blocks in place. Blocks below MapThreshold
+    //! bytes come from malloc and are resized with realloc, larger ones are
+    //! mapped pages and resized with mremap on Linux so growth rarely needs
+    //! to copy. xd::vector uses the reallocate path for trivially
+    //! relocatable element types.
+    template<typename T, size_t MapThreshold = (size_t(1) << 21)>
+    class realloc_allocator {
+    public:
+        using value_type = T;
+        using is_always_equal = std::true_type;
+
+        static_assert(alignof(T) <= alignof(std::max_align_t),
+                "realloc_allocator can't provide over-aligned storage");
+
+        template<typename U>
+        struct rebind {
+            using other = realloc_allocator<U, MapThreshold>;
+        };
+
+        realloc_allocator() noexcept = default;
+
+        template<typename U>
+        realloc_allocator(const realloc_allocator<U, MapThreshold>&) noexcept {}
+
+        T* allocate(size_t n);
+        void deallocate(T* p, size_t n) noexcept;
+
+        //! Resizes a block from old_n to new_n elements keeping the first
+        //! min(old_n, new_n) elements' bytes. The block may move.
+        T* reallocate(T* p, size_t old_n, size_t new_n);
+    private:
+        static bool is_mapped(size_t bytes) noexcept;
+        static size_t page_round(size_t bytes) noexcept;
+        static void* map(size_t bytes);
+    };
+
+    template<typename T, size_t A, typename U, size_t B>
+    bool operator==(const realloc_allocator<T, A>&, const realloc_allocator<U, B>&) {
+        return A == B;
+    }
+
+    template<typename T, size_t A, typename U, size_t B>
+    bool operator!=(const realloc_allocator<T, A>& lhs, const realloc_allocator<U, B>& rhs) {
+        return !(lhs == rhs);
+    }
+
+    template<typename T, size_t MapThreshold>
+    bool realloc_allocator<T, MapThreshold>::is_mapped(size_t bytes) noexcept {
+#ifdef XD_HAS_MMAP
+        return bytes >= MapThreshold;
+#else
+        return false;
+#endif
+    }
+
+    template<typename T, size_t MapThreshold>
+    size_t realloc_allocator<T, MapThreshold>::page_round(size_t bytes) noexcept {
+#ifdef XD_HAS_MMAP
+        static const size_t page = sysconf(_SC_PAGESIZE);
+        return (bytes + page - 1) & ~(page - 1);
+#else
+        return bytes;
+#endif
+    }
+
+    template<typename T, size_t MapThreshold>
+    void* realloc_allocator<T, MapThreshold>::map(size_t bytes) {
+#ifdef XD_HAS_MMAP
+        void* p = mmap(nullptr, page_round(bytes), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(p == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        return p;
+#else
+        (void)bytes;
+        throw std::bad_alloc();
+#endif
+    }
+
+    template<typename T, size_t MapThreshold>
+    T* realloc_allocator<T, MapThreshold>::allocate(size_t n) {
+        const size_t bytes = n*sizeof(T);
+        if(is_mapped(bytes)) {
+            return static_cast<T*>(map(bytes));
+        }
+        void* p = malloc(bytes);
+        if(p == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(p);
+    }
+
+    template<typename T, size_t MapThreshold>
+    void realloc_allocator<T, MapThreshold>::deallocate(T* p, size_t n) noexcept {
+        const size_t bytes = n*sizeof(T);
+        if(is_mapped(bytes)) {
+#ifdef XD_HAS_MMAP
+            munmap(p, page_round(bytes));
+#endif
+        } else {
+            free(p);
+        }
+    }
+
+    template<typename T, size_t MapThreshold>
+    T* realloc_allocator<T, MapThreshold>::reallocate(T* p, size_t old_n, size_t new_n) {
+        if(p == nullptr) {
+            return allocate(new_n);
+        }
+        const size_t old_bytes = old_n*sizeof(T);
+        const size_t new_bytes = new_n*sizeof(T);
+        const bool old_mapped = is_mapped(old_bytes);
+        const bool new_mapped = is_mapped(new_bytes);
+        if(!old_mapped && !new_mapped) {
+            void* q = realloc(p, new_bytes);
+            if(q == nullptr) {
+                throw std::bad_alloc();
+            }
+            return static_cast<T*>(q);
+        }
+#if defined(XD_HAS_MMAP) && defined(__linux__)
+        if(old_mapped && new_mapped) {
+            // The kernel moves the page table entries, no data is copied
+            void* q = mremap(p, page_round(old_bytes), page_round(new_bytes), MREMAP_MAYMOVE);
+            if(q == MAP_FAILED) {
+                throw std::bad_alloc();
+            }
+            return static_cast<T*>(q);
+        }
+#endif
+        // Crossing the threshold (or no mremap), copy to the new kind of block
+        T* q = allocate(new_n);
+        memcpy(static_cast<void*>(q), static_cast<const void*>(p), old_bytes < new_bytes ? old_bytes : new_bytes);
+        deallocate(p, old_n);
+        return q;
+    }
+}
+
+#endif
@@ -0,0 +1,346 @@
+#ifndef XD_SERIALIZE_H
+#define XD_SERIALIZE_H
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include "vector.hpp"
+
+
+namespace xd {
+
+    //! Version of the binary format written by serialize and stream_writer
+    constexpr uint8_t serial_version = 1;
+
+    namespace detail {
+        //! Flattens nested vectors down to the element type that is
+        //! actually written, depth is 0 for that element
+        template<typename T>
+        struct serial_traits {
+            using leaf = T;
+            static constexpr uint8_t depth = 0;
+        };
+
+        template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+        struct serial_traits<vector<T, Allocator, Growth, BoundsCheck>> {
+            using leaf = typename serial_traits<T>::leaf;
+            static constexpr uint8_t depth = serial_traits<T>::depth + 1;
+        };
+
+        constexpr char serial_magic[4] = {'X', 'D', 'V', 'S'};
+        constexpr uint8_t serial_little_endian = 1;
+        constexpr uint8_t serial_big_endian = 2;
+        //! Count used in the header by the chunked streaming format
+        constexpr uint64_t serial_streamed = std::numeric_limits<uint64_t>::max();
+        constexpr size_t serial_header_size = 20;
+        //! Most bytes read into a vector before checking the stream has more
+        constexpr size_t serial_read_chunk = 1<<20;
+
+        inline uint8_t native_endian() noexcept {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            return serial_big_endian;
+#else
+            return serial_little_endian;
+#endif
+        }
+
+        struct serial_header {
+            uint8_t version;
+            uint8_t endian;
+            uint8_t depth;
+            uint32_t element_size;
+            uint64_t count;
+        };
+
+        inline void write_bytes(std::ostream& os, const void* bytes, size_t n) {
+            if(n != 0 && !os.write(static_cast<const char*>(bytes), n)) {
+                throw std::runtime_error("Failed to write serialized vector");
+            }
+        }
+
+        inline void read_bytes(std::istream& is, void* bytes, size_t n) {
+            if(n != 0 && !is.read(static_cast<char*>(bytes), n)) {
+                throw std::runtime_error("Serialized vector is truncated");
+            }
+        }
+
+        inline void write_count(std::ostream& os, uint64_t count) {
+            write_bytes(os, &count, sizeof(count));
+        }
+
+        inline uint64_t read_count(std::istream& is) {
+            uint64_t count;
+            read_bytes(is, &count, sizeof(count));
+            return count;
+        }
+
+        inline void write_header(std::ostream& os, uint8_t depth, uint32_t element_size, uint64_t count) {
+            unsigned char buffer[serial_header_size] = {};
+            memcpy(buffer, serial_magic, 4);
+            buffer[4] = serial_version;
+            buffer[5] = native_endian();
+            buffer[6] = depth;
+            memcpy(buffer + 8, &element_size, 4);
+            memcpy(buffer + 12, &count, 8);
+            write_bytes(os, buffer, serial_header_size);
+        }
+
+        //! Reads and validates a header against the type being read into
+        inline serial_header read_header(std::istream& is, uint8_t depth, uint32_t element_size) {
+            unsigned char buffer[serial_header_size];
+            read_bytes(is, buffer, serial_header_size);
+            if(memcmp(buffer, serial_magic, 4) != 0) {
+                throw std::runtime_error("Not a serialized vector");
+            }
+            serial_header h;
+            h.version = buffer[4];
+            h.endian = buffer[5];
+            h.depth = buffer[6];
+            memcpy(&h.element_size, buffer + 8, 4);
+            memcpy(&h.count, buffer + 12, 8);
+            if(h.version != serial_version) {
+                throw std::runtime_error("Unsupported serialized vector version");
+            }
+            if(h.endian != native_endian()) {
+                throw std::runtime_error("Serialized vector has a different byte order");
+            }
+            if(h.depth != depth || h.element_size != element_size) {
+                throw std::runtime_error("Serialized vector holds a different element type");
+            }
+            return h;
+        }
+
+        template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+        void write_payload(std::ostream& os, const vector<T, Allocator, Growth, BoundsCheck>& vec) {
+            if constexpr(serial_traits<T>::depth == 0) {
+                write_bytes(os, vec.data(), vec.size()*sizeof(T));
+            } else {
+                for(const auto& inner: vec) {
+                    write_count(os, inner.size());
+                    write_payload(os, inner);
+                }
+            }
+        }
+
+        //! Appends count elements read from is to vec. The count comes from
+        //! the data so it isn't trusted, vec only grows as elements arrive.
+        template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+        void read_payload(std::istream& is, vector<T, Allocator, Growth, BoundsCheck>& vec, uint64_t count) {
+            if constexpr(serial_traits<T>::depth == 0) {
+                const size_t chunk = std::max<size_t>(serial_read_chunk/sizeof(T), 1);
+                while(count != 0) {
+                    const size_t n = count < chunk ? count : chunk;
+                    if(vec.capacity() - vec.size() < n) {
+                        vec.reserve(std::max(vec.size() + n, 2*vec.capacity()));
+                    }
+                    // Trivially copyable so the bytes read are the elements
+                    read_bytes(is, vec.data() + vec.size(), n*sizeof(T));
+                    vec.commit(n);
+                    count -= n;
+                }
+            } else {
+                for(; count != 0; count--) {
+                    vec.emplace_back();
+                    read_payload(is, vec.back(), read_count(is));
+                }
+            }
+        }
+    }
+
+    //! Writes vec to os as a header followed by the raw elements. Nested
+    //! vectors prefix each inner vector with its size.
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    void serialize(std::ostream& os, const vector<T, Allocator, Growth, BoundsCheck>& vec) {
+        using traits = detail::serial_traits<vector<T, Allocator, Growth, BoundsCheck>>;
+        static_assert(std::is_trivially_copyable<typename traits::leaf>::value,
+                "Only vectors of trivially copyable types can be serialized");
+        detail::write_header(os, traits::depth, sizeof(typename traits::leaf), vec.size());
+        detail::write_payload(os, vec);
+    }
+
+    //! Replaces the contents of vec with a vector written by serialize or
+    //! stream_writer. Throws std::runtime_error if the data is truncated or
+    //! was written for a different element type or byte order.
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    void deserialize(std::istream& is, vector<T, Allocator, Growth, BoundsCheck>& vec) {
+        using traits = detail::serial_traits<vector<T, Allocator, Growth, BoundsCheck>>;
+        static_assert(std::is_trivially_copyable<typename traits::leaf>::value,
+                "Only vectors of trivially copyable types can be serialized");
+        const auto h = detail::read_header(is, traits::depth, sizeof(typename traits::leaf));
+        vec.clear();
+        if(h.count != detail::serial_streamed) {
+            detail::read_payload(is, vec, h.count);
+            return;
+        }
+        while(const uint64_t chunk = detail::read_count(is)) {
+            detail::read_payload(is, vec, chunk);
+        }
+    }
+
+    template<typename Vector>
+    Vector deserialize(std::istream& is) {
+        Vector vec;
+        deserialize(is, vec);
+        return vec;
+    }
+
+    //! Writes elements in chunks without knowing the total count up front,
+    //! the output can be read back with deserialize or stream_reader
+    template<typename T>
+    class stream_writer {
+    public:
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be streamed");
+
+        //! Writes the header, elements passed to push_back are buffered and
+        //! written chunk_size at a time
+        explicit stream_writer(std::ostream& os, size_t chunk_size = 1<<16);
+        stream_writer(const stream_writer& other) = delete;
+        stream_writer& operator=(const stream_writer& other) = delete;
+        //! Calls finish, errors are swallowed so call it explicitly to see them
+        ~stream_writer();
+
+        void push_back(const T& value);
+
+        //! Writes count elements as a single chunk without copying them
+        void write(const T* values, size_t count);
+
+        template<typename Allocator, typename Growth, typename BoundsCheck>
+        void write(const vector<T, Allocator, Growth, BoundsCheck>& vec);
+
+        //! Writes any buffered elements as a chunk
+        void flush();
+
+        //! Flushes and writes the end of stream marker
+        void finish();
+    private:
+        std::ostream& os;
+        vector<T> buffer;
+        size_t chunk_size;
+        bool finished;
+    };
+
+    template<typename T>
+    stream_writer<T>::stream_writer(std::ostream& os, size_t chunk_size):
+    os(os),
+    buffer(),
+    chunk_size(chunk_size == 0 ? 1 : chunk_size),
+    finished(false) {
+        detail::write_header(os, 1, sizeof(T), detail::serial_streamed);
+    }
+
+    template<typename T>
+    stream_writer<T>::~stream_writer() {
+        try {
+            finish();
+        } catch(...) {
+        }
+    }
+
+    template<typename T>
+    void stream_writer<T>::push_back(const T& value) {
+        if(buffer.capacity() == 0) {
+            buffer.reserve(chunk_size);
+        }
+        buffer.push_back(value);
+        if(buffer.size() == chunk_size) {
+            flush();
+        }
+    }
+
+    template<typename T>
+    void stream_writer<T>::write(const T* values, size_t count) {
+        flush();
+        if(count != 0) {
+            detail::write_count(os, count);
+            detail::write_bytes(os, values, count*sizeof(T));
+        }
+    }
+
+    template<typename T>
+    template<typename Allocator, typename Growth, typename BoundsCheck>
+    void stream_writer<T>::write(const vector<T, Allocator, Growth, BoundsCheck>& vec) {
+        write(vec.data(), vec.size());
+    }
+
+    template<typename T>
+    void stream_writer<T>::flush() {
+        if(!buffer.empty()) {
+            detail::write_count(os, buffer.size());
+            detail::write_bytes(os, buffer.data(), buffer.size()*sizeof(T));
+            buffer.clear();
+        }
+    }
+
+    template<typename T>
+    void stream_writer<T>::finish() {
+        if(!finished) {
+            flush();
+            finished = true;
+            detail::write_count(os, 0);
+            os.flush();
+        }
+    }
+
+    //! Reads a stream written by stream_writer one chunk at a time, so a
+    //! consumer can process data from a pipe as it arrives
+    template<typename T>
+    class stream_reader {
+    public:
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be streamed");
+
+        //! Reads and validates the header
+        explicit stream_reader(std::istream& is);
+
+        //! Appends the next chunk to vec and returns the number of elements
+        //! read, 0 once the end of the stream is reached
+        template<typename Allocator, typename Growth, typename BoundsCheck>
+        size_t read_chunk(vector<T, Allocator, Growth, BoundsCheck>& vec);
+
+        bool done() const noexcept;
+    private:
+        std::istream& is;
+        //! Elements left when the header had a count, or serial_streamed
+        uint64_t remaining;
+        bool finished;
+    };
+
+    template<typename T>
+    stream_reader<T>::stream_reader(std::istream& is):
+    is(is),
+    remaining(detail::read_header(is, 1, sizeof(T)).count),
+    finished(false) {
+    }
+
+    template<typename T>
+    template<typename Allocator, typename Growth, typename BoundsCheck>
+    size_t stream_reader<T>::read_chunk(vector<T, Allocator, Growth, BoundsCheck>& vec) {
+        if(finished) {
+            return 0;
+        }
+        uint64_t count;
+        if(remaining == detail::serial_streamed) {
+            count = detail::read_count(is);
+        } else {
+            // Data from serialize is a single chunk
+            count = remaining;
+            remaining = 0;
+        }
+        if(count == 0) {
+            finished = true;
+            return 0;
+        }
+        detail::read_payload(is, vec, count);
+        return count;
+    }
+
+    template<typename T>
+    bool stream_reader<T>::done() const noexcept {
+        return finished;
+    }
+}
+
+#endif
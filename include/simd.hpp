@@ -0,0 +1,558 @@
+#ifndef XD_SIMD_H
+#define XD_SIMD_H
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+#if (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define XD_SIMD_X86 1
+#endif
+
+//! Under C++20, where std::allocator can be used in constant evaluation,
+//! the containers and these kernels are constexpr and fall back to plain
+//! loops when evaluated at compile time. Before that both are no-ops.
+#if defined(__cpp_lib_constexpr_dynamic_alloc) && __cpp_lib_constexpr_dynamic_alloc >= 201907L
+#define XD_CONSTEXPR_CONTAINERS 1
+#define XD_CONSTEXPR20 constexpr
+#define XD_IS_CONSTANT_EVALUATED() std::is_constant_evaluated()
+#else
+#define XD_CONSTEXPR_CONTAINERS 0
+#define XD_CONSTEXPR20
+#define XD_IS_CONSTANT_EVALUATED() false
+#endif
+
+
+//! Comparison, search and fill kernels for the containers. On x86 the
+//! AVX2 versions are compiled with target attributes and picked at
+//! runtime from CPUID, SSE2 is the baseline. Elsewhere, including i386
+//! builds without SSE2, they're scalar.
+namespace xd {
+    namespace detail {
+
+        //! Types whose == is the same as comparing their bytes, so no floats
+        //! (NaN, -0.0) and no class types with their own operator==
+        template<typename T>
+        inline constexpr bool is_bytewise_comparable_v = std::is_integral<T>::value ||
+                std::is_enum<T>::value || std::is_pointer<T>::value;
+
+        //! Types where memcmp order is the same as < on the elements
+        template<typename T>
+        inline constexpr bool is_memcmp_orderable_v = std::is_same<T, unsigned char>::value ||
+                std::is_same<T, std::byte>::value || std::is_same<T, bool>::value ||
+                (std::is_same<T, char>::value && !std::is_signed<char>::value);
+
+        //! Word-wise operations the bit containers combine with
+        enum class bit_op { and_, or_, xor_, and_not };
+
+        template<bit_op Op>
+        constexpr uint64_t apply_bit_op(uint64_t a, uint64_t b) noexcept {
+            if constexpr(Op == bit_op::and_) {
+                return a & b;
+            } else if constexpr(Op == bit_op::or_) {
+                return a | b;
+            } else if constexpr(Op == bit_op::xor_) {
+                return a ^ b;
+            } else {
+                return a & ~b;
+            }
+        }
+
+#ifdef XD_SIMD_X86
+        inline bool cpu_has_avx2() noexcept {
+            static const bool avx2 = []() {
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("avx2") != 0;
+            }();
+            return avx2;
+        }
+
+        __attribute__((target("avx2")))
+        inline size_t mismatch_bytes_avx2(const unsigned char* a, const unsigned char* b, size_t n) noexcept {
+            size_t i = 0;
+            for(; i + 32 <= n; i += 32) {
+                const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+                const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+                const unsigned diff = ~static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)));
+                if(diff != 0) {
+                    return i + __builtin_ctz(diff);
+                }
+            }
+            for(; i<n; i++) {
+                if(a[i] != b[i]) {
+                    return i;
+                }
+            }
+            return n;
+        }
+
+        inline size_t mismatch_bytes_sse2(const unsigned char* a, const unsigned char* b, size_t n) noexcept {
+            size_t i = 0;
+            for(; i + 16 <= n; i += 16) {
+                const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+                const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+                const unsigned diff = ~static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, y))) & 0xFFFF;
+                if(diff != 0) {
+                    return i + __builtin_ctz(diff);
+                }
+            }
+            for(; i<n; i++) {
+                if(a[i] != b[i]) {
+                    return i;
+                }
+            }
+            return n;
+        }
+
+        //! Bitmask of the byte lanes of data that belong to elements equal
+        //! to needle, E is the element size
+        template<size_t E>
+        __attribute__((target("avx2")))
+        inline unsigned match_mask_avx2(const unsigned char* data, __m256i needle) noexcept {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+            if constexpr(E == 1) {
+                return _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, needle));
+            } else if constexpr(E == 2) {
+                return _mm256_movemask_epi8(_mm256_cmpeq_epi16(x, needle));
+            } else if constexpr(E == 4) {
+                return _mm256_movemask_epi8(_mm256_cmpeq_epi32(x, needle));
+            } else {
+                return _mm256_movemask_epi8(_mm256_cmpeq_epi64(x, needle));
+            }
+        }
+
+        template<size_t E>
+        inline unsigned match_mask_sse2(const unsigned char* data, __m128i needle) noexcept {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+            if constexpr(E == 1) {
+                return _mm_movemask_epi8(_mm_cmpeq_epi8(x, needle));
+            } else if constexpr(E == 2) {
+                return _mm_movemask_epi8(_mm_cmpeq_epi16(x, needle));
+            } else if constexpr(E == 4) {
+                return _mm_movemask_epi8(_mm_cmpeq_epi32(x, needle));
+            } else {
+                // No 64 bit compare in SSE2, both 32 bit halves must match
+                const __m128i eq = _mm_cmpeq_epi32(x, needle);
+                return _mm_movemask_epi8(_mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1))));
+            }
+        }
+
+        template<size_t E>
+        __attribute__((target("avx2")))
+        inline __m256i splat_avx2(const void* value) noexcept {
+            if constexpr(E == 1) {
+                uint8_t v;
+                memcpy(&v, value, 1);
+                return _mm256_set1_epi8(v);
+            } else if constexpr(E == 2) {
+                uint16_t v;
+                memcpy(&v, value, 2);
+                return _mm256_set1_epi16(v);
+            } else if constexpr(E == 4) {
+                uint32_t v;
+                memcpy(&v, value, 4);
+                return _mm256_set1_epi32(v);
+            } else {
+                uint64_t v;
+                memcpy(&v, value, 8);
+                return _mm256_set1_epi64x(v);
+            }
+        }
+
+        template<size_t E>
+        inline __m128i splat_sse2(const void* value) noexcept {
+            if constexpr(E == 1) {
+                uint8_t v;
+                memcpy(&v, value, 1);
+                return _mm_set1_epi8(v);
+            } else if constexpr(E == 2) {
+                uint16_t v;
+                memcpy(&v, value, 2);
+                return _mm_set1_epi16(v);
+            } else if constexpr(E == 4) {
+                uint32_t v;
+                memcpy(&v, value, 4);
+                return _mm_set1_epi32(v);
+            } else {
+                uint64_t v;
+                memcpy(&v, value, 8);
+                return _mm_set1_epi64x(v);
+            }
+        }
+
+        template<size_t E>
+        __attribute__((target("avx2")))
+        inline size_t find_avx2(const unsigned char* data, size_t n, const void* value) noexcept {
+            const __m256i needle = splat_avx2<E>(value);
+            size_t i = 0;
+            for(; i + 32/E <= n; i += 32/E) {
+                const unsigned mask = match_mask_avx2<E>(data + i*E, needle);
+                if(mask != 0) {
+                    return i + __builtin_ctz(mask)/E;
+                }
+            }
+            for(; i<n; i++) {
+                if(memcmp(data + i*E, value, E) == 0) {
+                    return i;
+                }
+            }
+            return n;
+        }
+
+        template<size_t E>
+        inline size_t find_sse2(const unsigned char* data, size_t n, const void* value) noexcept {
+            const __m128i needle = splat_sse2<E>(value);
+            size_t i = 0;
+            for(; i + 16/E <= n; i += 16/E) {
+                const unsigned mask = match_mask_sse2<E>(data + i*E, needle);
+                if(mask != 0) {
+                    return i + __builtin_ctz(mask)/E;
+                }
+            }
+            for(; i<n; i++) {
+                if(memcmp(data + i*E, value, E) == 0) {
+                    return i;
+                }
+            }
+            return n;
+        }
+
+        template<size_t E>
+        __attribute__((target("avx2")))
+        inline size_t count_avx2(const unsigned char* data, size_t n, const void* value) noexcept {
+            const __m256i needle = splat_avx2<E>(value);
+            size_t total = 0;
+            size_t i = 0;
+            for(; i + 32/E <= n; i += 32/E) {
+                total += __builtin_popcount(match_mask_avx2<E>(data + i*E, needle));
+            }
+            total /= E;
+            for(; i<n; i++) {
+                total += memcmp(data + i*E, value, E) == 0;
+            }
+            return total;
+        }
+
+        template<size_t E>
+        inline size_t count_sse2(const unsigned char* data, size_t n, const void* value) noexcept {
+            const __m128i needle = splat_sse2<E>(value);
+            size_t total = 0;
+            size_t i = 0;
+            for(; i + 16/E <= n; i += 16/E) {
+                total += __builtin_popcount(match_mask_sse2<E>(data + i*E, needle));
+            }
+            total /= E;
+            for(; i<n; i++) {
+                total += memcmp(data + i*E, value, E) == 0;
+            }
+            return total;
+        }
+
+        template<size_t E>
+        __attribute__((target("avx2")))
+        inline void fill_avx2(unsigned char* dest, size_t n, const void* value) noexcept {
+            const __m256i v = splat_avx2<E>(value);
+            for(size_t i=0; i<n/(32/E); i++, dest += 32) {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest), v);
+            }
+            // Fewer than a vector's worth left
+            for(size_t left=n%(32/E); left!=0; left--, dest += E) {
+                memcpy(dest, value, E);
+            }
+        }
+
+        template<size_t E>
+        inline void fill_sse2(unsigned char* dest, size_t n, const void* value) noexcept {
+            const __m128i v = splat_sse2<E>(value);
+            for(size_t i=0; i<n/(16/E); i++, dest += 16) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), v);
+            }
+            // Fewer than a vector's worth left
+            for(size_t left=n%(16/E); left!=0; left--, dest += E) {
+                memcpy(dest, value, E);
+            }
+        }
+
+        template<bit_op Op>
+        __attribute__((target("avx2")))
+        inline void bit_op_words_avx2(uint64_t* dest, const uint64_t* src, size_t n) noexcept {
+            size_t i = 0;
+            for(; i + 4 <= n; i += 4) {
+                const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dest + i));
+                const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+                __m256i res;
+                if constexpr(Op == bit_op::and_) {
+                    res = _mm256_and_si256(a, b);
+                } else if constexpr(Op == bit_op::or_) {
+                    res = _mm256_or_si256(a, b);
+                } else if constexpr(Op == bit_op::xor_) {
+                    res = _mm256_xor_si256(a, b);
+                } else {
+                    res = _mm256_andnot_si256(b, a);
+                }
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i), res);
+            }
+            for(; i<n; i++) {
+                dest[i] = apply_bit_op<Op>(dest[i], src[i]);
+            }
+        }
+
+        template<bit_op Op>
+        inline void bit_op_words_sse2(uint64_t* dest, const uint64_t* src, size_t n) noexcept {
+            size_t i = 0;
+            for(; i + 2 <= n; i += 2) {
+                const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dest + i));
+                const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                __m128i res;
+                if constexpr(Op == bit_op::and_) {
+                    res = _mm_and_si128(a, b);
+                } else if constexpr(Op == bit_op::or_) {
+                    res = _mm_or_si128(a, b);
+                } else if constexpr(Op == bit_op::xor_) {
+                    res = _mm_xor_si128(a, b);
+                } else {
+                    res = _mm_andnot_si128(b, a);
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), res);
+            }
+            for(; i<n; i++) {
+                dest[i] = apply_bit_op<Op>(dest[i], src[i]);
+            }
+        }
+
+        //! Nibble lookup popcount with pshufb, the byte counts are folded
+        //! into 64 bit lanes with psadbw before they can overflow
+        __attribute__((target("avx2")))
+        inline size_t popcount_avx2(const uint64_t* words, size_t n) noexcept {
+            const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                                    0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+            const __m256i low = _mm256_set1_epi8(0x0f);
+            __m256i total = _mm256_setzero_si256();
+            size_t i = 0;
+            while(i + 4 <= n) {
+                // Each step adds at most 8 to a byte so 31 steps fit
+                const size_t steps = (n - i)/4 < 31 ? (n - i)/4 : 31;
+                const size_t end = i + steps*4;
+                __m256i bytes = _mm256_setzero_si256();
+                for(; i<end; i += 4) {
+                    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i));
+                    const __m256i lo = _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, low));
+                    const __m256i hi = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), low));
+                    bytes = _mm256_add_epi8(bytes, _mm256_add_epi8(lo, hi));
+                }
+                total = _mm256_add_epi64(total, _mm256_sad_epu8(bytes, _mm256_setzero_si256()));
+            }
+            uint64_t lanes[4];
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), total);
+            size_t res = size_t(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+            for(; i<n; i++) {
+                res += __builtin_popcountll(words[i]);
+            }
+            return res;
+        }
+#endif
+
+        //! Index of the first element where a and b differ, n if they don't
+        template<typename T>
+        XD_CONSTEXPR20 size_t mismatch(const T* a, const T* b, size_t n) {
+            if(XD_IS_CONSTANT_EVALUATED()) {
+                size_t i = 0;
+                for(; i<n && a[i]==b[i]; i++) {
+                }
+                return i;
+            }
+            if constexpr(is_bytewise_comparable_v<T>) {
+                const unsigned char* x = reinterpret_cast<const unsigned char*>(a);
+                const unsigned char* y = reinterpret_cast<const unsigned char*>(b);
+#ifdef XD_SIMD_X86
+                const size_t byte = cpu_has_avx2() ? mismatch_bytes_avx2(x, y, n*sizeof(T)) : mismatch_bytes_sse2(x, y, n*sizeof(T));
+                return byte / sizeof(T);
+#else
+                size_t i = 0;
+                for(; i<n*sizeof(T) && x[i]==y[i]; i++) {
+                }
+                return i / sizeof(T);
+#endif
+            } else {
+                size_t i = 0;
+                for(; i<n && a[i]==b[i]; i++) {
+                }
+                return i;
+            }
+        }
+
+        //! Whether the n elements at a and b are all equal
+        template<typename T>
+        XD_CONSTEXPR20 bool equal(const T* a, const T* b, size_t n) {
+            if(n == 0 || a == b) {
+                return true;
+            }
+            if constexpr(is_bytewise_comparable_v<T>) {
+                if(!XD_IS_CONSTANT_EVALUATED()) {
+                    return memcmp(a, b, n*sizeof(T)) == 0;
+                }
+            }
+            for(size_t i=0; i<n; i++) {
+                if(!(a[i] == b[i])) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        //! Three way lexicographical compare, negative if a < b, positive
+        //! if a > b and 0 if equal. Only uses < on the elements.
+        template<typename T>
+        XD_CONSTEXPR20 int compare(const T* a, size_t a_len, const T* b, size_t b_len) {
+            const size_t min_len = a_len<b_len ? a_len : b_len;
+            if(XD_IS_CONSTANT_EVALUATED()) {
+                for(size_t i=0; i<min_len; i++) {
+                    if(a[i] < b[i]) {
+                        return -1;
+                    }
+                    if(b[i] < a[i]) {
+                        return 1;
+                    }
+                }
+            } else if constexpr(is_memcmp_orderable_v<T>) {
+                const int res = min_len == 0 ? 0 : memcmp(a, b, min_len);
+                if(res != 0) {
+                    return res;
+                }
+            } else if constexpr(is_bytewise_comparable_v<T>) {
+                const size_t i = mismatch(a, b, min_len);
+                if(i != min_len) {
+                    return a[i] < b[i] ? -1 : 1;
+                }
+            } else {
+                for(size_t i=0; i<min_len; i++) {
+                    if(a[i] < b[i]) {
+                        return -1;
+                    }
+                    if(b[i] < a[i]) {
+                        return 1;
+                    }
+                }
+            }
+            return a_len<b_len ? -1 : (a_len==b_len ? 0 : 1);
+        }
+
+        //! Index of the first element equal to value, n if there isn't one
+        template<typename T>
+        XD_CONSTEXPR20 size_t find(const T* data, size_t n, const T& value) {
+            if(XD_IS_CONSTANT_EVALUATED()) {
+                size_t i = 0;
+                for(; i<n && !(data[i] == value); i++) {
+                }
+                return i;
+            }
+            if constexpr(is_bytewise_comparable_v<T> && sizeof(T) == 1) {
+                const void* pos = n == 0 ? nullptr : memchr(data, *reinterpret_cast<const unsigned char*>(&value), n);
+                return pos == nullptr ? n : static_cast<const unsigned char*>(pos) - reinterpret_cast<const unsigned char*>(data);
+            }
+#ifdef XD_SIMD_X86
+            else if constexpr(is_bytewise_comparable_v<T> && (sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8)) {
+                const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+                return cpu_has_avx2() ? find_avx2<sizeof(T)>(bytes, n, &value) : find_sse2<sizeof(T)>(bytes, n, &value);
+            }
+#endif
+            else {
+                size_t i = 0;
+                for(; i<n && !(data[i] == value); i++) {
+                }
+                return i;
+            }
+        }
+
+        //! Number of elements equal to value
+        template<typename T>
+        XD_CONSTEXPR20 size_t count(const T* data, size_t n, const T& value) {
+#ifdef XD_SIMD_X86
+            if constexpr(is_bytewise_comparable_v<T> && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8)) {
+                if(!XD_IS_CONSTANT_EVALUATED()) {
+                    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+                    return cpu_has_avx2() ? count_avx2<sizeof(T)>(bytes, n, &value) : count_sse2<sizeof(T)>(bytes, n, &value);
+                }
+            }
+#endif
+            size_t total = 0;
+            for(size_t i=0; i<n; i++) {
+                total += data[i] == value;
+            }
+            return total;
+        }
+
+        //! Writes n copies of value to dest, T must be trivially copyable as
+        //! the kernels write over uninitialised memory with plain stores
+        template<typename T>
+        XD_CONSTEXPR20 void fill(T* dest, size_t n, const T& value) {
+            static_assert(std::is_trivially_copyable<T>::value, "fill needs a trivially copyable T");
+            if(n == 0) {
+                return;
+            }
+#if XD_CONSTEXPR_CONTAINERS
+            if(std::is_constant_evaluated()) {
+                // The memory is uninitialised so the objects must be started
+                for(size_t i=0; i<n; i++) {
+                    std::construct_at(dest + i, value);
+                }
+                return;
+            }
+#endif
+            if constexpr(sizeof(T) == 1) {
+                unsigned char byte;
+                memcpy(&byte, &value, 1);
+                memset(static_cast<void*>(dest), byte, n);
+            }
+#ifdef XD_SIMD_X86
+            else if constexpr(sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8) {
+                unsigned char* bytes = reinterpret_cast<unsigned char*>(dest);
+                if(cpu_has_avx2()) {
+                    fill_avx2<sizeof(T)>(bytes, n, &value);
+                } else {
+                    fill_sse2<sizeof(T)>(bytes, n, &value);
+                }
+            }
+#endif
+            else {
+                for(size_t i=0; i<n; i++) {
+                    memcpy(static_cast<void*>(dest + i), static_cast<const void*>(&value), sizeof(T));
+                }
+            }
+        }
+
+        //! dest[i] = dest[i] Op src[i] over n words
+        template<bit_op Op>
+        inline void bit_op_words(uint64_t* dest, const uint64_t* src, size_t n) noexcept {
+#ifdef XD_SIMD_X86
+            if(cpu_has_avx2()) {
+                bit_op_words_avx2<Op>(dest, src, n);
+            } else {
+                bit_op_words_sse2<Op>(dest, src, n);
+            }
+#else
+            for(size_t i=0; i<n; i++) {
+                dest[i] = apply_bit_op<Op>(dest[i], src[i]);
+            }
+#endif
+        }
+
+        //! Number of set bits in n words
+        inline size_t popcount(const uint64_t* words, size_t n) noexcept {
+#ifdef XD_SIMD_X86
+            if(cpu_has_avx2()) {
+                return popcount_avx2(words, n);
+            }
+#endif
+            size_t res = 0;
+            for(size_t i=0; i<n; i++) {
+                res += __builtin_popcountll(words[i]);
+            }
+            return res;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,799 @@
+#ifndef XD_SMALL_VECTOR_H
+#define XD_SMALL_VECTOR_H
+#include <algorithm>
+#include "vector.hpp"
+
+
+namespace xd {
+
+    //! Vector that keeps up to N elements inside the object and only
+    //! allocates once it grows past that. Same interface as xd::vector so
+    //! one can be swapped for the other.
+    template<typename T, size_t N, typename Allocator = std::allocator<T>, typename Growth = double_growth,
+             typename BoundsCheck = default_bounds_check>
+    class small_vector {
+    public:
+        using reference = T&;
+        using const_reference = const T&;
+        using value_type = T;
+        using pointer = T*;
+        using iterator = pointer;
+        using const_pointer = const T*;
+        using const_iterator = const_pointer;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using allocator_type = Allocator;
+
+        static_assert(N > 0, "small_vector needs at least one inline element, use xd::vector");
+        static_assert(std::is_same<typename Allocator::value_type, T>::value,
+                "Allocator::value_type must be the same as T");
+
+        // default constructor
+        small_vector();
+        explicit small_vector(const Allocator& alloc);
+        small_vector(const small_vector& other);
+        //! Inline elements are moved one by one, so this can throw if
+        //! moving T can
+        small_vector(small_vector&& other) noexcept(std::is_nothrow_move_constructible<T>::value);
+        // Fill with a given value
+        small_vector(size_t count, const_reference value, const Allocator& alloc = Allocator());
+        explicit small_vector(size_t count, const Allocator& alloc = Allocator());
+        template<typename InputIt, typename = detail::require_input_iterator<InputIt>>
+        small_vector(InputIt first, InputIt last, const Allocator& alloc = Allocator());
+        small_vector(std::initializer_list<T> l, const Allocator& alloc = Allocator());
+
+        ~small_vector();
+
+        small_vector& operator=(std::initializer_list<T> il);
+        small_vector& operator=(const small_vector& other);
+        small_vector& operator=(small_vector&& other) noexcept(
+                std::is_nothrow_move_constructible<T>::value &&
+                (std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value ||
+                 std::allocator_traits<Allocator>::is_always_equal::value));
+
+        void assign(size_t count, const_reference value);
+        template<typename InputIt, typename = detail::require_input_iterator<InputIt>>
+        void assign(InputIt first, InputIt last);
+        void assign(std::initializer_list<T> il);
+
+        void reserve(size_t capacity);
+
+        void push_back(const_reference value);
+        void push_back(T&& value);
+
+        template<typename... Args>
+        reference emplace_back(Args&&... args);
+
+        template<typename... Args>
+        iterator emplace(const_iterator pos, Args&&... args);
+
+        iterator insert(const_iterator pos, const T& value);
+        iterator insert(const_iterator pos, T&& value);
+        iterator insert(const_iterator pos, size_t count, const T& value);
+        template<typename InputIt, typename = detail::require_input_iterator<InputIt>>
+        iterator insert(const_iterator pos, InputIt first, InputIt last);
+        iterator insert(const_iterator pos, std::initializer_list<T> il);
+
+        iterator erase(const_iterator pos);
+        iterator erase(const_iterator first, const_iterator last);
+
+        void pop_back();
+
+        void resize(size_t count);
+        void resize(size_t count, const T& value);
+
+        void clear();
+
+        reference operator[](size_t index);
+        const_reference operator[](size_t index) const;
+
+        reference at(size_t index);
+        const_reference at(size_t index) const;
+
+        reference front();
+        const_reference front() const;
+
+        reference back();
+        const_reference back() const;
+
+        size_t size() const noexcept;
+        size_t capacity() const noexcept;
+        bool empty() const noexcept;
+        size_t max_size() const noexcept;
+
+        //! Whether the elements are in the inline buffer
+        bool is_inline() const noexcept;
+
+        //! Moves the elements back inline if they fit
+        void shrink_to_fit();
+
+        pointer data() noexcept;
+
+        const_pointer data() const noexcept;
+
+        void swap(small_vector& other) noexcept(
+                std::is_nothrow_move_constructible<T>::value &&
+                (std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value ||
+                 std::allocator_traits<Allocator>::is_always_equal::value));
+
+        allocator_type get_allocator() const noexcept;
+
+        iterator begin() noexcept;
+        const_iterator begin() const noexcept;
+        const_iterator cbegin() const noexcept;
+
+        iterator end() noexcept;
+        const_iterator end() const noexcept;
+        const_iterator cend() const noexcept;
+
+        iterator rbegin() noexcept;
+        const_iterator rbegin() const noexcept;
+        const_iterator crbegin() const noexcept;
+
+        iterator rend() noexcept;
+        const_iterator rend() const noexcept;
+        const_iterator crend() const noexcept;
+    protected:
+        size_t next_capacity() const {
+            return Growth::next_capacity(_capacity);
+        }
+    private:
+        using alloc_traits = std::allocator_traits<Allocator>;
+
+        T* inline_data() noexcept;
+        //! Moves the elements into a buffer of cap elements, inline if
+        //! cap is N
+        void move_storage(size_t cap);
+        //! Frees heap storage, elements must already have been destroyed
+        void release_storage() noexcept;
+        //! Opens a gap of count uninitialised slots at index, growing the
+        //! storage if needed. Returns a pointer to the start of the gap.
+        T* open_gap(size_t index, size_t count);
+        //! Closes a gap previously opened by open_gap
+        void close_gap(size_t index, size_t count);
+
+        //! Current size of the vector
+        size_t raw_size;
+        //! Current capacity, N while inline
+        size_t _capacity;
+        //! Either the inline buffer or heap storage
+        T* _data;
+        //! Allocator heap storage is obtained from
+        Allocator _alloc;
+        //! Inline storage for the first N elements
+        alignas(T) unsigned char buffer[N*sizeof(T)];
+    };
+
+    template<class T, size_t N, class Allocator, class Growth, class BoundsCheck>
+    bool operator==(const small_vector<T, N, Allocator, Growth, BoundsCheck>& lhs, const small_vector<T, N, Allocator, Growth, BoundsCheck>& rhs);
+    template<class T, size_t N, class Allocator, class Growth, class BoundsCheck>
+    bool operator!=(const small_vector<T, N, Allocator, Growth, BoundsCheck>& lhs, const small_vector<T, N, Allocator, Growth, BoundsCheck>& rhs);
+    template<class T, size_t N, class Allocator, class Growth, class BoundsCheck>
+    bool operator<(const small_vector<T, N, Allocator, Growth, BoundsCheck>& lhs, const small_vector<T, N, Allocator, Growth, BoundsCheck>& rhs);
+    template<class T, size_t N, class Allocator, class Growth, class BoundsCheck>
+    bool operator<=(const small_vector<T, N, Allocator, Growth, BoundsCheck>& lhs, const small_vector<T, N, Allocator, Growth, BoundsCheck>& rhs);
+    template<class T, size_t N, class Allocator, class Growth, class BoundsCheck>
+    bool operator>(const small_vector<T, N, Allocator, Growth, BoundsCheck>& lhs, const small_vector<T, N, Allocator, Growth, BoundsCheck>& rhs);
+    template<class T, size_t N, class Allocator, class Growth, class BoundsCheck>
+    bool operator>=(const small_vector<T, N, Allocator, Growth, BoundsCheck>& lhs, const small_vector<T, N, Allocator, Growth, BoundsCheck>& rhs);
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    small_vector<T, N, Allocator, Growth, BoundsCheck>::small_vector():small_vector(Allocator()) {
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    small_vector<T, N, Allocator, Growth, BoundsCheck>::small_vector(const Allocator& alloc):
+    raw_size(0),
+    _capacity(N),
+    _data(inline_data()),
+    _alloc(alloc) {
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    small_vector<T, N, Allocator, Growth, BoundsCheck>::small_vector(size_t count, const T& value, const Allocator& alloc):small_vector(alloc) {
+        assign(count, value);
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    small_vector<T, N, Allocator, Growth, BoundsCheck>::small_vector(size_t count, const Allocator& alloc):small_vector(alloc) {
+        resize(count);
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    template<typename InputIt, typename>
+    small_vector<T, N, Allocator, Growth, BoundsCheck>::small_vector(InputIt first, InputIt last, const Allocator& alloc):small_vector(alloc) {
+        assign(first, last);
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    small_vector<T, N, Allocator, Growth, BoundsCheck>::small_vector(std::initializer_list<T> il, const Allocator& alloc):small_vector(il.begin(), il.end(), alloc) {
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    small_vector<T, N, Allocator, Growth, BoundsCheck>::small_vector(const small_vector<T, N, Allocator, Growth, BoundsCheck>& other):
+    small_vector(alloc_traits::select_on_container_copy_construction(other._alloc)) {
+        assign(other.begin(), other.end());
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    small_vector<T, N, Allocator, Growth, BoundsCheck>::small_vector(small_vector<T, N, Allocator, Growth, BoundsCheck>&& other) noexcept(std::is_nothrow_move_constructible<T>::value):
+    small_vector(other._alloc) {
+        if(other.is_inline()) {
+            detail::relocate(_alloc, other._data, other._data + other.raw_size, _data);
+        } else {
+            _data = other._data;
+            _capacity = other._capacity;
+            other._data = other.inline_data();
+            other._capacity = N;
+        }
+        raw_size = other.raw_size;
+        other.raw_size = 0;
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    small_vector<T, N, Allocator, Growth, BoundsCheck>::~small_vector() {
+        clear();
+        release_storage();
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    small_vector<T, N, Allocator, Growth, BoundsCheck>& small_vector<T, N, Allocator, Growth, BoundsCheck>::operator=(std::initializer_list<T> il) {
+        assign(il.begin(), il.end());
+        return *this;
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    small_vector<T, N, Allocator, Growth, BoundsCheck>& small_vector<T, N, Allocator, Growth, BoundsCheck>::operator=(const small_vector<T, N, Allocator, Growth, BoundsCheck>& other) {
+        if(this == &other) {
+            return *this;
+        }
+        if constexpr(alloc_traits::propagate_on_container_copy_assignment::value) {
+            if(_alloc != other._alloc) {
+                clear();
+                release_storage();
+                _data = inline_data();
+                _capacity = N;
+            }
+            _alloc = other._alloc;
+        }
+        assign(other.begin(), other.end());
+        return *this;
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    small_vector<T, N, Allocator, Growth, BoundsCheck>& small_vector<T, N, Allocator, Growth, BoundsCheck>::operator=(small_vector<T, N, Allocator, Growth, BoundsCheck>&& other) noexcept(
+            std::is_nothrow_move_constructible<T>::value &&
+            (std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value ||
+             std::allocator_traits<Allocator>::is_always_equal::value)) {
+        if(this == &other) {
+            return *this;
+        }
+        clear();
+        if(!other.is_inline() && (alloc_traits::propagate_on_container_move_assignment::value || _alloc == other._alloc)) {
+            release_storage();
+            if constexpr(alloc_traits::propagate_on_container_move_assignment::value) {
+                _alloc = std::move(other._alloc);
+            }
+            _data = other._data;
+            _capacity = other._capacity;
+            raw_size = other.raw_size;
+            other._data = other.inline_data();
+            other._capacity = N;
+            other.raw_size = 0;
+            return *this;
+        }
+        if constexpr(alloc_traits::propagate_on_container_move_assignment::value) {
+            if(_alloc != other._alloc) {
+                // Storage has to go back to the allocator that made it
+                release_storage();
+                _data = inline_data();
+                _capacity = N;
+            }
+            _alloc = other._alloc;
+        }
+        // Only allocates when other is on a heap this allocator can't
+        // free. If that or an element throws this is left empty and other
+        // keeps its elements.
+        reserve(other.size());
+        raw_size = detail::uninitialized_move_if_noexcept(_alloc, other._data, other._data + other.raw_size, _data) - _data;
+        other.clear();
+        return *this;
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    void small_vector<T, N, Allocator, Growth, BoundsCheck>::assign(size_t count, const T& value) {
+        // value may live in this vector so copy it before clearing
+        const T tmp(value);
+        clear();
+        reserve(count);
+        for(size_t i=0; i<count; i++) {
+            alloc_traits::construct(_alloc, _data + i, tmp);
+            raw_size++;
+        }
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    template<typename InputIt, typename>
+    void small_vector<T, N, Allocator, Growth, BoundsCheck>::assign(InputIt first, InputIt last) {
+        clear();
+        if constexpr(detail::is_forward_iterator_v<InputIt>) {
+            reserve(std::distance(first, last));
+            raw_size = detail::uninitialized_copy(_alloc, first, last, _data) - _data;
+        } else {
+            for(; first!=last; ++first) {
+                emplace_back(*first);
+            }
+        }
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    void small_vector<T, N, Allocator, Growth, BoundsCheck>::assign(std::initializer_list<T> il) {
+        assign(il.begin(), il.end());
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    void small_vector<T, N, Allocator, Growth, BoundsCheck>::reserve(size_t cap) {
+        if(cap > _capacity) {
+            move_storage(cap);
+        }
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    T* small_vector<T, N, Allocator, Growth, BoundsCheck>::inline_data() noexcept {
+        return reinterpret_cast<T*>(buffer);
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    void small_vector<T, N, Allocator, Growth, BoundsCheck>::move_storage(size_t cap) {
+        T* new_data = cap == N ? inline_data() : alloc_traits::allocate(_alloc, cap);
+        detail::relocate(_alloc, _data, _data + raw_size, new_data);
+        release_storage();
+        _data = new_data;
+        _capacity = cap;
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    void small_vector<T, N, Allocator, Growth, BoundsCheck>::release_storage() noexcept {
+        if(!is_inline()) {
+            alloc_traits::deallocate(_alloc, _data, _capacity);
+        }
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    T* small_vector<T, N, Allocator, Growth, BoundsCheck>::open_gap(size_t index, size_t count) {
+        const size_t required_size = raw_size + count;
+        if(required_size > _capacity) {
+            const size_t cap = required_size > next_capacity() ? required_size : next_capacity();
+            T* new_data = alloc_traits::allocate(_alloc, cap);
+            // Relocate around the gap so the tail only moves once
+            detail::relocate(_alloc, _data, _data + index, new_data);
+            detail::relocate(_alloc, _data + index, _data + raw_size, new_data + index + count);
+            release_storage();
+            _data = new_data;
+            _capacity = cap;
+        } else {
+            detail::relocate(_alloc, _data + index, _data + raw_size, _data + index + count);
+        }
+        return _data + index;
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    void small_vector<T, N, Allocator, Growth, BoundsCheck>::close_gap(size_t index, size_t count) {
+        detail::relocate(_alloc, _data + index + count, _data + raw_size + count, _data + index);
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    template<typename... Args>
+    T& small_vector<T, N, Allocator, Growth, BoundsCheck>::emplace_back(Args&&... args) {
+        if(raw_size != _capacity) {
+            alloc_traits::construct(_alloc, _data + raw_size, std::forward<Args>(args)...);
+        } else {
+            // Construct into the new buffer before relocating, args may
+            // refer to an element of this vector
+            const size_t cap = next_capacity();
+            T* new_data = alloc_traits::allocate(_alloc, cap);
+            try {
+                alloc_traits::construct(_alloc, new_data + raw_size, std::forward<Args>(args)...);
+            } catch(...) {
+                alloc_traits::deallocate(_alloc, new_data, cap);
+                throw;
+            }
+            detail::relocate(_alloc, _data, _data + raw_size, new_data);
+            release_storage();
+            _data = new_data;
+            _capacity = cap;
+        }
+        raw_size++;
+        return _data[raw_size-1];
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    template<typename... Args>
+    T* small_vector<T, N, Allocator, Growth, BoundsCheck>::emplace(const T* pos, Args&&... args) {
+        // If we work out index after growing pointer distance is wrong!
+        const size_t index = std::distance(cbegin(), pos);
+        if(index == raw_size) {
+            emplace_back(std::forward<Args>(args)...);
+            return _data + index;
+        }
+        // args may refer to an element that open_gap is about to move
+        T tmp(std::forward<Args>(args)...);
+        T* gap = open_gap(index, 1);
+        try {
+            alloc_traits::construct(_alloc, gap, std::move(tmp));
+        } catch(...) {
+            close_gap(index, 1);
+            throw;
+        }
+        raw_size++;
+        return gap;
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    void small_vector<T, N, Allocator, Growth, BoundsCheck>::push_back(const T& value) {
+        emplace_back(value);
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    void small_vector<T, N, Allocator, Growth, BoundsCheck>::push_back(T&& value) {
+        emplace_back(std::move(value));
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    T* small_vector<T, N, Allocator, Growth, BoundsCheck>::insert(const T* pos, const T& value) {
+        return emplace(pos, value);
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    T* small_vector<T, N, Allocator, Growth, BoundsCheck>::insert(const T* pos, T&& value) {
+        return emplace(pos, std::move(value));
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    T* small_vector<T, N, Allocator, Growth, BoundsCheck>::insert(const T* pos, size_t count, const T& value) {
+        const size_t index = std::distance(cbegin(), pos);
+        if(count == 0) {
+            return _data + index;
+        }
+        const T tmp(value);
+        T* gap = open_gap(index, count);
+        size_t i = 0;
+        try {
+            for(; i<count; i++) {
+                alloc_traits::construct(_alloc, gap + i, tmp);
+            }
+        } catch(...) {
+            for(size_t j=0; j<i; j++) {
+                alloc_traits::destroy(_alloc, gap + j);
+            }
+            close_gap(index, count);
+            throw;
+        }
+        raw_size += count;
+        return gap;
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    template<typename InputIt, typename>
+    T* small_vector<T, N, Allocator, Growth, BoundsCheck>::insert(const T* pos, InputIt first, InputIt last) {
+        const size_t index = std::distance(cbegin(), pos);
+        if constexpr(detail::is_forward_iterator_v<InputIt>) {
+            if constexpr(std::is_pointer<InputIt>::value) {
+                // The range would move under us when the gap opens
+                if(first != last && &*first >= _data && &*first < _data + raw_size) {
+                    const small_vector<T, N, Allocator, Growth, BoundsCheck> tmp(first, last, _alloc);
+                    return insert(pos, tmp.begin(), tmp.end());
+                }
+            }
+            const size_t count = std::distance(first, last);
+            if(count == 0) {
+                return _data + index;
+            }
+            T* gap = open_gap(index, count);
+            try {
+                detail::uninitialized_copy(_alloc, first, last, gap);
+            } catch(...) {
+                close_gap(index, count);
+                throw;
+            }
+            raw_size += count;
+            return gap;
+        } else {
+            const size_t old_size = raw_size;
+            for(; first!=last; ++first) {
+                emplace_back(*first);
+            }
+            std::rotate(_data + index, _data + old_size, _data + raw_size);
+            return _data + index;
+        }
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    T* small_vector<T, N, Allocator, Growth, BoundsCheck>::insert(const T* pos, std::initializer_list<T> il) {
+        return insert(pos, il.begin(), il.end());
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    T* small_vector<T, N, Allocator, Growth, BoundsCheck>::erase(const T* pos) {
+        const size_t index = std::distance(cbegin(), pos);
+        alloc_traits::destroy(_alloc, _data + index);
+        detail::relocate(_alloc, _data + index + 1, _data + raw_size, _data + index);
+        raw_size--;
+        return _data + index;
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    T* small_vector<T, N, Allocator, Growth, BoundsCheck>::erase(const T* first, const T* last) {
+        const size_t len = std::distance(first, last);
+        const size_t index = std::distance(cbegin(), first);
+
+        if(len > 0) {
+            for(size_t i=index; i<index+len; i++) {
+                alloc_traits::destroy(_alloc, _data + i);
+            }
+            detail::relocate(_alloc, _data + index + len, _data + raw_size, _data + index);
+            raw_size -= len;
+        }
+
+        return _data + index;
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    void small_vector<T, N, Allocator, Growth, BoundsCheck>::pop_back() {
+        if(!empty()) {
+            alloc_traits::destroy(_alloc, _data + raw_size - 1);
+            raw_size--;
+        }
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    void small_vector<T, N, Allocator, Growth, BoundsCheck>::resize(size_t count) {
+        if(count < raw_size) {
+            for(size_t i=count; i<raw_size; i++) {
+                alloc_traits::destroy(_alloc, _data + i);
+            }
+            raw_size = count;
+        } else {
+            reserve(count);
+            for(; raw_size<count; raw_size++) {
+                alloc_traits::construct(_alloc, _data + raw_size);
+            }
+        }
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    void small_vector<T, N, Allocator, Growth, BoundsCheck>::resize(size_t count, const T& value) {
+        if(count < raw_size) {
+            for(size_t i=count; i<raw_size; i++) {
+                alloc_traits::destroy(_alloc, _data + i);
+            }
+            raw_size = count;
+        } else if(count > raw_size) {
+            const T tmp(value);
+            reserve(count);
+            for(; raw_size<count; raw_size++) {
+                alloc_traits::construct(_alloc, _data + raw_size, tmp);
+            }
+        }
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    T& small_vector<T, N, Allocator, Growth, BoundsCheck>::operator[](size_t i) {
+        BoundsCheck::check(i, raw_size);
+        return _data[i];
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    const T& small_vector<T, N, Allocator, Growth, BoundsCheck>::operator[](size_t i) const {
+        BoundsCheck::check(i, raw_size);
+        return _data[i];
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    T& small_vector<T, N, Allocator, Growth, BoundsCheck>::at(size_t i) {
+        if(!(i < raw_size)) {
+            throw std::out_of_range("Attempted to access element out of range");
+        }
+        return _data[i];
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    const T& small_vector<T, N, Allocator, Growth, BoundsCheck>::at(size_t i) const {
+        if(!(i < raw_size)) {
+            throw std::out_of_range("Attempted to access element out of range");
+        }
+        return _data[i];
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    const T& small_vector<T, N, Allocator, Growth, BoundsCheck>::front() const {
+        BoundsCheck::check(0, raw_size);
+        return _data[0];
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    T& small_vector<T, N, Allocator, Growth, BoundsCheck>::front() {
+        BoundsCheck::check(0, raw_size);
+        return _data[0];
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    const T& small_vector<T, N, Allocator, Growth, BoundsCheck>::back() const {
+        BoundsCheck::check(0, raw_size);
+        return _data[raw_size-1];
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    T& small_vector<T, N, Allocator, Growth, BoundsCheck>::back() {
+        BoundsCheck::check(0, raw_size);
+        return _data[raw_size-1];
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    size_t small_vector<T, N, Allocator, Growth, BoundsCheck>::size() const noexcept {
+        return raw_size;
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    size_t small_vector<T, N, Allocator, Growth, BoundsCheck>::capacity() const noexcept {
+        return _capacity;
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    size_t small_vector<T, N, Allocator, Growth, BoundsCheck>::max_size() const noexcept {
+        return std::numeric_limits<size_t>::max();
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    bool small_vector<T, N, Allocator, Growth, BoundsCheck>::empty() const noexcept {
+        return raw_size == 0;
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    bool small_vector<T, N, Allocator, Growth, BoundsCheck>::is_inline() const noexcept {
+        return _data == reinterpret_cast<const T*>(buffer);
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    void small_vector<T, N, Allocator, Growth, BoundsCheck>::clear() {
+        for(size_t i=0; i<raw_size; i++) {
+            alloc_traits::destroy(_alloc, _data + i);
+        }
+        raw_size = 0;
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    void small_vector<T, N, Allocator, Growth, BoundsCheck>::shrink_to_fit() {
+        if(is_inline() || raw_size == _capacity) {
+            return;
+        }
+        move_storage(raw_size > N ? raw_size : N);
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    void small_vector<T, N, Allocator, Growth, BoundsCheck>::swap(small_vector<T, N, Allocator, Growth, BoundsCheck>& other) noexcept(
+            std::is_nothrow_move_constructible<T>::value &&
+            (std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value ||
+             std::allocator_traits<Allocator>::is_always_equal::value)) {
+        if(!is_inline() && !other.is_inline()) {
+            std::swap(_data, other._data);
+            std::swap(_capacity, other._capacity);
+            std::swap(raw_size, other.raw_size);
+            if constexpr(alloc_traits::propagate_on_container_swap::value) {
+                using std::swap;
+                swap(_alloc, other._alloc);
+            }
+            return;
+        }
+        // Inline elements have to be moved one by one
+        small_vector<T, N, Allocator, Growth, BoundsCheck> tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    Allocator small_vector<T, N, Allocator, Growth, BoundsCheck>::get_allocator() const noexcept {
+        return _alloc;
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    T* small_vector<T, N, Allocator, Growth, BoundsCheck>::data() noexcept {
+        return _data;
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    const T* small_vector<T, N, Allocator, Growth, BoundsCheck>::data() const noexcept {
+        return _data;
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    T* small_vector<T, N, Allocator, Growth, BoundsCheck>::begin() noexcept {
+        return data();
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    const T* small_vector<T, N, Allocator, Growth, BoundsCheck>::begin() const noexcept {
+        return cbegin();
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    const T* small_vector<T, N, Allocator, Growth, BoundsCheck>::cbegin() const noexcept {
+        return data();
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    T* small_vector<T, N, Allocator, Growth, BoundsCheck>::end() noexcept {
+        return _data + raw_size;
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    const T* small_vector<T, N, Allocator, Growth, BoundsCheck>::end() const noexcept {
+        return cend();
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    const T* small_vector<T, N, Allocator, Growth, BoundsCheck>::cend() const noexcept {
+        return _data + raw_size;
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    T* small_vector<T, N, Allocator, Growth, BoundsCheck>::rbegin() noexcept {
+        return data() - 1;
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    const T* small_vector<T, N, Allocator, Growth, BoundsCheck>::rbegin() const noexcept {
+        return crbegin();
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    const T* small_vector<T, N, Allocator, Growth, BoundsCheck>::crbegin() const noexcept {
+        return data() - 1;
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    T* small_vector<T, N, Allocator, Growth, BoundsCheck>::rend() noexcept {
+        return _data + raw_size - 1;
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    const T* small_vector<T, N, Allocator, Growth, BoundsCheck>::rend() const noexcept {
+        return crend();
+    }
+
+    template<typename T, size_t N, typename Allocator, typename Growth, typename BoundsCheck>
+    const T* small_vector<T, N, Allocator, Growth, BoundsCheck>::crend() const noexcept {
+        return _data + raw_size - 1;
+    }
+
+    template<class T, size_t N, class Allocator, class Growth, class BoundsCheck>
+    bool operator==(const small_vector<T, N, Allocator, Growth, BoundsCheck>& lhs, const small_vector<T, N, Allocator, Growth, BoundsCheck>& rhs) {
+        return lhs.size() == rhs.size() && detail::equal(lhs.data(), rhs.data(), lhs.size());
+    }
+
+    template<class T, size_t N, class Allocator, class Growth, class BoundsCheck>
+    bool operator!=(const small_vector<T, N, Allocator, Growth, BoundsCheck>& lhs, const small_vector<T, N, Allocator, Growth, BoundsCheck>& rhs) {
+        return !(lhs == rhs);
+    }
+
+    template<class T, size_t N, class Allocator, class Growth, class BoundsCheck>
+    bool operator<(const small_vector<T, N, Allocator, Growth, BoundsCheck>& lhs, const small_vector<T, N, Allocator, Growth, BoundsCheck>& rhs) {
+        return detail::compare(lhs.data(), lhs.size(), rhs.data(), rhs.size()) < 0;
+    }
+
+    template<class T, size_t N, class Allocator, class Growth, class BoundsCheck>
+    bool operator<=(const small_vector<T, N, Allocator, Growth, BoundsCheck>& lhs, const small_vector<T, N, Allocator, Growth, BoundsCheck>& rhs) {
+        return detail::compare(lhs.data(), lhs.size(), rhs.data(), rhs.size()) <= 0;
+    }
+
+    template<class T, size_t N, class Allocator, class Growth, class BoundsCheck>
+    bool operator>(const small_vector<T, N, Allocator, Growth, BoundsCheck>& lhs, const small_vector<T, N, Allocator, Growth, BoundsCheck>& rhs) {
+        return detail::compare(lhs.data(), lhs.size(), rhs.data(), rhs.size()) > 0;
+    }
+
+    template<class T, size_t N, class Allocator, class Growth, class BoundsCheck>
+    bool operator>=(const small_vector<T, N, Allocator, Growth, BoundsCheck>& lhs, const small_vector<T, N, Allocator, Growth, BoundsCheck>& rhs) {
+        return detail::compare(lhs.data(), lhs.size(), rhs.data(), rhs.size()) >= 0;
+    }
+}
+
+#endif
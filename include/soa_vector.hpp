@@ -0,0 +1,671 @@
+#ifndef XD_SOA_VECTOR_H
+#define XD_SOA_VECTOR_H
+#include <iterator>
+#include <new>
+#include <tuple>
+#include <utility>
+#include "vector.hpp"
+
+
+namespace xd {
+
+    //! Non-owning view of contiguous elements
+    template<typename T>
+    class span {
+    public:
+        using value_type = std::remove_const_t<T>;
+        using iterator = T*;
+
+        constexpr span() noexcept: _data(nullptr), _size(0) {}
+        constexpr span(T* data, size_t size) noexcept: _data(data), _size(size) {}
+
+        constexpr T* data() const noexcept { return _data; }
+        constexpr size_t size() const noexcept { return _size; }
+        constexpr bool empty() const noexcept { return _size == 0; }
+
+        constexpr T* begin() const noexcept { return _data; }
+        constexpr T* end() const noexcept { return _data + _size; }
+
+        T& operator[](size_t i) const {
+            default_bounds_check::check(i, _size);
+            return _data[i];
+        }
+    private:
+        T* _data;
+        size_t _size;
+    };
+
+    //! Proxy for one row of an soa_vector, holds a reference to the element
+    //! in each column. Assigning to a row assigns the elements, it never
+    //! rebinds, and converting to value_type copies the row out. Beware
+    //! that auto x = vec[i] gives a proxy, not a copy.
+    template<typename... Ts>
+    class soa_row {
+    public:
+        using value_type = std::tuple<std::remove_const_t<Ts>...>;
+
+        explicit soa_row(Ts&... elements) noexcept: refs(elements...) {}
+        soa_row(const soa_row& other) noexcept = default;
+
+        //! Mutable rows convert to const ones
+        template<typename... Us, typename = std::enable_if_t<(std::is_convertible<Us*, Ts*>::value && ...)>>
+        soa_row(const soa_row<Us...>& other) noexcept: refs(other.as_tuple()) {}
+
+        soa_row& operator=(const soa_row& other) {
+            refs = other.refs;
+            return *this;
+        }
+
+        soa_row& operator=(const value_type& value) {
+            refs = value;
+            return *this;
+        }
+
+        soa_row& operator=(value_type&& value) {
+            refs = std::move(value);
+            return *this;
+        }
+
+        operator value_type() const {
+            return value_type(refs);
+        }
+
+        template<size_t I>
+        auto& get() const noexcept {
+            return std::get<I>(refs);
+        }
+
+        const std::tuple<Ts&...>& as_tuple() const noexcept {
+            return refs;
+        }
+
+        friend void swap(soa_row a, soa_row b) {
+            a.swap_elements(b, std::index_sequence_for<Ts...>());
+        }
+
+        friend bool operator==(const soa_row& a, const soa_row& b) { return a.refs == b.refs; }
+        friend bool operator!=(const soa_row& a, const soa_row& b) { return a.refs != b.refs; }
+        friend bool operator<(const soa_row& a, const soa_row& b) { return a.refs < b.refs; }
+        friend bool operator==(const soa_row& a, const value_type& b) { return a.refs == b; }
+        friend bool operator==(const value_type& a, const soa_row& b) { return a == b.refs; }
+        friend bool operator<(const soa_row& a, const value_type& b) { return a.refs < b; }
+        friend bool operator<(const value_type& a, const soa_row& b) { return a < b.refs; }
+    private:
+        template<size_t... I>
+        void swap_elements(soa_row& other, std::index_sequence<I...>) {
+            using std::swap;
+            (swap(std::get<I>(refs), std::get<I>(other.refs)), ...);
+        }
+
+        std::tuple<Ts&...> refs;
+    };
+
+    template<size_t I, typename... Ts>
+    auto& get(const soa_row<Ts...>& row) noexcept {
+        return row.template get<I>();
+    }
+
+    //! Struct of arrays vector, row i is made of the ith element of every
+    //! column. All columns share one allocation and one capacity, each
+    //! column starts on a cache line so hot loops over a single field only
+    //! load that field and vectorise cleanly.
+    template<typename... Ts>
+    class soa_vector {
+    public:
+        static_assert(sizeof...(Ts) > 0, "soa_vector needs at least one column");
+        static_assert((std::is_nothrow_move_constructible<Ts>::value && ...),
+                "Columns are relocated one at a time so moves can't throw");
+
+        using value_type = std::tuple<Ts...>;
+        using reference = soa_row<Ts...>;
+        using const_reference = soa_row<const Ts...>;
+
+        template<size_t I>
+        using column_type = std::tuple_element_t<I, value_type>;
+
+        template<typename Owner, typename Row>
+        class row_iterator;
+
+        using iterator = row_iterator<soa_vector, reference>;
+        using const_iterator = row_iterator<const soa_vector, const_reference>;
+
+        soa_vector() noexcept;
+        soa_vector(const soa_vector& other);
+        soa_vector(soa_vector&& other) noexcept;
+        soa_vector(std::initializer_list<value_type> il);
+
+        ~soa_vector();
+
+        soa_vector& operator=(const soa_vector& other);
+        soa_vector& operator=(soa_vector&& other) noexcept;
+
+        void reserve(size_t capacity);
+
+        void push_back(const Ts&... values);
+        void push_back(const value_type& row);
+
+        //! Takes one argument per column, each constructs that column's
+        //! element in place
+        template<typename... Args>
+        reference emplace_back(Args&&... args);
+
+        void pop_back();
+
+        void resize(size_t count);
+
+        void clear() noexcept;
+
+        reference operator[](size_t index);
+        const_reference operator[](size_t index) const;
+
+        reference at(size_t index);
+        const_reference at(size_t index) const;
+
+        reference front();
+        const_reference front() const;
+
+        reference back();
+        const_reference back() const;
+
+        //! Contiguous view of column I
+        template<size_t I>
+        span<column_type<I>> column() noexcept;
+        template<size_t I>
+        span<const column_type<I>> column() const noexcept;
+
+        template<size_t I>
+        column_type<I>* data() noexcept;
+        template<size_t I>
+        const column_type<I>* data() const noexcept;
+
+        size_t size() const noexcept;
+        size_t capacity() const noexcept;
+        bool empty() const noexcept;
+
+        void shrink_to_fit();
+
+        void swap(soa_vector& other) noexcept;
+
+        iterator begin() noexcept;
+        const_iterator begin() const noexcept;
+        const_iterator cbegin() const noexcept;
+
+        iterator end() noexcept;
+        const_iterator end() const noexcept;
+        const_iterator cend() const noexcept;
+    private:
+        using columns_type = std::tuple<Ts*...>;
+        using indices = std::index_sequence_for<Ts...>;
+
+        static constexpr size_t column_alignment = std::max({size_t(64), alignof(Ts)...});
+
+        static size_t column_bytes(size_t cap, size_t element_size) noexcept {
+            return (cap*element_size + column_alignment - 1) & ~(column_alignment - 1);
+        }
+
+        //! Allocates one block for cap rows and points every column into it
+        static columns_type allocate_columns(size_t cap);
+        static void deallocate_columns(const columns_type& cols) noexcept;
+        template<size_t... I>
+        static columns_type split_block(unsigned char* block, size_t cap, std::index_sequence<I...>) noexcept;
+
+        //! Constructs columns I and up of row from args, on failure the
+        //! columns already built are destroyed
+        template<size_t I, typename Tuple>
+        static void construct_row(const columns_type& cols, size_t row, Tuple&& args);
+        template<size_t I>
+        static void construct_default_row(const columns_type& cols, size_t row);
+        template<size_t... I>
+        static void destroy_rows(const columns_type& cols, size_t first, size_t last, std::index_sequence<I...>) noexcept;
+        template<size_t... I>
+        static void relocate_rows(const columns_type& from, const columns_type& to, size_t count, std::index_sequence<I...>) noexcept;
+
+        //! Moves every row to storage for cap rows
+        void reallocate(size_t cap);
+        size_t next_capacity() const noexcept {
+            return _capacity == 0 ? 1 : _capacity*2;
+        }
+
+        template<size_t... I>
+        reference row(size_t index, std::index_sequence<I...>) noexcept {
+            return reference(std::get<I>(columns)[index]...);
+        }
+        template<size_t... I>
+        const_reference row(size_t index, std::index_sequence<I...>) const noexcept {
+            return const_reference(std::get<I>(columns)[index]...);
+        }
+
+        //! Current size of the vector
+        size_t raw_size;
+        //! Rows every column has room for
+        size_t _capacity;
+        //! Start of each column, the first is the start of the block
+        columns_type columns;
+    };
+
+    //! Random access iterator over rows, dereferencing gives a row proxy
+    template<typename... Ts>
+    template<typename Owner, typename Row>
+    class soa_vector<Ts...>::row_iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::tuple<Ts...>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = Row;
+
+        row_iterator() noexcept: owner(nullptr), index(0) {}
+        row_iterator(Owner* owner, size_t index) noexcept: owner(owner), index(index) {}
+
+        reference operator*() const noexcept { return owner->row(index, indices()); }
+        reference operator[](difference_type n) const noexcept { return owner->row(index + n, indices()); }
+
+        row_iterator& operator++() noexcept { index++; return *this; }
+        row_iterator operator++(int) noexcept { auto tmp = *this; index++; return tmp; }
+        row_iterator& operator--() noexcept { index--; return *this; }
+        row_iterator operator--(int) noexcept { auto tmp = *this; index--; return tmp; }
+        row_iterator& operator+=(difference_type n) noexcept { index += n; return *this; }
+        row_iterator& operator-=(difference_type n) noexcept { index -= n; return *this; }
+        row_iterator operator+(difference_type n) const noexcept { return row_iterator(owner, index + n); }
+        friend row_iterator operator+(difference_type n, const row_iterator& it) noexcept { return it + n; }
+        row_iterator operator-(difference_type n) const noexcept { return row_iterator(owner, index - n); }
+        difference_type operator-(const row_iterator& other) const noexcept {
+            return difference_type(index) - difference_type(other.index);
+        }
+
+        bool operator==(const row_iterator& other) const noexcept { return index == other.index; }
+        bool operator!=(const row_iterator& other) const noexcept { return index != other.index; }
+        bool operator<(const row_iterator& other) const noexcept { return index < other.index; }
+        bool operator>(const row_iterator& other) const noexcept { return index > other.index; }
+        bool operator<=(const row_iterator& other) const noexcept { return index <= other.index; }
+        bool operator>=(const row_iterator& other) const noexcept { return index >= other.index; }
+    private:
+        Owner* owner;
+        size_t index;
+    };
+
+    template<typename... Ts>
+    bool operator==(const soa_vector<Ts...>& lhs, const soa_vector<Ts...>& rhs) {
+        return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+
+    template<typename... Ts>
+    bool operator!=(const soa_vector<Ts...>& lhs, const soa_vector<Ts...>& rhs) {
+        return !(lhs == rhs);
+    }
+
+    template<typename... Ts>
+    soa_vector<Ts...>::soa_vector() noexcept:
+    raw_size(0),
+    _capacity(0),
+    columns() {
+    }
+
+    template<typename... Ts>
+    soa_vector<Ts...>::soa_vector(const soa_vector& other):soa_vector() {
+        reserve(other.size());
+        for(const auto& r: other) {
+            push_back(value_type(r));
+        }
+    }
+
+    template<typename... Ts>
+    soa_vector<Ts...>::soa_vector(soa_vector&& other) noexcept:
+    raw_size(other.raw_size),
+    _capacity(other._capacity),
+    columns(other.columns) {
+        other.raw_size = 0;
+        other._capacity = 0;
+        other.columns = columns_type();
+    }
+
+    template<typename... Ts>
+    soa_vector<Ts...>::soa_vector(std::initializer_list<value_type> il):soa_vector() {
+        reserve(il.size());
+        for(const auto& r: il) {
+            push_back(r);
+        }
+    }
+
+    template<typename... Ts>
+    soa_vector<Ts...>::~soa_vector() {
+        clear();
+        deallocate_columns(columns);
+    }
+
+    template<typename... Ts>
+    soa_vector<Ts...>& soa_vector<Ts...>::operator=(const soa_vector& other) {
+        if(this != &other) {
+            soa_vector tmp(other);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    template<typename... Ts>
+    soa_vector<Ts...>& soa_vector<Ts...>::operator=(soa_vector&& other) noexcept {
+        if(this != &other) {
+            soa_vector tmp(std::move(other));
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    template<typename... Ts>
+    template<size_t... I>
+    typename soa_vector<Ts...>::columns_type soa_vector<Ts...>::split_block(unsigned char* block, size_t cap, std::index_sequence<I...>) noexcept {
+        columns_type cols;
+        size_t offset = 0;
+        ((std::get<I>(cols) = reinterpret_cast<column_type<I>*>(block + offset),
+          offset += column_bytes(cap, sizeof(column_type<I>))), ...);
+        return cols;
+    }
+
+    template<typename... Ts>
+    typename soa_vector<Ts...>::columns_type soa_vector<Ts...>::allocate_columns(size_t cap) {
+        const size_t bytes = (column_bytes(cap, sizeof(Ts)) + ...);
+        auto* block = static_cast<unsigned char*>(::operator new(bytes, std::align_val_t(column_alignment)));
+        return split_block(block, cap, indices());
+    }
+
+    template<typename... Ts>
+    void soa_vector<Ts...>::deallocate_columns(const columns_type& cols) noexcept {
+        if(std::get<0>(cols) != nullptr) {
+            ::operator delete(static_cast<void*>(std::get<0>(cols)), std::align_val_t(column_alignment));
+        }
+    }
+
+    template<typename... Ts>
+    template<size_t I, typename Tuple>
+    void soa_vector<Ts...>::construct_row(const columns_type& cols, size_t row, Tuple&& args) {
+        if constexpr(I < sizeof...(Ts)) {
+            using C = column_type<I>;
+            C* dest = std::get<I>(cols) + row;
+            new (dest) C(std::get<I>(std::forward<Tuple>(args)));
+            try {
+                construct_row<I + 1>(cols, row, std::forward<Tuple>(args));
+            } catch(...) {
+                dest->~C();
+                throw;
+            }
+        }
+    }
+
+    template<typename... Ts>
+    template<size_t I>
+    void soa_vector<Ts...>::construct_default_row(const columns_type& cols, size_t row) {
+        if constexpr(I < sizeof...(Ts)) {
+            using C = column_type<I>;
+            C* dest = std::get<I>(cols) + row;
+            new (dest) C();
+            try {
+                construct_default_row<I + 1>(cols, row);
+            } catch(...) {
+                dest->~C();
+                throw;
+            }
+        }
+    }
+
+    template<typename... Ts>
+    template<size_t... I>
+    void soa_vector<Ts...>::destroy_rows(const columns_type& cols, size_t first, size_t last, std::index_sequence<I...>) noexcept {
+        auto destroy = [first, last](auto* column) {
+            using C = std::remove_pointer_t<decltype(column)>;
+            if constexpr(!std::is_trivially_destructible<C>::value) {
+                for(size_t i=first; i<last; i++) {
+                    column[i].~C();
+                }
+            }
+        };
+        (destroy(std::get<I>(cols)), ...);
+    }
+
+    template<typename... Ts>
+    template<size_t... I>
+    void soa_vector<Ts...>::relocate_rows(const columns_type& from, const columns_type& to, size_t count, std::index_sequence<I...>) noexcept {
+        auto move_column = [count](auto* src, auto* dest) {
+            using C = std::remove_pointer_t<decltype(src)>;
+            std::allocator<C> alloc;
+            detail::relocate(alloc, src, src + count, dest);
+        };
+        (move_column(std::get<I>(from), std::get<I>(to)), ...);
+    }
+
+    template<typename... Ts>
+    void soa_vector<Ts...>::reallocate(size_t cap) {
+        columns_type fresh = allocate_columns(cap);
+        if(raw_size != 0) {
+            relocate_rows(columns, fresh, raw_size, indices());
+        }
+        deallocate_columns(columns);
+        columns = fresh;
+        _capacity = cap;
+    }
+
+    template<typename... Ts>
+    void soa_vector<Ts...>::reserve(size_t cap) {
+        if(cap > _capacity) {
+            reallocate(cap);
+        }
+    }
+
+    template<typename... Ts>
+    void soa_vector<Ts...>::push_back(const Ts&... values) {
+        emplace_back(values...);
+    }
+
+    template<typename... Ts>
+    void soa_vector<Ts...>::push_back(const value_type& r) {
+        std::apply([this](const auto&... values) { emplace_back(values...); }, r);
+    }
+
+    template<typename... Ts>
+    template<typename... Args>
+    typename soa_vector<Ts...>::reference soa_vector<Ts...>::emplace_back(Args&&... args) {
+        static_assert(sizeof...(Args) == sizeof...(Ts), "emplace_back takes one argument per column");
+        if(raw_size == _capacity) {
+            // Build the row in the new block first, args may be elements
+            const size_t cap = next_capacity();
+            columns_type fresh = allocate_columns(cap);
+            try {
+                construct_row<0>(fresh, raw_size, std::forward_as_tuple(std::forward<Args>(args)...));
+            } catch(...) {
+                deallocate_columns(fresh);
+                throw;
+            }
+            if(raw_size != 0) {
+                relocate_rows(columns, fresh, raw_size, indices());
+            }
+            deallocate_columns(columns);
+            columns = fresh;
+            _capacity = cap;
+        } else {
+            construct_row<0>(columns, raw_size, std::forward_as_tuple(std::forward<Args>(args)...));
+        }
+        raw_size++;
+        return back();
+    }
+
+    template<typename... Ts>
+    void soa_vector<Ts...>::pop_back() {
+        if(!empty()) {
+            destroy_rows(columns, raw_size - 1, raw_size, indices());
+            raw_size--;
+        }
+    }
+
+    template<typename... Ts>
+    void soa_vector<Ts...>::resize(size_t count) {
+        if(count < raw_size) {
+            destroy_rows(columns, count, raw_size, indices());
+            raw_size = count;
+            return;
+        }
+        reserve(count);
+        for(; raw_size<count; raw_size++) {
+            construct_default_row<0>(columns, raw_size);
+        }
+    }
+
+    template<typename... Ts>
+    void soa_vector<Ts...>::clear() noexcept {
+        destroy_rows(columns, 0, raw_size, indices());
+        raw_size = 0;
+    }
+
+    template<typename... Ts>
+    typename soa_vector<Ts...>::reference soa_vector<Ts...>::operator[](size_t i) {
+        default_bounds_check::check(i, raw_size);
+        return row(i, indices());
+    }
+
+    template<typename... Ts>
+    typename soa_vector<Ts...>::const_reference soa_vector<Ts...>::operator[](size_t i) const {
+        default_bounds_check::check(i, raw_size);
+        return row(i, indices());
+    }
+
+    template<typename... Ts>
+    typename soa_vector<Ts...>::reference soa_vector<Ts...>::at(size_t i) {
+        if(!(i < raw_size)) {
+            throw std::out_of_range("Attempted to access element out of range");
+        }
+        return row(i, indices());
+    }
+
+    template<typename... Ts>
+    typename soa_vector<Ts...>::const_reference soa_vector<Ts...>::at(size_t i) const {
+        if(!(i < raw_size)) {
+            throw std::out_of_range("Attempted to access element out of range");
+        }
+        return row(i, indices());
+    }
+
+    template<typename... Ts>
+    typename soa_vector<Ts...>::reference soa_vector<Ts...>::front() {
+        default_bounds_check::check(0, raw_size);
+        return row(0, indices());
+    }
+
+    template<typename... Ts>
+    typename soa_vector<Ts...>::const_reference soa_vector<Ts...>::front() const {
+        default_bounds_check::check(0, raw_size);
+        return row(0, indices());
+    }
+
+    template<typename... Ts>
+    typename soa_vector<Ts...>::reference soa_vector<Ts...>::back() {
+        default_bounds_check::check(0, raw_size);
+        return row(raw_size - 1, indices());
+    }
+
+    template<typename... Ts>
+    typename soa_vector<Ts...>::const_reference soa_vector<Ts...>::back() const {
+        default_bounds_check::check(0, raw_size);
+        return row(raw_size - 1, indices());
+    }
+
+    template<typename... Ts>
+    template<size_t I>
+    span<typename soa_vector<Ts...>::template column_type<I>> soa_vector<Ts...>::column() noexcept {
+        return span<column_type<I>>(std::get<I>(columns), raw_size);
+    }
+
+    template<typename... Ts>
+    template<size_t I>
+    span<const typename soa_vector<Ts...>::template column_type<I>> soa_vector<Ts...>::column() const noexcept {
+        return span<const column_type<I>>(std::get<I>(columns), raw_size);
+    }
+
+    template<typename... Ts>
+    template<size_t I>
+    typename soa_vector<Ts...>::template column_type<I>* soa_vector<Ts...>::data() noexcept {
+        return std::get<I>(columns);
+    }
+
+    template<typename... Ts>
+    template<size_t I>
+    const typename soa_vector<Ts...>::template column_type<I>* soa_vector<Ts...>::data() const noexcept {
+        return std::get<I>(columns);
+    }
+
+    template<typename... Ts>
+    size_t soa_vector<Ts...>::size() const noexcept {
+        return raw_size;
+    }
+
+    template<typename... Ts>
+    size_t soa_vector<Ts...>::capacity() const noexcept {
+        return _capacity;
+    }
+
+    template<typename... Ts>
+    bool soa_vector<Ts...>::empty() const noexcept {
+        return raw_size == 0;
+    }
+
+    template<typename... Ts>
+    void soa_vector<Ts...>::shrink_to_fit() {
+        if(raw_size == _capacity) {
+            return;
+        }
+        if(raw_size == 0) {
+            deallocate_columns(columns);
+            columns = columns_type();
+            _capacity = 0;
+        } else {
+            reallocate(raw_size);
+        }
+    }
+
+    template<typename... Ts>
+    void soa_vector<Ts...>::swap(soa_vector& other) noexcept {
+        std::swap(raw_size, other.raw_size);
+        std::swap(_capacity, other._capacity);
+        std::swap(columns, other.columns);
+    }
+
+    template<typename... Ts>
+    typename soa_vector<Ts...>::iterator soa_vector<Ts...>::begin() noexcept {
+        return iterator(this, 0);
+    }
+
+    template<typename... Ts>
+    typename soa_vector<Ts...>::const_iterator soa_vector<Ts...>::begin() const noexcept {
+        return cbegin();
+    }
+
+    template<typename... Ts>
+    typename soa_vector<Ts...>::const_iterator soa_vector<Ts...>::cbegin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    template<typename... Ts>
+    typename soa_vector<Ts...>::iterator soa_vector<Ts...>::end() noexcept {
+        return iterator(this, raw_size);
+    }
+
+    template<typename... Ts>
+    typename soa_vector<Ts...>::const_iterator soa_vector<Ts...>::end() const noexcept {
+        return cend();
+    }
+
+    template<typename... Ts>
+    typename soa_vector<Ts...>::const_iterator soa_vector<Ts...>::cend() const noexcept {
+        return const_iterator(this, raw_size);
+    }
+}
+
+namespace std {
+    //! Lets rows be unpacked with structured bindings
+    template<typename... Ts>
+    struct tuple_size<xd::soa_row<Ts...>>: std::integral_constant<size_t, sizeof...(Ts)> {};
+
+    template<size_t I, typename... Ts>
+    struct tuple_element<I, xd::soa_row<Ts...>> {
+        using type = std::tuple_element_t<I, std::tuple<Ts...>>&;
+    };
+}
+
+#endif
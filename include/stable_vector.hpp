@@ -0,0 +1,544 @@
+#ifndef XD_STABLE_VECTOR_H
+#define XD_STABLE_VECTOR_H
+#include <iterator>
+#include "vector.hpp"
+
+
+namespace xd {
+
+    namespace detail {
+        //! Largest power of two number of T that fits in about 4KB
+        template<typename T>
+        constexpr size_t default_chunk_size() {
+            size_t n = 1;
+            while(n*2*sizeof(T) <= 4096) {
+                n *= 2;
+            }
+            return n;
+        }
+    }
+
+    //! Vector made of fixed size chunks found through a directory. Growing
+    //! only allocates new chunks, so elements never move and pointers,
+    //! references and iterators stay valid until their element is erased.
+    //! Indexing is a shift and a mask into the directory.
+    template<typename T, size_t ChunkSize = detail::default_chunk_size<T>(),
+             typename Allocator = std::allocator<T>, typename BoundsCheck = default_bounds_check>
+    class stable_vector {
+    public:
+        using reference = T&;
+        using const_reference = const T&;
+        using value_type = T;
+        using allocator_type = Allocator;
+
+        static_assert(ChunkSize != 0 && (ChunkSize & (ChunkSize - 1)) == 0, "ChunkSize must be a power of two");
+        static_assert(std::is_same<typename Allocator::value_type, T>::value,
+                "Allocator::value_type must be the same as T");
+
+        template<typename Owner, typename Value>
+        class chunk_iterator;
+
+        using iterator = chunk_iterator<stable_vector, T>;
+        using const_iterator = chunk_iterator<const stable_vector, const T>;
+
+        stable_vector();
+        explicit stable_vector(const Allocator& alloc);
+        stable_vector(const stable_vector& other);
+        stable_vector(stable_vector&& other) noexcept;
+        stable_vector(size_t count, const_reference value, const Allocator& alloc = Allocator());
+        stable_vector(std::initializer_list<T> l, const Allocator& alloc = Allocator());
+
+        ~stable_vector();
+
+        stable_vector& operator=(const stable_vector& other);
+        stable_vector& operator=(stable_vector&& other) noexcept(
+                std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value ||
+                std::allocator_traits<Allocator>::is_always_equal::value);
+
+        //! Allocates chunks until capacity elements fit
+        void reserve(size_t capacity);
+
+        void push_back(const_reference value);
+        void push_back(T&& value);
+
+        template<typename... Args>
+        reference emplace_back(Args&&... args);
+
+        //! Frees the chunk past the end once two are unused, the spare one
+        //! stops a push/pop pair at a chunk boundary from thrashing
+        void pop_back();
+
+        void resize(size_t count);
+        void resize(size_t count, const T& value);
+
+        //! Destroys the elements, the chunks are kept
+        void clear();
+
+        reference operator[](size_t index);
+        const_reference operator[](size_t index) const;
+
+        reference at(size_t index);
+        const_reference at(size_t index) const;
+
+        reference front();
+        const_reference front() const;
+
+        reference back();
+        const_reference back() const;
+
+        size_t size() const noexcept;
+        size_t capacity() const noexcept;
+        bool empty() const noexcept;
+
+        //! Frees every chunk past the one holding the last element
+        void shrink_to_fit();
+
+        allocator_type get_allocator() const;
+
+        void swap(stable_vector& other) noexcept;
+
+        iterator begin() noexcept;
+        const_iterator begin() const noexcept;
+        const_iterator cbegin() const noexcept;
+
+        iterator end() noexcept;
+        const_iterator end() const noexcept;
+        const_iterator cend() const noexcept;
+    private:
+        using alloc_traits = std::allocator_traits<Allocator>;
+        using directory_allocator = typename alloc_traits::template rebind_alloc<T*>;
+
+        static constexpr size_t chunk_shift = __builtin_ctzll(ChunkSize);
+        static constexpr size_t chunk_mask = ChunkSize - 1;
+
+        T* slot(size_t index) const noexcept;
+        //! Makes sure the chunk for index raw_size exists
+        T* next_slot();
+        //! Frees chunks until at most keep remain
+        void release_chunks(size_t keep) noexcept;
+
+        //! Current size of the vector
+        size_t raw_size;
+        //! Chunks in order, elements fill them front to back
+        vector<T*, directory_allocator> chunks;
+        //! Allocator the chunks are obtained from
+        Allocator _alloc;
+    };
+
+    //! Random access iterator caching a pointer to its element, it only
+    //! goes back to the directory when it crosses into another chunk
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    template<typename Owner, typename Value>
+    class stable_vector<T, ChunkSize, Allocator, BoundsCheck>::chunk_iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Value*;
+        using reference = Value&;
+
+        chunk_iterator() noexcept: owner(nullptr), index(0), element(nullptr) {}
+        chunk_iterator(Owner* owner, size_t index) noexcept:
+        owner(owner),
+        index(index),
+        element(owner->slot(index)) {
+        }
+
+        //! iterator converts to const_iterator
+        template<typename O, typename V, typename = std::enable_if_t<std::is_convertible<V*, Value*>::value>>
+        chunk_iterator(const chunk_iterator<O, V>& other) noexcept:
+        owner(other.owner),
+        index(other.index),
+        element(other.element) {
+        }
+
+        reference operator*() const noexcept { return *element; }
+        pointer operator->() const noexcept { return element; }
+        reference operator[](difference_type n) const noexcept { return *owner->slot(index + n); }
+
+        chunk_iterator& operator++() noexcept {
+            index++;
+            if((index & chunk_mask) == 0) {
+                element = owner->slot(index);
+            } else {
+                element++;
+            }
+            return *this;
+        }
+        chunk_iterator operator++(int) noexcept { auto tmp = *this; ++*this; return tmp; }
+        chunk_iterator& operator--() noexcept {
+            if((index & chunk_mask) == 0) {
+                element = owner->slot(index - 1);
+            } else {
+                element--;
+            }
+            index--;
+            return *this;
+        }
+        chunk_iterator operator--(int) noexcept { auto tmp = *this; --*this; return tmp; }
+        chunk_iterator& operator+=(difference_type n) noexcept {
+            index += n;
+            element = owner->slot(index);
+            return *this;
+        }
+        chunk_iterator& operator-=(difference_type n) noexcept { return *this += -n; }
+        chunk_iterator operator+(difference_type n) const noexcept { return chunk_iterator(owner, index + n); }
+        chunk_iterator operator-(difference_type n) const noexcept { return chunk_iterator(owner, index - n); }
+        difference_type operator-(const chunk_iterator& other) const noexcept {
+            return difference_type(index) - difference_type(other.index);
+        }
+
+        bool operator==(const chunk_iterator& other) const noexcept { return index == other.index; }
+        bool operator!=(const chunk_iterator& other) const noexcept { return index != other.index; }
+        bool operator<(const chunk_iterator& other) const noexcept { return index < other.index; }
+        bool operator>(const chunk_iterator& other) const noexcept { return index > other.index; }
+        bool operator<=(const chunk_iterator& other) const noexcept { return index <= other.index; }
+        bool operator>=(const chunk_iterator& other) const noexcept { return index >= other.index; }
+    private:
+        template<typename O, typename V>
+        friend class chunk_iterator;
+
+        Owner* owner;
+        size_t index;
+        //! Element at index, nullptr if its chunk isn't allocated
+        Value* element;
+    };
+
+    template<typename T, size_t C, typename A, typename B>
+    bool operator==(const stable_vector<T, C, A, B>& lhs, const stable_vector<T, C, A, B>& rhs) {
+        return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+
+    template<typename T, size_t C, typename A, typename B>
+    bool operator!=(const stable_vector<T, C, A, B>& lhs, const stable_vector<T, C, A, B>& rhs) {
+        return !(lhs == rhs);
+    }
+
+    template<typename T, size_t C, typename A, typename B>
+    bool operator<(const stable_vector<T, C, A, B>& lhs, const stable_vector<T, C, A, B>& rhs) {
+        return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    stable_vector<T, ChunkSize, Allocator, BoundsCheck>::stable_vector():stable_vector(Allocator()) {
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    stable_vector<T, ChunkSize, Allocator, BoundsCheck>::stable_vector(const Allocator& alloc):
+    raw_size(0),
+    chunks(directory_allocator(alloc)),
+    _alloc(alloc) {
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    stable_vector<T, ChunkSize, Allocator, BoundsCheck>::stable_vector(const stable_vector& other):
+    stable_vector(alloc_traits::select_on_container_copy_construction(other._alloc)) {
+        reserve(other.size());
+        for(const auto& x: other) {
+            push_back(x);
+        }
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    stable_vector<T, ChunkSize, Allocator, BoundsCheck>::stable_vector(stable_vector&& other) noexcept:
+    raw_size(other.raw_size),
+    chunks(std::move(other.chunks)),
+    _alloc(std::move(other._alloc)) {
+        other.raw_size = 0;
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    stable_vector<T, ChunkSize, Allocator, BoundsCheck>::stable_vector(size_t count, const T& value, const Allocator& alloc):
+    stable_vector(alloc) {
+        resize(count, value);
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    stable_vector<T, ChunkSize, Allocator, BoundsCheck>::stable_vector(std::initializer_list<T> il, const Allocator& alloc):
+    stable_vector(alloc) {
+        reserve(il.size());
+        for(const auto& x: il) {
+            push_back(x);
+        }
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    stable_vector<T, ChunkSize, Allocator, BoundsCheck>::~stable_vector() {
+        clear();
+        release_chunks(0);
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    stable_vector<T, ChunkSize, Allocator, BoundsCheck>& stable_vector<T, ChunkSize, Allocator, BoundsCheck>::operator=(const stable_vector& other) {
+        if(this == &other) {
+            return *this;
+        }
+        clear();
+        if constexpr(alloc_traits::propagate_on_container_copy_assignment::value) {
+            if(_alloc != other._alloc) {
+                release_chunks(0);
+            }
+            _alloc = other._alloc;
+        }
+        reserve(other.size());
+        for(const auto& x: other) {
+            push_back(x);
+        }
+        return *this;
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    stable_vector<T, ChunkSize, Allocator, BoundsCheck>& stable_vector<T, ChunkSize, Allocator, BoundsCheck>::operator=(stable_vector&& other) noexcept(
+            std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value ||
+            std::allocator_traits<Allocator>::is_always_equal::value) {
+        if(this == &other) {
+            return *this;
+        }
+        clear();
+        if(alloc_traits::propagate_on_container_move_assignment::value || _alloc == other._alloc) {
+            release_chunks(0);
+            if constexpr(alloc_traits::propagate_on_container_move_assignment::value) {
+                _alloc = std::move(other._alloc);
+            }
+            chunks.swap(other.chunks);
+            raw_size = other.raw_size;
+            other.raw_size = 0;
+        } else if constexpr(!alloc_traits::is_always_equal::value) {
+            // Chunks can't change allocator, move the elements one by one.
+            // If that throws this is left empty and other keeps its
+            // elements.
+            try {
+                reserve(other.size());
+                for(auto& x: other) {
+                    push_back(std::move_if_noexcept(x));
+                }
+            } catch(...) {
+                clear();
+                throw;
+            }
+            other.clear();
+        }
+        return *this;
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    T* stable_vector<T, ChunkSize, Allocator, BoundsCheck>::slot(size_t index) const noexcept {
+        const size_t chunk = index >> chunk_shift;
+        return chunk < chunks.size() ? chunks.data()[chunk] + (index & chunk_mask) : nullptr;
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    T* stable_vector<T, ChunkSize, Allocator, BoundsCheck>::next_slot() {
+        if(raw_size == capacity()) {
+            // Make room in the directory first so a failure there doesn't
+            // leak the chunk
+            chunks.reserve(chunks.size() + 1);
+            chunks.push_back(alloc_traits::allocate(_alloc, ChunkSize));
+        }
+        return chunks.data()[raw_size >> chunk_shift] + (raw_size & chunk_mask);
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    void stable_vector<T, ChunkSize, Allocator, BoundsCheck>::release_chunks(size_t keep) noexcept {
+        while(chunks.size() > keep) {
+            alloc_traits::deallocate(_alloc, chunks.back(), ChunkSize);
+            chunks.pop_back();
+        }
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    void stable_vector<T, ChunkSize, Allocator, BoundsCheck>::reserve(size_t cap) {
+        const size_t needed = (cap + chunk_mask) >> chunk_shift;
+        if(needed > chunks.size()) {
+            chunks.reserve(needed);
+            while(chunks.size() < needed) {
+                chunks.push_back(alloc_traits::allocate(_alloc, ChunkSize));
+            }
+        }
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    void stable_vector<T, ChunkSize, Allocator, BoundsCheck>::push_back(const T& value) {
+        emplace_back(value);
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    void stable_vector<T, ChunkSize, Allocator, BoundsCheck>::push_back(T&& value) {
+        emplace_back(std::move(value));
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    template<typename... Args>
+    T& stable_vector<T, ChunkSize, Allocator, BoundsCheck>::emplace_back(Args&&... args) {
+        // Elements never move so args can't be invalidated by growing
+        T* dest = next_slot();
+        alloc_traits::construct(_alloc, dest, std::forward<Args>(args)...);
+        raw_size++;
+        return *dest;
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    void stable_vector<T, ChunkSize, Allocator, BoundsCheck>::pop_back() {
+        if(!empty()) {
+            raw_size--;
+            alloc_traits::destroy(_alloc, slot(raw_size));
+            const size_t used = (raw_size + chunk_mask) >> chunk_shift;
+            if(chunks.size() > used + 1) {
+                release_chunks(used + 1);
+            }
+        }
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    void stable_vector<T, ChunkSize, Allocator, BoundsCheck>::resize(size_t count) {
+        while(raw_size > count) {
+            raw_size--;
+            alloc_traits::destroy(_alloc, slot(raw_size));
+        }
+        reserve(count);
+        while(raw_size < count) {
+            emplace_back();
+        }
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    void stable_vector<T, ChunkSize, Allocator, BoundsCheck>::resize(size_t count, const T& value) {
+        while(raw_size > count) {
+            raw_size--;
+            alloc_traits::destroy(_alloc, slot(raw_size));
+        }
+        reserve(count);
+        while(raw_size < count) {
+            emplace_back(value);
+        }
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    void stable_vector<T, ChunkSize, Allocator, BoundsCheck>::clear() {
+        if constexpr(!std::is_trivially_destructible<T>::value) {
+            for(size_t i=0; i<raw_size; i++) {
+                alloc_traits::destroy(_alloc, slot(i));
+            }
+        }
+        raw_size = 0;
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    T& stable_vector<T, ChunkSize, Allocator, BoundsCheck>::operator[](size_t i) {
+        BoundsCheck::check(i, raw_size);
+        return chunks.data()[i >> chunk_shift][i & chunk_mask];
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    const T& stable_vector<T, ChunkSize, Allocator, BoundsCheck>::operator[](size_t i) const {
+        BoundsCheck::check(i, raw_size);
+        return chunks.data()[i >> chunk_shift][i & chunk_mask];
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    T& stable_vector<T, ChunkSize, Allocator, BoundsCheck>::at(size_t i) {
+        if(!(i < raw_size)) {
+            throw std::out_of_range("Attempted to access element out of range");
+        }
+        return *slot(i);
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    const T& stable_vector<T, ChunkSize, Allocator, BoundsCheck>::at(size_t i) const {
+        if(!(i < raw_size)) {
+            throw std::out_of_range("Attempted to access element out of range");
+        }
+        return *slot(i);
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    T& stable_vector<T, ChunkSize, Allocator, BoundsCheck>::front() {
+        BoundsCheck::check(0, raw_size);
+        return *slot(0);
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    const T& stable_vector<T, ChunkSize, Allocator, BoundsCheck>::front() const {
+        BoundsCheck::check(0, raw_size);
+        return *slot(0);
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    T& stable_vector<T, ChunkSize, Allocator, BoundsCheck>::back() {
+        BoundsCheck::check(0, raw_size);
+        return *slot(raw_size - 1);
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    const T& stable_vector<T, ChunkSize, Allocator, BoundsCheck>::back() const {
+        BoundsCheck::check(0, raw_size);
+        return *slot(raw_size - 1);
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    size_t stable_vector<T, ChunkSize, Allocator, BoundsCheck>::size() const noexcept {
+        return raw_size;
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    size_t stable_vector<T, ChunkSize, Allocator, BoundsCheck>::capacity() const noexcept {
+        return chunks.size()*ChunkSize;
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    bool stable_vector<T, ChunkSize, Allocator, BoundsCheck>::empty() const noexcept {
+        return raw_size == 0;
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    void stable_vector<T, ChunkSize, Allocator, BoundsCheck>::shrink_to_fit() {
+        release_chunks((raw_size + chunk_mask) >> chunk_shift);
+        chunks.shrink_to_fit();
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    Allocator stable_vector<T, ChunkSize, Allocator, BoundsCheck>::get_allocator() const {
+        return _alloc;
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    void stable_vector<T, ChunkSize, Allocator, BoundsCheck>::swap(stable_vector& other) noexcept {
+        std::swap(raw_size, other.raw_size);
+        chunks.swap(other.chunks);
+        if constexpr(alloc_traits::propagate_on_container_swap::value) {
+            std::swap(_alloc, other._alloc);
+        }
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    typename stable_vector<T, ChunkSize, Allocator, BoundsCheck>::iterator stable_vector<T, ChunkSize, Allocator, BoundsCheck>::begin() noexcept {
+        return iterator(this, 0);
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    typename stable_vector<T, ChunkSize, Allocator, BoundsCheck>::const_iterator stable_vector<T, ChunkSize, Allocator, BoundsCheck>::begin() const noexcept {
+        return cbegin();
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    typename stable_vector<T, ChunkSize, Allocator, BoundsCheck>::const_iterator stable_vector<T, ChunkSize, Allocator, BoundsCheck>::cbegin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    typename stable_vector<T, ChunkSize, Allocator, BoundsCheck>::iterator stable_vector<T, ChunkSize, Allocator, BoundsCheck>::end() noexcept {
+        return iterator(this, raw_size);
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    typename stable_vector<T, ChunkSize, Allocator, BoundsCheck>::const_iterator stable_vector<T, ChunkSize, Allocator, BoundsCheck>::end() const noexcept {
+        return cend();
+    }
+
+    template<typename T, size_t ChunkSize, typename Allocator, typename BoundsCheck>
+    typename stable_vector<T, ChunkSize, Allocator, BoundsCheck>::const_iterator stable_vector<T, ChunkSize, Allocator, BoundsCheck>::cend() const noexcept {
+        return const_iterator(this, raw_size);
+    }
+}
+
+#endif
@@ -0,0 +1,906 @@
+#ifndef XD_STATIC_VECTOR_H
+#define XD_STATIC_VECTOR_H
+#include <algorithm>
+#include <cstdint>
+#include "vector.hpp"
+
+
+namespace xd {
+
+    namespace detail {
+        //! Smallest unsigned type that can count to N
+        template<size_t N>
+        using smallest_size_t = std::conditional_t<N <= UINT8_MAX, uint8_t,
+                std::conditional_t<N <= UINT16_MAX, uint16_t,
+                std::conditional_t<N <= UINT32_MAX, uint32_t, uint64_t>>>;
+
+        //! Inline buffer and count for static_vector. The buffer comes first
+        //! so the count packs into the tail padding of the elements.
+        template<typename T, size_t N>
+        struct static_vector_buffer {
+            T* elements() noexcept {
+                return reinterpret_cast<T*>(buffer);
+            }
+
+            const T* elements() const noexcept {
+                return reinterpret_cast<const T*>(buffer);
+            }
+
+            alignas(T) unsigned char buffer[N*sizeof(T)];
+            smallest_size_t<N> raw_size = 0;
+        };
+
+        //! Trivially copyable elements get the implicit copy, move and
+        //! destructor so static_vector is trivially copyable too
+        template<typename T, size_t N, bool = std::is_trivially_copyable<T>::value>
+        struct static_vector_storage: static_vector_buffer<T, N> {
+        };
+
+        template<typename T, size_t N>
+        struct static_vector_storage<T, N, false>: static_vector_buffer<T, N> {
+            using alloc_traits = std::allocator_traits<std::allocator<T>>;
+
+            static_vector_storage() noexcept = default;
+
+            static_vector_storage(const static_vector_storage& other) {
+                std::allocator<T> alloc;
+                T* end = detail::uninitialized_copy(alloc, other.elements(), other.elements() + other.raw_size, this->elements());
+                this->raw_size = smallest_size_t<N>(end - this->elements());
+            }
+
+            static_vector_storage(static_vector_storage&& other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+                std::allocator<T> alloc;
+                detail::relocate(alloc, other.elements(), other.elements() + other.raw_size, this->elements());
+                this->raw_size = other.raw_size;
+                other.raw_size = 0;
+            }
+
+            ~static_vector_storage() {
+                destroy_from(0);
+            }
+
+            static_vector_storage& operator=(const static_vector_storage& other) {
+                if(this == &other) {
+                    return *this;
+                }
+                // Assign over the elements both have, then build or destroy
+                // the difference
+                const size_t common = std::min<size_t>(this->raw_size, other.raw_size);
+                std::copy(other.elements(), other.elements() + common, this->elements());
+                if(other.raw_size > common) {
+                    std::allocator<T> alloc;
+                    detail::uninitialized_copy(alloc, other.elements() + common, other.elements() + other.raw_size,
+                                               this->elements() + common);
+                    this->raw_size = other.raw_size;
+                } else {
+                    destroy_from(common);
+                }
+                return *this;
+            }
+
+            static_vector_storage& operator=(static_vector_storage&& other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+                if(this == &other) {
+                    return *this;
+                }
+                destroy_from(0);
+                std::allocator<T> alloc;
+                detail::relocate(alloc, other.elements(), other.elements() + other.raw_size, this->elements());
+                this->raw_size = other.raw_size;
+                other.raw_size = 0;
+                return *this;
+            }
+
+            void destroy_from(size_t count) noexcept {
+                std::allocator<T> alloc;
+                for(size_t i=count; i<this->raw_size; i++) {
+                    alloc_traits::destroy(alloc, this->elements() + i);
+                }
+                this->raw_size = smallest_size_t<N>(count);
+            }
+        };
+    }
+
+    //! Vector with inline storage for exactly N elements that never
+    //! allocates, for code where the heap is off limits. Same interface as
+    //! xd::vector, growing past N throws std::length_error and the try_
+    //! functions report it instead. Copies are plain memcpys when T is
+    //! trivially copyable and the count is the smallest type that fits N,
+    //! so a static_vector<uint32_t, 15> is one 64 byte cache line.
+    template<typename T, size_t N, typename BoundsCheck = default_bounds_check>
+    class static_vector: private detail::static_vector_storage<T, N> {
+    public:
+        using reference = T&;
+        using const_reference = const T&;
+        using value_type = T;
+        using pointer = T*;
+        using iterator = pointer;
+        using const_pointer = const T*;
+        using const_iterator = const_pointer;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using size_type = detail::smallest_size_t<N>;
+
+        static_assert(N > 0, "static_vector needs room for at least one element");
+
+        // default constructor
+        static_vector() noexcept;
+        // Fill with a given value
+        static_vector(size_t count, const_reference value);
+        explicit static_vector(size_t count);
+        template<typename InputIt, typename = detail::require_input_iterator<InputIt>>
+        static_vector(InputIt first, InputIt last);
+        static_vector(std::initializer_list<T> l);
+
+        static_vector& operator=(std::initializer_list<T> il);
+
+        void assign(size_t count, const_reference value);
+        template<typename InputIt, typename = detail::require_input_iterator<InputIt>>
+        void assign(InputIt first, InputIt last);
+        void assign(std::initializer_list<T> il);
+
+        //! Only checks capacity fits, the storage is always there
+        void reserve(size_t capacity);
+
+        void push_back(const_reference value);
+        void push_back(T&& value);
+        //! Appends unless full, returns whether it did
+        bool try_push_back(const_reference value);
+        bool try_push_back(T&& value);
+
+        template<typename... Args>
+        reference emplace_back(Args&&... args);
+        //! Constructs at the end unless full, returns the new element or
+        //! nullptr
+        template<typename... Args>
+        pointer try_emplace_back(Args&&... args);
+
+        template<typename... Args>
+        iterator emplace(const_iterator pos, Args&&... args);
+
+        iterator insert(const_iterator pos, const T& value);
+        iterator insert(const_iterator pos, T&& value);
+        iterator insert(const_iterator pos, size_t count, const T& value);
+        template<typename InputIt, typename = detail::require_input_iterator<InputIt>>
+        iterator insert(const_iterator pos, InputIt first, InputIt last);
+        iterator insert(const_iterator pos, std::initializer_list<T> il);
+
+        iterator erase(const_iterator pos);
+        iterator erase(const_iterator first, const_iterator last);
+        //! O(1) erase that moves the last element into pos, doesn't keep
+        //! the order of the elements
+        iterator erase_unordered(const_iterator pos);
+        //! Erases the elements at the given ascending indices in one sweep,
+        //! returns how many were removed. Repeated indices are fine, out of
+        //! order ones throw std::invalid_argument and past the end ones
+        //! std::out_of_range, both before anything is erased
+        template<typename Indices>
+        size_t erase_indices(const Indices& sorted_indices);
+        //! Erases every element matching pred in one pass, returns how
+        //! many were removed
+        template<typename Predicate>
+        size_t remove_if(Predicate pred);
+
+        void pop_back();
+
+        void resize(size_t count);
+        void resize(size_t count, const T& value);
+
+        void clear() noexcept;
+
+        reference operator[](size_t index);
+        const_reference operator[](size_t index) const;
+
+        reference at(size_t index);
+        const_reference at(size_t index) const;
+
+        reference front();
+        const_reference front() const;
+
+        reference back();
+        const_reference back() const;
+
+        size_t size() const noexcept;
+        static constexpr size_t capacity() noexcept;
+        bool empty() const noexcept;
+        //! Whether another element would throw
+        bool full() const noexcept;
+        static constexpr size_t max_size() noexcept;
+
+        //! No-op, the capacity is fixed
+        void shrink_to_fit() noexcept;
+
+        pointer data() noexcept;
+
+        const_pointer data() const noexcept;
+
+        void swap(static_vector& other) noexcept(std::is_nothrow_move_constructible<T>::value &&
+                                                 std::is_nothrow_swappable<T>::value);
+
+        iterator begin() noexcept;
+        const_iterator begin() const noexcept;
+        const_iterator cbegin() const noexcept;
+
+        iterator end() noexcept;
+        const_iterator end() const noexcept;
+        const_iterator cend() const noexcept;
+
+        iterator rbegin() noexcept;
+        const_iterator rbegin() const noexcept;
+        const_iterator crbegin() const noexcept;
+
+        iterator rend() noexcept;
+        const_iterator rend() const noexcept;
+        const_iterator crend() const noexcept;
+    private:
+        using storage = detail::static_vector_storage<T, N>;
+        using alloc_traits = std::allocator_traits<std::allocator<T>>;
+
+        //! Throws std::length_error if required elements don't fit
+        static void check_capacity(size_t required);
+        //! Destroys the elements from count onwards
+        void truncate(size_t count) noexcept;
+        //! Moves the live objects in [first, last) to the uninitialised
+        //! memory at dest, the ranges may overlap
+        static void relocate(T* first, T* last, T* dest);
+        //! Opens a gap of count uninitialised slots at index, throws if
+        //! they don't fit. Returns a pointer to the start of the gap.
+        T* open_gap(size_t index, size_t count);
+        //! Closes a gap previously opened by open_gap
+        void close_gap(size_t index, size_t count);
+    };
+
+    //! Erases every element equal to value, returns the number removed
+    template<class T, size_t N, class BoundsCheck, class U>
+    size_t erase(static_vector<T, N, BoundsCheck>& vec, const U& value);
+    //! Erases every element matching pred, returns the number removed
+    template<class T, size_t N, class BoundsCheck, class Predicate>
+    size_t erase_if(static_vector<T, N, BoundsCheck>& vec, Predicate pred);
+
+    template<class T, size_t N, class BoundsCheck>
+    bool operator==(const static_vector<T, N, BoundsCheck>& lhs, const static_vector<T, N, BoundsCheck>& rhs);
+    template<class T, size_t N, class BoundsCheck>
+    bool operator!=(const static_vector<T, N, BoundsCheck>& lhs, const static_vector<T, N, BoundsCheck>& rhs);
+    template<class T, size_t N, class BoundsCheck>
+    bool operator<(const static_vector<T, N, BoundsCheck>& lhs, const static_vector<T, N, BoundsCheck>& rhs);
+    template<class T, size_t N, class BoundsCheck>
+    bool operator<=(const static_vector<T, N, BoundsCheck>& lhs, const static_vector<T, N, BoundsCheck>& rhs);
+    template<class T, size_t N, class BoundsCheck>
+    bool operator>(const static_vector<T, N, BoundsCheck>& lhs, const static_vector<T, N, BoundsCheck>& rhs);
+    template<class T, size_t N, class BoundsCheck>
+    bool operator>=(const static_vector<T, N, BoundsCheck>& lhs, const static_vector<T, N, BoundsCheck>& rhs);
+
+    template<typename T, size_t N, typename BoundsCheck>
+    static_vector<T, N, BoundsCheck>::static_vector() noexcept {
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    static_vector<T, N, BoundsCheck>::static_vector(size_t count, const T& value) {
+        assign(count, value);
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    static_vector<T, N, BoundsCheck>::static_vector(size_t count) {
+        resize(count);
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    template<typename InputIt, typename>
+    static_vector<T, N, BoundsCheck>::static_vector(InputIt first, InputIt last) {
+        assign(first, last);
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    static_vector<T, N, BoundsCheck>::static_vector(std::initializer_list<T> il):static_vector(il.begin(), il.end()) {
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    static_vector<T, N, BoundsCheck>& static_vector<T, N, BoundsCheck>::operator=(std::initializer_list<T> il) {
+        assign(il.begin(), il.end());
+        return *this;
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    void static_vector<T, N, BoundsCheck>::assign(size_t count, const T& value) {
+        check_capacity(count);
+        // value may live in this vector so copy it before clearing
+        const T tmp(value);
+        clear();
+        if constexpr(std::is_trivially_copyable<T>::value) {
+            detail::fill(data(), count, tmp);
+            this->raw_size = size_type(count);
+        } else {
+            std::allocator<T> alloc;
+            for(size_t i=0; i<count; i++) {
+                alloc_traits::construct(alloc, data() + i, tmp);
+                this->raw_size++;
+            }
+        }
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    template<typename InputIt, typename>
+    void static_vector<T, N, BoundsCheck>::assign(InputIt first, InputIt last) {
+        if constexpr(detail::is_forward_iterator_v<InputIt>) {
+            const size_t count = std::distance(first, last);
+            check_capacity(count);
+            if constexpr(std::is_pointer<InputIt>::value) {
+                if(first != last && detail::points_into(&*first, data(), size())) {
+                    // Copy out before clearing, the range is our own
+                    const static_vector tmp(first, last);
+                    *this = tmp;
+                    return;
+                }
+            }
+            clear();
+            std::allocator<T> alloc;
+            this->raw_size = size_type(detail::uninitialized_copy(alloc, first, last, data()) - data());
+        } else {
+            clear();
+            for(; first!=last; ++first) {
+                emplace_back(*first);
+            }
+        }
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    void static_vector<T, N, BoundsCheck>::assign(std::initializer_list<T> il) {
+        assign(il.begin(), il.end());
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    void static_vector<T, N, BoundsCheck>::reserve(size_t cap) {
+        check_capacity(cap);
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    void static_vector<T, N, BoundsCheck>::check_capacity(size_t required) {
+        if(required > N) {
+            throw std::length_error("static_vector capacity exceeded");
+        }
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    void static_vector<T, N, BoundsCheck>::truncate(size_t count) noexcept {
+        std::allocator<T> alloc;
+        for(size_t i=count; i<size(); i++) {
+            alloc_traits::destroy(alloc, data() + i);
+        }
+        this->raw_size = size_type(count);
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    void static_vector<T, N, BoundsCheck>::relocate(T* first, T* last, T* dest) {
+        std::allocator<T> alloc;
+        detail::relocate(alloc, first, last, dest);
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    T* static_vector<T, N, BoundsCheck>::open_gap(size_t index, size_t count) {
+        check_capacity(size() + count);
+        relocate(data() + index, data() + size(), data() + index + count);
+        return data() + index;
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    void static_vector<T, N, BoundsCheck>::close_gap(size_t index, size_t count) {
+        relocate(data() + index + count, data() + size() + count, data() + index);
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    template<typename... Args>
+    T& static_vector<T, N, BoundsCheck>::emplace_back(Args&&... args) {
+        // A one byte count is a char type so element stores may alias it,
+        // keep it in a local and write it back last
+        const size_t n = size();
+        check_capacity(n + 1);
+        std::allocator<T> alloc;
+        T* slot = data() + n;
+        alloc_traits::construct(alloc, slot, std::forward<Args>(args)...);
+        this->raw_size = size_type(n + 1);
+        return *slot;
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    template<typename... Args>
+    T* static_vector<T, N, BoundsCheck>::try_emplace_back(Args&&... args) {
+        const size_t n = size();
+        if(n == N) {
+            return nullptr;
+        }
+        std::allocator<T> alloc;
+        T* slot = data() + n;
+        alloc_traits::construct(alloc, slot, std::forward<Args>(args)...);
+        this->raw_size = size_type(n + 1);
+        return slot;
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    template<typename... Args>
+    T* static_vector<T, N, BoundsCheck>::emplace(const T* pos, Args&&... args) {
+        const size_t index = std::distance(cbegin(), pos);
+        if(index == size()) {
+            emplace_back(std::forward<Args>(args)...);
+            return data() + index;
+        }
+        // args may refer to an element that open_gap is about to move
+        T tmp(std::forward<Args>(args)...);
+        T* gap = open_gap(index, 1);
+        try {
+            std::allocator<T> alloc;
+            alloc_traits::construct(alloc, gap, std::move(tmp));
+        } catch(...) {
+            close_gap(index, 1);
+            throw;
+        }
+        this->raw_size++;
+        return gap;
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    void static_vector<T, N, BoundsCheck>::push_back(const T& value) {
+        emplace_back(value);
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    void static_vector<T, N, BoundsCheck>::push_back(T&& value) {
+        emplace_back(std::move(value));
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    bool static_vector<T, N, BoundsCheck>::try_push_back(const T& value) {
+        return try_emplace_back(value) != nullptr;
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    bool static_vector<T, N, BoundsCheck>::try_push_back(T&& value) {
+        return try_emplace_back(std::move(value)) != nullptr;
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    T* static_vector<T, N, BoundsCheck>::insert(const T* pos, const T& value) {
+        return emplace(pos, value);
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    T* static_vector<T, N, BoundsCheck>::insert(const T* pos, T&& value) {
+        return emplace(pos, std::move(value));
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    T* static_vector<T, N, BoundsCheck>::insert(const T* pos, size_t count, const T& value) {
+        const size_t index = std::distance(cbegin(), pos);
+        if(count == 0) {
+            return data() + index;
+        }
+        const T tmp(value);
+        T* gap = open_gap(index, count);
+        if constexpr(std::is_trivially_copyable<T>::value) {
+            detail::fill(gap, count, tmp);
+            this->raw_size += size_type(count);
+            return gap;
+        }
+        std::allocator<T> alloc;
+        size_t i = 0;
+        try {
+            for(; i<count; i++) {
+                alloc_traits::construct(alloc, gap + i, tmp);
+            }
+        } catch(...) {
+            for(size_t j=0; j<i; j++) {
+                alloc_traits::destroy(alloc, gap + j);
+            }
+            close_gap(index, count);
+            throw;
+        }
+        this->raw_size += size_type(count);
+        return gap;
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    template<typename InputIt, typename>
+    T* static_vector<T, N, BoundsCheck>::insert(const T* pos, InputIt first, InputIt last) {
+        const size_t index = std::distance(cbegin(), pos);
+        if constexpr(detail::is_forward_iterator_v<InputIt>) {
+            if constexpr(std::is_pointer<InputIt>::value) {
+                // The range would move under us when the gap opens
+                if(first != last && detail::points_into(&*first, data(), size())) {
+                    const static_vector tmp(first, last);
+                    return insert(pos, tmp.begin(), tmp.end());
+                }
+            }
+            const size_t count = std::distance(first, last);
+            if(count == 0) {
+                return data() + index;
+            }
+            T* gap = open_gap(index, count);
+            try {
+                std::allocator<T> alloc;
+                detail::uninitialized_copy(alloc, first, last, gap);
+            } catch(...) {
+                close_gap(index, count);
+                throw;
+            }
+            this->raw_size += size_type(count);
+            return gap;
+        } else {
+            const size_t old_size = size();
+            try {
+                for(; first!=last; ++first) {
+                    emplace_back(*first);
+                }
+            } catch(...) {
+                // Drop the partial append so nothing is half inserted
+                truncate(old_size);
+                throw;
+            }
+            std::rotate(data() + index, data() + old_size, data() + size());
+            return data() + index;
+        }
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    T* static_vector<T, N, BoundsCheck>::insert(const T* pos, std::initializer_list<T> il) {
+        return insert(pos, il.begin(), il.end());
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    T* static_vector<T, N, BoundsCheck>::erase(const T* pos) {
+        const size_t index = std::distance(cbegin(), pos);
+        std::allocator<T> alloc;
+        alloc_traits::destroy(alloc, data() + index);
+        relocate(data() + index + 1, data() + size(), data() + index);
+        this->raw_size--;
+        return data() + index;
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    T* static_vector<T, N, BoundsCheck>::erase(const T* first, const T* last) {
+        const size_t len = std::distance(first, last);
+        const size_t index = std::distance(cbegin(), first);
+        if(len > 0) {
+            std::allocator<T> alloc;
+            for(size_t i=index; i<index+len; i++) {
+                alloc_traits::destroy(alloc, data() + i);
+            }
+            relocate(data() + index + len, data() + size(), data() + index);
+            this->raw_size -= size_type(len);
+        }
+        return data() + index;
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    T* static_vector<T, N, BoundsCheck>::erase_unordered(const T* pos) {
+        const size_t index = std::distance(cbegin(), pos);
+        std::allocator<T> alloc;
+        alloc_traits::destroy(alloc, data() + index);
+        if(index != size() - 1) {
+            relocate(data() + size() - 1, data() + size(), data() + index);
+        }
+        this->raw_size--;
+        return data() + index;
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    template<typename Indices>
+    size_t static_vector<T, N, BoundsCheck>::erase_indices(const Indices& sorted_indices) {
+        auto it = std::begin(sorted_indices);
+        const auto last = std::end(sorted_indices);
+        if(it == last) {
+            return 0;
+        }
+        // Reject bad input before anything moves, a descending index would
+        // otherwise be skipped as a duplicate and erase the wrong set
+        size_t previous = *it;
+        for(auto check = it; check != last; ++check) {
+            if(*check < previous) {
+                throw std::invalid_argument("erase_indices needs ascending indices");
+            }
+            previous = *check;
+        }
+        if(previous >= size()) {
+            throw std::out_of_range("Attempted to access element out of range");
+        }
+        std::allocator<T> alloc;
+        // [write, read) is always the uninitialised hole left by erasing
+        size_t write = *it;
+        size_t read = write;
+        for(; it != last; ++it) {
+            const size_t index = *it;
+            if(index < read) {
+                // Duplicate index
+                continue;
+            }
+            relocate(data() + read, data() + index, data() + write);
+            write += index - read;
+            alloc_traits::destroy(alloc, data() + index);
+            read = index + 1;
+        }
+        relocate(data() + read, data() + size(), data() + write);
+        write += size() - read;
+        const size_t removed = size() - write;
+        this->raw_size = size_type(write);
+        return removed;
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    template<typename Predicate>
+    size_t static_vector<T, N, BoundsCheck>::remove_if(Predicate pred) {
+        std::allocator<T> alloc;
+        T* const elements = data();
+        const size_t n = size();
+        size_t read = 0;
+        while(read < n && !pred(elements[read])) {
+            read++;
+        }
+        // [write, read) is always the uninitialised hole left by erasing
+        size_t write = read;
+        size_t run_start = read;
+        try {
+            for(; read < n; read++) {
+                if(pred(elements[read])) {
+                    relocate(elements + run_start, elements + read, elements + write);
+                    write += read - run_start;
+                    alloc_traits::destroy(alloc, elements + read);
+                    run_start = read + 1;
+                }
+            }
+        } catch(...) {
+            // Close the hole so the vector stays valid
+            relocate(elements + run_start, elements + n, elements + write);
+            this->raw_size = size_type(write + (n - run_start));
+            throw;
+        }
+        relocate(elements + run_start, elements + n, elements + write);
+        write += n - run_start;
+        this->raw_size = size_type(write);
+        return n - write;
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    void static_vector<T, N, BoundsCheck>::pop_back() {
+        if(!empty()) {
+            truncate(size() - 1);
+        }
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    void static_vector<T, N, BoundsCheck>::resize(size_t count) {
+        if(count < size()) {
+            truncate(count);
+            return;
+        }
+        check_capacity(count);
+        std::allocator<T> alloc;
+        for(; size()<count; this->raw_size++) {
+            alloc_traits::construct(alloc, data() + size());
+        }
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    void static_vector<T, N, BoundsCheck>::resize(size_t count, const T& value) {
+        if(count < size()) {
+            truncate(count);
+            return;
+        }
+        check_capacity(count);
+        const T tmp(value);
+        if constexpr(std::is_trivially_copyable<T>::value) {
+            detail::fill(data() + size(), count - size(), tmp);
+            this->raw_size = size_type(count);
+        } else {
+            std::allocator<T> alloc;
+            for(; size()<count; this->raw_size++) {
+                alloc_traits::construct(alloc, data() + size(), tmp);
+            }
+        }
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    void static_vector<T, N, BoundsCheck>::clear() noexcept {
+        truncate(0);
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    T& static_vector<T, N, BoundsCheck>::operator[](size_t i) {
+        BoundsCheck::check(i, size());
+        return data()[i];
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    const T& static_vector<T, N, BoundsCheck>::operator[](size_t i) const {
+        BoundsCheck::check(i, size());
+        return data()[i];
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    T& static_vector<T, N, BoundsCheck>::at(size_t i) {
+        if(!(i < size())) {
+            throw std::out_of_range("Attempted to access element out of range");
+        }
+        return data()[i];
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    const T& static_vector<T, N, BoundsCheck>::at(size_t i) const {
+        if(!(i < size())) {
+            throw std::out_of_range("Attempted to access element out of range");
+        }
+        return data()[i];
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    const T& static_vector<T, N, BoundsCheck>::front() const {
+        BoundsCheck::check(0, size());
+        return data()[0];
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    T& static_vector<T, N, BoundsCheck>::front() {
+        BoundsCheck::check(0, size());
+        return data()[0];
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    const T& static_vector<T, N, BoundsCheck>::back() const {
+        BoundsCheck::check(0, size());
+        return data()[size()-1];
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    T& static_vector<T, N, BoundsCheck>::back() {
+        BoundsCheck::check(0, size());
+        return data()[size()-1];
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    size_t static_vector<T, N, BoundsCheck>::size() const noexcept {
+        return this->raw_size;
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    constexpr size_t static_vector<T, N, BoundsCheck>::capacity() noexcept {
+        return N;
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    constexpr size_t static_vector<T, N, BoundsCheck>::max_size() noexcept {
+        return N;
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    bool static_vector<T, N, BoundsCheck>::empty() const noexcept {
+        return this->raw_size == 0;
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    bool static_vector<T, N, BoundsCheck>::full() const noexcept {
+        return this->raw_size == N;
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    void static_vector<T, N, BoundsCheck>::shrink_to_fit() noexcept {
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    void static_vector<T, N, BoundsCheck>::swap(static_vector<T, N, BoundsCheck>& other)
+            noexcept(std::is_nothrow_move_constructible<T>::value && std::is_nothrow_swappable<T>::value) {
+        static_vector* shorter = size() < other.size() ? this : &other;
+        static_vector* longer = shorter == this ? &other : this;
+        const size_t common = shorter->size();
+        std::swap_ranges(data(), data() + common, other.data());
+        relocate(longer->data() + common, longer->data() + longer->size(), shorter->data() + common);
+        shorter->raw_size = longer->raw_size;
+        longer->raw_size = size_type(common);
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    T* static_vector<T, N, BoundsCheck>::data() noexcept {
+        return this->elements();
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    const T* static_vector<T, N, BoundsCheck>::data() const noexcept {
+        return this->elements();
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    T* static_vector<T, N, BoundsCheck>::begin() noexcept {
+        return data();
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    const T* static_vector<T, N, BoundsCheck>::begin() const noexcept {
+        return cbegin();
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    const T* static_vector<T, N, BoundsCheck>::cbegin() const noexcept {
+        return data();
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    T* static_vector<T, N, BoundsCheck>::end() noexcept {
+        return data() + size();
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    const T* static_vector<T, N, BoundsCheck>::end() const noexcept {
+        return cend();
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    const T* static_vector<T, N, BoundsCheck>::cend() const noexcept {
+        return data() + size();
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    T* static_vector<T, N, BoundsCheck>::rbegin() noexcept {
+        return data() - 1;
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    const T* static_vector<T, N, BoundsCheck>::rbegin() const noexcept {
+        return crbegin();
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    const T* static_vector<T, N, BoundsCheck>::crbegin() const noexcept {
+        return data() - 1;
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    T* static_vector<T, N, BoundsCheck>::rend() noexcept {
+        return data() + size() - 1;
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    const T* static_vector<T, N, BoundsCheck>::rend() const noexcept {
+        return crend();
+    }
+
+    template<typename T, size_t N, typename BoundsCheck>
+    const T* static_vector<T, N, BoundsCheck>::crend() const noexcept {
+        return data() + size() - 1;
+    }
+
+    template<class T, size_t N, class BoundsCheck, class U>
+    size_t erase(static_vector<T, N, BoundsCheck>& vec, const U& value) {
+        return vec.remove_if([&value](const T& x) { return x == value; });
+    }
+
+    template<class T, size_t N, class BoundsCheck, class Predicate>
+    size_t erase_if(static_vector<T, N, BoundsCheck>& vec, Predicate pred) {
+        return vec.remove_if(pred);
+    }
+
+    template<class T, size_t N, class BoundsCheck>
+    bool operator==(const static_vector<T, N, BoundsCheck>& lhs, const static_vector<T, N, BoundsCheck>& rhs) {
+        return lhs.size() == rhs.size() && detail::equal(lhs.data(), rhs.data(), lhs.size());
+    }
+
+    template<class T, size_t N, class BoundsCheck>
+    bool operator!=(const static_vector<T, N, BoundsCheck>& lhs, const static_vector<T, N, BoundsCheck>& rhs) {
+        return !(lhs == rhs);
+    }
+
+    template<class T, size_t N, class BoundsCheck>
+    bool operator<(const static_vector<T, N, BoundsCheck>& lhs, const static_vector<T, N, BoundsCheck>& rhs) {
+        return detail::compare(lhs.data(), lhs.size(), rhs.data(), rhs.size()) < 0;
+    }
+
+    template<class T, size_t N, class BoundsCheck>
+    bool operator<=(const static_vector<T, N, BoundsCheck>& lhs, const static_vector<T, N, BoundsCheck>& rhs) {
+        return detail::compare(lhs.data(), lhs.size(), rhs.data(), rhs.size()) <= 0;
+    }
+
+    template<class T, size_t N, class BoundsCheck>
+    bool operator>(const static_vector<T, N, BoundsCheck>& lhs, const static_vector<T, N, BoundsCheck>& rhs) {
+        return detail::compare(lhs.data(), lhs.size(), rhs.data(), rhs.size()) > 0;
+    }
+
+    template<class T, size_t N, class BoundsCheck>
+    bool operator>=(const static_vector<T, N, BoundsCheck>& lhs, const static_vector<T, N, BoundsCheck>& rhs) {
+        return detail::compare(lhs.data(), lhs.size(), rhs.data(), rhs.size()) >= 0;
+    }
+}
+
+#endif
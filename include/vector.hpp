@@ -1,118 +1,470 @@
 #ifndef XD_VECTOR_H
 #define XD_VECTOR_H
+#include <algorithm>
+#include <array>
 #include <stdexcept>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <iterator>
 #include <initializer_list>
 #include <limits>
+#include <memory>
+#include <type_traits>
+#include "simd.hpp"
+
+#ifndef XD_VECTOR_INSTRUMENT
+#define XD_VECTOR_INSTRUMENT 0
+#endif
+#if XD_VECTOR_INSTRUMENT
+#include "instrument.hpp"
+// Used inside vector members, records an event for the element type T
+#define XD_VECTOR_RECORD(kind, old_capacity, new_capacity, size, data) \
+    (XD_IS_CONSTANT_EVALUATED() ? (void)0 : \
+     ::xd::detail::record_vector_event<T>(::xd::vector_event_kind::kind, old_capacity, new_capacity, size, data))
+#else
+#define XD_VECTOR_RECORD(kind, old_capacity, new_capacity, size, data) ((void)0)
+#endif
 
 
 namespace xd {
 
-    template<typename T> 
-    class vector {
-    public:
-        using reference = T&;
-        using const_reference = const T&;
-        using value_type = T;
-        using pointer = T*;
-        using iterator = pointer;
-        using const_pointer = const T*;
-        using const_iterator = const_pointer;
-        using reverse_iterator = std::reverse_iterator<iterator>;
+    //! Whether a T can be moved to a new address by copying its bytes and
+    //! forgetting the original. Trivially copyable types always can, other
+    //! types (i.e. ones holding a unique_ptr) can opt in by specialising this.
+    //! Types holding pointers into themselves must never be marked.
+    template<typename T>
+    struct is_trivially_relocatable: std::is_trivially_copyable<T> {};
 
-        // default constructor
-        vector();
-        vector(const vector<T>& other);
-        vector(vector<T>&& other) noexcept;
-        // Fill with a given value
-        vector(size_t count, const_reference value);
-        vector(size_t count);
-        vector(const_iterator first, const_iterator last);
-        vector(std::initializer_list<T> l);
+    template<typename T>
+    inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+    //! Whether an allocator can resize a block, possibly in place, with
+    //! T* reallocate(T* p, size_t old_n, size_t new_n). The bytes are kept
+    //! like realloc so it's only used for trivially relocatable types.
+    template<typename Allocator, typename = void>
+    struct has_reallocate: std::false_type {};
+
+    template<typename Allocator>
+    struct has_reallocate<Allocator, std::void_t<decltype(std::declval<Allocator&>().reallocate(
+            std::declval<typename Allocator::value_type*>(), size_t(), size_t()))>>: std::true_type {};
+
+    namespace detail {
+        //! Moves the live objects in [first, last) to the uninitialised
+        //! memory at dest leaving the source uninitialised, the ranges may
+        //! overlap. Shared by every container that owns raw storage.
+        template<typename Allocator, typename T>
+        XD_CONSTEXPR20 void relocate(Allocator& alloc, T* first, T* last, T* dest) {
+            using alloc_traits = std::allocator_traits<Allocator>;
+            if(first == last || first == dest) {
+                return;
+            }
+            if(XD_IS_CONSTANT_EVALUATED()) {
+                // Ordering pointers into different buffers isn't a constant
+                // expression, so go through scratch storage instead of
+                // working out which way the ranges overlap
+                const size_t n = last - first;
+                T* scratch = alloc_traits::allocate(alloc, n);
+                for(size_t i=0; i<n; i++) {
+                    alloc_traits::construct(alloc, scratch + i, std::move(first[i]));
+                    alloc_traits::destroy(alloc, first + i);
+                }
+                for(size_t i=0; i<n; i++) {
+                    alloc_traits::construct(alloc, dest + i, std::move(scratch[i]));
+                    alloc_traits::destroy(alloc, scratch + i);
+                }
+                alloc_traits::deallocate(alloc, scratch, n);
+            } else if constexpr(is_trivially_relocatable_v<T>) {
+                const size_t bytes = (last - first)*sizeof(T);
+                if(dest + (last - first) <= first || dest >= last) {
+                    memcpy(static_cast<void*>(dest), static_cast<const void*>(first), bytes);
+                } else {
+                    memmove(static_cast<void*>(dest), static_cast<const void*>(first), bytes);
+                }
+            } else if(dest < first) {
+                for(; first != last; first++, dest++) {
+                    alloc_traits::construct(alloc, dest, std::move(*first));
+                    alloc_traits::destroy(alloc, first);
+                }
+            } else {
+                // Walk backwards so an overlapping destination doesn't clobber
+                // elements before they're moved
+                dest += last - first;
+                while(last != first) {
+                    last--;
+                    dest--;
+                    alloc_traits::construct(alloc, dest, std::move(*last));
+                    alloc_traits::destroy(alloc, last);
+                }
+            }
+        }
+    }
 
-        ~vector();
+    namespace detail {
+        //! SFINAE guard so iterator overloads don't swallow (count, value)
+        template<typename It>
+        using require_input_iterator = std::enable_if_t<std::is_convertible<
+                typename std::iterator_traits<It>::iterator_category, std::input_iterator_tag>::value>;
+
+        template<typename It>
+        inline constexpr bool is_forward_iterator_v = std::is_convertible<
+                typename std::iterator_traits<It>::iterator_category, std::forward_iterator_tag>::value;
+
+        //! Copy constructs [first, last) into uninitialised memory at dest,
+        //! destroying what was built if a constructor throws. Returns one
+        //! past the last constructed element.
+        template<typename Allocator, typename It, typename T>
+        XD_CONSTEXPR20 T* uninitialized_copy(Allocator& alloc, It first, It last, T* dest) {
+            using alloc_traits = std::allocator_traits<Allocator>;
+            if constexpr(std::is_pointer<It>::value && std::is_trivially_copyable<T>::value &&
+                    std::is_same<std::remove_cv_t<std::remove_pointer_t<It>>, T>::value) {
+                if(!XD_IS_CONSTANT_EVALUATED()) {
+                    const size_t n = last - first;
+                    if(n > 0) {
+                        memcpy(static_cast<void*>(dest), static_cast<const void*>(first), n*sizeof(T));
+                    }
+                    return dest + n;
+                }
+            }
+            T* current = dest;
+            try {
+                for(; first != last; ++first, ++current) {
+                    alloc_traits::construct(alloc, current, *first);
+                }
+            } catch(...) {
+                for(; dest != current; ++dest) {
+                    alloc_traits::destroy(alloc, dest);
+                }
+                throw;
+            }
+            return current;
+        }
 
-        vector& operator=(std::initializer_list<T> il);
-        vector& operator=(const vector<T>& other);
-        vector& operator=(vector<T>&& other) noexcept;
-        
-        void assign(size_t count, const_reference value);
-        void assign(const_iterator first, const_iterator last);
-        void assign(std::initializer_list<T> il);
+        //! Move constructs [first, last) into uninitialised memory at dest,
+        //! copying instead when a move could throw and a copy is possible,
+        //! so the source is untouched if this throws. Returns one past the
+        //! last constructed element.
+        template<typename Allocator, typename T>
+        XD_CONSTEXPR20 T* uninitialized_move_if_noexcept(Allocator& alloc, T* first, T* last, T* dest) {
+            if constexpr(std::is_nothrow_move_constructible<T>::value || !std::is_copy_constructible<T>::value) {
+                return uninitialized_copy(alloc, std::make_move_iterator(first), std::make_move_iterator(last), dest);
+            } else {
+                return uninitialized_copy(alloc, static_cast<const T*>(first), static_cast<const T*>(last), dest);
+            }
+        }
 
-        void reserve(size_t capacity);
+        //! Whether p points at one of the n elements at data, without the
+        //! pointer ordering that constant evaluation rejects for unrelated
+        //! buffers
+        template<typename T>
+        XD_CONSTEXPR20 bool points_into(const T* p, const T* data, size_t n) {
+            if(XD_IS_CONSTANT_EVALUATED()) {
+                for(size_t i=0; i<n; i++) {
+                    if(p == data + i) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+            return p >= data && p < data + n;
+        }
+    }
 
-        void push_back(const_reference value);
-        void push_back(const T&& value);
+    //! Execution policies decide how bulk operations split their work. A
+    //! policy has chunk_count(n, element_size) giving the number of slices
+    //! to cut n elements into, and run(chunks, f) which calls f(chunk) for
+    //! each of them, possibly concurrently, returning once all are done.
+    //! Specialise is_execution_policy to use one with the vector overloads,
+    //! parallel.hpp has the sequential and thread pool policies.
+    template<typename Policy>
+    struct is_execution_policy: std::false_type {};
+
+    namespace detail {
+        template<typename Policy>
+        using require_execution_policy = std::enable_if_t<is_execution_policy<std::decay_t<Policy>>::value>;
+
+        //! Calls f(first, last) over contiguous slices of [0, n)
+        template<typename Policy, typename F>
+        void for_each_chunk(const Policy& policy, size_t n, size_t element_size, F f) {
+            const size_t chunks = policy.chunk_count(n, element_size);
+            if(chunks <= 1) {
+                f(size_t(0), n);
+                return;
+            }
+            policy.run(chunks, [&](size_t chunk) {
+                f(n*chunk/chunks, n*(chunk + 1)/chunks);
+            });
+        }
+    }
 
-        template<typename... Args>
-        reference emplace_back(Args&&... args);
-        
-        template<typename... Args>
-        iterator emplace(const_iterator pos, Args&&... args);
+    //! Growth policies pick the capacity to grow to once a vector is full
 
-        iterator insert(const_iterator pos, const T& value);
-        iterator insert(const_iterator pos, const T&& value);
-        iterator insert(const_iterator pos, size_t count, const T& value);
-        iterator insert(const_iterator pos, const_iterator first, const_iterator last);
-        iterator insert(const_iterator pos, std::initializer_list<T> il);
+    //! Doubles the capacity, fewest reallocations but up to half the
+    //! storage can be unused
+    struct double_growth {
+        static constexpr size_t next_capacity(size_t capacity) noexcept {
+            return capacity==0?1:capacity*2;
+        }
+    };
 
-        iterator erase(const_iterator pos);
-        iterator erase(const_iterator first, const_iterator last);
+    //! Grows by half again, less slack and lets freed blocks be reused by
+    //! later growth steps
+    struct one_and_a_half_growth {
+        static constexpr size_t next_capacity(size_t capacity) noexcept {
+            return capacity<2?capacity+1:capacity + capacity/2;
+        }
+    };
 
-        void pop_back();
+    //! Doubles until Chunk elements then grows Chunk elements at a time,
+    //! for huge vectors where doubling would waste gigabytes
+    template<size_t Chunk = (size_t(1) << 20)>
+    struct chunked_growth {
+        static_assert(Chunk > 0, "Chunk must be non-zero");
 
-        void resize(size_t count);
-        void resize(size_t count, const T& value);
+        static constexpr size_t next_capacity(size_t capacity) noexcept {
+            return capacity<Chunk?double_growth::next_capacity(capacity):capacity + Chunk;
+        }
+    };
 
-        void clear();
+    //! Bounds checking policies for operator[], front() and back(). at()
+    //! always throws like the standard requires. In constant evaluation a
+    //! failed check is a compile error whichever policy is used.
 
-        reference operator[](size_t index);
-        const_reference operator[](size_t index) const;
+    //! No checks, lets indexed loops vectorise
+    struct bounds_unchecked {
+        static constexpr void check(size_t, size_t) noexcept {
+        }
+    };
 
-        reference at(size_t index);
-        const_reference at(size_t index) const;
+    //! Aborts on a bad index unless NDEBUG is defined, like assert
+    struct bounds_assert {
+        static constexpr void check(size_t index, size_t size) noexcept {
+#ifndef NDEBUG
+            if(!(index < size)) {
+                fputs("xd::vector index out of range\n", stderr);
+                std::abort();
+            }
+#else
+            (void)index;
+            (void)size;
+#endif
+        }
+    };
 
-        reference front();
-        const_reference front() const;
+    //! Throws std::out_of_range on a bad index
+    struct bounds_throw {
+        static constexpr void check(size_t index, size_t size) {
+            if(!(index < size)) {
+                throw std::out_of_range("Attempted to access element out of range");
+            }
+        }
+    };
 
-        reference back();
-        const_reference back() const;
+    //! Policy used when one isn't given, XD_VECTOR_BOUNDS_CHECK picks it
+    //! for the whole build: 0 unchecked, 1 assert, 2 throw. Defaults to
+    //! unchecked in release (NDEBUG) builds and assert otherwise.
+#ifndef XD_VECTOR_BOUNDS_CHECK
+#ifdef NDEBUG
+#define XD_VECTOR_BOUNDS_CHECK 0
+#else
+#define XD_VECTOR_BOUNDS_CHECK 1
+#endif
+#endif
 
-        size_t size() const noexcept;
-        size_t capacity() const noexcept;
-        bool empty() const noexcept;
-        size_t max_size() const noexcept;
+#if XD_VECTOR_BOUNDS_CHECK == 2
+    using default_bounds_check = bounds_throw;
+#elif XD_VECTOR_BOUNDS_CHECK == 1
+    using default_bounds_check = bounds_assert;
+#else
+    using default_bounds_check = bounds_unchecked;
+#endif
 
-        void shrink_to_fit();
+    template<typename T, typename Allocator = std::allocator<T>, typename Growth = double_growth,
+             typename BoundsCheck = default_bounds_check>
+    class vector {
+    public:
+        using reference = T&;
+        using const_reference = const T&;
+        using value_type = T;
+        using pointer = T*;
+        using iterator = pointer;
+        using const_pointer = const T*;
+        using const_iterator = const_pointer;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using allocator_type = Allocator;
 
-        pointer data() noexcept;
+        static_assert(std::is_same<typename Allocator::value_type, T>::value,
+                "Allocator::value_type must be the same as T");
 
-        const_pointer data() const noexcept;
+        // default constructor
+        XD_CONSTEXPR20 vector();
+        XD_CONSTEXPR20 explicit vector(const Allocator& alloc);
+        XD_CONSTEXPR20 vector(const vector& other);
+        XD_CONSTEXPR20 vector(const vector& other, const Allocator& alloc);
+        XD_CONSTEXPR20 vector(vector&& other) noexcept;
+        // Fill with a given value
+        XD_CONSTEXPR20 vector(size_t count, const_reference value, const Allocator& alloc = Allocator());
+        XD_CONSTEXPR20 explicit vector(size_t count, const Allocator& alloc = Allocator());
+        template<typename InputIt, typename = detail::require_input_iterator<InputIt>>
+        XD_CONSTEXPR20 vector(InputIt first, InputIt last, const Allocator& alloc = Allocator());
+        XD_CONSTEXPR20 vector(std::initializer_list<T> l, const Allocator& alloc = Allocator());
+        //! Copies other in contiguous chunks split by policy, so the first
+        //! touch of each page happens on the thread that copies it
+        template<typename Policy, typename = detail::require_execution_policy<Policy>>
+        vector(Policy&& policy, const vector& other);
+
+        XD_CONSTEXPR20 ~vector();
+
+        XD_CONSTEXPR20 vector& operator=(std::initializer_list<T> il);
+        XD_CONSTEXPR20 vector& operator=(const vector& other);
+        XD_CONSTEXPR20 vector& operator=(vector&& other) noexcept(
+                std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value ||
+                std::allocator_traits<Allocator>::is_always_equal::value);
+        
+        XD_CONSTEXPR20 void assign(size_t count, const_reference value);
+        template<typename InputIt, typename = detail::require_input_iterator<InputIt>>
+        XD_CONSTEXPR20 void assign(InputIt first, InputIt last);
+        XD_CONSTEXPR20 void assign(std::initializer_list<T> il);
+        template<typename Policy, typename = detail::require_execution_policy<Policy>>
+        void assign(Policy&& policy, size_t count, const_reference value);
 
-        void swap(vector<T>& other) noexcept;
+        XD_CONSTEXPR20 void reserve(size_t capacity);
 
-        iterator begin() noexcept;
-        const_iterator begin() const noexcept;
-        const_iterator cbegin() const noexcept;
+        XD_CONSTEXPR20 void push_back(const_reference value);
+        XD_CONSTEXPR20 void push_back(T&& value);
 
-        iterator end() noexcept;
-        const_iterator end() const noexcept;
-        const_iterator cend() const noexcept;
+        template<typename... Args>
+        XD_CONSTEXPR20 reference emplace_back(Args&&... args);
         
-        iterator rbegin() noexcept;
-        const_iterator rbegin() const noexcept;
-        const_iterator crbegin() const noexcept;
+        template<typename... Args>
+        XD_CONSTEXPR20 iterator emplace(const_iterator pos, Args&&... args);
+
+        XD_CONSTEXPR20 iterator insert(const_iterator pos, const T& value);
+        XD_CONSTEXPR20 iterator insert(const_iterator pos, T&& value);
+        XD_CONSTEXPR20 iterator insert(const_iterator pos, size_t count, const T& value);
+        //! Grows at most once and shifts the tail once for forward
+        //! iterators, input iterators are appended then rotated into place
+        template<typename InputIt, typename = detail::require_input_iterator<InputIt>>
+        XD_CONSTEXPR20 iterator insert(const_iterator pos, InputIt first, InputIt last);
+        XD_CONSTEXPR20 iterator insert(const_iterator pos, std::initializer_list<T> il);
+
+        XD_CONSTEXPR20 iterator erase(const_iterator pos);
+        XD_CONSTEXPR20 iterator erase(const_iterator first, const_iterator last);
+        //! O(1) erase that moves the last element into pos, doesn't keep
+        //! the order of the elements
+        XD_CONSTEXPR20 iterator erase_unordered(const_iterator pos);
+        //! Erases the elements at the given ascending indices in one sweep,
+        //! returns how many were removed. Repeated indices are fine, out of
+        //! order ones throw std::invalid_argument and past the end ones
+        //! std::out_of_range, both before anything is erased
+        template<typename Indices>
+        XD_CONSTEXPR20 size_t erase_indices(const Indices& sorted_indices);
+        //! Erases every element matching pred in one pass, surviving runs
+        //! are moved block-wise. Returns how many were removed.
+        template<typename Predicate>
+        XD_CONSTEXPR20 size_t remove_if(Predicate pred);
+
+        XD_CONSTEXPR20 void pop_back();
+
+        XD_CONSTEXPR20 void resize(size_t count);
+        XD_CONSTEXPR20 void resize(size_t count, const T& value);
+        //! Constructs the new elements in chunks split by policy
+        template<typename Policy, typename = detail::require_execution_policy<Policy>>
+        void resize(Policy&& policy, size_t count);
+        template<typename Policy, typename = detail::require_execution_policy<Policy>>
+        void resize(Policy&& policy, size_t count, const T& value);
+
+        //! Filling a buffer straight from read() or a decoder without first
+        //! zeroing it. Only for trivial types, the new elements are left
+        //! uninitialised for the caller to overwrite.
+
+        //! Resizes to count without initialising the new elements, returns
+        //! a pointer to the first of them (end() if it shrank)
+        pointer resize_for_overwrite(size_t count);
+        //! Makes room for count more elements past the end and returns a
+        //! pointer to them, the size doesn't change until commit. Grows by
+        //! the Growth policy so repeated calls are amortised O(1).
+        pointer append_uninitialized(size_t count);
+        //! Adds count elements written past the end to the size, throws
+        //! std::length_error if that is more than the spare capacity
+        void commit(size_t count);
+
+        XD_CONSTEXPR20 void clear();
+
+        XD_CONSTEXPR20 reference operator[](size_t index);
+        XD_CONSTEXPR20 const_reference operator[](size_t index) const;
+
+        XD_CONSTEXPR20 reference at(size_t index);
+        XD_CONSTEXPR20 const_reference at(size_t index) const;
+
+        XD_CONSTEXPR20 reference front();
+        XD_CONSTEXPR20 const_reference front() const;
+
+        XD_CONSTEXPR20 reference back();
+        XD_CONSTEXPR20 const_reference back() const;
+
+        XD_CONSTEXPR20 size_t size() const noexcept;
+        XD_CONSTEXPR20 size_t capacity() const noexcept;
+        XD_CONSTEXPR20 bool empty() const noexcept;
+        XD_CONSTEXPR20 size_t max_size() const noexcept;
+
+        XD_CONSTEXPR20 void shrink_to_fit();
+
+        XD_CONSTEXPR20 pointer data() noexcept;
+
+        XD_CONSTEXPR20 const_pointer data() const noexcept;
+
+        XD_CONSTEXPR20 void swap(vector& other) noexcept;
+
+        XD_CONSTEXPR20 allocator_type get_allocator() const noexcept;
+
+        XD_CONSTEXPR20 iterator begin() noexcept;
+        XD_CONSTEXPR20 const_iterator begin() const noexcept;
+        XD_CONSTEXPR20 const_iterator cbegin() const noexcept;
+
+        XD_CONSTEXPR20 iterator end() noexcept;
+        XD_CONSTEXPR20 const_iterator end() const noexcept;
+        XD_CONSTEXPR20 const_iterator cend() const noexcept;
+        
+        XD_CONSTEXPR20 iterator rbegin() noexcept;
+        XD_CONSTEXPR20 const_iterator rbegin() const noexcept;
+        XD_CONSTEXPR20 const_iterator crbegin() const noexcept;
 
-        iterator rend() noexcept;
-        const_iterator rend() const noexcept;
-        const_iterator crend() const noexcept;
+        XD_CONSTEXPR20 iterator rend() noexcept;
+        XD_CONSTEXPR20 const_iterator rend() const noexcept;
+        XD_CONSTEXPR20 const_iterator crend() const noexcept;
     protected:
-        size_t next_capacity() const {
-            return _capacity==0?1:_capacity*2;
+        XD_CONSTEXPR20 size_t next_capacity() const {
+            return Growth::next_capacity(_capacity);
         }
     private:
+        using alloc_traits = std::allocator_traits<Allocator>;
+
+        //! Growth can hand the buffer to Allocator::reallocate instead of
+        //! allocating and relocating
+        static constexpr bool can_reallocate = is_trivially_relocatable_v<T> && has_reallocate<Allocator>::value;
+
+        //! Allocates uninitialised storage for cap elements
+        XD_CONSTEXPR20 T* allocate_storage(size_t cap);
+        //! Hands the storage back to the allocator, elements must already
+        //! have been destroyed
+        XD_CONSTEXPR20 void release_storage() noexcept;
+        //! Moves the live objects in [first, last) to the uninitialised
+        //! memory at dest, the source is left uninitialised. The ranges may
+        //! overlap.
+        XD_CONSTEXPR20 void relocate(T* first, T* last, T* dest);
+        //! Opens a gap of count uninitialised slots at index, growing the
+        //! storage if needed. Returns a pointer to the start of the gap.
+        XD_CONSTEXPR20 T* open_gap(size_t index, size_t count);
+        //! Closes a gap previously opened by open_gap
+        XD_CONSTEXPR20 void close_gap(size_t index, size_t count);
+        //! Appends count elements into reserved storage, construct(first,
+        //! last, offset) builds one chunk and is run by policy. Only used
+        //! with constructors that can't throw, as a failed chunk can't be
+        //! unwound once the others have finished.
+        template<typename Policy, typename Construct>
+        void append_chunked(const Policy& policy, size_t count, Construct construct);
+
         //! Current size of the vector
         size_t raw_size;
         //! Current capacity 
@@ -120,397 +472,798 @@ namespace xd {
         size_t _capacity;
         //! Array containing the data
         T* _data;
+        //! Allocator all storage is obtained from
+        Allocator _alloc;
     };
 
-    template<class T>
-    bool operator==(const vector<T>& lhs, const vector<T>& rhs);
-    template<class T>
-    bool operator!=(const vector<T>& lhs, const vector<T>& rhs);
-    template<class T>
-    bool operator<(const vector<T>& lhs, const vector<T>& rhs);
-    template<class T>
-    bool operator<=(const vector<T>& lhs, const vector<T>& rhs);
-    template<class T>
-    bool operator>(const vector<T>& lhs, const vector<T>& rhs);
-    template<class T>
-    bool operator>=(const vector<T>& lhs, const vector<T>& rhs);
-
-    template<typename T>
-    vector<T>::vector():
+    //! Erases every element equal to value, returns the number removed
+    template<class T, class Allocator, class Growth, class BoundsCheck, class U>
+    XD_CONSTEXPR20 size_t erase(vector<T, Allocator, Growth, BoundsCheck>& vec, const U& value);
+    //! Erases every element matching pred, returns the number removed
+    template<class T, class Allocator, class Growth, class BoundsCheck, class Predicate>
+    XD_CONSTEXPR20 size_t erase_if(vector<T, Allocator, Growth, BoundsCheck>& vec, Predicate pred);
+
+    template<class T, class Allocator, class Growth, class BoundsCheck>
+    XD_CONSTEXPR20 bool operator==(const vector<T, Allocator, Growth, BoundsCheck>& lhs, const vector<T, Allocator, Growth, BoundsCheck>& rhs);
+    template<class T, class Allocator, class Growth, class BoundsCheck>
+    XD_CONSTEXPR20 bool operator!=(const vector<T, Allocator, Growth, BoundsCheck>& lhs, const vector<T, Allocator, Growth, BoundsCheck>& rhs);
+    template<class T, class Allocator, class Growth, class BoundsCheck>
+    XD_CONSTEXPR20 bool operator<(const vector<T, Allocator, Growth, BoundsCheck>& lhs, const vector<T, Allocator, Growth, BoundsCheck>& rhs);
+    template<class T, class Allocator, class Growth, class BoundsCheck>
+    XD_CONSTEXPR20 bool operator<=(const vector<T, Allocator, Growth, BoundsCheck>& lhs, const vector<T, Allocator, Growth, BoundsCheck>& rhs);
+    template<class T, class Allocator, class Growth, class BoundsCheck>
+    XD_CONSTEXPR20 bool operator>(const vector<T, Allocator, Growth, BoundsCheck>& lhs, const vector<T, Allocator, Growth, BoundsCheck>& rhs);
+    template<class T, class Allocator, class Growth, class BoundsCheck>
+    XD_CONSTEXPR20 bool operator>=(const vector<T, Allocator, Growth, BoundsCheck>& lhs, const vector<T, Allocator, Growth, BoundsCheck>& rhs);
+
+    //! Vectorised search helpers, SIMD for integral element types
+    template<class T, class Allocator, class Growth, class BoundsCheck>
+    XD_CONSTEXPR20 const T* find(const vector<T, Allocator, Growth, BoundsCheck>& vec, const T& value);
+    template<class T, class Allocator, class Growth, class BoundsCheck>
+    XD_CONSTEXPR20 T* find(vector<T, Allocator, Growth, BoundsCheck>& vec, const T& value);
+    template<class T, class Allocator, class Growth, class BoundsCheck>
+    XD_CONSTEXPR20 size_t count(const vector<T, Allocator, Growth, BoundsCheck>& vec, const T& value);
+    template<class T, class Allocator, class Growth, class BoundsCheck>
+    XD_CONSTEXPR20 bool contains(const vector<T, Allocator, Growth, BoundsCheck>& vec, const T& value);
+
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 vector<T, Allocator, Growth, BoundsCheck>::vector():vector(Allocator()) {
+    }
+
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 vector<T, Allocator, Growth, BoundsCheck>::vector(const Allocator& alloc):
     raw_size(0),
     _capacity(0),
-    _data(nullptr) {
+    _data(nullptr),
+    _alloc(alloc) {
     }
 
-    template<typename T>
-    vector<T>::vector(size_t count, const T& value):vector() {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 vector<T, Allocator, Growth, BoundsCheck>::vector(size_t count, const T& value, const Allocator& alloc):vector(alloc) {
         assign(count, value);
     }
 
-    template<typename T>
-    vector<T>::vector(size_t count):vector(count, T()) {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 vector<T, Allocator, Growth, BoundsCheck>::vector(size_t count, const Allocator& alloc):vector(count, T(), alloc) {
     }
 
-    template<typename T>
-    vector<T>::vector(vector<T>::const_iterator begin, vector<T>::const_iterator end):vector(){
-        assign(begin, end);
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    template<typename InputIt, typename>
+    XD_CONSTEXPR20 vector<T, Allocator, Growth, BoundsCheck>::vector(InputIt first, InputIt last, const Allocator& alloc):vector(alloc){
+        assign(first, last);
     }
 
-    template<typename T>
-    vector<T>::vector(std::initializer_list<T> il):vector(il.begin(), il.end()){
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 vector<T, Allocator, Growth, BoundsCheck>::vector(std::initializer_list<T> il, const Allocator& alloc):vector(il.begin(), il.end(), alloc){
     }
 
-    template<typename T>
-    vector<T>::vector(const vector<T>& other):vector() {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 vector<T, Allocator, Growth, BoundsCheck>::vector(const vector<T, Allocator, Growth, BoundsCheck>& other):
+    vector(other, alloc_traits::select_on_container_copy_construction(other._alloc)) {
+    }
+
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 vector<T, Allocator, Growth, BoundsCheck>::vector(const vector<T, Allocator, Growth, BoundsCheck>& other, const Allocator& alloc):vector(alloc) {
         reserve(other.capacity());
-        for(size_t i=0; i<other.size(); i++) {
-            _data[i] = other[i];
-        }
-        raw_size = other.size();
+        raw_size = detail::uninitialized_copy(_alloc, other.begin(), other.end(), _data) - _data;
     }
 
-    template<typename T>
-    vector<T>::vector(vector<T>&& other) noexcept {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    template<typename Policy, typename>
+    vector<T, Allocator, Growth, BoundsCheck>::vector(Policy&& policy, const vector<T, Allocator, Growth, BoundsCheck>& other):
+    vector(alloc_traits::select_on_container_copy_construction(other._alloc)) {
         reserve(other.capacity());
-        for(size_t i=0; i<other.size(); i++) {
-            _data[i] = std::move(other[i]);
+        if constexpr(std::is_nothrow_copy_constructible<T>::value) {
+            const T* src = other._data;
+            append_chunked(policy, other.raw_size, [&](T* first, T* last, size_t offset) {
+                detail::uninitialized_copy(_alloc, src + offset, src + offset + (last - first), first);
+            });
+        } else {
+            raw_size = detail::uninitialized_copy(_alloc, other.begin(), other.end(), _data) - _data;
         }
-        raw_size = other.size();
+    }
+
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 vector<T, Allocator, Growth, BoundsCheck>::vector(vector<T, Allocator, Growth, BoundsCheck>&& other) noexcept:
+    raw_size(other.raw_size),
+    _capacity(other._capacity),
+    _data(other._data),
+    _alloc(std::move(other._alloc)) {
+        other.raw_size = 0;
+        other._capacity = 0;
+        other._data = nullptr;
     }
     
-    template<typename T>
-    vector<T>::~vector() {
-        delete [] _data;
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 vector<T, Allocator, Growth, BoundsCheck>::~vector() {
+        // Not clear() so release_storage still sees how much was used
+        for(size_t i=0; i<raw_size; i++) {
+            alloc_traits::destroy(_alloc, _data + i);
+        }
+        release_storage();
     }
 
-    template<typename T>
-    void vector<T>::assign(size_t count, const T& value) {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 void vector<T, Allocator, Growth, BoundsCheck>::assign(size_t count, const T& value) {
+        // value may live in this vector so copy it before clearing
+        const T tmp(value);
         clear();
         reserve(count);
-        for(size_t i=0; i<count; i++) {
-            push_back(value);
+        if constexpr(std::is_trivially_copyable<T>::value) {
+            detail::fill(_data, count, tmp);
+            raw_size = count;
+        } else {
+            for(size_t i=0; i<count; i++) {
+                alloc_traits::construct(_alloc, _data + i, tmp);
+                raw_size++;
+            }
         }
     }
 
-    template<typename T>
-    void vector<T>::assign(vector<T>::const_iterator first, vector<T>::const_iterator last) {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    template<typename InputIt, typename>
+    XD_CONSTEXPR20 void vector<T, Allocator, Growth, BoundsCheck>::assign(InputIt first, InputIt last) {
         clear();
-        reserve(std::distance(first, last));
-        for(auto it=first; it!=last; it++) {
-            push_back(*it);
+        if constexpr(detail::is_forward_iterator_v<InputIt>) {
+            reserve(std::distance(first, last));
+            raw_size = detail::uninitialized_copy(_alloc, first, last, _data) - _data;
+        } else {
+            for(; first!=last; ++first) {
+                emplace_back(*first);
+            }
         }
     }
 
-    template<typename T> 
-    void vector<T>::assign(std::initializer_list<T> il) {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 void vector<T, Allocator, Growth, BoundsCheck>::assign(std::initializer_list<T> il) {
         assign(il.begin(), il.end());
     }
 
-    template<typename T>
-    vector<T>& vector<T>::operator=(std::initializer_list<T> il) {
-        clear();
-        reserve(std::distance(il.begin(), il.end()));
-        for(auto it=il.begin(); it!=il.end(); it++) {
-            push_back(*it);
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    template<typename Policy, typename>
+    void vector<T, Allocator, Growth, BoundsCheck>::assign(Policy&& policy, size_t count, const T& value) {
+        if constexpr(std::is_nothrow_copy_constructible<T>::value) {
+            const T tmp(value);
+            clear();
+            reserve(count);
+            resize(policy, count, tmp);
+        } else {
+            assign(count, value);
         }
+    }
+
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 vector<T, Allocator, Growth, BoundsCheck>& vector<T, Allocator, Growth, BoundsCheck>::operator=(std::initializer_list<T> il) {
+        assign(il.begin(), il.end());
         return *this;
     }
     
-    template<typename T>
-    vector<T>& vector<T>::operator=(const vector<T>& other) {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 vector<T, Allocator, Growth, BoundsCheck>& vector<T, Allocator, Growth, BoundsCheck>::operator=(const vector<T, Allocator, Growth, BoundsCheck>& other) {
+        if(this == &other) {
+            return *this;
+        }
         clear();
-        reserve(other.size());
-        for(size_t i=0; i<other.size(); i++) {
-            _data[i] = other[i];
+        if constexpr(alloc_traits::propagate_on_container_copy_assignment::value) {
+            if(_alloc != other._alloc) {
+                // Storage has to go back to the allocator that made it
+                release_storage();
+                _data = nullptr;
+                _capacity = 0;
+            }
+            _alloc = other._alloc;
         }
-        raw_size = other.size();
+        reserve(other.size());
+        raw_size = detail::uninitialized_copy(_alloc, other.begin(), other.end(), _data) - _data;
         return *this;
     }
     
-    template<typename T>
-    vector<T>& vector<T>::operator=(vector<T>&& other) noexcept {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 vector<T, Allocator, Growth, BoundsCheck>& vector<T, Allocator, Growth, BoundsCheck>::operator=(vector<T, Allocator, Growth, BoundsCheck>&& other) noexcept(
+            std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value ||
+            std::allocator_traits<Allocator>::is_always_equal::value) {
+        if(this == &other) {
+            return *this;
+        }
         clear();
-        reserve(other.size());
-        for(size_t i=0; i<other.size(); i++) {
-            _data[i] = std::move(other[i]);
+        if(alloc_traits::propagate_on_container_move_assignment::value || _alloc == other._alloc) {
+            // Can take the buffer as whatever allocator we end up with can free it
+            release_storage();
+            if constexpr(alloc_traits::propagate_on_container_move_assignment::value) {
+                _alloc = std::move(other._alloc);
+            }
+            _data = other._data;
+            _capacity = other._capacity;
+            raw_size = other.raw_size;
+            other._data = nullptr;
+            other._capacity = 0;
+            other.raw_size = 0;
+            return *this;
         }
-        raw_size = other.size();
+        // Storage can't be shared so the elements move one by one. If that
+        // throws nothing is left half built here and other keeps its
+        // elements.
+        reserve(other.size());
+        raw_size = detail::uninitialized_move_if_noexcept(_alloc, other._data, other._data + other.raw_size, _data) - _data;
         return *this;
     }
 
-    template<typename T>
-    void vector<T>::reserve(size_t cap) {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 void vector<T, Allocator, Growth, BoundsCheck>::reserve(size_t cap) {
         if(cap <= _capacity) {
             return;
         }
-        T* new_data = new T[cap];
+        if constexpr(can_reallocate) {
+            T* old_data = _data;
+            _data = _alloc.reallocate(_data, _capacity, cap);
+            if(old_data == _data) {
+                // Nothing was allocated or freed, only the capacity changed
+                XD_VECTOR_RECORD(resize_in_place, _capacity, cap, raw_size, _data);
+            } else {
+                if(old_data != nullptr) {
+                    XD_VECTOR_RECORD(deallocate, _capacity, 0, raw_size, old_data);
+                }
+                XD_VECTOR_RECORD(allocate, 0, cap, raw_size, _data);
+                if(old_data != nullptr) {
+                    XD_VECTOR_RECORD(grow, _capacity, cap, raw_size, _data);
+                }
+            }
+            _capacity = cap;
+            return;
+        }
+        T* new_data = allocate_storage(cap);
         if(_data != nullptr) {
-            memcpy(new_data, _data, raw_size*sizeof(T));
-            delete[] _data;
+            XD_VECTOR_RECORD(grow, _capacity, cap, raw_size, new_data);
+            relocate(_data, _data + raw_size, new_data);
+            release_storage();
         }
         _data = new_data;
         _capacity = cap;
     }
 
-    template<typename T>
-    template<typename... Args>
-    T& vector<T>::emplace_back(Args&&... args) {
-        if((raw_size + 1) > _capacity) {
-            // Double rate growth factor just to be simple
-            reserve(next_capacity());
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 T* vector<T, Allocator, Growth, BoundsCheck>::allocate_storage(size_t cap) {
+        T* p = alloc_traits::allocate(_alloc, cap);
+        XD_VECTOR_RECORD(allocate, 0, cap, raw_size, p);
+        return p;
+    }
+
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 void vector<T, Allocator, Growth, BoundsCheck>::release_storage() noexcept {
+        if(_data != nullptr) {
+            XD_VECTOR_RECORD(deallocate, _capacity, 0, raw_size, _data);
+            alloc_traits::deallocate(_alloc, _data, _capacity);
         }
-        _data[raw_size] = std::move(T(std::forward<Args>(args)...));
-        raw_size++;
-        return _data[raw_size-1];
     }
-    
-    template<typename T>
-    template<typename... Args>
-    T* vector<T>::emplace(const T* pos, Args&&... args) {
-        return insert(pos, T(std::forward<Args>(args)...));
+
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 void vector<T, Allocator, Growth, BoundsCheck>::relocate(T* first, T* last, T* dest) {
+        detail::relocate(_alloc, first, last, dest);
     }
 
-    template<typename T> 
-    void vector<T>::push_back(const T& value) {
-        if((raw_size + 1) > _capacity) {
-            reserve(next_capacity());
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 T* vector<T, Allocator, Growth, BoundsCheck>::open_gap(size_t index, size_t count) {
+        const size_t required_size = raw_size + count;
+        if(required_size > _capacity) {
+            const size_t cap = required_size > next_capacity() ? required_size : next_capacity();
+            if constexpr(can_reallocate) {
+                reserve(cap);
+                relocate(_data + index, _data + raw_size, _data + index + count);
+                return _data + index;
+            }
+            T* new_data = allocate_storage(cap);
+            if(_data != nullptr) {
+                XD_VECTOR_RECORD(grow, _capacity, cap, raw_size, new_data);
+                // Relocate around the gap so the tail only moves once
+                relocate(_data, _data + index, new_data);
+                relocate(_data + index, _data + raw_size, new_data + index + count);
+                release_storage();
+            }
+            _data = new_data;
+            _capacity = cap;
+        } else {
+            relocate(_data + index, _data + raw_size, _data + index + count);
         }
-        _data[raw_size] = value;
-        raw_size++;
+        return _data + index;
     }
 
-    template<typename T> 
-    void vector<T>::push_back(const T&& value) {
-        if((raw_size + 1) > _capacity) {
-            reserve(next_capacity());
-        }
-        _data[raw_size] = std::move(value);
-        raw_size++;
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 void vector<T, Allocator, Growth, BoundsCheck>::close_gap(size_t index, size_t count) {
+        relocate(_data + index + count, _data + raw_size + count, _data + index);
     }
 
-    template<typename T>
-    T* vector<T>::insert(const T* pos, const T& value) {
-        if(pos == end()) {
-            push_back(value);
-            return rend();
-        }
-        // If we work out index after reserve pointer distance is wrong!
-        size_t index = std::distance(cbegin(), pos);
-        if((raw_size + 1) > _capacity) {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    template<typename... Args>
+    XD_CONSTEXPR20 T& vector<T, Allocator, Growth, BoundsCheck>::emplace_back(Args&&... args) {
+        if(raw_size != _capacity) {
+            alloc_traits::construct(_alloc, _data + raw_size, std::forward<Args>(args)...);
+        } else if constexpr(can_reallocate) {
+            // The buffer may move under args so build the element first
+            T tmp(std::forward<Args>(args)...);
             reserve(next_capacity());
+            alloc_traits::construct(_alloc, _data + raw_size, std::move(tmp));
+        } else {
+            // Construct into the new buffer before relocating, args may
+            // refer to an element of this vector
+            const size_t cap = next_capacity();
+            T* new_data = allocate_storage(cap);
+            try {
+                alloc_traits::construct(_alloc, new_data + raw_size, std::forward<Args>(args)...);
+            } catch(...) {
+                XD_VECTOR_RECORD(deallocate, cap, 0, 0, new_data);
+                alloc_traits::deallocate(_alloc, new_data, cap);
+                throw;
+            }
+            if(_data != nullptr) {
+                XD_VECTOR_RECORD(grow, _capacity, cap, raw_size, new_data);
+                relocate(_data, _data + raw_size, new_data);
+                release_storage();
+            }
+            _data = new_data;
+            _capacity = cap;
         }
-        memmove(_data+index+1, _data+index, (raw_size-index)*sizeof(T));
-        _data[index] = value;
-        
         raw_size++;
-        return _data+index;
+        return _data[raw_size-1];
     }
     
-    template<typename T>
-    T* vector<T>::insert(const T* pos, const T&& value) {
-        if(pos == end()) {
-            push_back(value);
-            return rend();
-        }
-        // If we work out index after reserve pointer distance is wrong!
-        size_t index = std::distance(cbegin(), pos);
-        if((raw_size + 1) > _capacity) {
-            reserve(next_capacity());
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    template<typename... Args>
+    XD_CONSTEXPR20 T* vector<T, Allocator, Growth, BoundsCheck>::emplace(const T* pos, Args&&... args) {
+        // If we work out index after growing pointer distance is wrong!
+        const size_t index = std::distance(cbegin(), pos);
+        if(index == raw_size) {
+            emplace_back(std::forward<Args>(args)...);
+            return _data + index;
+        }
+        // args may refer to an element that open_gap is about to move
+        T tmp(std::forward<Args>(args)...);
+        T* gap = open_gap(index, 1);
+        try {
+            alloc_traits::construct(_alloc, gap, std::move(tmp));
+        } catch(...) {
+            close_gap(index, 1);
+            throw;
         }
-        memmove(_data+index+1, _data+index, (raw_size-index)*sizeof(T));
-        _data[index] = std::move(value);
-        
         raw_size++;
-        return _data+index;
+        return gap;
+    }
+
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 void vector<T, Allocator, Growth, BoundsCheck>::push_back(const T& value) {
+        emplace_back(value);
+    }
+
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 void vector<T, Allocator, Growth, BoundsCheck>::push_back(T&& value) {
+        emplace_back(std::move(value));
+    }
+
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 T* vector<T, Allocator, Growth, BoundsCheck>::insert(const T* pos, const T& value) {
+        return emplace(pos, value);
     }
     
-    template<typename T>
-    T* vector<T>::insert(const T* pos, size_t count, const T& value) {
-        if(pos == end()) {
-            push_back(value);
-            return rend();
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 T* vector<T, Allocator, Growth, BoundsCheck>::insert(const T* pos, T&& value) {
+        return emplace(pos, std::move(value));
+    }
+    
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 T* vector<T, Allocator, Growth, BoundsCheck>::insert(const T* pos, size_t count, const T& value) {
+        const size_t index = std::distance(cbegin(), pos);
+        if(count == 0) {
+            return _data + index;
         }
-        // If we work out index after reserve pointer distance is wrong!
-        size_t index = std::distance(cbegin(), pos);
-        const size_t required_size = raw_size + count;
-        if(required_size > _capacity) {
-            if(required_size > next_capacity()) {
-                reserve(required_size);
-            } else {
-                reserve(next_capacity());
-            }
+        const T tmp(value);
+        T* gap = open_gap(index, count);
+        if constexpr(std::is_trivially_copyable<T>::value) {
+            detail::fill(gap, count, tmp);
+            raw_size += count;
+            return gap;
         }
-        memmove(_data+index+count, _data+index, (raw_size-index)*sizeof(T));
-        for(size_t i=0; i<count; i++) { 
-            _data[index+i] = value;
+        size_t i = 0;
+        try {
+            for(; i<count; i++) {
+                alloc_traits::construct(_alloc, gap + i, tmp);
+            }
+        } catch(...) {
+            for(size_t j=0; j<i; j++) {
+                alloc_traits::destroy(_alloc, gap + j);
+            }
+            close_gap(index, count);
+            throw;
         }
         raw_size += count;
-        return _data+index;
+        return gap;
     }
 
-    template<typename T>
-    T* vector<T>::insert(const T* pos, const T* first, const T* last) {
-        size_t index = std::distance(cbegin(), pos);
-        size_t n_elem = std::distance(first, last);
-        for(size_t i=0; i<n_elem; i++) {
-            insert(begin()+index+i, first[i]);
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    template<typename InputIt, typename>
+    XD_CONSTEXPR20 T* vector<T, Allocator, Growth, BoundsCheck>::insert(const T* pos, InputIt first, InputIt last) {
+        const size_t index = std::distance(cbegin(), pos);
+        if constexpr(detail::is_forward_iterator_v<InputIt>) {
+            if constexpr(std::is_pointer<InputIt>::value) {
+                // The range would move under us when the gap opens
+                if(first != last && detail::points_into(&*first, _data, raw_size)) {
+                    const vector<T, Allocator, Growth, BoundsCheck> tmp(first, last, _alloc);
+                    return insert(pos, tmp.begin(), tmp.end());
+                }
+            }
+            const size_t count = std::distance(first, last);
+            if(count == 0) {
+                return _data + index;
+            }
+            T* gap = open_gap(index, count);
+            try {
+                detail::uninitialized_copy(_alloc, first, last, gap);
+            } catch(...) {
+                close_gap(index, count);
+                throw;
+            }
+            raw_size += count;
+            return gap;
+        } else {
+            const size_t old_size = raw_size;
+            for(; first!=last; ++first) {
+                emplace_back(*first);
+            }
+            std::rotate(_data + index, _data + old_size, _data + raw_size);
+            return _data + index;
         }
-        return begin() + index;
     }
 
-    template<typename T>
-    T* vector<T>::insert(const T* pos, std::initializer_list<T> il) {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 T* vector<T, Allocator, Growth, BoundsCheck>::insert(const T* pos, std::initializer_list<T> il) {
         return insert(pos, il.begin(), il.end());
     }
     
-    template<typename T>
-    T* vector<T>::erase(const T* pos) {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 T* vector<T, Allocator, Growth, BoundsCheck>::erase(const T* pos) {
         const size_t index = std::distance(cbegin(), pos);
-        _data[index].~T();
-        if(index == raw_size - 1) {
-            raw_size--;
-            return rbegin();
-        } else {
-            memmove(_data+index, _data+index+1, (raw_size-index)*sizeof(T));
-            raw_size--;
-            return _data+index;
-        }
+        alloc_traits::destroy(_alloc, _data + index);
+        relocate(_data + index + 1, _data + raw_size, _data + index);
+        raw_size--;
+        return _data + index;
     }
 
-    template<typename T>
-    T* vector<T>::erase(const T* first, const T* last) {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 T* vector<T, Allocator, Growth, BoundsCheck>::erase(const T* first, const T* last) {
         const size_t len = std::distance(first, last);
         const size_t index = std::distance(cbegin(), first);
-        const size_t end_index = std::distance(cbegin(), last);
-        
-        T* pos = &_data[index];
         
-        if(first != last) {
-            for( ; pos != last; pos++) {
-                pos->~T();
+        if(len > 0) {
+            for(size_t i=index; i<index+len; i++) {
+                alloc_traits::destroy(_alloc, _data + i);
             }
-            memmove(pos, last, raw_size - end_index);
+            relocate(_data + index + len, _data + raw_size, _data + index);
             raw_size -= len;
         }
 
-        return pos;
+        return _data + index;
     }
 
-    template<typename T>
-    void vector<T>::pop_back() {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 T* vector<T, Allocator, Growth, BoundsCheck>::erase_unordered(const T* pos) {
+        const size_t index = std::distance(cbegin(), pos);
+        alloc_traits::destroy(_alloc, _data + index);
+        if(index != raw_size - 1) {
+            relocate(_data + raw_size - 1, _data + raw_size, _data + index);
+        }
+        raw_size--;
+        return _data + index;
+    }
+
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    template<typename Indices>
+    XD_CONSTEXPR20 size_t vector<T, Allocator, Growth, BoundsCheck>::erase_indices(const Indices& sorted_indices) {
+        auto it = std::begin(sorted_indices);
+        const auto last = std::end(sorted_indices);
+        if(it == last) {
+            return 0;
+        }
+        // Reject bad input before anything moves, a descending index would
+        // otherwise be skipped as a duplicate and erase the wrong set
+        size_t previous = *it;
+        for(auto check = it; check != last; ++check) {
+            if(*check < previous) {
+                throw std::invalid_argument("erase_indices needs ascending indices");
+            }
+            previous = *check;
+        }
+        if(previous >= raw_size) {
+            throw std::out_of_range("Attempted to access element out of range");
+        }
+        // [write, read) is always the uninitialised hole left by erasing
+        size_t write = *it;
+        size_t read = write;
+        for(; it != last; ++it) {
+            const size_t index = *it;
+            if(index < read) {
+                // Duplicate index
+                continue;
+            }
+            relocate(_data + read, _data + index, _data + write);
+            write += index - read;
+            alloc_traits::destroy(_alloc, _data + index);
+            read = index + 1;
+        }
+        relocate(_data + read, _data + raw_size, _data + write);
+        write += raw_size - read;
+        const size_t removed = raw_size - write;
+        raw_size = write;
+        return removed;
+    }
+
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    template<typename Predicate>
+    XD_CONSTEXPR20 size_t vector<T, Allocator, Growth, BoundsCheck>::remove_if(Predicate pred) {
+        // Skip the prefix that stays put
+        size_t read = 0;
+        while(read < raw_size && !pred(_data[read])) {
+            read++;
+        }
+        // [write, read) is always the uninitialised hole left by erasing
+        size_t write = read;
+        size_t run_start = read;
+        try {
+            for(; read < raw_size; read++) {
+                if(pred(_data[read])) {
+                    relocate(_data + run_start, _data + read, _data + write);
+                    write += read - run_start;
+                    alloc_traits::destroy(_alloc, _data + read);
+                    run_start = read + 1;
+                }
+            }
+        } catch(...) {
+            // Close the hole so the vector stays valid
+            relocate(_data + run_start, _data + raw_size, _data + write);
+            raw_size = write + (raw_size - run_start);
+            throw;
+        }
+        relocate(_data + run_start, _data + raw_size, _data + write);
+        write += raw_size - run_start;
+        const size_t removed = raw_size - write;
+        raw_size = write;
+        return removed;
+    }
+
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 void vector<T, Allocator, Growth, BoundsCheck>::pop_back() {
         if(!empty()) {
-            _data[raw_size - 1].~T();
+            alloc_traits::destroy(_alloc, _data + raw_size - 1);
             raw_size--;
         }
     }
 
-    template<typename T>
-    void vector<T>::resize(size_t count) {
-        resize(count, T());
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 void vector<T, Allocator, Growth, BoundsCheck>::resize(size_t count) {
+        if(count < raw_size) {
+            for(size_t i=count; i<raw_size; i++) {
+                alloc_traits::destroy(_alloc, _data + i);
+            }
+            raw_size = count;
+        } else {
+            reserve(count);
+            for(; raw_size<count; raw_size++) {
+                alloc_traits::construct(_alloc, _data + raw_size);
+            }
+        }
     }
     
-    template<typename T>
-    void vector<T>::resize(size_t count, const T& value) {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 void vector<T, Allocator, Growth, BoundsCheck>::resize(size_t count, const T& value) {
         if(count < raw_size) {
             for(size_t i=count; i<raw_size; i++) {
-                _data[i].~T();
+                alloc_traits::destroy(_alloc, _data + i);
             }
             raw_size = count;
-        } else {
-            if(_capacity < count) {
+        } else if(count > raw_size) {
+            const T tmp(value);
+            reserve(count);
+            if constexpr(std::is_trivially_copyable<T>::value) {
+                detail::fill(_data + raw_size, count - raw_size, tmp);
+                raw_size = count;
+            } else {
+                for(; raw_size<count; raw_size++) {
+                    alloc_traits::construct(_alloc, _data + raw_size, tmp);
+                }
+            }
+        }
+    }
+
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    template<typename Policy, typename>
+    void vector<T, Allocator, Growth, BoundsCheck>::resize(Policy&& policy, size_t count) {
+        if constexpr(std::is_nothrow_default_constructible<T>::value) {
+            if(count > raw_size) {
                 reserve(count);
+                append_chunked(policy, count - raw_size, [&](T* first, T* last, size_t) {
+                    for(; first!=last; ++first) {
+                        alloc_traits::construct(_alloc, first);
+                    }
+                });
+                return;
             }
-            for(size_t i=raw_size; i<count; i++) {
-                push_back(value);
+        }
+        resize(count);
+    }
+
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    template<typename Policy, typename>
+    void vector<T, Allocator, Growth, BoundsCheck>::resize(Policy&& policy, size_t count, const T& value) {
+        if constexpr(std::is_nothrow_copy_constructible<T>::value) {
+            if(count > raw_size) {
+                const T tmp(value);
+                reserve(count);
+                append_chunked(policy, count - raw_size, [&](T* first, T* last, size_t) {
+                    if constexpr(std::is_trivially_copyable<T>::value) {
+                        detail::fill(first, last - first, tmp);
+                    } else {
+                        for(; first!=last; ++first) {
+                            alloc_traits::construct(_alloc, first, tmp);
+                        }
+                    }
+                });
+                return;
             }
         }
+        resize(count, value);
     }
 
-    template<typename T>
-    T& vector<T>::operator[](size_t i) {
-        return at(i);
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    T* vector<T, Allocator, Growth, BoundsCheck>::resize_for_overwrite(size_t count) {
+        static_assert(std::is_trivially_default_constructible<T>::value && std::is_trivially_destructible<T>::value,
+                "resize_for_overwrite needs a trivial T");
+        const size_t old_size = raw_size;
+        if(count > raw_size) {
+            reserve(count);
+        }
+        raw_size = count;
+        return _data + std::min(old_size, count);
     }
 
-    template<typename T>
-    const T& vector<T>::operator[](size_t i) const {
-        return at(i);
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    T* vector<T, Allocator, Growth, BoundsCheck>::append_uninitialized(size_t count) {
+        static_assert(std::is_trivially_default_constructible<T>::value && std::is_trivially_destructible<T>::value,
+                "append_uninitialized needs a trivial T");
+        if(count > _capacity - raw_size) {
+            const size_t required_size = raw_size + count;
+            reserve(required_size > next_capacity() ? required_size : next_capacity());
+        }
+        return _data + raw_size;
     }
 
-    template<typename T>
-    T& vector<T>::at(size_t i) {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    void vector<T, Allocator, Growth, BoundsCheck>::commit(size_t count) {
+        if(count > _capacity - raw_size) {
+            throw std::length_error("Committed more elements than were reserved");
+        }
+        raw_size += count;
+    }
+
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    template<typename Policy, typename Construct>
+    void vector<T, Allocator, Growth, BoundsCheck>::append_chunked(const Policy& policy, size_t count, Construct construct) {
+        T* dest = _data + raw_size;
+        detail::for_each_chunk(policy, count, sizeof(T), [&](size_t first, size_t last) {
+            construct(dest + first, dest + last, first);
+        });
+        raw_size += count;
+    }
+
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 T& vector<T, Allocator, Growth, BoundsCheck>::operator[](size_t i) {
+        BoundsCheck::check(i, raw_size);
+        return _data[i];
+    }
+
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 const T& vector<T, Allocator, Growth, BoundsCheck>::operator[](size_t i) const {
+        BoundsCheck::check(i, raw_size);
+        return _data[i];
+    }
+
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 T& vector<T, Allocator, Growth, BoundsCheck>::at(size_t i) {
         if(!(i < raw_size)) {
             throw std::out_of_range("Attempted to access element out of range");
         }
         return _data[i];
     }
     
-    template<typename T>
-    const T& vector<T>::at(size_t i) const {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 const T& vector<T, Allocator, Growth, BoundsCheck>::at(size_t i) const {
         if(!(i < raw_size)) {
             throw std::out_of_range("Attempted to access element out of range");
         }
         return _data[i];
     }
 
-    template<typename T>
-    const T& vector<T>::front() const {
-        return at(0);
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 const T& vector<T, Allocator, Growth, BoundsCheck>::front() const {
+        BoundsCheck::check(0, raw_size);
+        return _data[0];
     }
 
-    template<typename T>
-    T& vector<T>::front() {
-        return at(0);
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 T& vector<T, Allocator, Growth, BoundsCheck>::front() {
+        BoundsCheck::check(0, raw_size);
+        return _data[0];
     }
 
-    template<typename T>
-    const T& vector<T>::back() const {
-        return at(raw_size-1);
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 const T& vector<T, Allocator, Growth, BoundsCheck>::back() const {
+        BoundsCheck::check(0, raw_size);
+        return _data[raw_size-1];
     }
 
-    template<typename T>
-    T& vector<T>::back() {
-        return at(raw_size-1);
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 T& vector<T, Allocator, Growth, BoundsCheck>::back() {
+        BoundsCheck::check(0, raw_size);
+        return _data[raw_size-1];
     }
 
-    template<typename T> 
-    size_t vector<T>::size() const noexcept {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 size_t vector<T, Allocator, Growth, BoundsCheck>::size() const noexcept {
         return raw_size;
     }
 
-    template<typename T>
-    size_t vector<T>::capacity() const noexcept {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 size_t vector<T, Allocator, Growth, BoundsCheck>::capacity() const noexcept {
         return _capacity;
     }
 
-    template<typename T>
-    size_t vector<T>::max_size() const noexcept {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 size_t vector<T, Allocator, Growth, BoundsCheck>::max_size() const noexcept {
         return std::numeric_limits<size_t>::max();
     }
 
-    template<typename T>
-    bool vector<T>::empty() const noexcept {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 bool vector<T, Allocator, Growth, BoundsCheck>::empty() const noexcept {
         return raw_size == 0;
     }
 
-    template<typename T> 
-    void vector<T>::clear() {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 void vector<T, Allocator, Growth, BoundsCheck>::clear() {
         for(size_t i=0; i<raw_size; i++) {
-            _data[i].~T();
+            alloc_traits::destroy(_alloc, _data + i);
         }
         raw_size = 0;
     }
 
-    template<typename T>
-    void vector<T>::shrink_to_fit() {
-        T* new_data = new T[raw_size];
-        memcpy(new_data, _data, raw_size*sizeof(T));
-        delete[] _data;
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 void vector<T, Allocator, Growth, BoundsCheck>::shrink_to_fit() {
+        if(raw_size == _capacity) {
+            return;
+        }
+        if constexpr(can_reallocate) {
+            if(raw_size > 0) {
+                T* old_data = _data;
+                _data = _alloc.reallocate(_data, _capacity, raw_size);
+                if(old_data == _data) {
+                    XD_VECTOR_RECORD(resize_in_place, _capacity, raw_size, raw_size, _data);
+                } else {
+                    XD_VECTOR_RECORD(deallocate, _capacity, 0, raw_size, old_data);
+                    XD_VECTOR_RECORD(allocate, 0, raw_size, raw_size, _data);
+                    XD_VECTOR_RECORD(shrink, _capacity, raw_size, raw_size, _data);
+                }
+                _capacity = raw_size;
+                return;
+            }
+        }
+        T* new_data = nullptr;
+        if(raw_size > 0) {
+            new_data = allocate_storage(raw_size);
+            XD_VECTOR_RECORD(shrink, _capacity, raw_size, raw_size, new_data);
+            relocate(_data, _data + raw_size, new_data);
+        }
+        release_storage();
         _data = new_data;
         _capacity = raw_size;
     }
     
-    template<typename T>
-    void vector<T>::swap(vector<T>& other) noexcept {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 void vector<T, Allocator, Growth, BoundsCheck>::swap(vector<T, Allocator, Growth, BoundsCheck>& other) noexcept {
         T* tmp_data = _data;
         _data = other._data;
         other._data = tmp_data;
@@ -522,139 +1275,177 @@ namespace xd {
         tmp_size = _capacity;
         _capacity = other._capacity;
         other._capacity = tmp_size;
+
+        if constexpr(alloc_traits::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(_alloc, other._alloc);
+        }
     }
 
-    template<typename T>
-    T* vector<T>::data() noexcept {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 Allocator vector<T, Allocator, Growth, BoundsCheck>::get_allocator() const noexcept {
+        return _alloc;
+    }
+
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 T* vector<T, Allocator, Growth, BoundsCheck>::data() noexcept {
         return _data;
     }
 
-    template<typename T>
-    const T* vector<T>::data() const noexcept {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 const T* vector<T, Allocator, Growth, BoundsCheck>::data() const noexcept {
         return _data;
     }
 
-    template<typename T>
-    T* vector<T>::begin() noexcept {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 T* vector<T, Allocator, Growth, BoundsCheck>::begin() noexcept {
         return data();
     }
 
-    template<typename T>
-    const T* vector<T>::begin() const noexcept {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 const T* vector<T, Allocator, Growth, BoundsCheck>::begin() const noexcept {
         return cbegin();
     }
 
-    template<typename T>
-    const T* vector<T>::cbegin() const noexcept {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 const T* vector<T, Allocator, Growth, BoundsCheck>::cbegin() const noexcept {
         return data();
     }
 
-    template<typename T>
-    T* vector<T>::end() noexcept {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 T* vector<T, Allocator, Growth, BoundsCheck>::end() noexcept {
         return _data + raw_size;
     }
 
-    template<typename T>
-    const T* vector<T>::end() const noexcept {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 const T* vector<T, Allocator, Growth, BoundsCheck>::end() const noexcept {
         return cend();
     }
 
-    template<typename T>
-    const T* vector<T>::cend() const noexcept {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 const T* vector<T, Allocator, Growth, BoundsCheck>::cend() const noexcept {
         return _data + raw_size;
     }
 
-    template<typename T>
-    T* vector<T>::rbegin() noexcept {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 T* vector<T, Allocator, Growth, BoundsCheck>::rbegin() noexcept {
         return data() - 1;
     }
 
-    template<typename T>
-    const T* vector<T>::rbegin() const noexcept {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 const T* vector<T, Allocator, Growth, BoundsCheck>::rbegin() const noexcept {
         return crbegin();
     }
 
-    template<typename T>
-    const T* vector<T>::crbegin() const noexcept {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 const T* vector<T, Allocator, Growth, BoundsCheck>::crbegin() const noexcept {
         return data() - 1;
     }
 
-    template<typename T>
-    T* vector<T>::rend() noexcept {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 T* vector<T, Allocator, Growth, BoundsCheck>::rend() noexcept {
         return _data + raw_size - 1;
     }
 
-    template<typename T>
-    const T* vector<T>::rend() const noexcept {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 const T* vector<T, Allocator, Growth, BoundsCheck>::rend() const noexcept {
         return crend();
     }
 
-    template<typename T>
-    const T* vector<T>::crend() const noexcept {
+    template<typename T, typename Allocator, typename Growth, typename BoundsCheck>
+    XD_CONSTEXPR20 const T* vector<T, Allocator, Growth, BoundsCheck>::crend() const noexcept {
         return _data + raw_size - 1;
     }
     
-    template<class T>
-    bool operator==(const vector<T>& lhs, const vector<T>& rhs) {
-        if(lhs.size() != rhs.size()) {
-            return false;
-        }
-        for(size_t i=0; i<lhs.size(); i++) {
-            if(lhs[i] != rhs[i]) {
-                return false;
-            }
-        }
-        return true;
+    template<class T, class Allocator, class Growth, class BoundsCheck, class U>
+    XD_CONSTEXPR20 size_t erase(vector<T, Allocator, Growth, BoundsCheck>& vec, const U& value) {
+        return vec.remove_if([&value](const T& x) { return x == value; });
+    }
+
+    template<class T, class Allocator, class Growth, class BoundsCheck, class Predicate>
+    XD_CONSTEXPR20 size_t erase_if(vector<T, Allocator, Growth, BoundsCheck>& vec, Predicate pred) {
+        return vec.remove_if(pred);
+    }
+    
+    template<class T, class Allocator, class Growth, class BoundsCheck>
+    XD_CONSTEXPR20 bool operator==(const vector<T, Allocator, Growth, BoundsCheck>& lhs, const vector<T, Allocator, Growth, BoundsCheck>& rhs) {
+        return lhs.size() == rhs.size() && detail::equal(lhs.data(), rhs.data(), lhs.size());
     }
 
-    template<class T>
-    bool operator!=(const vector<T>& lhs, const vector<T>& rhs) {
+    template<class T, class Allocator, class Growth, class BoundsCheck>
+    XD_CONSTEXPR20 bool operator!=(const vector<T, Allocator, Growth, BoundsCheck>& lhs, const vector<T, Allocator, Growth, BoundsCheck>& rhs) {
         return !(lhs == rhs);
     }
 
-    template<class T>
-    bool operator<(const vector<T>& lhs, const vector<T>& rhs) {
-        size_t min_len = lhs.size()<rhs.size() ? lhs.size() : rhs.size();
-        for(size_t i=0; i<min_len; i++) {
-            if(lhs[i] != rhs[i]) {
-                return lhs[i] < rhs[i];
-            }
-        }
-        return lhs.size() < rhs.size();
+    template<class T, class Allocator, class Growth, class BoundsCheck>
+    XD_CONSTEXPR20 bool operator<(const vector<T, Allocator, Growth, BoundsCheck>& lhs, const vector<T, Allocator, Growth, BoundsCheck>& rhs) {
+        return detail::compare(lhs.data(), lhs.size(), rhs.data(), rhs.size()) < 0;
     }
 
-    template<class T>
-    bool operator<=(const vector<T>& lhs, const vector<T>& rhs) {
-        size_t min_len = lhs.size()<rhs.size() ? lhs.size() : rhs.size();
-        for(size_t i=0; i<min_len; i++) {
-            if(lhs[i] != rhs[i]) {
-                return lhs[i] < rhs[i]; // Already know they aren't equal
-            }
-        }
-        return lhs.size() <= rhs.size();
+    template<class T, class Allocator, class Growth, class BoundsCheck>
+    XD_CONSTEXPR20 bool operator<=(const vector<T, Allocator, Growth, BoundsCheck>& lhs, const vector<T, Allocator, Growth, BoundsCheck>& rhs) {
+        return detail::compare(lhs.data(), lhs.size(), rhs.data(), rhs.size()) <= 0;
     }
 
-    template<class T>
-    bool operator>(const vector<T>& lhs, const vector<T>& rhs) {
-        size_t min_len = lhs.size()<rhs.size() ? lhs.size() : rhs.size();
-        for(size_t i=0; i<min_len; i++) {
-            if(lhs[i] != rhs[i]) {
-                return lhs[i] > rhs[i];
-            }
-        }
-        return lhs.size() > rhs.size();
+    template<class T, class Allocator, class Growth, class BoundsCheck>
+    XD_CONSTEXPR20 bool operator>(const vector<T, Allocator, Growth, BoundsCheck>& lhs, const vector<T, Allocator, Growth, BoundsCheck>& rhs) {
+        return detail::compare(lhs.data(), lhs.size(), rhs.data(), rhs.size()) > 0;
     }
 
-    template<class T>
-    bool operator>=(const vector<T>& lhs, const vector<T>& rhs) {
-        size_t min_len = lhs.size()<rhs.size() ? lhs.size() : rhs.size();
-        for(size_t i=0; i<min_len; i++) {
-            if(lhs[i] != rhs[i]) {
-                return lhs[i] > rhs[i];
-            }
+    template<class T, class Allocator, class Growth, class BoundsCheck>
+    XD_CONSTEXPR20 bool operator>=(const vector<T, Allocator, Growth, BoundsCheck>& lhs, const vector<T, Allocator, Growth, BoundsCheck>& rhs) {
+        return detail::compare(lhs.data(), lhs.size(), rhs.data(), rhs.size()) >= 0;
+    }
+
+    template<class T, class Allocator, class Growth, class BoundsCheck>
+    XD_CONSTEXPR20 const T* find(const vector<T, Allocator, Growth, BoundsCheck>& vec, const T& value) {
+        return vec.data() + detail::find(vec.data(), vec.size(), value);
+    }
+
+    template<class T, class Allocator, class Growth, class BoundsCheck>
+    XD_CONSTEXPR20 T* find(vector<T, Allocator, Growth, BoundsCheck>& vec, const T& value) {
+        return vec.data() + detail::find(vec.data(), vec.size(), value);
+    }
+
+    template<class T, class Allocator, class Growth, class BoundsCheck>
+    XD_CONSTEXPR20 size_t count(const vector<T, Allocator, Growth, BoundsCheck>& vec, const T& value) {
+        return detail::count(vec.data(), vec.size(), value);
+    }
+
+    template<class T, class Allocator, class Growth, class BoundsCheck>
+    XD_CONSTEXPR20 bool contains(const vector<T, Allocator, Growth, BoundsCheck>& vec, const T& value) {
+        return detail::find(vec.data(), vec.size(), value) != vec.size();
+    }
+
+#if XD_CONSTEXPR_CONTAINERS
+    //! Bakes the vector returned by Make into a std::array, so a table
+    //! built at compile time lives in the binary instead of being built at
+    //! startup:
+    //!
+    //!     constexpr auto squares = xd::to_static_array<[]() {
+    //!         xd::vector<int> v;
+    //!         for(int i=0; i<16; i++) {
+    //!             v.push_back(i*i);
+    //!         }
+    //!         return v;
+    //!     }>();
+    //!
+    //! The vector's storage can't outlive constant evaluation so Make runs
+    //! once for the size and again for the elements. T must be default
+    //! constructible.
+    template<auto Make>
+    consteval auto to_static_array() {
+        using vector_type = decltype(Make());
+        using T = typename vector_type::value_type;
+        constexpr size_t n = Make().size();
+        std::array<T, n> out{};
+        const vector_type vec = Make();
+        for(size_t i=0; i<n; i++) {
+            out[i] = vec[i];
         }
-        return lhs.size() >= rhs.size();
+        return out;
     }
+#endif
 }
 
 
@@ -0,0 +1,174 @@
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "bitvector.hpp"
+
+
+void assert(bool condition, const std::string& message) {
+    if(!condition) {
+        std::cout<<message<<std::endl;
+        exit(-1);
+    }
+}
+
+bool same_bits(const xd::bitvector& bits, const std::vector<bool>& expected) {
+    if(bits.size() != expected.size()) {
+        return false;
+    }
+    for(size_t i=0; i<expected.size(); i++) {
+        if(bits[i] != expected[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<bool> random_bits(size_t n, std::mt19937& rng, unsigned one_in) {
+    std::vector<bool> res;
+    for(size_t i=0; i<n; i++) {
+        res.push_back(rng() % one_in == 0);
+    }
+    return res;
+}
+
+void test_basic() {
+    xd::bitvector bits = {true, false, true};
+    assert(bits.size() == 3 && bits[0] && !bits[1] && bits.back(), "Initializer list went wrong");
+    bits[1] = true;
+    bits[0] = bits[2];
+    bits[2].flip();
+    assert(bits[0] && bits[1] && !bits[2] && ~bits[2], "Proxy reference failed");
+    for(int i=0; i<200; i++) {
+        bits.push_back(i % 3 == 0);
+    }
+    assert(bits.size() == 203 && bits.word_count() == 4 && bits[3] && !bits[4], "push_back across words failed");
+    for(int i=0; i<140; i++) {
+        bits.pop_back();
+    }
+    assert(bits.size() == 63 && bits.word_count() == 1, "pop_back didn't drop the empty words");
+    assert(bits.data()[0] >> 63 == 0, "pop_back left a bit past the end");
+
+    bool threw = false;
+    try {
+        bits.at(63);
+    } catch(const std::out_of_range&) {
+        threw = true;
+    }
+    assert(threw, "at() past the end didn't throw");
+
+    std::vector<bool> expected(bits.begin(), bits.end());
+    assert(same_bits(bits, expected) && bits.end() - bits.begin() == 63, "Iterating over the bits failed");
+
+    xd::bitvector empty;
+    empty.pop_back();
+    assert(empty.empty() && empty.word_count() == 0, "pop_back on an empty bitvector changed it");
+}
+
+void test_resize() {
+    xd::bitvector bits(70, true);
+    assert(bits.count() == 70 && bits.all() && bits.data()[1] == 0x3f, "Fill constructor set the tail");
+    bits.resize(10);
+    bits.resize(130, true);
+    assert(bits.count() == 130 && bits.all(), "Growing with true missed bits");
+    bits.resize(200);
+    assert(bits.count() == 130 && !bits.all() && !bits[130] && bits[129], "Growing with false set bits");
+    bits.assign(65, false);
+    assert(bits.none() && bits.size() == 65, "assign didn't clear the bits");
+    bits.set();
+    assert(bits.count() == 65 && bits.data()[1] == 1, "set() went past the end");
+    bits.flip();
+    assert(bits.none(), "flip() went past the end");
+    bits.set(64).set(3);
+    assert(bits.count() == 2 && bits.reset(3).count() == 1, "set(i) or reset(i) failed");
+}
+
+void test_find() {
+    std::mt19937 rng(11);
+    for(unsigned one_in: {1u, 3u, 500u}) {
+        const std::vector<bool> expected = random_bits(3000, rng, one_in);
+        const xd::bitvector bits(expected.begin(), expected.end());
+        std::vector<size_t> ones;
+        for(size_t i=0; i<expected.size(); i++) {
+            if(expected[i]) {
+                ones.push_back(i);
+            }
+        }
+        std::vector<size_t> found;
+        for(size_t i=bits.find_first(); i!=xd::bitvector::npos; i=bits.find_next(i)) {
+            found.push_back(i);
+        }
+        assert(found == ones, "find_first/find_next disagree with a scan");
+        assert(bits.count() == ones.size(), "count() is wrong");
+    }
+    const xd::bitvector empty(500);
+    assert(empty.find_first() == xd::bitvector::npos && empty.find_next(10) == xd::bitvector::npos,
+           "Found a bit in an empty bitvector");
+}
+
+void test_bitwise() {
+    std::mt19937 rng(5);
+    const std::vector<bool> a = random_bits(1000, rng, 2);
+    const std::vector<bool> b = random_bits(1000, rng, 2);
+    const xd::bitvector x(a.begin(), a.end());
+    const xd::bitvector y(b.begin(), b.end());
+    std::vector<bool> expected_and, expected_or, expected_xor, expected_and_not, expected_not;
+    for(size_t i=0; i<a.size(); i++) {
+        expected_and.push_back(a[i] && b[i]);
+        expected_or.push_back(a[i] || b[i]);
+        expected_xor.push_back(a[i] != b[i]);
+        expected_and_not.push_back(a[i] && !b[i]);
+        expected_not.push_back(!a[i]);
+    }
+    assert(same_bits(x & y, expected_and), "AND is wrong");
+    assert(same_bits(x | y, expected_or), "OR is wrong");
+    assert(same_bits(x ^ y, expected_xor), "XOR is wrong");
+    xd::bitvector z = x;
+    assert(same_bits(z.and_not(y), expected_and_not), "ANDNOT is wrong");
+    assert(same_bits(~x, expected_not) && (~x).count() == 1000 - x.count(), "NOT is wrong");
+    assert(z != x && (x ^ x).none() && (x | x) == x, "Equality is wrong");
+
+    bool threw = false;
+    try {
+        z &= xd::bitvector(999);
+    } catch(const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw, "Mismatched sizes didn't throw");
+}
+
+void test_rank_select() {
+    std::mt19937 rng(3);
+    for(size_t n: {size_t(0), size_t(64), size_t(512), size_t(5000)}) {
+        for(unsigned one_in: {1u, 2u, 40u}) {
+            const std::vector<bool> expected = random_bits(n, rng, one_in);
+            const xd::bitvector bits(expected.begin(), expected.end());
+            const xd::rank_select index(bits);
+            size_t ones = 0;
+            for(size_t i=0; i<=n; i++) {
+                if(index.rank(i) != ones) {
+                    assert(false, "rank("+std::to_string(i)+") of "+std::to_string(n)+" bits is wrong");
+                }
+                if(i < n && expected[i]) {
+                    if(index.select(ones) != i) {
+                        assert(false, "select("+std::to_string(ones)+") of "+std::to_string(n)+" bits is wrong");
+                    }
+                    ones++;
+                }
+            }
+            assert(index.ones() == ones && index.select(ones) == xd::bitvector::npos, "select past the last one didn't give npos");
+        }
+    }
+}
+
+int main() {
+    test_basic();
+    test_resize();
+    test_find();
+    test_bitwise();
+    test_rank_select();
+    std::cout<<"Test passed"<<std::endl;
+    return 0;
+}
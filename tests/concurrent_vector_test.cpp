@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arena.hpp"
+#include "concurrent_vector.hpp"
+
+
+void assert(bool condition, const std::string& message) {
+    if(!condition) {
+        std::cout<<message<<std::endl;
+        exit(-1);
+    }
+}
+
+void test_single_thread() {
+    xd::concurrent_vector<std::string> list;
+    assert(list.empty(), "New vector isn't empty");
+    for(int i=0; i<1000; i++) {
+        assert(list.push_back(std::to_string(i)) == size_t(i), "push_back returned the wrong index");
+    }
+    const std::string* first = &list[0];
+    const std::string* middle = &list[500];
+    const size_t start = list.grow_by(5000, "x");
+    assert(start == 1000 && list.size() == 6000, "grow_by claimed the wrong range");
+    assert(first == &list[0] && middle == &list[500], "Growing moved elements");
+    assert(list[999] == "999" && list[1000] == "x" && list[5999] == "x", "Elements have the wrong values");
+    assert(list.grow_by(3) == 6000 && list[6002].empty(), "grow_by didn't value initialise");
+
+    size_t count = 0;
+    for(const auto& s: list) {
+        (void)s;
+        count++;
+    }
+    assert(count == list.size(), "Iteration didn't visit every element");
+    assert(std::find(list.begin(), list.end(), "999") - list.begin() == 999, "Iterators don't index correctly");
+
+    bool threw = false;
+    try {
+        list.at(list.size());
+    } catch(std::out_of_range&) {
+        threw = true;
+    }
+    assert(threw, "at past the end didn't throw");
+    list.clear();
+    assert(list.empty() && list.push_back("a") == 0, "clear didn't reset the vector");
+}
+
+void test_concurrent_append() {
+    const int threads = 8;
+    const int per_thread = 20000;
+    xd::concurrent_vector<int> list;
+    std::atomic<bool> stop(false);
+    std::atomic<bool> bad_read(false);
+    std::thread reader([&]() {
+        while(!stop.load()) {
+            // Everything below size() must be constructed
+            const size_t n = list.size();
+            for(size_t i=0; i<n; i += 97) {
+                if(list[i] < 0) {
+                    bad_read = true;
+                }
+            }
+        }
+    });
+    std::vector<std::thread> writers;
+    for(int t=0; t<threads; t++) {
+        writers.emplace_back([&list, t]() {
+            for(int i=0; i<per_thread; i++) {
+                if(i % 100 == 0) {
+                    const size_t first = list.grow_by(10, t*per_thread + i);
+                    (void)first;
+                } else {
+                    list.push_back(t*per_thread + i);
+                }
+            }
+        });
+    }
+    for(auto& w: writers) {
+        w.join();
+    }
+    stop = true;
+    reader.join();
+    assert(!bad_read, "Reader saw an unconstructed element");
+    const size_t expected = threads*per_thread + threads*(per_thread/100)*9;
+    assert(list.size() == expected, "Lost appends, size is "+std::to_string(list.size()));
+    std::vector<int> seen(threads*per_thread, 0);
+    for(int x: list) {
+        seen[x]++;
+    }
+    for(int i=0; i<threads*per_thread; i++) {
+        const int want = (i % per_thread) % 100 == 0 ? 10 : 1;
+        assert(seen[i] == want, "Value "+std::to_string(i)+" appended the wrong number of times");
+    }
+}
+
+// Construction blocks until released, to stand in for a preempted appender
+struct stalled {
+    stalled(std::atomic<bool>* started, std::atomic<bool>* gate) {
+        *started = true;
+        while(!gate->load()) {
+            std::this_thread::yield();
+        }
+    }
+    stalled(int) {}
+};
+
+void test_stalled_append() {
+    xd::concurrent_vector<stalled> list;
+    list.emplace_back(1);
+    std::atomic<bool> started(false);
+    std::atomic<bool> gate(false);
+    std::thread slow([&]() {
+        list.emplace_back(&started, &gate);
+    });
+    while(!started.load()) {
+        std::this_thread::yield();
+    }
+    // The slow append holds slot 1 but mustn't hold up anyone else
+    for(int i=0; i<200; i++) {
+        list.emplace_back(i);
+    }
+    assert(list.size() == 1, "size() counted a slot still being constructed");
+    gate = true;
+    slow.join();
+    assert(list.size() == 202, "size() didn't catch up once the slow append finished");
+}
+
+void test_allocator() {
+    xd::arena arena;
+    {
+        xd::concurrent_vector<int, xd::arena_allocator<int>> list(arena);
+        list.push_back(1);
+        // The first segment and its ready bits both come from the arena
+        assert(arena.bytes_used() >= 64*sizeof(int) + sizeof(uint64_t), "Ready bits didn't come from the allocator");
+        list.grow_by(1000, 2);
+        assert(list.size() == 1001 && list[1000] == 2, "Growing on an arena failed");
+    }
+}
+
+int main() {
+    test_single_thread();
+    test_concurrent_append();
+    test_stalled_append();
+    test_allocator();
+    std::cout<<"Test passed"<<std::endl;
+    return 0;
+}
@@ -0,0 +1,174 @@
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "fd_io.hpp"
+
+
+void assert(bool condition, const std::string& message) {
+    if(!condition) {
+        std::cout<<message<<std::endl;
+        exit(-1);
+    }
+}
+
+struct pipe_fds {
+    pipe_fds() {
+        assert(pipe(fds) == 0, "Failed to make a pipe");
+    }
+    ~pipe_fds() {
+        close_write();
+        close(fds[0]);
+    }
+    void close_write() {
+        if(fds[1] >= 0) {
+            close(fds[1]);
+            fds[1] = -1;
+        }
+    }
+    int read_end() const { return fds[0]; }
+    int write_end() const { return fds[1]; }
+
+    int fds[2];
+};
+
+void test_file_round_trip() {
+    char path[] = "/tmp/xd_fd_io_XXXXXX";
+    const int fd = mkstemp(path);
+    assert(fd >= 0, "Failed to make a temp file");
+    unlink(path);
+    xd::vector<uint32_t> out;
+    for(uint32_t i=0; i<100000; i++) {
+        out.push_back(i*7);
+    }
+    xd::write_all(fd, out);
+    assert(lseek(fd, 0, SEEK_SET) == 0, "Failed to rewind");
+
+    xd::vector<uint32_t> in = {42};
+    assert(xd::read_all(fd, in) == out.size(), "read_all read the wrong number of elements");
+    assert(in.size() == out.size() + 1 && in[0] == 42 && in[1] == 0 && in.back() == out.back(),
+           "read_all didn't append the file");
+    assert(in.capacity() < 2*in.size(), "read_all grew past the file size");
+
+    assert(lseek(fd, 0, SEEK_SET) == 0, "Failed to rewind");
+    xd::vector<uint32_t> limited;
+    assert(xd::read_append(fd, limited, 10) == 10 && limited.size() == 10 && limited[9] == 63,
+           "read_append read past max");
+    close(fd);
+}
+
+void test_pipe_streaming() {
+    pipe_fds p;
+    xd::vector<char> out;
+    for(size_t i=0; i<(1<<20); i++) {
+        out.push_back(char('a' + i % 26));
+    }
+    // Bigger than the pipe buffer so the writes come back partial
+    std::thread writer([&]() {
+        xd::write_all(p.write_end(), out);
+        p.close_write();
+    });
+    xd::vector<char> in;
+    size_t reads = 0;
+    while(xd::read_append(p.read_end(), in) != 0) {
+        reads++;
+    }
+    writer.join();
+    assert(in == out, "Streaming through a pipe corrupted the data");
+    assert(reads > 1, "Expected the pipe to need more than one read");
+}
+
+void test_partial_element() {
+    pipe_fds p;
+    const unsigned char bytes[8] = {1, 0, 0, 0, 2, 0, 0, 0};
+    assert(write(p.write_end(), bytes, 6) == 6, "Failed to write to the pipe");
+    // The rest of the second element turns up after the first read
+    std::thread writer([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        assert(write(p.write_end(), bytes + 6, 2) == 2, "Failed to write to the pipe");
+        assert(write(p.write_end(), bytes, 3) == 3, "Failed to write to the pipe");
+        p.close_write();
+    });
+    xd::vector<uint32_t> in;
+    assert(xd::read_append(p.read_end(), in) == 2 && in[0] == 1 && in[1] == 2, "Split element wasn't completed");
+    bool threw = false;
+    try {
+        xd::read_append(p.read_end(), in);
+    } catch(const std::runtime_error&) {
+        threw = true;
+    }
+    writer.join();
+    assert(threw, "End of file inside an element didn't throw");
+}
+
+void test_scatter_gather() {
+    pipe_fds p;
+    xd::vector<uint32_t> header = {0xfeed, 3};
+    xd::vector<uint32_t> empty;
+    xd::vector<uint32_t> body = {10, 20, 30};
+    const xd::vector<uint32_t>* parts[] = {&header, &empty, &body};
+    xd::writev_all(p.write_end(), parts);
+
+    xd::vector<xd::vector<uint32_t>> in;
+    in.push_back(xd::vector<uint32_t>(1, 0u));
+    in.push_back(xd::vector<uint32_t>(4, 0u));
+    xd::readv_all(p.read_end(), in);
+    assert(in[0][0] == 0xfeed && in[1][0] == 3 && in[1][1] == 10 && in[1][3] == 30, "Scatter read split the data wrongly");
+
+    xd::write_all(p.write_end(), body);
+    p.close_write();
+    bool threw = false;
+    try {
+        xd::readv_all(p.read_end(), in);
+    } catch(const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw, "Scatter read past the end of the data didn't throw");
+
+    bool bad_fd = false;
+    try {
+        xd::write_all(-1, body);
+    } catch(const std::system_error& e) {
+        bad_fd = e.code().value() == EBADF;
+    }
+    assert(bad_fd, "Writing to a bad descriptor didn't throw EBADF");
+}
+
+void ignore_signal(int) {
+}
+
+void test_interrupted_read() {
+    struct sigaction action = {};
+    action.sa_handler = ignore_signal;
+    // No SA_RESTART so the blocked read fails with EINTR
+    sigaction(SIGUSR1, &action, nullptr);
+    pipe_fds p;
+    const pthread_t reader = pthread_self();
+    std::thread writer([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        pthread_kill(reader, SIGUSR1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        const char byte = 'x';
+        assert(write(p.write_end(), &byte, 1) == 1, "Failed to write to the pipe");
+    });
+    xd::vector<char> in;
+    const size_t got = xd::read_append(p.read_end(), in);
+    writer.join();
+    assert(got == 1 && in[0] == 'x', "Interrupted read wasn't retried");
+}
+
+int main() {
+    test_file_round_trip();
+    test_pipe_streaming();
+    test_partial_element();
+    test_scatter_gather();
+    test_interrupted_read();
+    std::cout<<"Test passed"<<std::endl;
+    return 0;
+}
@@ -0,0 +1,147 @@
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "flat_map.hpp"
+
+
+void assert(bool condition, const std::string& message) {
+    if(!condition) {
+        std::cout<<message<<std::endl;
+        exit(-1);
+    }
+}
+
+void test_branchless_search() {
+    xd::vector<int> keys;
+    for(int i=0; i<100; i++) {
+        keys.push_back(i*2);
+    }
+    for(size_t n=0; n<=keys.size(); n++) {
+        for(int key=-1; key<=201; key++) {
+            const size_t expected = std::lower_bound(keys.begin(), keys.begin() + n, key) - keys.begin();
+            const size_t got = xd::detail::branchless_lower_bound(keys.data(), n, key, std::less<int>());
+            if(got != expected) {
+                assert(false, "lower_bound of "+std::to_string(key)+" in "+std::to_string(n)+" keys gave "+std::to_string(got));
+            }
+            const xd::detail::eytzinger_index<int, std::less<int>> index(keys.data(), n, std::less<int>());
+            if(index.lower_bound(key) != expected) {
+                assert(false, "Eytzinger lower_bound of "+std::to_string(key)+" in "+std::to_string(n)+" keys is wrong");
+            }
+        }
+    }
+}
+
+void test_set() {
+    xd::flat_set<int> set = {5, 1, 3, 1, 5};
+    assert(set.size() == 3 && set.keys()[0] == 1 && set.keys()[2] == 5, "Initializer list wasn't sorted and deduplicated");
+    assert(set.insert(4).second && !set.insert(4).second && set.size() == 4, "Insert didn't report duplicates");
+    assert(set.contains(3) && !set.contains(2) && set.count(4) == 1, "Lookup failed");
+    assert(*set.lower_bound(2) == 3 && *set.upper_bound(3) == 4 && set.upper_bound(5) == set.end(), "Bounds are wrong");
+    assert(set.erase(3) == 1 && set.erase(3) == 0 && !set.contains(3), "Erase failed");
+
+    xd::flat_set<int> adopted(xd::vector<int>{9, 2, 9, 7});
+    assert(adopted.size() == 3 && *adopted.begin() == 2, "Adopting a vector didn't sort it");
+
+    xd::flat_set<std::string, std::greater<std::string>> strings = {"a", "c", "b"};
+    assert(strings.keys()[0] == "c" && strings.keys()[2] == "a", "Custom comparison ignored");
+}
+
+void test_insert_range() {
+    std::mt19937 rng(7);
+    std::set<int> expected;
+    xd::flat_set<int> set;
+    for(int round=0; round<20; round++) {
+        xd::vector<int> batch;
+        for(int i=0; i<200; i++) {
+            batch.push_back(rng() % 3000);
+        }
+        set.insert_range(batch.begin(), batch.end());
+        expected.insert(batch.begin(), batch.end());
+        assert(set.size() == expected.size() && std::equal(set.begin(), set.end(), expected.begin()),
+               "insert_range doesn't match std::set");
+    }
+
+    xd::flat_map<int, std::string> map = {{1, "one"}, {3, "three"}};
+    const std::pair<int, std::string> pairs[] = {{2, "two"}, {3, "ignored"}, {0, "zero"}, {2, "second two"}};
+    map.insert_range(std::begin(pairs), std::end(pairs));
+    assert(map.size() == 4 && map.keys()[0] == 0 && map.at(2) == "two" && map.at(3) == "three",
+           "Map insert_range didn't keep the first value for each key");
+}
+
+void test_map() {
+    xd::flat_map<std::string, int> map;
+    map["b"] = 2;
+    map["a"] = 1;
+    assert(map.insert({"c", 3}).second && !map.insert({"c", 4}).second && map.at("c") == 3, "Insert overwrote a value");
+    assert(!map.insert_or_assign("c", 5).second && map.at("c") == 5, "insert_or_assign didn't assign");
+    assert(map.try_emplace("d", 4).second && map["d"] == 4, "try_emplace failed");
+    assert(map.keys()[0] == "a" && map.values()[0] == 1, "Map isn't sorted by key");
+
+    int total = 0;
+    std::string order;
+    for(auto kv: map) {
+        order += kv.first;
+        total += kv.second;
+    }
+    assert(order == "abcd" && total == 12, "Iteration over the map is wrong");
+    auto pos = map.find("b");
+    assert(pos != map.end() && pos->first == "b" && (*pos).second == 2, "find failed");
+    pos->second = 20;
+    assert(map.at("b") == 20, "Writing through an iterator failed");
+
+    assert(map.erase("b") == 1 && !map.contains("b") && map.size() == 3, "Erase by key failed");
+    auto next = map.erase(map.find("a"));
+    assert(next->first == "c" && map.size() == 2, "Erase by iterator failed");
+    bool threw = false;
+    try {
+        map.at("zz");
+    } catch(const std::out_of_range&) {
+        threw = true;
+    }
+    assert(threw, "at() on a missing key didn't throw");
+
+    const xd::flat_map<std::string, int>& cmap = map;
+    assert(cmap.find("d")->second == 4 && cmap.lower_bound("a")->first == "c", "Const lookups failed");
+}
+
+void test_freeze() {
+    xd::flat_map<uint64_t, uint64_t> map;
+    std::map<uint64_t, uint64_t> expected;
+    std::mt19937_64 rng(3);
+    xd::vector<std::pair<uint64_t, uint64_t>> pairs;
+    for(int i=0; i<5000; i++) {
+        const uint64_t key = rng() % 100000;
+        pairs.push_back({key, uint64_t(i)});
+        expected.insert({key, uint64_t(i)});
+    }
+    map.insert_range(pairs.begin(), pairs.end());
+    map.freeze();
+    assert(map.frozen(), "freeze() didn't build the index");
+    const auto copy = map;
+    assert(copy.frozen(), "Copies should share the index");
+    for(uint64_t key=0; key<100000; key+=7) {
+        auto it = expected.find(key);
+        auto pos = map.find(key);
+        if((it == expected.end()) != (pos == map.end()) || (pos != map.end() && pos->second != it->second)) {
+            assert(false, "Frozen lookup of "+std::to_string(key)+" is wrong");
+        }
+    }
+    map[100001] = 1;
+    assert(!map.frozen() && copy.frozen(), "Inserting didn't drop the index");
+    assert(map.contains(100001) && !copy.contains(100001), "Copy changed with the original");
+}
+
+int main() {
+    test_branchless_search();
+    test_set();
+    test_insert_range();
+    test_map();
+    test_freeze();
+    std::cout<<"Test passed"<<std::endl;
+    return 0;
+}
@@ -0,0 +1,126 @@
+#define XD_VECTOR_INSTRUMENT 1
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include "arena.hpp"
+#include "realloc_allocator.hpp"
+#include "vector.hpp"
+
+
+void assert(bool condition, const std::string& message) {
+    if(!condition) {
+        std::cout<<message<<std::endl;
+        exit(-1);
+    }
+}
+
+struct hook_log {
+    size_t grows = 0;
+    size_t largest_grow = 0;
+};
+
+void log_event(const xd::vector_event& e, void* context) {
+    auto* log = static_cast<hook_log*>(context);
+    if(e.kind == xd::vector_event_kind::grow && *e.type == typeid(uint32_t)) {
+        log->grows++;
+        log->largest_grow = e.new_capacity > log->largest_grow ? e.new_capacity : log->largest_grow;
+    }
+}
+
+void test_counters() {
+    xd::reset_vector_stats();
+    const auto& stats = xd::vector_stats_for<uint32_t>();
+    {
+        xd::vector<uint32_t> list;
+        for(uint32_t i=0; i<1000; i++) {
+            list.push_back(i);
+        }
+        // Capacity goes 1, 2, 4, ..., 1024: 11 buffers, 10 of them outgrown
+        assert(stats.allocations == 11, "Expected 11 allocations got "+std::to_string(stats.allocations.load()));
+        assert(stats.reallocations == 10, "Expected 10 reallocations got "+std::to_string(stats.reallocations.load()));
+        assert(stats.bytes_copied == 1023*4, "Bytes copied should be sizes at each growth");
+        assert(stats.live_bytes == 1024*4 && stats.peak_bytes == 1024*4 + 512*4,
+                "Live/peak capacity is wrong, peak "+std::to_string(stats.peak_bytes.load()));
+        assert(stats.slack_bytes == 0, "Outgrown full buffers shouldn't count as slack");
+    }
+    assert(stats.live_bytes == 0 && stats.deallocations == 11, "Destruction wasn't recorded");
+    assert(stats.slack_bytes == 24*4, "Unused capacity at destruction should be slack");
+
+    xd::vector<uint32_t> reserved;
+    reserved.reserve(1000);
+    for(uint32_t i=0; i<1000; i++) {
+        reserved.push_back(i);
+    }
+    assert(stats.allocations == 12 && stats.reallocations == 10, "reserve() still reallocated");
+    reserved.resize(10);
+    reserved.shrink_to_fit();
+    assert(stats.reallocations == 11 && stats.slack_bytes == 24*4 + 990*4, "shrink_to_fit wasn't recorded");
+    assert(xd::vector_stats_for<double>().allocations == 0, "Counters leaked into another type");
+    assert(xd::global_vector_stats().allocations >= stats.allocations, "Global counters missed events");
+}
+
+void test_hook() {
+    hook_log log;
+    xd::set_vector_hook(log_event, &log);
+    xd::vector<uint32_t> list;
+    for(uint32_t i=0; i<100; i++) {
+        list.push_back(i);
+    }
+    list.insert(list.begin(), 100, 0u);
+    xd::set_vector_hook(nullptr);
+    list.push_back(0);
+    assert(log.grows == 8 && log.largest_grow == 256, "Hook saw "+std::to_string(log.grows)+" grows");
+
+    // Whether realloc moves the buffer is up to the allocator, only a move
+    // should count as a reallocation
+    xd::vector<char, xd::realloc_allocator<char>> grown;
+    grown.reserve(10);
+    const char* before = grown.data();
+    grown.reserve(100);
+    const auto& chars = xd::vector_stats_for<char>();
+    const bool grow_moved = grown.data() != before;
+    assert(chars.reallocations == (grow_moved ? 1u : 0u) && chars.in_place_resizes == (grow_moved ? 0u : 1u)
+           && chars.live_bytes == 100, "realloc path wasn't recorded");
+    grown.resize(40);
+    before = grown.data();
+    grown.shrink_to_fit();
+    const bool shrink_moved = grown.data() != before;
+    assert(chars.bytes_copied == (shrink_moved ? 40u : 0u) && chars.live_bytes == 40,
+           "realloc shrink recorded the wrong copy");
+}
+
+void test_in_place() {
+    // Growing the newest block of an arena always happens in place
+    xd::arena arena;
+    const auto& shorts = xd::vector_stats_for<int16_t>();
+    {
+        xd::vector<int16_t, xd::arena_allocator<int16_t>> list(arena);
+        list.reserve(10);
+        const int16_t* first = list.data();
+        list.reserve(100);
+        assert(list.data() == first, "Arena didn't grow in place");
+        assert(shorts.allocations == 1 && shorts.deallocations == 0 && shorts.bytes_allocated == 20,
+               "In place growth counted as an allocation");
+        assert(shorts.in_place_resizes == 1 && shorts.reallocations == 0 && shorts.bytes_copied == 0,
+               "In place growth counted as a copy");
+        assert(shorts.live_bytes == 200 && shorts.peak_bytes == 200, "In place growth didn't update live bytes");
+        list.resize(40);
+        list.shrink_to_fit();
+        assert(list.data() == first && shorts.in_place_resizes == 2 && shorts.allocations == 1,
+               "In place shrink counted as an allocation");
+        assert(shorts.live_bytes == 80 && shorts.peak_bytes == 200 && shorts.slack_bytes == 120,
+               "In place shrink didn't update live and slack bytes");
+    }
+    assert(shorts.deallocations == 1 && shorts.live_bytes == 0, "Buffer resized in place wasn't freed once");
+}
+
+int main() {
+    test_counters();
+    test_hook();
+    test_in_place();
+    xd::print_vector_stats(stdout);
+    std::cout<<"Test passed"<<std::endl;
+    return 0;
+}
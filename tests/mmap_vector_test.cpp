@@ -0,0 +1,121 @@
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mmap_vector.hpp"
+
+
+void assert(bool condition, const std::string& message) {
+    if(!condition) {
+        std::cout<<message<<std::endl;
+        exit(-1);
+    }
+}
+
+struct point {
+    int32_t x;
+    int32_t y;
+};
+
+size_t file_size(const std::string& path) {
+    struct stat info;
+    assert(stat(path.c_str(), &info) == 0, "Couldn't stat "+path);
+    return info.st_size;
+}
+
+std::string temp_path() {
+    char path[] = "/tmp/xd_mmap_vector_XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0, "Couldn't create a temporary file");
+    close(fd);
+    return path;
+}
+
+void test_persistence(const std::string& path) {
+    {
+        xd::mmap_vector<point> list(path);
+        assert(list.empty(), "New file isn't an empty table");
+        for(int i=0; i<10000; i++) {
+            list.push_back(point{i, -i});
+        }
+        list.sync();
+        assert(list.size() == 10000, "push_back gave the wrong size");
+    }
+    {
+        xd::mmap_view<point> list(path);
+        assert(list.size() == 10000, "Reopening lost the size");
+        int i = 0;
+        for(auto& p: list) {
+            assert(p.x == i && p.y == -i, "Element "+std::to_string(i)+" wasn't persisted");
+            i++;
+        }
+    }
+    {
+        xd::mmap_vector<point> list(path);
+        list.emplace_back(point{-1, -1});
+        list.push_back(list[0]);
+        assert(list.size() == 10002, "Appending to an existing table failed");
+        assert(list.back().x == 0 && list[10000].x == -1, "Append stored the wrong values");
+        list.resize(5, point{7, 7});
+        list.resize(8, point{9, 9});
+        assert(list[4].x == 4 && list[5].x == 9 && list.size() == 8, "resize gave the wrong contents");
+        list.shrink_to_fit();
+        assert(list.capacity() == 8, "shrink_to_fit didn't trim the file");
+        list.reserve(100);
+    }
+    // Other processes may still map the spare capacity
+    assert(file_size(path) == 64 + 100*sizeof(point), "Destructor trimmed the file");
+    {
+        xd::mmap_vector<point> list(path);
+        assert(list.size() == 8 && list.capacity() == 100, "Reopening lost the capacity");
+        list.close();
+        assert(list.empty() && list.capacity() == 0, "close didn't empty the vector");
+    }
+    assert(file_size(path) == 64 + 8*sizeof(point), "close didn't trim the file");
+}
+
+void test_errors(const std::string& path) {
+    xd::mmap_view<point> view(path);
+    assert(view.size() == 8, "Size from previous test wasn't kept");
+    static_assert(std::is_same<decltype(view[0]), const point&>::value &&
+            std::is_same<decltype(*view.begin()), const point&>::value,
+            "A view handed out writable references");
+    assert(view[0].x == 0 && view.back().x == 9 && view.at(5).x == 9, "View read the wrong values");
+    bool threw = false;
+    try {
+        xd::mmap_view<int16_t> wrong(path);
+    } catch(std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw, "Opening with the wrong element type didn't throw");
+    threw = false;
+    try {
+        xd::mmap_view<point> missing("/tmp/xd_mmap_vector_missing/none");
+    } catch(std::system_error&) {
+        threw = true;
+    }
+    assert(threw, "Opening a missing file didn't throw");
+}
+
+void test_move(const std::string& path) {
+    xd::mmap_vector<point> a(path);
+    xd::mmap_vector<point> b(std::move(a));
+    assert(b.size() == 8 && a.size() == 0, "Move constructor didn't take the mapping");
+    b.clear();
+    a = std::move(b);
+    assert(a.empty() && a.capacity() == 8, "Move assignment didn't take the mapping");
+}
+
+int main() {
+    const std::string path = temp_path();
+    test_persistence(path);
+    test_errors(path);
+    test_move(path);
+    unlink(path.c_str());
+    std::cout<<"Test passed"<<std::endl;
+    return 0;
+}
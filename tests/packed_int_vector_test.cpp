@@ -0,0 +1,114 @@
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+#include "packed_int_vector.hpp"
+
+
+void assert(bool condition, const std::string& message) {
+    if(!condition) {
+        std::cout<<message<<std::endl;
+        exit(-1);
+    }
+}
+
+template<typename T>
+void check_round_trip(const xd::vector<T>& values, const std::string& name) {
+    const xd::packed_int_vector<T> packed(values);
+    assert(packed.size() == values.size(), name+": size is wrong");
+    for(size_t i=0; i<values.size(); i++) {
+        if(packed[i] != values[i]) {
+            assert(false, name+": value "+std::to_string(i)+" is wrong");
+        }
+    }
+    size_t i = 0;
+    for(T value: packed) {
+        if(value != values[i++]) {
+            assert(false, name+": iterating gave the wrong value at "+std::to_string(i - 1));
+        }
+    }
+    assert(i == values.size(), name+": iterating gave the wrong number of values");
+    assert(packed.to_vector() == values, name+": to_vector is wrong");
+}
+
+void test_widths() {
+    // One block pinned to each width, bumping the max to the top of the range
+    std::mt19937_64 rng(1);
+    for(unsigned width=0; width<=64; width++) {
+        const uint64_t mask = width == 64 ? ~uint64_t(0) : (uint64_t(1) << width) - 1;
+        xd::vector<uint64_t> values;
+        for(size_t i=0; i<300; i++) {
+            values.push_back(1000 + (rng() & mask));
+        }
+        values[5] = 1000 + mask;
+        check_round_trip(values, "Width "+std::to_string(width));
+    }
+}
+
+void test_sorted() {
+    std::mt19937_64 rng(2);
+    xd::vector<uint64_t> ids;
+    uint64_t id = uint64_t(1) << 40;
+    for(size_t i=0; i<100000; i++) {
+        id += rng() % 1000;
+        ids.push_back(id);
+    }
+    check_round_trip(ids, "Sorted ids");
+    xd::packed_int_vector<uint64_t> packed(ids);
+    packed.shrink_to_fit();
+    assert(packed.memory_usage()*4 < ids.size()*sizeof(uint64_t), "Sorted ids didn't compress 4x");
+
+    // Gaps would need more bits than the spread here, so frame of reference
+    xd::vector<uint64_t> sawtooth;
+    for(size_t i=0; i<1000; i++) {
+        sawtooth.push_back(i % 2 == 0 ? 500 : 3);
+    }
+    check_round_trip(sawtooth, "Sawtooth");
+
+    // Only rising within each of the four lanes, which is all delta needs
+    xd::vector<uint64_t> interleaved;
+    for(uint64_t i=0; i<1000; i++) {
+        interleaved.push_back((i % 4)*100000 + i*3);
+    }
+    check_round_trip(interleaved, "Interleaved");
+}
+
+void test_appending() {
+    std::mt19937 rng(3);
+    xd::vector<uint32_t> values;
+    xd::packed_int_vector<uint32_t> pushed;
+    xd::packed_int_vector<uint32_t> appended;
+    for(size_t round=0; round<20; round++) {
+        const size_t n = rng() % 400;
+        xd::vector<uint32_t> batch;
+        for(size_t i=0; i<n; i++) {
+            batch.push_back(rng());
+            pushed.push_back(batch.back());
+        }
+        appended.append(batch.data(), batch.size());
+        values.insert(values.end(), batch.begin(), batch.end());
+        assert(pushed.to_vector() == values && appended.to_vector() == values, "Appending went wrong");
+    }
+    assert(appended.block_count() == (values.size() + 127)/128, "Wrong number of blocks");
+    assert(appended.back() == values.back() && appended.front() == values.front(), "front or back is wrong");
+    check_round_trip(xd::vector<uint16_t>{1, 2, 3}, "Partial block");
+    check_round_trip(xd::vector<uint64_t>(), "Empty");
+
+    const xd::packed_int_vector<uint8_t> bytes = {9, 8, 7};
+    bool threw = false;
+    try {
+        bytes.at(3);
+    } catch(const std::out_of_range&) {
+        threw = true;
+    }
+    assert(threw && bytes.at(2) == 7, "at() past the end didn't throw");
+}
+
+int main() {
+    test_widths();
+    test_sorted();
+    test_appending();
+    std::cout<<"Test passed"<<std::endl;
+    return 0;
+}
@@ -0,0 +1,122 @@
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "parallel.hpp"
+#include "vector.hpp"
+
+
+void assert(bool condition, const std::string& message) {
+    if(!condition) {
+        std::cout<<message<<std::endl;
+        exit(-1);
+    }
+}
+
+void test_pool() {
+    xd::thread_pool pool(4);
+    assert(pool.size() == 4, "Pool has the wrong number of threads");
+    const size_t tasks = 1000;
+    std::unique_ptr<std::atomic<int>[]> hits(new std::atomic<int>[tasks]());
+    for(int round=0; round<50; round++) {
+        pool.run(tasks, [&](size_t i) {
+            hits[i]++;
+        });
+    }
+    for(size_t i=0; i<tasks; i++) {
+        assert(hits[i] == 50, "Task "+std::to_string(i)+" ran the wrong number of times");
+    }
+
+    std::atomic<int> nested(0);
+    pool.run(8, [&](size_t) {
+        pool.run(4, [&](size_t) { nested++; });
+    });
+    assert(nested == 32, "Nested jobs didn't all run");
+
+    bool threw = false;
+    try {
+        pool.run(100, [](size_t i) {
+            if(i == 37) {
+                throw std::runtime_error("task failed");
+            }
+        });
+    } catch(std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw, "Task exception wasn't rethrown");
+    std::atomic<int> after(0);
+    pool.run(10, [&](size_t) { after++; });
+    assert(after == 10, "Pool broke after an exception");
+}
+
+void test_back_to_back_jobs() {
+    xd::thread_pool pool(4);
+    for(size_t round=0; round<2000; round++) {
+        // Varying the count means a task leaking into the next job runs
+        // an index outside it or runs an index twice
+        const size_t tasks = 2 + (round*7)%13;
+        std::unique_ptr<std::atomic<int>[]> hits(new std::atomic<int>[tasks]());
+        pool.run(tasks, [&hits, tasks](size_t i) {
+            assert(i < tasks, "Task index "+std::to_string(i)+" was outside the job");
+            hits[i]++;
+        });
+        for(size_t i=0; i<tasks; i++) {
+            assert(hits[i] == 1, "Task "+std::to_string(i)+" of round "+std::to_string(round)+" ran "+std::to_string(hits[i])+" times");
+        }
+    }
+}
+
+void test_vector_overloads() {
+    xd::thread_pool pool(3);
+    const auto policy = xd::par.on(pool);
+
+    xd::vector<uint32_t> list;
+    list.assign(policy, 10001, 7);
+    assert(list.size() == 10001 && xd::count(list, 7u) == 10001, "Parallel assign gave the wrong contents");
+    list.resize(policy, 20000);
+    assert(list.size() == 20000 && list[10000] == 7 && list[10001] == 0 && list[19999] == 0,
+            "Parallel resize didn't value initialise");
+    list.resize(policy, 30000, 3);
+    assert(list[20000] == 3 && list[29999] == 3, "Parallel resize didn't fill");
+    list.resize(policy, 5);
+    assert(list.size() == 5, "Parallel resize didn't shrink");
+
+    xd::vector<std::string> names;
+    names.resize(policy, 100, "name");
+    xd::vector<std::string> copy(policy, names);
+    assert(copy == names, "Parallel copy didn't match");
+
+    xd::vector<uint64_t> values;
+    values.resize(policy, 100000);
+    xd::fill(policy, values, uint64_t(2));
+    xd::vector<double> halves;
+    xd::transform(policy, values, halves, [](uint64_t x) { return x*0.5; });
+    assert(halves.size() == values.size() && halves[99999] == 1.0, "Parallel transform gave the wrong values");
+    xd::transform(policy, values, values, [](uint64_t x) { return x*3; });
+    assert(values[0] == 6 && values[99999] == 6, "In place transform failed");
+    assert(xd::reduce(policy, values) == 600000, "Parallel reduce gave the wrong sum");
+    assert(xd::reduce(xd::seq, values) == 600000, "Sequential reduce gave the wrong sum");
+
+    xd::vector<std::string> words = {"a", "b", "c", "d", "e", "f", "g"};
+    const std::string joined = xd::reduce(policy, words, std::string(">"), [](std::string acc, const std::string& s) {
+        return acc + s;
+    });
+    assert(joined == ">abcdefg", "Reduce didn't keep the order, got "+joined);
+    xd::vector<int> empty;
+    assert(xd::reduce(policy, empty, 5, [](int a, int b) { return a + b; }) == 5, "Reducing nothing didn't return init");
+
+    xd::vector<int> small;
+    small.assign(xd::par_auto, 10, 1);
+    assert(small.size() == 10 && xd::reduce(xd::par_auto, small) == 10, "par_auto gave the wrong result");
+}
+
+int main() {
+    test_pool();
+    test_back_to_back_jobs();
+    test_vector_overloads();
+    std::cout<<"Test passed"<<std::endl;
+    return 0;
+}
@@ -0,0 +1,215 @@
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "persistent_vector.hpp"
+
+
+void assert(bool condition, const std::string& message) {
+    if(!condition) {
+        std::cout<<message<<std::endl;
+        exit(-1);
+    }
+}
+
+// Past 32*32*32 so the root has to grow twice
+const size_t big = 40000;
+
+void test_push_back() {
+    xd::persistent_vector<size_t> list;
+    xd::vector<xd::persistent_vector<size_t>> versions;
+    for(size_t i=0; i<big; i++) {
+        if(i % 997 == 0 || i == 32 || i == 33 || i == 1056 || i == 32800) {
+            versions.push_back(list);
+        }
+        list = list.push_back(i);
+    }
+    assert(list.size() == big && list.back() == big - 1, "Pushing didn't grow the vector");
+    for(size_t i=0; i<big; i++) {
+        if(list[i] != i) {
+            assert(false, "Index "+std::to_string(i)+" holds "+std::to_string(list[i]));
+        }
+    }
+    for(const auto& version: versions) {
+        for(size_t i=0; i<version.size(); i++) {
+            if(version[i] != i) {
+                assert(false, "Older version changed at "+std::to_string(i));
+            }
+        }
+    }
+    size_t expected = 0;
+    for(size_t x: list) {
+        assert(x == expected++, "Iteration out of order");
+    }
+    assert(expected == big && list.end() - list.begin() == big, "Iteration missed elements");
+
+    xd::persistent_vector<size_t> moved;
+    for(size_t i=0; i<big; i++) {
+        moved = std::move(moved).push_back(i);
+    }
+    assert(moved == list, "Pushing onto rvalues gave a different vector");
+}
+
+void test_reverse_iteration() {
+    const xd::persistent_vector<int> small = {1, 2, 3, 4, 5};
+    auto last = small.end();
+    --last;
+    assert(*last == 5 && *(last--) == 5 && *last == 4, "Stepping back from end() failed");
+    for(size_t n: {size_t(5), size_t(32), size_t(33), size_t(1000), big}) {
+        xd::persistent_vector<size_t> list;
+        for(size_t i=0; i<n; i++) {
+            list = std::move(list).push_back(i);
+        }
+        size_t expected = n;
+        for(auto it = std::make_reverse_iterator(list.end()); it != std::make_reverse_iterator(list.begin()); ++it) {
+            if(*it != --expected) {
+                assert(false, "Reverse iteration over "+std::to_string(n)+" elements is wrong");
+            }
+        }
+        assert(expected == 0, "Reverse iteration missed elements");
+    }
+}
+
+void test_set() {
+    xd::persistent_vector<std::string> list = {"a", "b", "c"};
+    auto changed = list.set(1, "x");
+    assert(list[1] == "b" && changed[1] == "x" && changed[0] == "a", "Set changed the old version");
+
+    xd::persistent_vector<int> ints;
+    for(int i=0; i<5000; i++) {
+        ints = std::move(ints).push_back(i);
+    }
+    auto first = ints.set(0, -1);
+    auto last = first.set(4999, -2);
+    assert(ints[0] == 0 && ints[4999] == 4999, "Set changed the original");
+    assert(first[0] == -1 && first[4999] == 4999, "Set in the tree failed");
+    assert(last[0] == -1 && last[4999] == -2 && last[2500] == 2500, "Set in the tail failed");
+    bool threw = false;
+    try {
+        ints.set(5000, 0);
+    } catch(const std::out_of_range&) {
+        threw = true;
+    }
+    assert(threw, "Set out of range didn't throw");
+}
+
+void test_pop_back() {
+    xd::vector<std::string> source;
+    for(size_t i=0; i<2100; i++) {
+        source.push_back(std::to_string(i));
+    }
+    const xd::persistent_vector<std::string> full(source);
+    xd::persistent_vector<std::string> list = full;
+    while(!list.empty()) {
+        const size_t n = list.size();
+        auto shorter = list.pop_back();
+        assert(shorter.size() == n - 1 && list.size() == n, "pop_back changed the old version");
+        if(!shorter.empty() && shorter.back() != source[n - 2]) {
+            assert(false, "pop_back left "+shorter.back()+" at the end");
+        }
+        list = shorter;
+    }
+    assert(full.size() == 2100 && full.back() == "2099" && full[1024] == "1024", "Popping changed the first version");
+    assert(list.pop_back().empty(), "Popping an empty vector failed");
+
+    auto builder = full.transient();
+    for(size_t i=0; i<2090; i++) {
+        builder.pop_back();
+    }
+    assert(builder.size() == 10 && builder.back() == "9", "Transient pop_back failed");
+    builder.push_back("x");
+    assert(builder[10] == "x" && full[10] == "10", "Transient changed the vector it came from");
+}
+
+void test_transient() {
+    xd::transient_vector<std::string> builder;
+    for(size_t i=0; i<3000; i++) {
+        builder.push_back(std::to_string(i));
+    }
+    auto snapshot = builder.persistent();
+    builder.set(0, "changed");
+    builder.set(2999, "changed");
+    builder.emplace_back(3, 'z');
+    assert(snapshot.size() == 3000 && snapshot[0] == "0" && snapshot[2999] == "2999",
+           "Editing the transient changed its snapshot");
+    assert(builder.size() == 3001 && builder[0] == "changed" && builder.back() == "zzz", "Transient edits failed");
+
+    auto again = std::move(builder).persistent();
+    auto edited = again.transient();
+    edited.set(1500, "y");
+    assert(again[1500] == "1500" && edited[1500] == "y", "Transient from a persistent vector shared an edit");
+    bool threw = false;
+    try {
+        again.at(3001);
+    } catch(const std::out_of_range&) {
+        threw = true;
+    }
+    assert(threw, "at() out of range didn't throw");
+}
+
+void test_vector_conversion() {
+    const size_t sizes[] = {0, 1, 32, 33, 1024, 1056, 1057, big};
+    for(size_t n: sizes) {
+        xd::vector<int> source;
+        for(size_t i=0; i<n; i++) {
+            source.push_back(i*3);
+        }
+        xd::persistent_vector<int> list(source);
+        assert(list.size() == n, "Converted vector has the wrong size");
+        auto back = list.to_vector();
+        assert(back == source, "Round trip through a vector of "+std::to_string(n)+" failed");
+        list = list.push_back(-1);
+        assert(list.back() == -1 && list.size() == n + 1, "Pushing onto a converted vector failed");
+    }
+    xd::vector<std::string> strings = {"a", "b", "c"};
+    xd::persistent_vector<std::string> moved(std::move(strings));
+    assert(strings.empty() && moved.size() == 3 && moved[2] == "c", "Converting from an rvalue vector failed");
+}
+
+void test_snapshots_across_threads() {
+    xd::persistent_vector<size_t> list;
+    xd::vector<xd::persistent_vector<size_t>> snapshots;
+    for(size_t i=0; i<4; i++) {
+        for(size_t j=0; j<1000; j++) {
+            list = list.push_back(list.size());
+        }
+        snapshots.push_back(list);
+    }
+    bool ok[4] = {false, false, false, false};
+    xd::vector<std::thread> readers;
+    for(size_t t=0; t<4; t++) {
+        // Each reader drops its copy on its own thread
+        readers.push_back(std::thread([&ok, t, snapshot = snapshots[t]]() {
+            size_t expected = 0;
+            for(size_t x: snapshot) {
+                if(x != expected++) {
+                    return;
+                }
+            }
+            ok[t] = expected == (t + 1)*1000;
+        }));
+    }
+    for(size_t i=0; i<list.size(); i++) {
+        list = list.set(i, 0);
+    }
+    snapshots.clear();
+    for(auto& reader: readers) {
+        reader.join();
+    }
+    for(bool reader_ok: ok) {
+        assert(reader_ok, "A reader saw its snapshot change");
+    }
+}
+
+int main() {
+    test_push_back();
+    test_reverse_iteration();
+    test_set();
+    test_pop_back();
+    test_transient();
+    test_vector_conversion();
+    test_snapshots_across_threads();
+    std::cout<<"Test passed"<<std::endl;
+    return 0;
+}
@@ -0,0 +1,147 @@
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "serialize.hpp"
+#include "vector.hpp"
+
+
+void assert(bool condition, const std::string& message) {
+    if(!condition) {
+        std::cout<<message<<std::endl;
+        exit(-1);
+    }
+}
+
+struct sample {
+    double time;
+    int32_t value;
+};
+
+void test_round_trip() {
+    xd::vector<sample> list;
+    for(int i=0; i<1000; i++) {
+        list.push_back(sample{i*0.5, i});
+    }
+    std::stringstream stream;
+    xd::serialize(stream, list);
+    auto copy = xd::deserialize<xd::vector<sample>>(stream);
+    assert(copy.size() == list.size(), "Round trip changed the size");
+    for(size_t i=0; i<copy.size(); i++) {
+        assert(copy[i].time == list[i].time && copy[i].value == list[i].value,
+                "Round trip changed element "+std::to_string(i));
+    }
+
+    xd::vector<int> empty;
+    std::stringstream empty_stream;
+    xd::serialize(empty_stream, empty);
+    xd::vector<int> target = {1, 2, 3};
+    xd::deserialize(empty_stream, target);
+    assert(target.empty(), "Deserializing an empty vector didn't clear the target");
+}
+
+void test_nested() {
+    xd::vector<xd::vector<uint16_t>> table;
+    for(uint16_t i=0; i<20; i++) {
+        table.emplace_back(i, i);
+    }
+    std::stringstream stream;
+    xd::serialize(stream, table);
+    auto copy = xd::deserialize<xd::vector<xd::vector<uint16_t>>>(stream);
+    assert(copy == table, "Nested round trip didn't match");
+
+    stream.clear();
+    stream.seekg(0);
+    bool threw = false;
+    try {
+        xd::deserialize<xd::vector<uint16_t>>(stream);
+    } catch(std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw, "Reading nested data as flat didn't throw");
+}
+
+void test_errors() {
+    xd::vector<int32_t> list = {1, 2, 3, 4};
+    std::stringstream stream;
+    xd::serialize(stream, list);
+    const std::string bytes = stream.str();
+
+    auto throws = [](const std::string& data) {
+        std::stringstream in(data);
+        try {
+            xd::deserialize<xd::vector<int32_t>>(in);
+        } catch(std::runtime_error&) {
+            return true;
+        }
+        return false;
+    };
+    assert(throws(bytes.substr(0, bytes.size()-1)), "Truncated payload didn't throw");
+    assert(throws("XDVT"+bytes.substr(4)), "Bad magic didn't throw");
+    std::string wrong_version = bytes;
+    wrong_version[4] = 9;
+    assert(throws(wrong_version), "Unknown version didn't throw");
+    std::string wrong_endian = bytes;
+    wrong_endian[5] = wrong_endian[5] == 1 ? 2 : 1;
+    assert(throws(wrong_endian), "Foreign byte order didn't throw");
+    // A corrupt count mustn't allocate before the data turns out to be missing
+    std::string huge_count = bytes;
+    const uint64_t count = uint64_t(1) << 60;
+    huge_count.replace(12, 8, reinterpret_cast<const char*>(&count), 8);
+    assert(throws(huge_count), "Huge count didn't throw");
+
+    std::stringstream in(bytes);
+    bool threw = false;
+    try {
+        xd::deserialize<xd::vector<int64_t>>(in);
+    } catch(std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw, "Reading with a different element size didn't throw");
+}
+
+void test_streaming() {
+    std::stringstream stream;
+    {
+        xd::stream_writer<uint32_t> writer(stream, 64);
+        for(uint32_t i=0; i<1000; i++) {
+            writer.push_back(i);
+        }
+        xd::vector<uint32_t> block(100, 7);
+        writer.write(block);
+    }
+    const std::string bytes = stream.str();
+
+    std::stringstream whole(bytes);
+    auto list = xd::deserialize<xd::vector<uint32_t>>(whole);
+    assert(list.size() == 1100, "Streamed data read back with the wrong size");
+    assert(list[999] == 999 && list[1000] == 7, "Streamed data read back wrong");
+
+    std::stringstream chunked(bytes);
+    xd::stream_reader<uint32_t> reader(chunked);
+    xd::vector<uint32_t> out;
+    size_t chunks = 0;
+    while(reader.read_chunk(out) != 0) {
+        chunks++;
+    }
+    assert(reader.done() && chunks == 17, "Expected 17 chunks got "+std::to_string(chunks));
+    assert(out == list, "Chunked read didn't match bulk read");
+
+    std::stringstream plain;
+    xd::serialize(plain, list);
+    xd::stream_reader<uint32_t> plain_reader(plain);
+    xd::vector<uint32_t> plain_out;
+    assert(plain_reader.read_chunk(plain_out) == 1100, "serialize output isn't a single chunk");
+    assert(plain_reader.read_chunk(plain_out) == 0 && plain_reader.done(), "Reader didn't stop after the payload");
+}
+
+int main() {
+    test_round_trip();
+    test_nested();
+    test_errors();
+    test_streaming();
+    std::cout<<"Test passed"<<std::endl;
+    return 0;
+}
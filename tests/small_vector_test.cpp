@@ -0,0 +1,120 @@
+#include <deque>
+#include <iostream>
+#include <string>
+
+#include "small_vector.hpp"
+
+
+void assert(bool condition, const std::string& message) {
+    if(!condition) {
+        std::cout<<message<<std::endl;
+        exit(-1);
+    }
+}
+
+void test_inline() {
+    xd::small_vector<int, 4> list;
+    assert(list.is_inline() && list.capacity() == 4, "Empty small_vector isn't inline");
+    for(int i=0; i<4; i++) {
+        list.push_back(i);
+    }
+    assert(list.is_inline(), "small_vector spilled before reaching N");
+    list.push_back(4);
+    assert(!list.is_inline() && list.capacity() == 8, "small_vector didn't spill past N");
+    for(int i=0; i<5; i++) {
+        assert(list[i] == i, "Spilling lost element "+std::to_string(i));
+    }
+    list.pop_back();
+    list.shrink_to_fit();
+    assert(list.is_inline() && list.size() == 4, "shrink_to_fit didn't move back inline");
+    assert(list.back() == 3, "shrink_to_fit lost data");
+}
+
+void test_insert_erase() {
+    xd::small_vector<std::string, 3> list = {"a", "d"};
+    list.insert(list.begin()+1, {"b", "c"});
+    list.emplace(list.end(), 2, 'e');
+    const char* expected[] = {"a", "b", "c", "d", "ee"};
+    for(int i=0; i<5; i++) {
+        assert(list[i] == expected[i], "Insert gave "+list[i]+" expected "+expected[i]);
+    }
+    list.insert(list.begin(), 2, list[4]);
+    assert(list.front() == "ee" && list.size() == 7, "Inserting own element failed");
+    list.erase(list.begin(), list.begin()+3);
+    assert(list.front() == "b" && list.size() == 4, "Range erase failed");
+    list.erase(list.begin());
+    assert(list.front() == "c" && list.size() == 3, "Erase failed");
+    std::deque<std::string> source = {"x", "y"};
+    list.insert(list.begin()+1, source.begin(), source.end());
+    assert(list[1] == "x" && list[2] == "y" && list[3] == "d", "Range insert from deque failed");
+}
+
+void test_copy_move() {
+    xd::small_vector<std::string, 2> small = {"x"};
+    xd::small_vector<std::string, 2> large = {"a", "b", "c"};
+
+    xd::small_vector<std::string, 2> copy(large);
+    assert(copy == large, "Copy doesn't match");
+    xd::small_vector<std::string, 2> moved(std::move(copy));
+    assert(moved == large && copy.empty() && copy.is_inline(), "Moving a heap small_vector failed");
+    xd::small_vector<std::string, 2> moved_inline(std::move(small));
+    assert(moved_inline.size() == 1 && moved_inline[0] == "x", "Moving an inline small_vector failed");
+
+    moved_inline.swap(moved);
+    assert(moved.size() == 1 && moved[0] == "x", "Swap didn't move inline elements");
+    assert(moved_inline == large, "Swap didn't move heap elements");
+
+    moved = moved_inline;
+    assert(moved == moved_inline, "Copy assignment failed");
+
+    struct throwing_move {
+        throwing_move() = default;
+        throwing_move(const throwing_move&) = default;
+        throwing_move(throwing_move&&) noexcept(false) {}
+    };
+    static_assert(std::is_nothrow_move_constructible<xd::small_vector<std::string, 2>>::value &&
+            std::is_nothrow_move_assignable<xd::small_vector<std::string, 2>>::value,
+            "Moving a small_vector of strings shouldn't throw");
+    static_assert(!std::is_nothrow_move_constructible<xd::small_vector<throwing_move, 2>>::value &&
+            !std::is_nothrow_move_assignable<xd::small_vector<throwing_move, 2>>::value,
+            "Moving inline elements that can throw was marked noexcept");
+}
+
+void test_growth() {
+    xd::small_vector<int, 4> doubling;
+    xd::small_vector<int, 4, std::allocator<int>, xd::one_and_a_half_growth> slow;
+    for(int i=0; i<5; i++) {
+        doubling.push_back(i);
+        slow.push_back(i);
+    }
+    assert(doubling.capacity() == 8, "Default growth didn't double");
+    assert(slow.capacity() == 6, "Growth policy wasn't used, capacity "+std::to_string(slow.capacity()));
+    slow.insert(slow.begin(), {7, 8});
+    assert(slow.capacity() == 9 && slow[0] == 7 && slow[6] == 4, "Insert didn't use the growth policy");
+}
+
+void test_comparisons() {
+    xd::small_vector<uint32_t, 2> one = {0,1,2,3};
+    xd::small_vector<uint32_t, 2> two = {0,1,2,3};
+
+    assert(one == two, "Vector == failed");
+    assert(one >= two, "Vector >= failed on equal vectors");
+    assert(one <= two, "Vector <= failed on equal vectors");
+
+    one.push_back(4);
+    assert(one != two, "Vector != failed");
+    assert(one > two, "vector > failed");
+    assert(two < one, "vector < failed");
+    assert(one >= two, "vector >= failed on different vectors");
+    assert(two <= one, "vector <= failed on different vectors");
+}
+
+int main() {
+    test_inline();
+    test_insert_erase();
+    test_copy_move();
+    test_growth();
+    test_comparisons();
+    std::cout<<"Test passed"<<std::endl;
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+#include <string>
+
+#include "soa_vector.hpp"
+
+
+void assert(bool condition, const std::string& message) {
+    if(!condition) {
+        std::cout<<message<<std::endl;
+        exit(-1);
+    }
+}
+
+void test_columns() {
+    xd::soa_vector<float, int, char> list;
+    for(int i=0; i<100; i++) {
+        list.push_back(i*0.5f, i, char('a' + i%26));
+    }
+    assert(list.size() == 100 && list.capacity() == 128, "push_back gave the wrong size");
+    auto ids = list.column<1>();
+    assert(ids.size() == 100 && std::accumulate(ids.begin(), ids.end(), 0) == 4950, "Column span is wrong");
+    assert(reinterpret_cast<uintptr_t>(list.data<0>()) % 64 == 0 &&
+           reinterpret_cast<uintptr_t>(list.data<1>()) % 64 == 0 &&
+           reinterpret_cast<uintptr_t>(list.data<2>()) % 64 == 0, "Columns aren't cache line aligned");
+    for(auto& x: list.column<0>()) {
+        x *= 2;
+    }
+    auto [x, id, c] = list[10];
+    assert(x == 10.0f && id == 10 && c == 'k', "Structured binding gave the wrong row");
+    id = -10;
+    assert(list.column<1>()[10] == -10, "Row proxy didn't write through");
+    list.pop_back();
+    list.resize(120);
+    assert(list.size() == 120 && xd::get<1>(list[119]) == 0 && xd::get<2>(list[99]) == 0, "resize didn't value initialise");
+    list.shrink_to_fit();
+    assert(list.capacity() == 120 && xd::get<1>(list[98]) == 98, "shrink_to_fit lost data");
+}
+
+void test_rows() {
+    xd::soa_vector<int, std::string> list = {{3, "c"}, {1, "a"}, {2, "b"}};
+    std::sort(list.begin(), list.end());
+    assert(xd::get<1>(list[0]) == "a" && xd::get<1>(list[2]) == "c", "Sorting rows failed");
+    auto it = std::find_if(list.begin(), list.end(), [](const auto& row) { return xd::get<0>(row) == 2; });
+    assert(it - list.begin() == 1, "find_if over rows failed");
+    list[0] = list[2];
+    assert(list[0] == list[2] && xd::get<1>(list[0]) == "c", "Row assignment didn't copy the elements");
+    std::tuple<int, std::string> copy = list[1];
+    xd::get<1>(list[1]) = "changed";
+    assert(std::get<1>(copy) == "b", "Converting a row didn't copy it");
+    list.emplace_back(4, "xxx");
+    assert(list.back() == std::make_tuple(4, std::string("xxx")), "emplace_back didn't construct in place");
+    for(int i=0; i<10; i++) {
+        list.push_back(list[0]);
+    }
+    assert(xd::get<1>(list.back()) == "c", "push_back of an element across growth failed");
+
+    xd::soa_vector<int, std::string> other(list);
+    assert(other == list, "Copy doesn't compare equal");
+    xd::soa_vector<int, std::string> moved(std::move(other));
+    assert(moved == list && other.empty(), "Move didn't take the columns");
+    const auto& const_list = list;
+    size_t count = 0;
+    for(auto row: const_list) {
+        count += xd::get<1>(row).size();
+    }
+    assert(count == 1 + 7 + 1 + 3 + 10, "Const iteration gave the wrong rows");
+    list.clear();
+    assert(list.empty() && list.capacity() != 0, "clear released storage");
+}
+
+int main() {
+    test_columns();
+    test_rows();
+    std::cout<<"Test passed"<<std::endl;
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <type_traits>
+
+#include "arena.hpp"
+#include "stable_vector.hpp"
+
+
+void assert(bool condition, const std::string& message) {
+    if(!condition) {
+        std::cout<<message<<std::endl;
+        exit(-1);
+    }
+}
+
+void test_stability() {
+    xd::stable_vector<std::string, 4> list;
+    list.push_back("zero");
+    std::string* first = &list[0];
+    auto it = list.begin();
+    for(int i=1; i<100; i++) {
+        list.push_back(std::to_string(i));
+    }
+    assert(first == &list[0] && *it == "zero", "push_back moved an element");
+    assert(list.capacity() == 100, "Capacity should be whole chunks");
+    it += 50;
+    assert(*it == "50" && it - list.begin() == 50, "Random access iterator is wrong");
+    for(int i=0; i<7; i++) {
+        ++it;
+    }
+    --it;
+    assert(*it == "56" && &*it == &list[56], "Iterator didn't cross chunks correctly");
+    list.emplace_back(list[3]);
+    assert(list.back() == "3", "emplace_back from an element failed");
+    size_t count = 0;
+    for(const auto& s: list) {
+        assert(s == (count == 100 ? "3" : count == 0 ? "zero" : std::to_string(count)), "Iteration gave "+s);
+        count++;
+    }
+    assert(count == list.size(), "Iteration didn't visit every element");
+    xd::stable_vector<std::string, 4>::const_iterator cit = list.begin();
+    assert(std::find(cit, list.cend(), "42") - cit == 42, "find over const iterators failed");
+}
+
+void test_release() {
+    xd::stable_vector<int, 8> list;
+    for(int i=0; i<64; i++) {
+        list.push_back(i);
+    }
+    assert(list.capacity() == 64, "Expected 8 chunks");
+    for(int i=0; i<32; i++) {
+        list.pop_back();
+    }
+    assert(list.size() == 32 && list.capacity() == 40, "pop_back should keep one spare chunk");
+    list.push_back(32);
+    list.pop_back();
+    assert(list.capacity() == 40, "Push/pop at a boundary changed capacity");
+    list.shrink_to_fit();
+    assert(list.capacity() == 32 && list.back() == 31, "shrink_to_fit didn't release the spare chunk");
+    list.resize(3);
+    list.shrink_to_fit();
+    assert(list.capacity() == 8 && list.size() == 3, "shrink_to_fit after resize kept too much");
+    list.clear();
+    list.shrink_to_fit();
+    assert(list.capacity() == 0, "shrink_to_fit on an empty vector kept a chunk");
+}
+
+void test_copy_move() {
+    xd::stable_vector<std::string, 2> a = {"a", "b", "c", "d", "e"};
+    xd::stable_vector<std::string, 2> b(a);
+    assert(a == b, "Copy doesn't compare equal");
+    b.back() = "f";
+    assert(a != b && a < b, "Comparison operators are wrong");
+    const std::string* addr = &b[1];
+    xd::stable_vector<std::string, 2> c(std::move(b));
+    assert(&c[1] == addr && b.empty(), "Move constructor didn't steal the chunks");
+    a = c;
+    assert(a == c, "Copy assignment failed");
+    a = std::move(c);
+    assert(a.size() == 5 && a[4] == "f" && c.empty(), "Move assignment failed");
+    xd::stable_vector<int, 16> filled(40, 9);
+    assert(filled.size() == 40 && filled[39] == 9, "Fill constructor failed");
+
+    xd::arena arena;
+    xd::stable_vector<int, 16, xd::arena_allocator<int>> on_arena(arena);
+    for(int i=0; i<100; i++) {
+        on_arena.push_back(i);
+    }
+    assert(on_arena[99] == 99 && arena.bytes_used() > 0, "Chunks didn't come from the arena");
+
+    // Different arenas can't share chunks so this has to allocate
+    xd::arena other_arena;
+    xd::stable_vector<int, 16, xd::arena_allocator<int>> other(other_arena);
+    other = std::move(on_arena);
+    assert(other.size() == 100 && other[99] == 99 && on_arena.empty(), "Move between arenas failed");
+    assert(other_arena.bytes_used() > 0, "Moved elements didn't go to the destination arena");
+    static_assert(!std::is_nothrow_move_assignable<xd::stable_vector<int, 16, xd::arena_allocator<int>>>::value,
+            "Move assigning across arenas can allocate");
+    static_assert(std::is_nothrow_move_assignable<xd::stable_vector<std::string>>::value,
+            "Move assigning with std::allocator can't throw");
+}
+
+int main() {
+    test_stability();
+    test_release();
+    test_copy_move();
+    std::cout<<"Test passed"<<std::endl;
+    return 0;
+}
@@ -0,0 +1,130 @@
+#include <deque>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "static_vector.hpp"
+
+
+void assert(bool condition, const std::string& message) {
+    if(!condition) {
+        std::cout<<message<<std::endl;
+        exit(-1);
+    }
+}
+
+static_assert(std::is_trivially_copyable<xd::static_vector<int, 8>>::value,
+              "static_vector of a trivially copyable type isn't trivially copyable");
+static_assert(!std::is_trivially_copyable<xd::static_vector<std::string, 8>>::value,
+              "static_vector of strings claims to be trivially copyable");
+static_assert(sizeof(xd::static_vector<uint32_t, 15>) == 64, "static_vector<uint32_t, 15> isn't one cache line");
+static_assert(sizeof(xd::static_vector<char, 63>) == 64, "static_vector<char, 63> isn't one cache line");
+static_assert(std::is_same<xd::static_vector<char, 255>::size_type, uint8_t>::value, "Size type isn't the smallest that fits");
+static_assert(std::is_same<xd::static_vector<char, 256>::size_type, uint16_t>::value, "Size type is too small for N");
+
+void test_capacity() {
+    xd::static_vector<int, 4> list;
+    assert(list.empty() && list.capacity() == 4, "Empty static_vector is wrong");
+    for(int i=0; i<4; i++) {
+        list.push_back(i);
+    }
+    assert(list.full() && list.back() == 3, "static_vector didn't fill to N");
+    bool threw = false;
+    try {
+        list.push_back(4);
+    } catch(const std::length_error&) {
+        threw = true;
+    }
+    assert(threw && list.size() == 4, "Pushing past N didn't throw");
+    assert(!list.try_push_back(4) && list.try_emplace_back(5) == nullptr, "try_push_back succeeded when full");
+    list.pop_back();
+    assert(list.try_push_back(9) && list.back() == 9, "try_push_back failed with room left");
+
+    threw = false;
+    try {
+        list.insert(list.begin(), 2, 7);
+    } catch(const std::length_error&) {
+        threw = true;
+    }
+    assert(threw && list[0] == 0 && list.size() == 4, "Overflowing insert changed the vector");
+    threw = false;
+    try {
+        list.resize(5);
+    } catch(const std::length_error&) {
+        threw = true;
+    }
+    assert(threw && list.size() == 4, "Resizing past N didn't throw");
+    list.resize(2);
+    assert(list.size() == 2 && list[1] == 1, "Shrinking resize failed");
+}
+
+void test_insert_erase() {
+    xd::static_vector<std::string, 8> list = {"a", "d"};
+    list.insert(list.begin()+1, {"b", "c"});
+    list.emplace(list.end(), 2, 'e');
+    const char* expected[] = {"a", "b", "c", "d", "ee"};
+    for(int i=0; i<5; i++) {
+        assert(list[i] == expected[i], "Insert gave "+list[i]+" expected "+expected[i]);
+    }
+    list.insert(list.begin(), 2, list[4]);
+    assert(list.front() == "ee" && list.size() == 7, "Inserting own element failed");
+    list.erase(list.begin(), list.begin()+3);
+    assert(list.front() == "b" && list.size() == 4, "Range erase failed");
+    list.erase(list.begin());
+    assert(list.front() == "c" && list.size() == 3, "Erase failed");
+    std::deque<std::string> source = {"x", "y"};
+    list.insert(list.begin()+1, source.begin(), source.end());
+    assert(list[1] == "x" && list[2] == "y" && list[3] == "d", "Range insert from deque failed");
+    list.insert(list.begin(), list.begin(), list.begin()+2);
+    assert(list.size() == 7 && list[0] == "c" && list[1] == "x" && list[2] == "c", "Inserting own range failed");
+    assert(xd::erase(list, "c") == 2 && list.front() == "x", "Erase by value failed");
+    list.erase_unordered(list.begin());
+    assert(list.size() == 4 && list.front() == "ee", "erase_unordered failed");
+    const size_t indices[] = {1, 3};
+    assert(list.erase_indices(indices) == 2 && list.size() == 2 && list[1] == "y", "erase_indices failed");
+    try {
+        const size_t descending[] = {1, 0};
+        list.erase_indices(descending);
+        assert(false, "erase_indices accepted descending indices");
+    } catch(const std::invalid_argument&) {
+    }
+    assert(list.size() == 2, "Rejected erase_indices changed the vector");
+}
+
+void test_copy_move() {
+    xd::static_vector<std::string, 4> list = {"a", "b", "c"};
+    xd::static_vector<std::string, 4> copy(list);
+    assert(copy == list, "Copy doesn't match");
+    xd::static_vector<std::string, 4> moved(std::move(copy));
+    assert(moved == list && copy.empty(), "Move didn't take the elements");
+    xd::static_vector<std::string, 4> shorter = {"x"};
+    shorter = list;
+    assert(shorter == list, "Copy assigning a longer vector failed");
+    list = xd::static_vector<std::string, 4>{"y"};
+    assert(list.size() == 1 && list[0] == "y", "Copy assigning a shorter vector failed");
+    list.swap(shorter);
+    assert(shorter.size() == 1 && list.size() == 3 && list[2] == "c" && shorter[0] == "y", "Swap failed");
+
+    xd::static_vector<int, 8> ints(5, 3);
+    xd::static_vector<int, 8> int_copy = ints;
+    int_copy[0] = 1;
+    assert(ints[0] == 3 && int_copy.size() == 5 && int_copy[4] == 3, "Trivial copy failed");
+}
+
+void test_comparisons() {
+    xd::static_vector<uint32_t, 8> one = {0, 1, 2, 3};
+    xd::static_vector<uint32_t, 8> two = {0, 1, 2, 3};
+    assert(one == two && one <= two && one >= two, "Equal vectors don't compare equal");
+    one.push_back(4);
+    assert(one != two && two < one && one > two, "Different vectors compare wrongly");
+}
+
+int main() {
+    test_capacity();
+    test_insert_erase();
+    test_copy_move();
+    test_comparisons();
+    std::cout<<"Test passed"<<std::endl;
+    return 0;
+}
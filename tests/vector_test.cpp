@@ -1,6 +1,13 @@
+#include <deque>
 #include <iostream>
+#include <list>
+#include <memory>
+#include <sstream>
 #include <string>
 
+#include "aligned_allocator.hpp"
+#include "arena.hpp"
+#include "realloc_allocator.hpp"
 #include "vector.hpp"
 
 
@@ -43,10 +50,74 @@ void check_dtors() {
     count_dtors::reset();
     list.reserve(10);
     list.clear();
-    // Here as capacity is 2 and goes to 10 we should have created 8 more elements
-    // and the clear shouldn't change capacity so it should show creating 8 and
-    // not destroying any
-    assert(count_dtors::count == 8, "Reserved space inconsistent! "+ std::to_string(count_dtors::count));
+    // Reserved capacity is uninitialised so growing from 2 to 10 shouldn't
+    // construct anything
+    assert(count_dtors::count == 0, "Reserved space inconsistent! "+ std::to_string(count_dtors::count));
+    for(int i=0; i<20; i++) {
+        list.emplace_back();
+    }
+    list.erase(list.begin()+3, list.begin()+8);
+    list.insert(list.begin()+1, 4, count_dtors());
+    assert(count_dtors::count == (int32_t)list.size(), "Live objects don't match size "+ std::to_string(count_dtors::count));
+    list.clear();
+    assert(count_dtors::count == 0, "Leaked object after relocation! "+ std::to_string(count_dtors::count));
+}
+
+// Holds a pointer to its own member so memcpy'ing it would be wrong
+struct self_ref {
+    int value;
+    int* self;
+    self_ref(int v): value(v), self(&value) {}
+    self_ref(const self_ref& other): value(other.value), self(&value) {}
+    self_ref& operator=(const self_ref& other) {
+        value = other.value;
+        return *this;
+    }
+    bool valid() const {
+        return self == &value;
+    }
+};
+
+struct opt_in_relocatable {
+    std::unique_ptr<int> value;
+};
+
+namespace xd {
+    template<>
+    struct is_trivially_relocatable<opt_in_relocatable>: std::true_type {};
+}
+
+void test_relocation() {
+    xd::vector<self_ref> refs;
+    for(int i=0; i<50; i++) {
+        refs.insert(refs.begin() + i/2, self_ref(i));
+    }
+    refs.erase(refs.begin() + 10);
+    refs.erase(refs.begin() + 5, refs.begin() + 20);
+    refs.shrink_to_fit();
+    for(const auto& r: refs) {
+        assert(r.valid(), "Non trivially relocatable type was memcpy'd");
+    }
+
+    xd::vector<std::string> strings;
+    for(int i=0; i<40; i++) {
+        strings.insert(strings.begin(), std::to_string(i));
+    }
+    strings.erase(strings.begin() + 5, strings.begin() + 35);
+    assert(strings.size() == 10, "Range erase has wrong size");
+    assert(strings[4] == "35" && strings[5] == "4", "Range erase in the middle failed");
+    strings.insert(strings.begin() + 2, strings[0]);
+    assert(strings[2] == "39" && strings.size() == 11, "Inserting an element of itself failed");
+
+    xd::vector<opt_in_relocatable> ptrs;
+    static_assert(xd::is_trivially_relocatable_v<opt_in_relocatable>, "Opt in trait ignored");
+    for(int i=0; i<20; i++) {
+        ptrs.push_back(opt_in_relocatable{std::make_unique<int>(i)});
+    }
+    ptrs.erase(ptrs.begin());
+    for(int i=0; i<19; i++) {
+        assert(*ptrs[i].value == i+1, "Opt in relocatable type corrupted");
+    }
 }
 
 void test_emplace_back() {
@@ -97,6 +168,359 @@ void test_comparisons() {
     assert(two <= one, "vector <= failed on different vectors");
 }
 
+void test_allocator() {
+    xd::arena arena;
+    {
+        xd::vector<uint32_t, xd::arena_allocator<uint32_t>> list(arena);
+        for(uint32_t i=0; i<100; i++) {
+            list.push_back(i);
+        }
+        for(uint32_t i=0; i<100; i++) {
+            assert(list[i]==i, "Arena backed vector has wrong value at "+std::to_string(i));
+        }
+        assert(arena.bytes_used() >= 100*sizeof(uint32_t), "Vector didn't allocate from arena");
+
+        xd::vector<uint32_t, xd::arena_allocator<uint32_t>> copy(list);
+        assert(copy == list, "Arena backed copy differs");
+        assert(copy.get_allocator() == list.get_allocator(), "Copy isn't using the same arena");
+
+        xd::vector<uint32_t, xd::arena_allocator<uint32_t>> moved(std::move(copy));
+        assert(moved == list && copy.empty(), "Arena backed move failed");
+
+        // Different arenas can't share storage so this has to allocate
+        xd::arena other_arena;
+        xd::vector<uint32_t, xd::arena_allocator<uint32_t>> other(other_arena);
+        other = std::move(moved);
+        assert(other == list && other.get_allocator() != list.get_allocator(), "Move between arenas failed");
+        static_assert(!std::is_nothrow_move_assignable<xd::vector<uint32_t, xd::arena_allocator<uint32_t>>>::value,
+                "Move assigning across arenas can allocate");
+        static_assert(std::is_nothrow_move_assignable<xd::vector<std::string>>::value,
+                "Move assigning with std::allocator can't throw");
+    }
+    arena.reset();
+    assert(arena.bytes_used() == 0, "Arena reset didn't release memory");
+
+    xd::vector<std::string> strings = {"a", "b", "c"};
+    xd::vector<std::string> moved_strings(std::move(strings));
+    assert(strings.empty() && moved_strings.size() == 3, "Move constructor didn't take buffer");
+    assert(moved_strings[2] == "c", "Move constructor lost data");
+}
+
+void test_growth() {
+    xd::vector<int, std::allocator<int>, xd::one_and_a_half_growth> slow;
+    const size_t expected[] = {1, 2, 3, 4, 6, 9, 13, 19};
+    for(size_t i=0; i<19; i++) {
+        slow.push_back(i);
+        assert(slow.capacity() >= slow.size(), "Capacity below size");
+    }
+    assert(slow.capacity() == expected[7], "1.5x growth gave capacity "+std::to_string(slow.capacity()));
+
+    xd::vector<int, std::allocator<int>, xd::chunked_growth<8>> chunked;
+    for(int i=0; i<20; i++) {
+        chunked.push_back(i);
+    }
+    assert(chunked.capacity() == 24, "Chunked growth gave capacity "+std::to_string(chunked.capacity()));
+
+    // Small threshold so the vector crosses from realloc to mremap
+    xd::vector<uint64_t, xd::realloc_allocator<uint64_t, 4096>> big;
+    for(uint64_t i=0; i<100000; i++) {
+        big.push_back(i);
+    }
+    big.insert(big.begin() + 10, 5, 0);
+    big.erase(big.begin() + 10, big.begin() + 15);
+    big.push_back(big[0]);
+    for(uint64_t i=0; i<100000; i++) {
+        assert(big[i] == i, "Reallocated vector lost data at "+std::to_string(i));
+    }
+    big.resize(100);
+    big.shrink_to_fit();
+    assert(big.capacity() == 100 && big[99] == 99, "Shrinking a reallocated vector failed");
+
+    xd::arena arena;
+    xd::vector<int, xd::arena_allocator<int>> in_place(arena);
+    in_place.reserve(4);
+    const int* before = in_place.data();
+    in_place.reserve(64);
+    assert(in_place.data() == before, "Arena didn't extend the last allocation in place");
+}
+
+void test_bounds_check() {
+    xd::vector<int, std::allocator<int>, xd::double_growth, xd::bounds_throw> checked = {1, 2, 3};
+    try {
+        checked[3];
+        assert(false, "Throwing policy didn't check operator[]");
+    } catch(const std::out_of_range& e) {
+    }
+    checked.clear();
+    try {
+        checked.back();
+        assert(false, "Throwing policy didn't check back()");
+    } catch(const std::out_of_range& e) {
+    }
+
+    xd::vector<int, std::allocator<int>, xd::double_growth, xd::bounds_unchecked> unchecked = {1, 2, 3};
+    assert(unchecked[2] == 3 && unchecked.front() == 1 && unchecked.back() == 3, "Unchecked access failed");
+    try {
+        unchecked.at(3);
+        assert(false, "at() must always check");
+    } catch(const std::out_of_range& e) {
+    }
+}
+
+void test_range_insert() {
+    xd::vector<int> list = {0, 1, 8, 9};
+    std::deque<int> middle = {2, 3, 4, 5, 6, 7};
+    list.insert(list.begin()+2, middle.begin(), middle.end());
+    assert(list.size() == 10, "Range insert from deque has wrong size");
+    for(int i=0; i<10; i++) {
+        assert(list[i] == i, "Range insert from deque failed at "+std::to_string(i));
+    }
+
+    // Input iterators can only be walked once
+    std::istringstream stream("10 11 12");
+    list.insert(list.begin(), std::istream_iterator<int>(stream), std::istream_iterator<int>());
+    assert(list.size() == 13 && list[0] == 10 && list[2] == 12 && list[3] == 0, "Input iterator insert failed");
+
+    // Inserting part of itself
+    xd::vector<std::string> strings = {"a", "b", "c"};
+    strings.insert(strings.begin()+1, strings.begin(), strings.end());
+    const char* expected[] = {"a", "a", "b", "c", "b", "c"};
+    for(int i=0; i<6; i++) {
+        assert(strings[i] == expected[i], "Self range insert gave "+strings[i]+" expected "+expected[i]);
+    }
+
+    std::list<std::string> source = {"x", "y"};
+    strings.assign(source.begin(), source.end());
+    assert(strings.size() == 2 && strings[1] == "y", "Assign from list failed");
+    xd::vector<std::string> from_list(source.begin(), source.end());
+    assert(from_list == strings, "Constructing from list failed");
+}
+
+void test_compaction() {
+    xd::vector<int> ints;
+    for(int i=0; i<100; i++) {
+        ints.push_back(i);
+    }
+    size_t removed = xd::erase_if(ints, [](int x) { return x % 3 == 0; });
+    assert(removed == 34 && ints.size() == 66, "erase_if removed "+std::to_string(removed));
+    for(size_t i=0; i<ints.size(); i++) {
+        assert(ints[i] % 3 != 0 && (i == 0 || ints[i] > ints[i-1]), "erase_if broke the order");
+    }
+    assert(xd::erase(ints, 1) == 1 && ints.front() == 2, "erase by value failed");
+
+    xd::vector<std::string> strings = {"a", "b", "c", "d", "e", "f"};
+    xd::erase_if(strings, [](const std::string& x) { return x == "b" || x == "c" || x == "f"; });
+    assert(strings.size() == 3 && strings[0] == "a" && strings[1] == "d" && strings[2] == "e", "erase_if on strings failed");
+
+    strings.erase_unordered(strings.begin());
+    assert(strings.size() == 2 && strings[0] == "e" && strings[1] == "d", "erase_unordered failed");
+    strings.erase_unordered(strings.begin() + 1);
+    assert(strings.size() == 1 && strings[0] == "e", "erase_unordered of the back failed");
+
+    xd::vector<std::string> letters = {"a", "b", "c", "d", "e", "f", "g"};
+    xd::vector<size_t> indices = {0, 2, 2, 3, 6};
+    removed = letters.erase_indices(indices);
+    assert(removed == 4 && letters.size() == 3, "erase_indices removed "+std::to_string(removed));
+    assert(letters[0] == "b" && letters[1] == "e" && letters[2] == "f", "erase_indices kept the wrong elements");
+    try {
+        letters.erase_indices(xd::vector<size_t>{2, 0});
+        assert(false, "erase_indices accepted descending indices");
+    } catch(const std::invalid_argument&) {
+    }
+    try {
+        letters.erase_indices(xd::vector<size_t>{1, 3});
+        assert(false, "erase_indices accepted an index past the end");
+    } catch(const std::out_of_range&) {
+    }
+    assert(letters.size() == 3 && letters[0] == "b" && letters[2] == "f", "Rejected erase_indices changed the vector");
+
+    count_dtors::reset();
+    {
+        xd::vector<count_dtors> counted((size_t)10);
+        xd::erase_if(counted, [](const count_dtors&) { return true; });
+        assert(counted.empty(), "erase_if didn't remove everything");
+        assert(count_dtors::count == 0, "erase_if leaked "+std::to_string(count_dtors::count));
+    }
+}
+
+template<typename T>
+void check_kernels(const std::string& name) {
+    // Long enough to hit full SIMD blocks and a scalar tail
+    for(size_t len : {0, 1, 7, 16, 33, 100}) {
+        xd::vector<T> a;
+        for(size_t i=0; i<len; i++) {
+            a.push_back(static_cast<T>(i % 50));
+        }
+        for(size_t pos=0; pos<len; pos++) {
+            xd::vector<T> b(a);
+            b[pos] = static_cast<T>(b[pos] + 1);
+            assert(a != b && a < b && b > a && a <= b && b >= a, name+" mismatch at "+std::to_string(pos)+" missed");
+            assert(xd::find(b, b[pos]) - b.data() <= (long)pos, name+" find skipped the element");
+        }
+        xd::vector<T> c(a);
+        assert(a == c && a <= c && a >= c && !(a < c), name+" equal vectors compare wrong");
+
+        size_t expected = 0;
+        for(size_t i=0; i<len; i++) {
+            expected += a[i] == static_cast<T>(0);
+        }
+        assert(xd::count(a, static_cast<T>(0)) == expected, name+" count is wrong");
+        assert(xd::contains(a, static_cast<T>(0)) == (expected > 0), name+" contains is wrong");
+        assert(!xd::contains(a, static_cast<T>(100)), name+" found a missing value");
+
+        c.assign(len, static_cast<T>(7));
+        assert(c.size() == len && xd::count(c, static_cast<T>(7)) == len, name+" assign fill failed");
+    }
+}
+
+void test_kernels() {
+    check_kernels<int8_t>("int8_t");
+    check_kernels<uint8_t>("uint8_t");
+    check_kernels<int16_t>("int16_t");
+    check_kernels<int32_t>("int32_t");
+    check_kernels<int64_t>("int64_t");
+    check_kernels<float>("float");
+
+    // Signed order must come from the elements, not memcmp
+    xd::vector<int32_t> negative = {-1};
+    xd::vector<int32_t> positive = {1};
+    assert(negative < positive, "Signed compare used byte order");
+
+#ifdef XD_SIMD_X86
+    unsigned char x[40] = {0};
+    unsigned char y[40] = {0};
+    y[37] = 1;
+    assert(xd::detail::mismatch_bytes_sse2(x, y, 40) == 37, "SSE2 mismatch kernel is wrong");
+    assert(xd::detail::find_sse2<4>(y, 10, &y[36]) == 9, "SSE2 find kernel is wrong");
+#endif
+}
+
+void test_aligned_storage() {
+    xd::aligned_vector<float> floats;
+    for(int i=0; i<1000; i++) {
+        floats.push_back(i);
+        assert(reinterpret_cast<uintptr_t>(floats.data()) % 64 == 0, "aligned_vector storage isn't cache line aligned");
+    }
+    xd::aligned_vector<char, 4096> page;
+    page.resize(10);
+    assert(reinterpret_cast<uintptr_t>(page.data()) % 4096 == 0, "aligned_vector storage isn't page aligned");
+
+    // Threshold low enough that the vector moves onto mapped huge pages
+    xd::huge_page_vector<uint64_t, 1 << 16> big;
+    for(uint64_t i=0; i<(1 << 20); i++) {
+        big.push_back(i);
+    }
+    assert(reinterpret_cast<uintptr_t>(big.data()) % (1 << 21) == 0, "Huge page storage isn't 2MB aligned");
+    for(uint64_t i=0; i<(1 << 20); i++) {
+        assert(big[i] == i, "Huge page vector lost data at "+std::to_string(i));
+    }
+    big.resize(10);
+    big.shrink_to_fit();
+    assert(reinterpret_cast<uintptr_t>(big.data()) % 64 == 0 && big[9] == 9, "Small huge_page_vector isn't aligned");
+}
+
+
+#if XD_CONSTEXPR_CONTAINERS
+constexpr bool constexpr_push_back() {
+    xd::vector<int> vec;
+    for(int i=0; i<100; i++) {
+        vec.push_back(i*i);
+    }
+    int sum = 0;
+    for(int x: vec) {
+        sum += x;
+    }
+    return vec.size() == 100 && vec[10] == 100 && vec.back() == 99*99 && sum == 328350;
+}
+
+constexpr bool constexpr_modifiers() {
+    xd::vector<int> vec = {1, 2, 3, 4, 5};
+    vec.reserve(3);
+    vec.insert(vec.begin(), 0);
+    vec.insert(vec.begin() + 3, {10, 11});
+    vec.erase(vec.begin() + 1);
+    vec.insert(vec.end(), 2, 7);
+    xd::erase_if(vec, [](int x) { return x == 4; });
+    const xd::vector<int> expected = {0, 2, 10, 11, 3, 5, 7, 7};
+    if(vec != expected || vec < expected || !(expected < xd::vector<int>{0, 3})) {
+        return false;
+    }
+    // Range inside the vector itself takes the aliasing path
+    vec.insert(vec.begin(), vec.begin(), vec.begin() + 2);
+    vec.resize(4);
+    vec.shrink_to_fit();
+    xd::vector<int> other(3, 9);
+    other.swap(vec);
+    return vec == xd::vector<int>{9, 9, 9} && other == xd::vector<int>{0, 2, 0, 2} &&
+        other.capacity() == 4 && xd::count(vec, 9) == 3 && xd::contains(other, 2);
+}
+
+constexpr bool constexpr_nested() {
+    xd::vector<xd::vector<int>> nested;
+    for(int i=0; i<10; i++) {
+        nested.emplace_back(size_t(i), i);
+    }
+    nested.erase(nested.begin());
+    xd::vector<xd::vector<int>> copy = nested;
+    copy.insert(copy.begin() + 2, xd::vector<int>{42});
+    xd::vector<xd::vector<int>> moved = std::move(copy);
+    return moved.size() == 10 && moved[2][0] == 42 && moved[3] == xd::vector<int>(3, 3) && nested[0] == xd::vector<int>{1};
+}
+
+static_assert(constexpr_push_back(), "push_back isn't usable in constant evaluation");
+static_assert(constexpr_modifiers(), "Modifiers aren't usable in constant evaluation");
+static_assert(constexpr_nested(), "Nested vectors aren't usable in constant evaluation");
+
+constexpr auto square_table = xd::to_static_array<[]() {
+    xd::vector<uint32_t> vec;
+    for(uint32_t i=0; i<16; i++) {
+        vec.push_back(i*i);
+    }
+    return vec;
+}>();
+static_assert(square_table.size() == 16 && square_table[15] == 225, "to_static_array lost elements");
+#endif
+
+void test_constexpr() {
+#if XD_CONSTEXPR_CONTAINERS
+    // Same code at runtime goes through the memcpy and SIMD paths
+    assert(constexpr_push_back(), "push_back differs at runtime");
+    assert(constexpr_modifiers(), "Modifiers differ at runtime");
+    assert(constexpr_nested(), "Nested vectors differ at runtime");
+    assert(square_table[7] == 49, "to_static_array table is wrong at runtime");
+#endif
+}
+
+void test_uninitialized_growth() {
+    xd::vector<char> buffer = {'a', 'b'};
+    const char* chunks[] = {"hello", " ", "world, this is longer than the spare space"};
+    for(const char* chunk: chunks) {
+        const size_t len = strlen(chunk);
+        // Ask for more than is written, like a read() that comes up short
+        char* tail = buffer.append_uninitialized(len + 16);
+        assert(buffer.capacity() >= buffer.size() + len + 16, "append_uninitialized didn't make room");
+        memcpy(tail, chunk, len);
+        buffer.commit(len);
+    }
+    const std::string expected = "abhello world, this is longer than the spare space";
+    assert(std::string(buffer.begin(), buffer.end()) == expected, "Committed bytes don't match what was written");
+    bool threw = false;
+    try {
+        buffer.commit(buffer.capacity() - buffer.size() + 1);
+    } catch(const std::length_error&) {
+        threw = true;
+    }
+    assert(threw && buffer.size() == expected.size(), "Committing past the capacity didn't throw");
+
+    xd::vector<uint32_t> ints = {1, 2, 3};
+    uint32_t* fresh = ints.resize_for_overwrite(6);
+    assert(fresh == ints.data() + 3 && ints.size() == 6, "resize_for_overwrite didn't grow");
+    for(uint32_t i=0; i<3; i++) {
+        fresh[i] = 4 + i;
+    }
+    assert(ints[0] == 1 && ints[5] == 6, "resize_for_overwrite lost the old elements");
+    assert(ints.resize_for_overwrite(2) == ints.end() && ints.size() == 2 && ints[1] == 2, "resize_for_overwrite didn't shrink");
+}
 
 int main() {
     xd::vector<uint32_t> int_list((size_t)10, 45);
@@ -175,5 +599,15 @@ int main() {
     swapped.resize(1);
     assert(swapped[0]==0 && swapped.size()==1, "Resize shrink failed");
     test_comparisons();
+    test_allocator();
+    test_relocation();
+    test_growth();
+    test_bounds_check();
+    test_range_insert();
+    test_compaction();
+    test_kernels();
+    test_aligned_storage();
+    test_constexpr();
+    test_uninitialized_growth();
     return 0;
 }